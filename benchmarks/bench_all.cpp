@@ -0,0 +1,617 @@
+/**
+ * @file bench_all.cpp
+ */
+
+#include <algorithm>      // for std::copy, std::max, std::sort
+#include <chrono>         // for std::chrono
+#include <cstddef>        // for std::size_t
+#include <cstdint>        // for std::uint8_t, std::uint32_t, std::uint64_t
+#include <cstdio>         // for std::FILE, std::fopen, std::fclose
+#include <cstdlib>        // for EXIT_FAILURE, EXIT_SUCCESS
+#include <exception>      // for std::exception
+#include <filesystem>     // for std::filesystem
+#include <fstream>        // for std::ofstream
+#include <functional>     // for std::function
+#include <ios>            // for std::ios
+#include <iterator>       // for std::back_inserter
+#include <string>         // for std::string
+#include <string_view>    // for std::string_view
+#include <thread>         // for std::thread
+#include <unistd.h>       // for getpid
+#include <unordered_map>  // for std::unordered_map
+#include <utmpx.h>        // for struct utmpx, USER_PROCESS, DEAD_PROCESS
+#include <vector>         // for std::vector
+
+#include <fmt/core.h>
+#include <zlib.h>      // for compress2, compressBound, crc32, Z_OK
+
+#include "core/aggregate.hpp"
+#include "core/diff.hpp"
+#include "core/dump.hpp"
+#include "core/ring.hpp"
+#include "core/width.hpp"
+#include "modules/image.hpp"
+#include "modules/packages.hpp"
+#include "modules/record.hpp"
+#include "modules/sessions.hpp"
+
+#if defined(APPLEFETCH_EXECUTABLE)
+#include "applefetch.h"
+#include "core/shell.hpp"
+#endif
+
+namespace {
+
+/**
+ * @brief Struct that represents the timings of a benchmark.
+ */
+struct Timings final {
+    /**
+     * @brief Fastest iteration in milliseconds (e.g., "4.2").
+     */
+    double min_ms = 0.0;
+
+    /**
+     * @brief Median iteration in milliseconds (e.g., "4.8").
+     */
+    double median_ms = 0.0;
+};
+
+/**
+ * @brief Run a function repeatedly and measure it, after one untimed warm-up run.
+ *
+ * @param iterations Number of timed iterations (e.g., "10").
+ * @param function Function to measure.
+ *
+ * @return Fastest and median iteration.
+ */
+[[nodiscard]] Timings measure(const std::size_t iterations,
+                              const std::function<void()> &function)
+{
+    function();
+    std::vector<double> samples;
+    samples.reserve(iterations);
+    for (std::size_t i = 0; i < iterations; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        function();
+        const auto end = std::chrono::steady_clock::now();
+        samples.emplace_back(std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    std::sort(samples.begin(), samples.end());
+    return {samples.front(), samples[samples.size() / 2]};
+}
+
+/**
+ * @brief Create a unique, empty temporary directory for a benchmark fixture.
+ *
+ * @param name Name of the fixture (e.g., "homebrew").
+ *
+ * @return Path to the created directory (e.g., "/tmp/applefetch-benchmarks-4242/homebrew").
+ */
+[[nodiscard]] std::filesystem::path make_fixture_directory(const std::string &name)
+{
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / fmt::format("applefetch-benchmarks-{}", getpid()) / name;
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    return directory;
+}
+
+/**
+ * @brief Write a fixture file, creating parent directories as needed.
+ *
+ * @param path Path to the file.
+ * @param content Content of the file.
+ */
+void write_fixture_file(const std::filesystem::path &path,
+                        const std::string_view content)
+{
+    std::filesystem::create_directories(path.parent_path());
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << content;
+}
+
+/**
+ * @brief Append a PNG chunk with its length and CRC.
+ *
+ * @param type Chunk type (e.g., "IDAT").
+ * @param data Chunk data.
+ * @param output String to append to.
+ */
+void append_png_chunk(const std::string_view type,
+                      const std::string_view data,
+                      std::string &output)
+{
+    const auto append_u32 = [&output](const std::uint32_t value) {
+        output.push_back(static_cast<char>(value >> 24));
+        output.push_back(static_cast<char>(value >> 16));
+        output.push_back(static_cast<char>(value >> 8));
+        output.push_back(static_cast<char>(value));
+    };
+    append_u32(static_cast<std::uint32_t>(data.size()));
+    const std::size_t start = output.size();
+    output.append(type).append(data);
+    const auto *bytes = reinterpret_cast<const unsigned char *>(output.data() + start);
+    append_u32(static_cast<std::uint32_t>(crc32(0, bytes, static_cast<uInt>(output.size() - start))));
+}
+
+/**
+ * @brief Encode a square RGBA PNG that looks like a logo: a gradient disc on a transparent background, with every row Sub-filtered as encoders do for such images.
+ *
+ * @param size Width and height in pixels (e.g., "1024").
+ *
+ * @return Contents of the PNG file.
+ */
+[[nodiscard]] std::string make_png(const std::size_t size)
+{
+    std::string raw;
+    raw.reserve(size * (size * 4 + 1));
+    const long center = static_cast<long>(size / 2);
+    const long radius = center - center / 16;
+    for (std::size_t y = 0; y < size; ++y) {
+        raw.push_back('\x01');  // Filter: Sub
+        std::uint8_t previous[4] = {0, 0, 0, 0};
+        for (std::size_t x = 0; x < size; ++x) {
+            const long dx = static_cast<long>(x) - center;
+            const long dy = static_cast<long>(y) - center;
+            const bool inside = dx * dx + dy * dy < radius * radius;
+            const std::uint8_t pixel[4] = {static_cast<std::uint8_t>(inside ? x * 255 / size : 0),
+                                           static_cast<std::uint8_t>(inside ? y * 255 / size : 0),
+                                           static_cast<std::uint8_t>(inside ? 255 - x * 255 / size : 0),
+                                           static_cast<std::uint8_t>(inside ? 255 : 0)};
+            for (std::size_t c = 0; c < 4; ++c) {
+                raw.push_back(static_cast<char>(pixel[c] - previous[c]));
+                previous[c] = pixel[c];
+            }
+        }
+    }
+    std::string compressed(compressBound(static_cast<uLong>(raw.size())), '\0');
+    uLongf compressed_size = static_cast<uLongf>(compressed.size());
+    if (compress2(reinterpret_cast<Bytef *>(compressed.data()), &compressed_size, reinterpret_cast<const Bytef *>(raw.data()), static_cast<uLong>(raw.size()), 6) != Z_OK) {
+        return {};
+    }
+    compressed.resize(compressed_size);
+
+    std::string header;
+    for (const std::size_t dimension : {size, size}) {
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            header.push_back(static_cast<char>(dimension >> shift));
+        }
+    }
+    header.append("\x08\x06\x00\x00\x00", 5);  // 8-bit RGBA, not interlaced
+    std::string png("\x89PNG\r\n\x1a\n", 8);
+    append_png_chunk("IHDR", header, png);
+    append_png_chunk("IDAT", compressed, png);
+    append_png_chunk("IEND", "", png);
+    return png;
+}
+
+}  // namespace
+
+namespace bench_packages {
+[[nodiscard]] int scan_homebrew();
+}  // namespace bench_packages
+
+namespace bench_image {
+[[nodiscard]] int render();
+}  // namespace bench_image
+
+namespace bench_ring {
+[[nodiscard]] int append();
+}  // namespace bench_ring
+
+namespace bench_aggregate {
+[[nodiscard]] int corpus();
+}  // namespace bench_aggregate
+
+namespace bench_diff {
+[[nodiscard]] int packages();
+}  // namespace bench_diff
+
+namespace bench_dump {
+[[nodiscard]] int tree();
+}  // namespace bench_dump
+
+namespace bench_sessions {
+[[nodiscard]] int scan();
+}  // namespace bench_sessions
+
+namespace bench_width {
+[[nodiscard]] int measure();
+}  // namespace bench_width
+
+#if defined(APPLEFETCH_EXECUTABLE)
+namespace bench_capi {
+[[nodiscard]] int refresh_volatile();
+}  // namespace bench_capi
+#endif
+
+/**
+ * @brief Entry-point of the benchmark application.
+ *
+ * @param argc Number of command-line arguments (e.g., "2").
+ * @param argv Array of command-line arguments (e.g., {"./bin", "-h"}).
+ *
+ * @return EXIT_SUCCESS if the benchmark ran within its budget, EXIT_FAILURE otherwise.
+ */
+int main(int argc,
+         char **argv)
+{
+    // Define the formatted help message
+    const std::string help_message = fmt::format(
+        "Usage: {} <benchmark>\n"
+        "\n"
+        "Run benchmarks.\n"
+        "\n"
+        "Positional arguments:\n"
+        "  benchmark  name of the benchmark to run ('all' to run all benchmarks)\n",
+        argv[0]);
+
+    // If no arguments, print help message and exit
+    if (argc == 1) {
+        fmt::print("{}\n", help_message);
+        return EXIT_FAILURE;
+    }
+
+    // Otherwise, define argument to function mapping
+    const std::unordered_map<std::string, std::function<int()>> benchmarks = {
+        {"bench_packages::scan_homebrew", bench_packages::scan_homebrew},
+        {"bench_image::render", bench_image::render},
+        {"bench_ring::append", bench_ring::append},
+        {"bench_aggregate::corpus", bench_aggregate::corpus},
+        {"bench_diff::packages", bench_diff::packages},
+        {"bench_dump::tree", bench_dump::tree},
+        {"bench_sessions::scan", bench_sessions::scan},
+        {"bench_width::measure", bench_width::measure},
+#if defined(APPLEFETCH_EXECUTABLE)
+        {"bench_capi::refresh_volatile", bench_capi::refresh_volatile},
+#endif
+    };
+
+    // Get the benchmark name from the command-line arguments
+    const std::string arg = argv[1];
+
+    // If the benchmark name is found, run the corresponding benchmark
+    if (const auto it = benchmarks.find(arg); it != benchmarks.cend()) {
+        try {
+            return it->second();
+        }
+        catch (const std::exception &e) {
+            fmt::print(stderr, "Benchmark '{}' threw an exception: {}\n", arg, e.what());
+            return EXIT_FAILURE;
+        }
+    }
+    else if (arg == "all") {
+        // Run all benchmarks sequentially and print the results
+        bool all_passed = true;
+        for (const auto &[name, benchmark_func] : benchmarks) {
+            fmt::print("Running benchmark: {}\n", name);
+            try {
+                if (benchmark_func() != EXIT_SUCCESS) {
+                    all_passed = false;
+                    fmt::print(stderr, "Benchmark '{}' failed.\n", name);
+                }
+            }
+            catch (const std::exception &e) {
+                all_passed = false;
+                fmt::print(stderr, "Benchmark '{}' threw an exception: {}\n", name, e.what());
+            }
+        }
+        return all_passed ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    else {
+        fmt::print(stderr, "Error: Invalid benchmark name: '{}'\n\n{}\n", arg, help_message);
+        return EXIT_FAILURE;
+    }
+}
+
+int bench_packages::scan_homebrew()
+{
+    // Synthetic Cellar of 2,000 kegs, where every keg depends on the three kegs that follow it
+    constexpr std::size_t keg_count = 2000;
+    constexpr double budget_ms = 50.0;
+    const auto prefix = make_fixture_directory("homebrew");
+    std::filesystem::create_directories(prefix / "opt");
+    for (std::size_t i = 0; i < keg_count; ++i) {
+        std::string dependencies;
+        for (std::size_t j = i + 1; j < keg_count && j <= i + 3; ++j) {
+            dependencies += fmt::format(R"({}{{"full_name":"formula-{}","version":"1.0","revision":0,"pkg_version":"1.0","declared_directly":true}})",
+                                        dependencies.empty() ? "" : ",", j);
+        }
+        const std::string name = fmt::format("formula-{}", i);
+        write_fixture_file(prefix / "Cellar" / name / "1.0" / "INSTALL_RECEIPT.json",
+                           fmt::format(R"({{"homebrew_version":"4.3.0","used_options":[],"unused_options":[],"built_as_bottle":true,"poured_from_bottle":true,)"
+                                       R"("loaded_from_api":true,"installed_as_dependency":{},"installed_on_request":{},"changed_files":[],"time":1722470400,)"
+                                       R"("source_modified_time":1720000000,"compiler":"clang","aliases":[],"runtime_dependencies":[{}],)"
+                                       R"("source":{{"path":"/opt/homebrew/Library/Taps/homebrew/homebrew-core/Formula/{}.rb","tap":"homebrew/core","spec":"stable",)"
+                                       R"("versions":{{"stable":"1.0","head":null,"version_scheme":0}}}},"arch":"arm64","built_on":{{"os":"Macintosh","os_version":"macOS 14"}}}})",
+                                       i != 0, i == 0, dependencies, name));
+        std::filesystem::create_directory_symlink(std::filesystem::path("..") / "Cellar" / name / "1.0", prefix / "opt" / name);
+    }
+
+    std::size_t leaves = 0;
+    const Timings timings = measure(10, [&prefix, &leaves]() {
+        leaves = modules::packages::scan_homebrew(prefix).value_or(modules::packages::HomebrewSummary{}).leaves;
+    });
+    std::filesystem::remove_all(prefix);
+
+    fmt::print("modules::packages::scan_homebrew() on {} kegs: min {:.2f} ms, median {:.2f} ms (budget {:.0f} ms)\n", keg_count, timings.min_ms, timings.median_ms, budget_ms);
+    if (leaves != 1) {
+        fmt::print(stderr, "modules::packages::scan_homebrew() returned {} leaves, expected 1\n", leaves);
+        return EXIT_FAILURE;
+    }
+    return timings.median_ms < budget_ms ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int bench_image::render()
+{
+    // Rendering without a cache hit decodes, downscales and encodes the whole image, which must not delay the fetch
+    // Inflating the 4 MiB of pixels alone takes about 5 ms, and the full render about 12 ms, so the budget leaves room for slower machines
+    constexpr std::size_t size = 1024;
+    constexpr double budget_ms = 20.0;
+    const std::string png = make_png(size);
+    bool rendered = true;
+    const Timings kitty = measure(10, [&png, &rendered]() {
+        rendered = rendered && modules::image::render(png, modules::image::Protocol::Kitty, {}).has_value();
+    });
+    const Timings sixel = measure(10, [&png, &rendered]() {
+        rendered = rendered && modules::image::render(png, modules::image::Protocol::Sixel, {}).has_value();
+    });
+
+    fmt::print("modules::image::render() of a {}x{} PNG (kitty): min {:.2f} ms, median {:.2f} ms (budget {:.0f} ms)\n", size, size, kitty.min_ms, kitty.median_ms, budget_ms);
+    fmt::print("modules::image::render() of a {}x{} PNG (sixel): min {:.2f} ms, median {:.2f} ms (budget {:.0f} ms)\n", size, size, sixel.min_ms, sixel.median_ms, budget_ms);
+    if (!rendered) {
+        fmt::print(stderr, "modules::image::render() failed to render the PNG\n");
+        return EXIT_FAILURE;
+    }
+    return kitty.median_ms < budget_ms && sixel.median_ms < budget_ms ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int bench_ring::append()
+{
+    // Recording runs for days next to everything else, so a day of samples must take a few milliseconds in total
+    constexpr std::uint64_t sample_count = 86400;
+    constexpr double budget_ms = 20.0;
+    const std::string path = (make_fixture_directory("ring") / "bench.ring").string();
+    core::ring::Writer writer(path, modules::record::value_count, modules::record::block_count);
+
+    // Realistic drift: memory moves by a few pages, load by a few hundredths and page-ins by a few pages per second
+    modules::record::Sample sample = {1722470400, 1548000, 11681468, 524288, 241, 212, 198, 4318822, 16802, 0, 0};
+    const Timings timings = measure(10, [&writer, &sample]() {
+        for (std::uint64_t i = 0; i < sample_count; ++i) {
+            sample[0] += 1;
+            sample[1] += 1;
+            sample[2] += (i * 7919) % 64 - 32;
+            sample[4] = 200 + (i * 31) % 80;
+            sample[7] += (i * 13) % 6;
+            writer.append(sample.data());
+        }
+    });
+
+    fmt::print("core::ring::Writer::append() of {} samples: min {:.2f} ms, median {:.2f} ms (budget {:.0f} ms)\n", sample_count, timings.min_ms, timings.median_ms, budget_ms);
+    return timings.median_ms < budget_ms ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int bench_aggregate::corpus()
+{
+    // A fleet of 100,000 hosts, one snapshot each, spread over a few OS versions, models and memory sizes
+    constexpr std::size_t snapshot_count = 100000;
+    constexpr double budget_ms = 2000.0;
+    const auto directory = make_fixture_directory("aggregate");
+    for (std::size_t i = 0; i < snapshot_count; ++i) {
+        write_fixture_file(directory / fmt::format("host-{:06}.json", i),
+                           fmt::format(R"json({{"fields":{{"OS":"macOS {}.{} (arm64)","Model":"MacBook Pro ({}-inch, {})","Uptime":"{}d 2h 3m",)json"
+                                       R"json("Packages":"{} (brew, 42 leaves, 3 pinned)","Shell":"zsh 5.9","CPU":"Apple M{} Pro",)json"
+                                       R"json("Memory":"10.16GiB / {}.00GiB (63%)"}}}})json",
+                                       13 + i % 3, i % 7, i % 2 == 0 ? 14 : 16, 2021 + i % 4, i % 30, (i * 7919) % 600, 1 + i % 4, 8 << (i % 3)));
+    }
+
+    // The corpus fits in the page cache after the warm-up run, so this measures parsing and merging rather than the disk
+    const std::vector<std::string> paths = core::aggregate::expand_paths({directory.string()});
+    std::size_t parallel_count = 0;
+    std::size_t serial_count = 0;
+    const Timings parallel = measure(5, [&paths, &parallel_count]() {
+        parallel_count = core::aggregate::aggregate(paths).snapshots;
+    });
+    const Timings serial = measure(5, [&paths, &serial_count]() {
+        serial_count = core::aggregate::aggregate(paths, 1).snapshots;
+    });
+    std::filesystem::remove_all(directory);
+
+    const unsigned int thread_count = std::max(1U, std::thread::hardware_concurrency());
+    fmt::print("core::aggregate::aggregate() of {} snapshots ({} threads): min {:.2f} ms, median {:.2f} ms (budget {:.0f} ms)\n", snapshot_count, thread_count, parallel.min_ms, parallel.median_ms, budget_ms);
+    fmt::print("core::aggregate::aggregate() of {} snapshots (1 thread): min {:.2f} ms, median {:.2f} ms, speedup {:.2f}x\n", snapshot_count, serial.min_ms, serial.median_ms, serial.median_ms / parallel.median_ms);
+    if (parallel_count != snapshot_count || serial_count != snapshot_count) {
+        fmt::print(stderr, "core::aggregate::aggregate() parsed {} and {} snapshots, expected {}\n", parallel_count, serial_count, snapshot_count);
+        return EXIT_FAILURE;
+    }
+    return parallel.median_ms < budget_ms ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int bench_diff::packages()
+{
+    // Two snapshots of a build host with 20,000 packages each, in no particular order, of which 1,000 were upgraded
+    constexpr std::size_t package_count = 20000;
+    constexpr double budget_ms = 20.0;
+    const auto directory = make_fixture_directory("diff");
+    for (const bool upgraded : {false, true}) {
+        std::string packages;
+        for (std::size_t i = 0; i < package_count; ++i) {
+            const std::size_t index = (i * 7919) % package_count;
+            fmt::format_to(std::back_inserter(packages), R"({}"formula-{}@{}")", i == 0 ? "" : ",", index, upgraded && index % 20 == 0 ? 2 : 1);
+        }
+        write_fixture_file(directory / (upgraded ? "after.json" : "before.json"),
+                           fmt::format(R"json({{"fields":{{"OS":"macOS 15.{} (arm64)","Packages":[{}]}}}})json", upgraded ? 1 : 0, packages));
+    }
+
+    std::size_t added = 0;
+    const Timings timings = measure(10, [&directory, &added]() {
+        const auto changes = core::diff::compare(core::diff::read_snapshot((directory / "before.json").string()), core::diff::read_snapshot((directory / "after.json").string()));
+        added = changes.size() == 2 ? changes[1].added.size() : 0;
+    });
+    std::filesystem::remove_all(directory);
+
+    fmt::print("core::diff::compare() of two snapshots with {} packages: min {:.2f} ms, median {:.2f} ms (budget {:.0f} ms)\n", package_count, timings.min_ms, timings.median_ms, budget_ms);
+    if (added != package_count / 20) {
+        fmt::print(stderr, "core::diff::compare() found {} added packages, expected {}\n", added, package_count / 20);
+        return EXIT_FAILURE;
+    }
+    return timings.median_ms < budget_ms ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int bench_dump::tree()
+{
+    // A tree shaped like /proc/sys on a host with many interfaces, but deeper: 10 top-level directories, 3 more levels of 8 directories, and 2 variables per leaf directory
+    constexpr std::size_t top_count = 10;
+    constexpr std::size_t fanout = 8;
+    constexpr std::size_t files_per_leaf = 2;
+    constexpr std::size_t variable_count = top_count * fanout * fanout * fanout * files_per_leaf;
+    constexpr double budget_ms = 100.0;
+    const auto directory = make_fixture_directory("dump");
+    for (std::size_t top = 0; top < top_count; ++top) {
+        for (std::size_t i = 0; i < fanout * fanout * fanout; ++i) {
+            const auto leaf = directory / fmt::format("top{}", top) / fmt::format("eth{}.{}", i / (fanout * fanout), i / fanout % fanout) / fmt::format("conf{}", i % fanout);
+            for (std::size_t file = 0; file < files_per_leaf; ++file) {
+                write_fixture_file(leaf / fmt::format("var_{}", file), fmt::format("{}\t{}\n", i, file * 4096));
+            }
+        }
+    }
+
+    // The tree fits in the dentry and page caches after the warm-up run, as /proc/sys always does
+    std::FILE *output = std::fopen("/dev/null", "w");
+    std::size_t parallel_count = 0;
+    std::size_t serial_count = 0;
+    const core::dump::Pattern pattern("");
+    const Timings parallel = measure(10, [&directory, &pattern, output, &parallel_count]() {
+        parallel_count = core::dump::dump_tree(directory, pattern, core::dump::Format::Text, output);
+    });
+    const Timings serial = measure(10, [&directory, &pattern, output, &serial_count]() {
+        serial_count = core::dump::dump_tree(directory, pattern, core::dump::Format::Text, output, 1);
+    });
+    std::size_t filtered_count = 0;
+    const core::dump::Pattern filtered_pattern("top3.*conf1.var_?");
+    const Timings filtered = measure(10, [&directory, &filtered_pattern, output, &filtered_count]() {
+        filtered_count = core::dump::dump_tree(directory, filtered_pattern, core::dump::Format::Ndjson, output);
+    });
+    std::fclose(output);
+    std::filesystem::remove_all(directory);
+
+    const unsigned int thread_count = std::max(1U, std::thread::hardware_concurrency());
+    fmt::print("core::dump::dump_tree() of {} variables ({} threads): min {:.2f} ms, median {:.2f} ms (budget {:.0f} ms)\n", variable_count, thread_count, parallel.min_ms, parallel.median_ms, budget_ms);
+    fmt::print("core::dump::dump_tree() of {} variables (1 thread): min {:.2f} ms, median {:.2f} ms, speedup {:.2f}x\n", variable_count, serial.min_ms, serial.median_ms, serial.median_ms / parallel.median_ms);
+    fmt::print("core::dump::dump_tree() of {} variables matching \"top3.*conf1.var_?\": min {:.2f} ms, median {:.2f} ms\n", filtered_count, filtered.min_ms, filtered.median_ms);
+    if (parallel_count != variable_count || serial_count != variable_count || filtered_count != fanout * fanout * files_per_leaf) {
+        fmt::print(stderr, "core::dump::dump_tree() dumped {}, {} and {} variables, expected {}, {} and {}\n", parallel_count, serial_count, filtered_count, variable_count, variable_count,
+                   fanout * fanout * files_per_leaf);
+        return EXIT_FAILURE;
+    }
+    return parallel.median_ms < budget_ms ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int bench_sessions::scan()
+{
+    // A jump host whose database was never compacted: 50,000 records, mostly dead, with 2,000 live sessions of 300 users
+    constexpr std::size_t record_count = 50000;
+    constexpr std::size_t session_count = 2000;
+    constexpr double budget_ms = 1.0;
+    std::string records;
+    records.reserve(record_count * sizeof(struct utmpx));
+    for (std::size_t i = 0; i < record_count; ++i) {
+        struct utmpx record{};
+        const bool live = i % (record_count / session_count) == 0;
+        const std::string user = fmt::format("user{}", (live ? i / (record_count / session_count) : i) % 300);
+        record.ut_type = live ? USER_PROCESS : DEAD_PROCESS;
+        std::copy(user.begin(), user.end(), record.ut_user);
+        records.append(reinterpret_cast<const char *>(&record), sizeof(record));
+    }
+    const auto directory = make_fixture_directory("sessions");
+    write_fixture_file(directory / "utmp", records);
+
+    // The database is in the page cache after the warm-up run, as it is on a host where logins keep it warm
+    modules::sessions::Sessions sessions;
+    const Timings timings = measure(20, [&directory, &sessions]() {
+        sessions = modules::sessions::read_sessions(directory / "utmp").value_or(modules::sessions::Sessions{});
+    });
+    std::filesystem::remove_all(directory);
+
+    fmt::print("modules::sessions::read_sessions() of {} records: min {:.3f} ms, median {:.3f} ms (budget {:.0f} ms)\n", record_count, timings.min_ms, timings.median_ms, budget_ms);
+    if (sessions.sessions != session_count || sessions.users != 300) {
+        fmt::print(stderr, "modules::sessions::read_sessions() found {} sessions of {} users, expected {} of 300\n", sessions.sessions, sessions.users, session_count);
+        return EXIT_FAILURE;
+    }
+    return timings.median_ms < budget_ms ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int bench_width::measure()
+{
+    // 1 MB of output like an inventory or package list: mostly ASCII lines, with colored, CJK and emoji ones mixed in
+    constexpr std::size_t text_size = 1 << 20;
+    constexpr double budget_ms = 2.0;
+    constexpr std::string_view lines[] = {
+        "PCI  0000:00:02.0  8086:3e9b  Intel Corporation  CoffeeLake-H GT2 [UHD Graphics 630]\n",
+        "\033[1m\033[33mPackages: \033[0m\033[37m1432 (brew), 18 (cask)\033[0m\n",
+        "USB  1-1  0411:01f0  株式会社バッファロー  ポータブル HDD\n",
+        "python@3.12  3.12.4  Interpreted, interactive, object-oriented programming language\n",
+        "café-au-lait 1.0.0 ☕ \U0001F600 résumé naïve\n",
+        "openssl@3  3.3.1  Cryptography and SSL/TLS Toolkit\n",
+    };
+    std::string mixed;
+    std::string ascii;
+    for (std::size_t i = 0; mixed.size() < text_size; ++i) {
+        mixed.append(lines[i % std::size(lines)]);
+    }
+    for (std::size_t i = 0; ascii.size() < text_size; ++i) {
+        ascii.append(lines[(i % 2) * 3]);
+    }
+
+    // The scalar decoder is the baseline: one table lookup per codepoint, like calling wcwidth() on each
+    std::size_t fast_width = 0;
+    std::size_t slow_width = 0;
+    std::size_t ascii_width = 0;
+    const Timings fast = ::measure(20, [&mixed, &fast_width]() {
+        fast_width = core::width::get_width(mixed);
+    });
+    const Timings slow = ::measure(20, [&mixed, &slow_width]() {
+        slow_width = core::width::measure(mixed);
+    });
+    const Timings plain = ::measure(20, [&ascii, &ascii_width]() {
+        ascii_width = core::width::get_width(ascii);
+    });
+
+    fmt::print("core::width::get_width() of {} bytes of mixed text: min {:.3f} ms, median {:.3f} ms (budget {:.0f} ms)\n", mixed.size(), fast.min_ms, fast.median_ms, budget_ms);
+    fmt::print("core::width::measure() of the same text: min {:.3f} ms, median {:.3f} ms ({:.1f}x slower)\n", slow.min_ms, slow.median_ms, slow.median_ms / fast.median_ms);
+    fmt::print("core::width::get_width() of {} bytes of ASCII: min {:.3f} ms, median {:.3f} ms\n", ascii.size(), plain.min_ms, plain.median_ms);
+    if (fast_width != slow_width || ascii_width != core::width::measure(ascii)) {
+        fmt::print(stderr, "core::width::get_width() returned {} columns, core::width::measure() {}\n", fast_width, slow_width);
+        return EXIT_FAILURE;
+    }
+    return fast.median_ms < budget_ms ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#if defined(APPLEFETCH_EXECUTABLE)
+int bench_capi::refresh_volatile()
+{
+    // A status bar polls uptime and memory every few seconds, so a refresh must cost microseconds, not a process spawn
+    constexpr double budget_ms = 0.1;
+    af_context *ctx = af_create(AF_API_VERSION);
+    if (!ctx) {
+        fmt::print(stderr, "af_create() failed\n");
+        return EXIT_FAILURE;
+    }
+    af_status status = AF_OK;
+    const Timings in_process = measure(1000, [ctx, &status]() {
+        status = af_refresh(ctx, AF_FIELDS_VOLATILE);
+    });
+    af_destroy(ctx);
+    const Timings spawned = measure(10, []() {
+        static_cast<void>(core::shell::get_output(fmt::format("'{}'", APPLEFETCH_EXECUTABLE)));
+    });
+
+    fmt::print("af_refresh(AF_FIELDS_VOLATILE): min {:.4f} ms, median {:.4f} ms (budget {:.1f} ms)\n", in_process.min_ms, in_process.median_ms, budget_ms);
+    fmt::print("{}: min {:.2f} ms, median {:.2f} ms ({:.0f}x slower)\n", APPLEFETCH_EXECUTABLE, spawned.min_ms, spawned.median_ms, spawned.median_ms / in_process.median_ms);
+    if (status != AF_OK) {
+        fmt::print(stderr, "af_refresh(AF_FIELDS_VOLATILE) failed with status {}\n", static_cast<int>(status));
+        return EXIT_FAILURE;
+    }
+    return in_process.median_ms < budget_ms && in_process.median_ms < spawned.median_ms ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+#endif
@@ -20,8 +20,19 @@ function(fetch_and_link_external_dependencies target)
 
   # Make dependencies available
   FetchContent_MakeAvailable(fmt)
+  find_package(Threads REQUIRED)
+
+  # zlib ships with macOS, it is only used to inflate PNG images
+  find_package(ZLIB REQUIRED)
 
   # Link dependencies to the target
-  target_link_libraries(${target} PUBLIC fmt::fmt "-framework CoreGraphics")
-  message(STATUS "Linked dependencies 'fmt' and 'CoreGraphics' to target '${target}'.")
+  # dlopen() lives in libdl on older glibc, and in libc everywhere else (CMAKE_DL_LIBS is empty there)
+  target_link_libraries(${target} PUBLIC fmt::fmt Threads::Threads ZLIB::ZLIB ${CMAKE_DL_LIBS})
+  message(STATUS "Linked dependencies 'fmt', 'Threads', 'ZLIB' and 'dl' to target '${target}'.")
+
+  # The frameworks only exist on macOS; Linux reads the same information from procfs and sysfs
+  if(APPLE)
+    target_link_libraries(${target} PUBLIC "-framework CoreGraphics" "-framework CoreFoundation" "-framework IOKit")
+    message(STATUS "Linked frameworks 'CoreGraphics', 'CoreFoundation' and 'IOKit' to target '${target}'.")
+  endif()
 endfunction()
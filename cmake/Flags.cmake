@@ -8,14 +8,15 @@ function(apply_compile_flags target)
   target_compile_options(${target} PUBLIC
     -Wall                  # Enable all common warnings
     -Wextra                # Enable extra warnings
-    -Wpedantic             # Enforce ISO C++ standards strictly
+    -Wpedantic             # Enforce ISO C and C++ standards strictly
     -Werror                # Treat all warnings as errors
     -Wconversion           # Warn on implicit type conversions that may change value
     -Wsign-conversion      # Warn on sign conversions
     -Wshadow               # Warn when variables shadow others
-    -Wnon-virtual-dtor     # Warn on classes with virtual functions but non-virtual destructors
-    -Wold-style-cast       # Warn on C-style casts
-    -Woverloaded-virtual   # Warn when a derived class function hides a virtual function
+    # C++ only, since C targets (e.g., the C API test) get the same flags and GCC rejects these for C
+    $<$<COMPILE_LANGUAGE:CXX>:-Wnon-virtual-dtor>    # Warn on classes with virtual functions but non-virtual destructors
+    $<$<COMPILE_LANGUAGE:CXX>:-Wold-style-cast>      # Warn on C-style casts
+    $<$<COMPILE_LANGUAGE:CXX>:-Woverloaded-virtual>  # Warn when a derived class function hides a virtual function
     -Wnull-dereference     # Warn if null dereference is detected
     -Wdouble-promotion     # Warn when a float is implicitly promoted to double
     -Wcast-align           # Warn on cast that increases required alignment
@@ -0,0 +1,49 @@
+# Generate the C++ initializer list of the model name table from a tab-separated data file.
+#
+# Usage: cmake -DINPUT=data/models.tsv -DOUTPUT=generated/model_names.inc -P cmake/GenerateModelNames.cmake
+#
+# Every non-empty line that does not start with "#" must be "<identifier><TAB><marketing name>".
+# The perfect hash itself is built at compile time (see src/core/perfect_hash.hpp), so this script only has to validate and escape the data.
+
+cmake_minimum_required(VERSION 3.18)
+
+if(NOT DEFINED INPUT OR NOT DEFINED OUTPUT)
+  message(FATAL_ERROR "Both INPUT and OUTPUT must be defined.")
+endif()
+
+file(STRINGS "${INPUT}" lines ENCODING UTF-8)
+
+get_filename_component(input_name "${INPUT}" NAME)
+get_filename_component(script_name "${CMAKE_CURRENT_LIST_FILE}" NAME)
+set(content "// Generated from ${input_name} by ${script_name}, do not edit.\n")
+set(identifiers "")
+set(line_number 0)
+foreach(line IN LISTS lines)
+  math(EXPR line_number "${line_number} + 1")
+  if(line STREQUAL "" OR line MATCHES "^#")
+    continue()
+  endif()
+  if(NOT line MATCHES "^([^\t]+)\t([^\t]+)$")
+    message(FATAL_ERROR "${INPUT}:${line_number}: expected '<identifier><TAB><marketing name>', got '${line}'.")
+  endif()
+  set(identifier "${CMAKE_MATCH_1}")
+  set(name "${CMAKE_MATCH_2}")
+  if(identifier IN_LIST identifiers)
+    message(FATAL_ERROR "${INPUT}:${line_number}: duplicate identifier '${identifier}'.")
+  endif()
+  list(APPEND identifiers "${identifier}")
+
+  # Escape for a C++ string literal
+  foreach(variable identifier name)
+    string(REPLACE "\\" "\\\\" ${variable} "${${variable}}")
+    string(REPLACE "\"" "\\\"" ${variable} "${${variable}}")
+  endforeach()
+  string(APPEND content "{\"${identifier}\", \"${name}\"},\n")
+endforeach()
+
+if(identifiers STREQUAL "")
+  message(FATAL_ERROR "${INPUT}: no models found.")
+endif()
+
+# Only touch the output if it changed, so that unrelated edits (e.g., comments) do not trigger a rebuild
+file(CONFIGURE OUTPUT "${OUTPUT}" CONTENT "${content}" @ONLY)
@@ -0,0 +1,62 @@
+/**
+ * @file sample.c
+ *
+ * @brief Sample plugin that provides the host name (static) and the local time (volatile).
+ *
+ * Build it as a loadable module and copy it into the plugin directory:
+ * @code
+ * cc -shared -fPIC -fvisibility=hidden -I src/capi plugins/sample.c -o ~/.config/applefetch/plugins/sample.so
+ * @endcode
+ *
+ * Then request its fields in the configuration file:
+ * @code
+ * [plugin sample]
+ * fields = Hostname, Time
+ * @endcode
+ */
+
+#include <stddef.h>  // for size_t
+#include <stdint.h>  // for uint32_t
+#include <time.h>    // for time, localtime_r, strftime, time_t, struct tm
+#include <unistd.h>  // for gethostname
+
+#include "applefetch_plugin.h"
+
+/**
+ * @brief Fields provided by the plugin, in the order of their indices.
+ */
+static const af_plugin_field fields[] = {
+    {"Hostname", AF_PLUGIN_STATIC},
+    {"Time", AF_PLUGIN_VOLATILE},
+};
+
+/**
+ * @brief Probe a field.
+ *
+ * @param field_index Index of the field in "fields".
+ * @param buffer Buffer to write the value to.
+ * @param size Size of the buffer in bytes.
+ *
+ * @return 0 if succeeded, 1 otherwise.
+ */
+static int probe(uint32_t field_index,
+                 char *buffer,
+                 size_t size)
+{
+    if (field_index == 0) {
+        // The name is not null-terminated if it was truncated, which the caller handles
+        return gethostname(buffer, size) == 0 ? 0 : 1;
+    }
+    const time_t now = time(NULL);
+    struct tm local;
+    if (localtime_r(&now, &local) == NULL || strftime(buffer, size, "%H:%M:%S", &local) == 0) {
+        return 1;
+    }
+    return 0;
+}
+
+AF_PLUGIN_EXPORT const af_plugin_descriptor *af_plugin_get_descriptor(void)
+{
+    static const af_plugin_descriptor descriptor = {AF_PLUGIN_ABI_VERSION, "sample", sizeof(fields) / sizeof(fields[0]), fields, probe};
+    return &descriptor;
+}
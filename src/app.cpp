@@ -2,71 +2,585 @@
  * @file app.cpp
  */
 
-#include <string>  // for std::string
+#include <algorithm>  // for std::copy, std::find_if, std::max
+#include <chrono>     // for std::chrono::duration_cast, std::chrono::microseconds, std::chrono::seconds, std::chrono::steady_clock
+#include <cstddef>    // for std::size_t
+#include <cstdint>    // for std::uint64_t
+#include <cstdlib>    // for EXIT_SUCCESS
+#include <cstdio>     // for std::fflush, std::fputs, std::fwrite, stdout
+#include <exception>  // for std::exception
+#include <memory>     // for std::make_unique, std::unique_ptr
+#include <optional>   // for std::optional
+#include <string>     // for std::string
+#include <thread>     // for std::this_thread::sleep_for, std::this_thread::sleep_until
+#include <utility>    // for std::move
+#include <vector>     // for std::vector
 
-#include <fmt/color.h>
 #include <fmt/core.h>
 
 #include "app.hpp"
+#include "core/aggregate.hpp"
+#include "core/args.hpp"
+#include "core/art.hpp"
+#include "core/config.hpp"
+#include "core/diff.hpp"
+#include "core/dump.hpp"
 #include "core/env.hpp"
+#include "core/json.hpp"
+#include "core/layout.hpp"
+#include "core/profile.hpp"
+#include "core/ring.hpp"
+#include "core/text.hpp"
+#include "core/thread.hpp"
+#include "modules/commands.hpp"
 #include "modules/cpu.hpp"
 #include "modules/display.hpp"
 #include "modules/host.hpp"
+#include "modules/image.hpp"
+#include "modules/inventory.hpp"
+#include "modules/logo.hpp"
 #include "modules/memory.hpp"
+#include "modules/packages.hpp"
+#include "modules/plugins.hpp"
+#include "modules/pressure.hpp"
+#include "modules/record.hpp"
+#include "modules/sessions.hpp"
 
 namespace app {
 
-void run()
+namespace {
+
+/**
+ * @brief Run a probe as a profiled scope.
+ *
+ * @tparam Function Type of the probe.
+ * @param title Title of the field (e.g., "CPU").
+ * @param probe Function that returns the value of the field.
+ *
+ * @return Field.
+ */
+template <typename Function>
+[[nodiscard]] core::layout::Field run_probe(const char *title,
+                                            const Function &probe)
 {
-    // Check for NO_COLOR environment variable to determine if color should be disabled
-    bool color_enabled = true;
-    if (const auto no_color = core::env::get_variable("NO_COLOR"); no_color && !no_color->empty()) {
-        color_enabled = false;
+    const core::profile::Scope scope(title);
+    return {title, probe()};
+}
+
+/**
+ * @brief Run the commands, turning an unexpected failure (e.g., std::bad_alloc) into a value for every command.
+ *
+ * @param commands Commands to run.
+ *
+ * @return Values, in the order of the commands; "Unknown $TITLE ($REASON)" for the commands that failed.
+ */
+[[nodiscard]] std::vector<std::string> get_command_values(const std::vector<modules::commands::Command> &commands) noexcept
+{
+    try {
+        return modules::commands::run_commands(commands);
+    }
+    catch (const std::exception &e) {
+        std::vector<std::string> values;
+        for (const modules::commands::Command &command : commands) {
+            values.push_back(fmt::format("Unknown {} ({})", command.title, e.what()));
+        }
+        return values;
+    }
+}
+
+/**
+ * @brief Run the plugins, turning an unexpected failure (e.g., std::bad_alloc) into a value for every field.
+ *
+ * @param plugins Plugins to run.
+ *
+ * @return Values of the requested fields of every plugin, in order; "Unknown $TITLE ($REASON)" for the fields that failed.
+ */
+[[nodiscard]] std::vector<std::vector<std::string>> get_plugin_values(const std::vector<std::unique_ptr<modules::plugins::Plugin>> &plugins) noexcept
+{
+    try {
+        return modules::plugins::run_plugins(plugins);
+    }
+    catch (const std::exception &e) {
+        std::vector<std::vector<std::string>> values;
+        for (const auto &plugin : plugins) {
+            std::vector<std::string> &plugin_values = values.emplace_back();
+            for (const std::string &title : plugin->get_request().fields) {
+                plugin_values.push_back(fmt::format("Unknown {} ({})", title, e.what()));
+            }
+        }
+        return values;
+    }
+}
+
+/**
+ * @brief Format the fields (and the profile, if any) as a JSON object.
+ *
+ * @param fields Fields to format.
+ * @param profiler Profiler whose samples to include, nullptr if not profiling.
+ *
+ * @return JSON object (e.g., "{\"fields\":{\"CPU\":\"Apple M1 Pro\"}}").
+ */
+[[nodiscard]] std::string format_json(const std::vector<core::layout::Field> &fields,
+                                      const core::profile::Profiler *profiler)
+{
+    std::string output = R"({"fields":{)";
+    for (std::size_t i = 0; i < fields.size(); ++i) {
+        output.append(i == 0 ? "" : ",").append(core::json::quote(fields[i].title)).append(":").append(core::json::quote(fields[i].value));
+    }
+    output += '}';
+    if (profiler) {
+        output.append(R"(,"profile":)").append(core::profile::format_json(*profiler));
+    }
+    output += '}';
+    return output;
+}
+
+/**
+ * @brief Read the samples appended to a recording since the previous call.
+ *
+ * @param reader Reader of the recording.
+ *
+ * @return Samples, oldest first.
+ */
+[[nodiscard]] std::vector<modules::record::Sample> read_samples(core::ring::Reader &reader)
+{
+    std::vector<modules::record::Sample> samples;
+    for (const auto &values : reader.read()) {
+        modules::record::Sample &sample = samples.emplace_back();
+        std::copy(values.begin(), values.end(), sample.begin());
+    }
+    return samples;
+}
+
+/**
+ * @brief Open a recording for reading.
+ *
+ * @param path Path to the ring file (e.g., "memory.ring").
+ *
+ * @return Reader of the recording.
+ *
+ * @throws core::ring::RingError If the file cannot be read or was not recorded by "--record".
+ */
+[[nodiscard]] std::unique_ptr<core::ring::Reader> open_recording(const std::string &path)
+{
+    auto reader = std::make_unique<core::ring::Reader>(path);
+    if (reader->get_field_count() != modules::record::value_count) {
+        throw core::ring::RingError(fmt::format("Failed to read ring file: {} (Expected {} fields, found {})", path, modules::record::value_count, reader->get_field_count()));
+    }
+    return reader;
+}
+
+/**
+ * @brief Record a sample every second until interrupted.
+ *
+ * @param path Path to the ring file (e.g., "memory.ring").
+ */
+[[noreturn]] void record(const std::string &path)
+{
+    core::ring::Writer writer(path, modules::record::value_count, modules::record::block_count);
+    fmt::print(stderr, "Recording to {} every second, press Ctrl+C to stop.\n", path);
+
+    // Sleep until the next whole second since the start, so that slow samples do not make the recording drift
+    modules::record::Sample sample{};
+    auto next = std::chrono::steady_clock::now();
+    while (true) {
+        modules::record::take_sample(sample);
+        writer.append(sample.data());
+        next += std::chrono::seconds(1);
+        std::this_thread::sleep_until(next);
+    }
+}
+
+/**
+ * @brief Print a recording as one row per time window.
+ *
+ * @param path Path to the ring file (e.g., "memory.ring").
+ * @param window_seconds Length of a window in seconds (e.g., "60").
+ * @param follow Whether to keep printing windows as they are recorded.
+ */
+void replay(const std::string &path,
+            const std::uint64_t window_seconds,
+            const bool follow)
+{
+    const auto reader = open_recording(path);
+    std::vector<modules::record::Sample> samples = read_samples(*reader);
+    if (!follow) {
+        fmt::print("{}", modules::record::format_buckets(modules::record::downsample(samples, window_seconds), true));
+        return;
+    }
+
+    // When following, a window is printed once the first sample of the next one arrives, and its samples are dropped
+    for (bool first = true;; first = false) {
+        std::vector<modules::record::Bucket> buckets = modules::record::downsample(samples, window_seconds);
+        if (!buckets.empty()) {
+            const std::uint64_t current = buckets.back().start;
+            buckets.pop_back();
+            samples.erase(samples.begin(), std::find_if(samples.begin(), samples.end(), [current, window_seconds](const modules::record::Sample &sample) {
+                              return sample[0] - sample[0] % window_seconds == current;
+                          }));
+        }
+        fmt::print("{}", modules::record::format_buckets(buckets, first));
+        std::fflush(stdout);
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        const std::vector<modules::record::Sample> appended = read_samples(*reader);
+        samples.insert(samples.end(), appended.begin(), appended.end());
+    }
+}
+
+/**
+ * @brief Print the minimum, average and maximum of every field of a recording.
+ *
+ * @param path Path to the ring file (e.g., "memory.ring").
+ * @param window_seconds Only the samples of the last "window_seconds" seconds are summarized, 0 for all samples.
+ */
+void summarize(const std::string &path,
+               const std::uint64_t window_seconds)
+{
+    const auto reader = open_recording(path);
+    std::vector<modules::record::Sample> samples = read_samples(*reader);
+    if (samples.empty()) {
+        fmt::print("No samples recorded in {}\n", path);
+        return;
+    }
+    if (window_seconds != 0) {
+        const std::uint64_t last = samples.back()[0];
+        samples.erase(samples.begin(), std::find_if(samples.begin(), samples.end(), [last, window_seconds](const modules::record::Sample &sample) {
+                          return sample[0] + window_seconds > last;
+                      }));
+    }
+    fmt::print("{}", modules::record::format_summary(modules::record::downsample(samples, 0).front()));
+}
+
+/**
+ * @brief Print the drift between two snapshots.
+ *
+ * @param old_path Path to the snapshot taken first (e.g., "before.json").
+ * @param new_path Path to the snapshot taken last (e.g., "after.json").
+ * @param json Whether to print the changes as JSON instead of a report.
+ *
+ * @return EXIT_SUCCESS if the snapshots match, core::diff::drift_exit_code otherwise.
+ */
+[[nodiscard]] int diff(const std::string &old_path,
+                       const std::string &new_path,
+                       const bool json)
+{
+    const std::vector<core::diff::Change> changes = core::diff::compare(core::diff::read_snapshot(old_path), core::diff::read_snapshot(new_path));
+    if (json) {
+        fmt::print("{}\n", core::diff::format_json(changes));
+    }
+    else {
+        fmt::print("{}", core::diff::format_report(changes));
+    }
+    return changes.empty() ? EXIT_SUCCESS : core::diff::drift_exit_code;
+}
+
+/**
+ * @brief Print a summary of snapshots, and the files that could not be read.
+ *
+ * @param paths Paths to snapshot files or directories of snapshots (e.g., "snapshots/").
+ *
+ * @return EXIT_SUCCESS if at least one snapshot was read, EXIT_FAILURE otherwise.
+ */
+[[nodiscard]] int aggregate(const std::vector<std::string> &paths)
+{
+    const core::aggregate::Summary summary = core::aggregate::aggregate(core::aggregate::expand_paths(paths));
+    for (const std::string &path : summary.failed_paths) {
+        fmt::print(stderr, "Failed to read snapshot: {}\n", path);
+    }
+    if (summary.snapshots == 0) {
+        // Directories without any "*.json" file leave nothing to report above
+        if (summary.failed_paths.empty()) {
+            for (const std::string &path : paths) {
+                fmt::print(stderr, "No snapshots found: {}\n", path);
+            }
+        }
+        return EXIT_FAILURE;
     }
+    fmt::print("{}", core::aggregate::format_summary(summary));
+    return EXIT_SUCCESS;
+}
+
+}  // namespace
 
-    // Helper lambda to print with or without color
-    const auto print_title = [color_enabled](const std::string &title) {
-        if (color_enabled) {
-            fmt::print(fmt::fg(fmt::color::yellow) | fmt::emphasis::bold, "{}: ", title);
+Watch::Watch(std::vector<core::layout::Field> fields,
+             const core::art::View &logo,
+             const bool color_enabled)
+    : fields_(std::move(fields)),
+      logo_(logo),
+      color_enabled_(color_enabled)
+{
+    for (std::size_t i = 0; i < this->fields_.size(); ++i) {
+        if (this->fields_[i].title == "Uptime") {
+            this->uptime_index_ = i;
+        }
+        else if (this->fields_[i].title == "Memory") {
+            this->memory_index_ = i;
+        }
+        else if (this->fields_[i].title == "Display") {
+            this->display_index_ = i;
+        }
+        else if (this->fields_[i].title == "Load") {
+            this->load_index_ = i;
+        }
+    }
+}
+
+const std::string &Watch::refresh()
+{
+    if (this->uptime_index_) {
+        std::string &value = this->fields_[*this->uptime_index_].value;
+        if (const auto seconds = modules::host::get_uptime_seconds()) {
+            modules::host::format_uptime(*seconds, value);
         }
         else {
-            fmt::print("{}: ", title);
+            value.assign(modules::host::get_uptime());
         }
-    };
+    }
+    // The cgroup path was resolved by the first sample, so a refresh only reads its files again
+    if (this->memory_index_) {
+        modules::memory::get_memory_usage(this->fields_[*this->memory_index_].value);
+    }
+    // Stall totals are counters, so from the second refresh on, they give the share of the last interval spent stalled
+    if (this->load_index_) {
+        const modules::pressure::Sample sample = this->pressure_.read();
+        const auto now = std::chrono::steady_clock::now();
+        std::string &value = this->fields_[*this->load_index_].value;
+        if (this->previous_pressure_) {
+            const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(now - this->previous_time_).count();
+            modules::pressure::format_rates(*this->previous_pressure_, sample, static_cast<std::uint64_t>(elapsed), value);
+        }
+        else {
+            modules::pressure::format_sample(sample, value);
+        }
+        this->previous_pressure_ = sample;
+        this->previous_time_ = now;
+    }
+    // Plugins only probe the fields they mark as volatile
+    for (PluginFields &plugin_fields : this->plugins_) {
+        plugin_fields.plugin->probe(plugin_fields.values, true);
+        for (std::size_t i = 0; i < plugin_fields.values.size(); ++i) {
+            this->fields_[plugin_fields.first_index + i].value.assign(plugin_fields.values[i]);
+        }
+    }
+    // The display topology is only queried again after a change notification, not every second
+    if (this->display_index_ && this->displays_.refresh()) {
+        modules::display::format_topology(this->displays_.get_topology(), this->fields_[*this->display_index_].value);
+    }
+    core::layout::render(this->logo_, this->fields_, this->color_enabled_, this->output_);
+    return this->output_;
+}
+
+void Watch::add_plugin(std::unique_ptr<modules::plugins::Plugin> plugin,
+                       const std::size_t first_index)
+{
+    // The values start as the ones of the full fetch, so that static fields are copied back unchanged
+    std::vector<std::string> values;
+    for (std::size_t i = 0; i < plugin->get_request().fields.size(); ++i) {
+        values.push_back(this->fields_[first_index + i].value);
+    }
+    this->plugins_.push_back({std::move(plugin), first_index, std::move(values)});
+}
 
-    const auto print_value = [color_enabled](const std::string &value) {
-        if (color_enabled) {
-            fmt::print(fmt::fg(fmt::color::white), "{}\n", value);
+std::size_t Watch::get_row_count() const noexcept
+{
+    return std::max(this->logo_.row_count, this->fields_.size());
+}
+
+int run(const core::args::Args &args)
+{
+    // Aggregating and comparing snapshots, and recordings are handled on their own, without a fetch
+    if (args.diff_paths.size() == 2) {
+        return diff(args.diff_paths[0], args.diff_paths[1], args.json);
+    }
+    if (!args.aggregate_paths.empty()) {
+        return aggregate(args.aggregate_paths);
+    }
+    if (args.dump_pattern) {
+        // The pattern is compiled once, so that the traversal only compares names against it
+        const core::dump::Pattern pattern(*args.dump_pattern);
+        if (core::dump::dump(pattern, args.json ? core::dump::Format::Ndjson : core::dump::Format::Text, stdout) == 0) {
+            fmt::print(stderr, "No kernel variables match: {}\n", *args.dump_pattern);
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+    if (args.inventory) {
+        const auto devices = modules::inventory::get_devices();
+        if (args.json) {
+            fmt::print("{}\n", modules::inventory::format_json(devices));
         }
         else {
-            fmt::print("{}\n", value);
+            fmt::print("{}", modules::inventory::format_text(devices));
         }
-    };
+        return EXIT_SUCCESS;
+    }
+    if (args.record_path) {
+        record(*args.record_path);
+    }
+    if (args.replay_path) {
+        replay(*args.replay_path, args.window_seconds.value_or(60), args.follow);
+        return EXIT_SUCCESS;
+    }
+    if (args.summarize_path) {
+        summarize(*args.summarize_path, args.window_seconds.value_or(0));
+        return EXIT_SUCCESS;
+    }
 
-    // Print system information with or without colors
-    print_title("OS");
-    print_value(fmt::format("{} ({})", modules::host::get_version(), modules::host::get_architecture()));
+    // Check for NO_COLOR environment variable to determine if color should be disabled
+    bool color_enabled = true;
+    if (const auto no_color = core::env::get_variable("NO_COLOR"); no_color && !no_color->empty()) {
+        color_enabled = false;
+    }
 
-    print_title("Model");
-    print_value(modules::host::get_model_identifier());
+    // Every probe, render stage and the primitives they call are measured while the profiler exists
+    std::optional<core::profile::Profiler> profiler;
+    if (args.profile || args.alloc_stats) {
+        profiler.emplace();
+    }
+
+    // Custom fields are read from the configuration file first, so that an invalid file fails before anything runs
+    const std::vector<core::config::Section> sections = core::config::load();
+    for (const core::config::Section &section : sections) {
+        if (section.kind != "command" && section.kind != "plugin") {
+            throw core::config::ConfigError(fmt::format("Invalid config: [{} {}] (Unknown section, expected \"command\" or \"plugin\")", section.kind, section.name));
+        }
+    }
+    const std::vector<modules::commands::Command> commands = modules::commands::get_commands(sections);
+    std::vector<std::unique_ptr<modules::plugins::Plugin>> plugins;
+    for (modules::plugins::Request &request : modules::plugins::get_requests(sections)) {
+        plugins.push_back(std::make_unique<modules::plugins::Plugin>(std::move(request)));
+    }
+
+    // Commands and plugins mostly wait on other processes, so they run in the background while the built-in probes run
+    // If a probe throws, the threads are still joined before the error is reported
+    std::vector<std::string> command_values;
+    std::vector<std::vector<std::string>> plugin_values;
+    core::thread::JoiningThread custom_thread([&commands, &plugins, &command_values, &plugin_values] {
+        const core::thread::JoiningThread plugin_thread([&plugins, &plugin_values] {
+            plugin_values = get_plugin_values(plugins);
+        });
+        command_values = get_command_values(commands);
+    });
+
+    // Collect all fields first, so that they can be laid out next to the logo
+    std::vector<core::layout::Field> fields = {
+        run_probe("OS", [] { return modules::host::get_version() + " (" + modules::host::get_architecture() + ")"; }),
+        run_probe("Model", [] { return modules::host::get_model_name(); }),
+        run_probe("Uptime", [] { return modules::host::get_uptime(); }),
+        run_probe("Packages", [] { return modules::packages::get_packages(); }),
+        run_probe("Shell", [] { return modules::host::get_shell(); }),
+        run_probe("Terminal", [] { return modules::host::get_terminal(); }),
+        run_probe("Display", [] { return modules::display::get_displays(); }),
+        run_probe("CPU", [] { return modules::cpu::get_cpu_model(); }),
+        run_probe("Topology", [] { return modules::cpu::get_cpu_topology(); }),
+        run_probe("Memory", [] { return modules::memory::get_memory_usage(); }),
+        run_probe("Load", [] { return modules::pressure::get_pressure(); }),
+        run_probe("Users", [] { return modules::sessions::get_users(); }),
+    };
+
+    // Custom fields follow the built-in ones, in the order of the configuration file
+    std::vector<std::size_t> plugin_indices;
+    {
+        // The wall time is only how long the fetch waited, but the CPU time, context switches and page faults of the commands
+        // and plugins are mostly counted here: the counters add a thread or child process when it exits, which is during the join
+        const core::profile::Scope scope("Wait for commands and plugins");
+        custom_thread.join();
+        std::size_t command_index = 0;
+        std::size_t plugin_index = 0;
+        for (const core::config::Section &section : sections) {
+            if (section.kind == "command") {
+                fields.push_back({commands[command_index].title, std::move(command_values[command_index])});
+                ++command_index;
+                continue;
+            }
+            plugin_indices.push_back(fields.size());
+            const std::vector<std::string> &titles = plugins[plugin_index]->get_request().fields;
+            for (std::size_t i = 0; i < titles.size(); ++i) {
+                fields.push_back({titles[i], std::move(plugin_values[plugin_index][i])});
+            }
+            ++plugin_index;
+        }
+    }
 
-    print_title("Uptime");
-    print_value(modules::host::get_uptime());
+    // Print the fields as JSON, which includes the profile if requested
+    if (args.json) {
+        std::string json;
+        {
+            const core::profile::Scope scope("Render JSON");
+            json = format_json(fields, args.profile ? &*profiler : nullptr);
+        }
+        json.push_back('\n');
+        std::fwrite(json.data(), 1, json.size(), stdout);
+        if (args.alloc_stats) {
+            fmt::print(stderr, "{}", core::profile::format_allocations(*profiler));
+        }
+        return EXIT_SUCCESS;
+    }
 
-    print_title("Packages");
-    print_value(fmt::format("{} (brew)", modules::host::get_packages()));
+    // Render system information next to the image if one was requested and it could be rendered
+    std::string output;
+    if (args.image_path && !args.watch) {
+        const core::profile::Scope scope("Render image");
+        if (const auto image = modules::image::get_image(*args.image_path)) {
+            output = core::layout::render_image(image->escape, image->columns, image->rows, fields, color_enabled);
+        }
+        else {
+            fmt::print(stderr, "Warning: Failed to render image: {}\n", *args.image_path);
+        }
+    }
 
-    print_title("Shell");
-    print_value(modules::host::get_shell());
+    // Otherwise, render system information next to the logo with or without colors
+    core::art::View logo{};
+    if (output.empty()) {
+        {
+            const core::profile::Scope scope("Logo");
+            logo = modules::logo::get_logo(modules::host::get_os_ids());
+        }
+        const core::profile::Scope scope("Render");
+        core::layout::render(logo, fields, color_enabled, output);
+    }
 
-    print_title("Display");
-    print_value(fmt::format("{} @ {}", modules::display::get_resolution(), modules::display::get_refresh_rate()));
+    // In watch mode, the first frame of the watch replaces the output
+    if (!args.watch) {
+        std::fwrite(output.data(), 1, output.size(), stdout);
+    }
 
-    print_title("CPU");
-    print_value(modules::cpu::get_cpu_model());
+    // Print the cost of every probe after the fields
+    if (args.profile) {
+        fmt::print("\n{}", core::profile::format_table(*profiler));
+        if (!sections.empty() && profiler->get_source() == core::profile::Source::PerfEvent) {
+            fmt::print("Commands and plugins have no rows of their own: their cost is counted in \"Wait for commands and plugins\"\n");
+        }
+    }
+    if (args.alloc_stats) {
+        fmt::print("\n{}", core::profile::format_allocations(*profiler));
+    }
+    if (!args.watch) {
+        return EXIT_SUCCESS;
+    }
 
-    print_title("Memory");
-    print_value(modules::memory::get_memory_usage());
+    // Redraw in place: move up to the first row, clear to the end of the screen, then print the new frame
+    profiler.reset();
+    Watch watch(std::move(fields), logo, color_enabled);
+    for (std::size_t i = 0; i < plugins.size(); ++i) {
+        watch.add_plugin(std::move(plugins[i]), plugin_indices[i]);
+    }
+    if (args.profile || args.alloc_stats) {
+        std::fputs("\n", stdout);
+    }
+    std::string clear;
+    for (bool first = true;; first = false) {
+        const std::string &frame = watch.refresh();
+        if (!first) {
+            clear.assign("\033[");
+            core::text::append_unsigned(watch.get_row_count(), clear);
+            clear.append("A\033[J");
+            std::fwrite(clear.data(), 1, clear.size(), stdout);
+        }
+        std::fwrite(frame.data(), 1, frame.size(), stdout);
+        std::fflush(stdout);
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
 }
 
 }  // namespace app
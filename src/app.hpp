@@ -6,11 +6,159 @@
 
 #pragma once
 
+#include <chrono>    // for std::chrono::steady_clock
+#include <cstddef>   // for std::size_t
+#include <memory>    // for std::unique_ptr
+#include <optional>  // for std::optional
+#include <string>    // for std::string
+#include <vector>    // for std::vector
+
+#include "core/args.hpp"
+#include "core/art.hpp"
+#include "core/layout.hpp"
+#include "modules/display.hpp"
+#include "modules/plugins.hpp"
+#include "modules/pressure.hpp"
+
 namespace app {
 
+/**
+ * @brief Class that refreshes the volatile fields of a fetch (uptime, memory and load) and redraws it.
+ *
+ * The fields, their values and the rendered output are kept between refreshes and rewritten in place, so once the strings have grown to their final size, a refresh does not allocate.
+ *
+ * @note This class is marked as `final` to prevent inheritance.
+ */
+class Watch final {
+  public:
+    /**
+     * @brief Construct a new Watch object.
+     *
+     * @param fields Fields of a full fetch; the ones titled "Uptime", "Memory" and "Load" are refreshed, and "Display" when the displays change.
+     * @param logo Logo to print on the left.
+     * @param color_enabled Whether to use colors (false if NO_COLOR is set).
+     */
+    explicit Watch(std::vector<core::layout::Field> fields,
+                   const core::art::View &logo,
+                   const bool color_enabled);
+
+    /**
+     * @brief Fetch the volatile fields again and render the fetch.
+     *
+     * @return Rendered output, valid until the next refresh.
+     */
+    [[nodiscard]] const std::string &refresh();
+
+    /**
+     * @brief Refresh the volatile fields of a plugin too.
+     *
+     * @param plugin Plugin that provided some of the fields.
+     * @param first_index Index of the first field of the plugin; the others follow it.
+     */
+    void add_plugin(std::unique_ptr<modules::plugins::Plugin> plugin,
+                    const std::size_t first_index);
+
+    /**
+     * @brief Get the number of rows of the rendered output, to move the cursor back before redrawing.
+     *
+     * @return Number of rows (e.g., "12").
+     */
+    [[nodiscard]] std::size_t get_row_count() const noexcept;
+
+  private:
+    /**
+     * @brief Struct that represents a plugin and the fields it provides.
+     */
+    struct PluginFields final {
+        /**
+         * @brief Plugin, loaded by the full fetch.
+         */
+        std::unique_ptr<modules::plugins::Plugin> plugin;
+
+        /**
+         * @brief Index of the first field of the plugin.
+         */
+        std::size_t first_index;
+
+        /**
+         * @brief Values of the fields of the plugin, reused by every refresh.
+         */
+        std::vector<std::string> values;
+    };
+
+    /**
+     * @brief Fields, with the volatile values rewritten by every refresh.
+     */
+    std::vector<core::layout::Field> fields_;
+
+    /**
+     * @brief Logo to print on the left.
+     */
+    core::art::View logo_;
+
+    /**
+     * @brief Whether to use colors.
+     */
+    bool color_enabled_;
+
+    /**
+     * @brief Index of the "Uptime" field, std::nullopt if there is none.
+     */
+    std::optional<std::size_t> uptime_index_;
+
+    /**
+     * @brief Index of the "Memory" field, std::nullopt if there is none.
+     */
+    std::optional<std::size_t> memory_index_;
+
+    /**
+     * @brief Index of the "Display" field, std::nullopt if there is none.
+     */
+    std::optional<std::size_t> display_index_;
+
+    /**
+     * @brief Index of the "Load" field, std::nullopt if there is none.
+     */
+    std::optional<std::size_t> load_index_;
+
+    /**
+     * @brief Sampler of the load and pressure, whose files stay open between refreshes.
+     */
+    modules::pressure::Sampler pressure_;
+
+    /**
+     * @brief Previous sample of the load and pressure, std::nullopt before the first refresh.
+     */
+    std::optional<modules::pressure::Sample> previous_pressure_;
+
+    /**
+     * @brief Time the previous sample was read at.
+     */
+    std::chrono::steady_clock::time_point previous_time_;
+
+    /**
+     * @brief Display topology, queried again only when the displays change.
+     */
+    modules::display::Watcher displays_;
+
+    /**
+     * @brief Plugins whose volatile fields are refreshed.
+     */
+    std::vector<PluginFields> plugins_;
+
+    /**
+     * @brief Rendered output of the last refresh.
+     */
+    std::string output_;
+};
+
 /**
  * @brief Run the application.
+ *
+ * @param args Parsed command-line arguments.
+ *
+ * @return Exit code: EXIT_SUCCESS, or core::diff::drift_exit_code if "diff" found drift.
  */
-void run();
+[[nodiscard]] int run(const core::args::Args &args);
 
 }  // namespace app
@@ -0,0 +1,262 @@
+/**
+ * @file applefetch.cpp
+ */
+
+#include <algorithm>  // for std::min
+#include <array>      // for std::array
+#include <cstddef>    // for std::size_t
+#include <cstdint>    // for std::uint32_t, std::uint64_t
+#include <cstring>    // for std::memcpy
+#include <exception>  // for std::exception
+#include <new>        // for std::nothrow
+#include <optional>   // for std::optional, std::nullopt
+#include <stdexcept>  // for std::runtime_error
+#include <string>     // for std::string
+
+#include <fmt/core.h>
+
+#include "applefetch.h"
+#include "modules/cpu.hpp"
+#include "modules/display.hpp"
+#include "modules/host.hpp"
+#include "modules/memory.hpp"
+#include "modules/packages.hpp"
+
+namespace {
+
+/**
+ * @brief Number of fields defined by the API.
+ */
+constexpr std::size_t field_count = 9;
+
+/**
+ * @brief Size of the buffer that holds the display string of each field, including the null terminator.
+ */
+constexpr std::size_t string_capacity = 256;
+
+/**
+ * @brief Get the index of a single field flag.
+ *
+ * @param field Field flag (e.g., "AF_FIELD_CPU").
+ *
+ * @return Index of the field (e.g., "7") if the flag is valid, field_count otherwise.
+ */
+[[nodiscard]] std::size_t get_field_index(const std::uint32_t field) noexcept
+{
+    for (std::size_t i = 0; i < field_count; ++i) {
+        if (field == (std::uint32_t{1} << i)) {
+            return i;
+        }
+    }
+    return field_count;
+}
+
+/**
+ * @brief Keep the value of a module getter only if it succeeded.
+ *
+ * @param value Value returned by the getter (e.g., "Apple M1 Pro", "Unknown CPU model ($REASON)").
+ *
+ * @return Value if succeeded, std::nullopt if the getter reported a failure.
+ */
+[[nodiscard]] std::optional<std::string> get_known(std::string value)
+{
+    // Every getter reports failures as "Unknown $WHAT ($REASON)"
+    if (value.rfind("Unknown ", 0) == 0) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+/**
+ * @brief Get the display string of a static field from the modules.
+ *
+ * @param field Field flag (e.g., "AF_FIELD_CPU").
+ *
+ * @return Display string (e.g., "Apple M1 Pro") if succeeded, std::nullopt otherwise.
+ */
+[[nodiscard]] std::optional<std::string> get_static_field(const std::uint32_t field)
+{
+    switch (field) {
+    case AF_FIELD_OS: {
+        const auto version = get_known(modules::host::get_version());
+        const auto architecture = get_known(modules::host::get_architecture());
+        if (!version || !architecture) {
+            return std::nullopt;
+        }
+        return fmt::format("{} ({})", *version, *architecture);
+    }
+    case AF_FIELD_MODEL:
+        return get_known(modules::host::get_model_identifier());
+    case AF_FIELD_PACKAGES:
+        return get_known(modules::packages::get_packages());
+    case AF_FIELD_SHELL:
+        return get_known(modules::host::get_shell());
+    case AF_FIELD_TERMINAL:
+        return get_known(modules::host::get_terminal());
+    case AF_FIELD_DISPLAY:
+        return get_known(modules::display::get_displays());
+    case AF_FIELD_CPU:
+        return get_known(modules::cpu::get_cpu_model());
+    default:
+        return std::nullopt;
+    }
+}
+
+}  // namespace
+
+/**
+ * @brief Context that owns the values of all fields. Strings are stored inline, so reading them never allocates.
+ */
+struct af_context final {
+    /**
+     * @brief Mask of the fields that hold a valid value.
+     */
+    std::uint32_t valid_fields = 0;
+
+    /**
+     * @brief Null-terminated display string of each field.
+     */
+    std::array<std::array<char, string_capacity>, field_count> strings{};
+
+    /**
+     * @brief Uptime in seconds.
+     */
+    std::uint64_t uptime_seconds = 0;
+
+    /**
+     * @brief Memory usage in bytes.
+     */
+    af_memory memory{};
+
+    /**
+     * @brief Store the display string of a field, truncating it if needed.
+     *
+     * @param field Field flag (e.g., "AF_FIELD_CPU").
+     * @param value Display string (e.g., "Apple M1 Pro").
+     */
+    void set_string(const std::uint32_t field,
+                    const std::string &value) noexcept
+    {
+        auto &buffer = this->strings[get_field_index(field)];
+        const std::size_t length = std::min(value.size(), buffer.size() - 1);
+        std::memcpy(buffer.data(), value.data(), length);
+        buffer[length] = '\0';
+    }
+
+    /**
+     * @brief Mark a field as invalid and clear its display string.
+     *
+     * @param field Field flag (e.g., "AF_FIELD_CPU").
+     */
+    void invalidate(const std::uint32_t field) noexcept
+    {
+        this->valid_fields &= ~field;
+        this->strings[get_field_index(field)][0] = '\0';
+    }
+};
+
+extern "C" {
+
+uint32_t af_api_version(void)
+{
+    return AF_API_VERSION;
+}
+
+af_context *af_create(const uint32_t api_version)
+{
+    if (api_version != AF_API_VERSION) {
+        return nullptr;
+    }
+    return new (std::nothrow) af_context();
+}
+
+void af_destroy(af_context *ctx)
+{
+    delete ctx;
+}
+
+af_status af_refresh(af_context *ctx,
+                     const uint32_t field_mask)
+{
+    if (!ctx || (field_mask & ~AF_FIELDS_ALL) != 0) {
+        return AF_ERROR_INVALID_ARGUMENT;
+    }
+
+    af_status status = AF_OK;
+    for (std::size_t i = 0; i < field_count; ++i) {
+        const std::uint32_t field = std::uint32_t{1} << i;
+        if ((field_mask & field) == 0) {
+            continue;
+        }
+        // No exception may cross the C boundary
+        try {
+            if (field == AF_FIELD_UPTIME) {
+                const auto seconds = modules::host::get_uptime_seconds();
+                if (!seconds) {
+                    throw std::runtime_error("uptime unavailable");
+                }
+                ctx->uptime_seconds = *seconds;
+                ctx->set_string(field, modules::host::format_uptime(*seconds));
+            }
+            else if (field == AF_FIELD_MEMORY) {
+                const auto usage = modules::memory::get_usage();
+                if (!usage) {
+                    throw std::runtime_error("memory unavailable");
+                }
+                ctx->memory = {usage->used_bytes, usage->total_bytes};
+                ctx->set_string(field, modules::memory::format_usage(*usage));
+            }
+            else {
+                const auto value = get_static_field(field);
+                if (!value) {
+                    throw std::runtime_error("field unavailable");
+                }
+                ctx->set_string(field, *value);
+            }
+            ctx->valid_fields |= field;
+        }
+        catch (const std::exception &) {
+            ctx->invalidate(field);
+            status = AF_ERROR_UNAVAILABLE;
+        }
+    }
+    return status;
+}
+
+const char *af_get_string(const af_context *ctx,
+                          const af_field field)
+{
+    const std::size_t index = get_field_index(static_cast<std::uint32_t>(field));
+    if (!ctx || index == field_count) {
+        return nullptr;
+    }
+    return ctx->strings[index].data();
+}
+
+af_status af_get_uptime(const af_context *ctx,
+                        uint64_t *seconds)
+{
+    if (!ctx || !seconds) {
+        return AF_ERROR_INVALID_ARGUMENT;
+    }
+    if ((ctx->valid_fields & AF_FIELD_UPTIME) == 0) {
+        return AF_ERROR_UNAVAILABLE;
+    }
+    *seconds = ctx->uptime_seconds;
+    return AF_OK;
+}
+
+af_status af_get_memory(const af_context *ctx,
+                        af_memory *memory)
+{
+    if (!ctx || !memory) {
+        return AF_ERROR_INVALID_ARGUMENT;
+    }
+    if ((ctx->valid_fields & AF_FIELD_MEMORY) == 0) {
+        return AF_ERROR_UNAVAILABLE;
+    }
+    *memory = ctx->memory;
+    return AF_OK;
+}
+
+}  // extern "C"
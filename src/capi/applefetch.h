@@ -0,0 +1,166 @@
+/**
+ * @file applefetch.h
+ *
+ * @brief Stable C API of the applefetch library, for embedding in status bars and other long-running programs.
+ *
+ * A context is created once and refreshed as often as needed. Static fields (e.g., OS, CPU) are usually refreshed once, while volatile fields (uptime, memory) are cheap to refresh and can be polled every few seconds without spawning a process.
+ *
+ * Example:
+ * @code
+ * af_context *ctx = af_create(AF_API_VERSION);
+ * af_refresh(ctx, AF_FIELDS_ALL);
+ * for (;;) {
+ *     af_refresh(ctx, AF_FIELDS_VOLATILE);
+ *     printf("%s\n", af_get_string(ctx, AF_FIELD_MEMORY));
+ *     sleep(5);
+ * }
+ * af_destroy(ctx);
+ * @endcode
+ *
+ * @note A context must not be used from multiple threads at the same time, but different contexts can be.
+ */
+
+#ifndef APPLEFETCH_H
+#define APPLEFETCH_H
+
+#include <stdint.h>  // for uint32_t, uint64_t
+
+#if defined(APPLEFETCH_BUILDING_LIBRARY)
+#define AF_EXPORT __attribute__((visibility("default")))
+#else
+#define AF_EXPORT
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Version of the API described by this header. It is incremented whenever the API changes in an incompatible way.
+ */
+#define AF_API_VERSION 1u
+
+/**
+ * @brief Opaque context that owns the cached values and buffers of all fields.
+ */
+typedef struct af_context af_context;
+
+/**
+ * @brief Fields that can be refreshed and read. Values are bit flags, so they can be combined into a mask.
+ *
+ * @note New fields are only ever appended, existing values never change.
+ */
+typedef enum af_field {
+    AF_FIELD_OS = 1u << 0,        /**< OS version and architecture (e.g., "macOS 14.6.1 (arm64)"). */
+    AF_FIELD_MODEL = 1u << 1,     /**< Model identifier (e.g., "MacBookPro18,3"). */
+    AF_FIELD_UPTIME = 1u << 2,    /**< Uptime (e.g., "17d 23h 52m"). Volatile. */
+    AF_FIELD_PACKAGES = 1u << 3,  /**< Packages (e.g., "139 (brew, 42 leaves, 3 pinned)"). */
+    AF_FIELD_SHELL = 1u << 4,     /**< Shell (e.g., "/bin/zsh 5.9"). */
+    AF_FIELD_TERMINAL = 1u << 5,  /**< Terminal (e.g., "iTerm2"). */
+    AF_FIELD_DISPLAY = 1u << 6,   /**< Display (e.g., "1512x982 @ 120 Hz"). */
+    AF_FIELD_CPU = 1u << 7,       /**< CPU (e.g., "Apple M1 Pro"). */
+    AF_FIELD_MEMORY = 1u << 8,    /**< Memory (e.g., "10.16GiB / 16.00GiB (63%)"). Volatile. */
+} af_field;
+
+/**
+ * @brief Mask of the fields that change while the system is running.
+ */
+#define AF_FIELDS_VOLATILE (0u | AF_FIELD_UPTIME | AF_FIELD_MEMORY)
+
+/**
+ * @brief Mask of all fields.
+ */
+#define AF_FIELDS_ALL ((AF_FIELD_MEMORY << 1) - 1u)
+
+/**
+ * @brief Status codes returned by the API.
+ */
+typedef enum af_status {
+    AF_OK = 0,                        /**< Success. */
+    AF_ERROR_INVALID_ARGUMENT = -1,   /**< A null pointer or an unknown field was passed. */
+    AF_ERROR_UNAVAILABLE = -2,        /**< The field was not refreshed yet, or could not be read. */
+    AF_ERROR_UNSUPPORTED_VERSION = -3 /**< The requested API version is not supported. */
+} af_status;
+
+/**
+ * @brief Memory usage in bytes.
+ */
+typedef struct af_memory {
+    uint64_t used_bytes;  /**< Used memory (active + wired + compressed) in bytes. */
+    uint64_t total_bytes; /**< Total physical memory in bytes. */
+} af_memory;
+
+/**
+ * @brief Get the API version implemented by the loaded library.
+ *
+ * @return API version (e.g., "1").
+ */
+AF_EXPORT uint32_t af_api_version(void);
+
+/**
+ * @brief Create a new context. No fields are read until af_refresh() is called.
+ *
+ * @param api_version API version the caller was compiled against (pass AF_API_VERSION).
+ *
+ * @return New context if succeeded, NULL otherwise (unsupported version or out of memory).
+ */
+AF_EXPORT af_context *af_create(uint32_t api_version);
+
+/**
+ * @brief Destroy a context. Passing NULL is allowed.
+ *
+ * @param ctx Context to destroy.
+ */
+AF_EXPORT void af_destroy(af_context *ctx);
+
+/**
+ * @brief Refresh the given fields. Fields that are not in the mask keep their previous values.
+ *
+ * Refreshing AF_FIELDS_VOLATILE only queries the kernel, without spawning processes or touching the disk, and costs microseconds.
+ *
+ * @param ctx Context to refresh.
+ * @param field_mask Combination of af_field values (e.g., "AF_FIELDS_VOLATILE").
+ *
+ * @return AF_OK if all requested fields were refreshed, AF_ERROR_UNAVAILABLE if at least one could not be read, AF_ERROR_INVALID_ARGUMENT otherwise.
+ */
+AF_EXPORT af_status af_refresh(af_context *ctx,
+                               uint32_t field_mask);
+
+/**
+ * @brief Get a field as a display string. Does not allocate.
+ *
+ * @param ctx Context to read from.
+ * @param field Field to read (e.g., "AF_FIELD_CPU").
+ *
+ * @return Null-terminated string owned by the context, valid until the field is refreshed again or the context is destroyed. An empty string is returned if the field is not available, NULL on invalid arguments.
+ */
+AF_EXPORT const char *af_get_string(const af_context *ctx,
+                                    af_field field);
+
+/**
+ * @brief Get the uptime in seconds. Does not allocate.
+ *
+ * @param ctx Context to read from (AF_FIELD_UPTIME must have been refreshed).
+ * @param seconds Output for the uptime in seconds.
+ *
+ * @return AF_OK if succeeded, AF_ERROR_UNAVAILABLE if the field is not available, AF_ERROR_INVALID_ARGUMENT otherwise.
+ */
+AF_EXPORT af_status af_get_uptime(const af_context *ctx,
+                                  uint64_t *seconds);
+
+/**
+ * @brief Get the memory usage in bytes. Does not allocate.
+ *
+ * @param ctx Context to read from (AF_FIELD_MEMORY must have been refreshed).
+ * @param memory Output for the memory usage.
+ *
+ * @return AF_OK if succeeded, AF_ERROR_UNAVAILABLE if the field is not available, AF_ERROR_INVALID_ARGUMENT otherwise.
+ */
+AF_EXPORT af_status af_get_memory(const af_context *ctx,
+                                  af_memory *memory);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // APPLEFETCH_H
@@ -0,0 +1,102 @@
+/**
+ * @file applefetch_plugin.h
+ *
+ * @brief Stable C ABI of applefetch plugins, for probes that need in-process work a shell command would make too slow.
+ *
+ * A plugin is a shared object that exports af_plugin_get_descriptor(). The descriptor lists the fields the plugin provides and the function that probes them. A plugin is only loaded if the configuration file requests one of its fields.
+ *
+ * Example:
+ * @code
+ * static const af_plugin_field fields[] = {{"Agent", AF_PLUGIN_VOLATILE}};
+ *
+ * static int probe(uint32_t field_index, char *buffer, size_t size)
+ * {
+ *     (void)field_index;
+ *     snprintf(buffer, size, "%s", "healthy");
+ *     return 0;
+ * }
+ *
+ * AF_PLUGIN_EXPORT const af_plugin_descriptor *af_plugin_get_descriptor(void)
+ * {
+ *     static const af_plugin_descriptor descriptor = {AF_PLUGIN_ABI_VERSION, "agent", 1, fields, probe};
+ *     return &descriptor;
+ * }
+ * @endcode
+ *
+ * @note The probe function may be called from any thread, but never concurrently for the same plugin.
+ */
+
+#ifndef APPLEFETCH_PLUGIN_H
+#define APPLEFETCH_PLUGIN_H
+
+#include <stddef.h>  // for size_t
+#include <stdint.h>  // for uint32_t
+
+#define AF_PLUGIN_EXPORT __attribute__((visibility("default")))
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Version of the ABI described by this header. It is incremented whenever the descriptor changes in an incompatible way, and plugins with another version are not loaded.
+ */
+#define AF_PLUGIN_ABI_VERSION 1u
+
+/**
+ * @brief Name of the function every plugin exports.
+ */
+#define AF_PLUGIN_DESCRIPTOR_SYMBOL "af_plugin_get_descriptor"
+
+/**
+ * @brief How often the value of a field changes.
+ */
+typedef enum af_plugin_volatility {
+    AF_PLUGIN_STATIC = 0,  /**< The value is probed once per run. */
+    AF_PLUGIN_VOLATILE = 1 /**< The value is probed again on every refresh of "--watch". */
+} af_plugin_volatility;
+
+/**
+ * @brief Field provided by a plugin.
+ */
+typedef struct af_plugin_field {
+    const char *title;   /**< Title of the field (e.g., "Agent"), as requested in the configuration file. */
+    uint32_t volatility; /**< One of af_plugin_volatility. */
+} af_plugin_field;
+
+/**
+ * @brief Function that probes a field.
+ *
+ * @param field_index Index of the field in the descriptor (e.g., "0").
+ * @param buffer Buffer owned by the caller, to write the null-terminated value to (e.g., "healthy").
+ * @param size Size of the buffer in bytes, including the terminator; longer values must be truncated.
+ *
+ * @return 0 if succeeded, any other value otherwise (the field is then shown as "Unknown").
+ */
+typedef int (*af_plugin_probe)(uint32_t field_index,
+                               char *buffer,
+                               size_t size);
+
+/**
+ * @brief Descriptor of a plugin. It must stay valid until the plugin is unloaded.
+ */
+typedef struct af_plugin_descriptor {
+    uint32_t abi_version;          /**< AF_PLUGIN_ABI_VERSION the plugin was compiled against. */
+    const char *name;              /**< Name of the plugin (e.g., "agent"). */
+    uint32_t field_count;          /**< Number of fields. */
+    const af_plugin_field *fields; /**< Fields provided by the plugin. */
+    af_plugin_probe probe;         /**< Function that probes a field. */
+} af_plugin_descriptor;
+
+/**
+ * @brief Get the descriptor of the plugin; exported by every plugin under AF_PLUGIN_DESCRIPTOR_SYMBOL.
+ *
+ * @return Descriptor of the plugin.
+ */
+typedef const af_plugin_descriptor *(*af_plugin_get_descriptor_function)(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // APPLEFETCH_PLUGIN_H
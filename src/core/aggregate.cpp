@@ -0,0 +1,404 @@
+/**
+ * @file aggregate.cpp
+ */
+
+#include <algorithm>     // for std::max, std::min, std::sort
+#include <atomic>        // for std::atomic, std::memory_order_relaxed
+#include <charconv>      // for std::from_chars
+#include <cstddef>       // for std::size_t
+#include <cstdint>       // for std::uint64_t
+#include <fcntl.h>       // for ::open, O_RDONLY, O_CLOEXEC
+#include <filesystem>    // for std::filesystem
+#include <iterator>      // for std::back_inserter
+#include <optional>      // for std::optional, std::nullopt
+#include <string>        // for std::string
+#include <string_view>   // for std::string_view
+#include <sys/mman.h>    // for ::mmap, ::munmap, PROT_READ, MAP_PRIVATE, MAP_FAILED
+#include <sys/stat.h>    // for ::fstat, struct stat
+#include <system_error>  // for std::error_code, std::errc
+#include <thread>        // for std::thread
+#include <unistd.h>      // for ::close
+#include <utility>       // for std::pair
+#include <vector>        // for std::vector
+
+#include <fmt/core.h>
+
+#include "aggregate.hpp"
+#include "json.hpp"
+#include "width.hpp"
+
+namespace core::aggregate {
+
+namespace {
+
+/**
+ * @brief Number of files a thread claims at once; small enough to balance uneven files, large enough to keep the shared counter cold.
+ */
+constexpr std::size_t batch_size = 16;
+
+/**
+ * @brief Number of most common values printed per field.
+ */
+constexpr std::size_t top_count = 10;
+
+/**
+ * @brief Parse the leading unsigned integer of a value.
+ *
+ * @param text Value (e.g., "138 (brew, 42 leaves, 3 pinned)").
+ *
+ * @return Integer if the value starts with one (e.g., "138"), std::nullopt otherwise.
+ */
+[[nodiscard]] std::optional<std::uint64_t> parse_leading_number(const std::string_view text) noexcept
+{
+    std::uint64_t value = 0;
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (error != std::errc() || end == text.data()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+/**
+ * @brief Parse the total memory of a memory usage value, rounded to GiB.
+ *
+ * @param text Memory usage (e.g., "10.16GiB / 16.00GiB (63%)").
+ *
+ * @return Total memory in GiB (e.g., "16") if succeeded, std::nullopt otherwise.
+ */
+[[nodiscard]] std::optional<std::uint64_t> parse_memory_gib(const std::string_view text) noexcept
+{
+    const std::size_t slash = text.find(" / ");
+    if (slash == std::string_view::npos) {
+        return std::nullopt;
+    }
+    const std::string_view total = text.substr(slash + 3);
+    std::uint64_t gib = 0;
+    const auto [end, error] = std::from_chars(total.data(), total.data() + total.size(), gib);
+    if (error != std::errc() || end == total.data()) {
+        return std::nullopt;
+    }
+    const std::size_t fraction = static_cast<std::size_t>(end - total.data());
+    if (fraction + 1 < total.size() && total[fraction] == '.' && total[fraction + 1] >= '5' && total[fraction + 1] <= '9') {
+        ++gib;
+    }
+    return gib;
+}
+
+/**
+ * @brief Count a value of a text field, reusing a buffer for the key so that known values do not allocate.
+ *
+ * @param counts Counts to update.
+ * @param value Value of the field (e.g., "Apple M1 Pro").
+ * @param key Buffer for the key.
+ */
+void count_value(Counts &counts,
+                 const std::string_view value,
+                 std::string &key)
+{
+    key.assign(value);
+    if (const auto it = counts.find(key); it != counts.end()) {
+        ++it->second;
+    }
+    else {
+        counts.emplace(key, 1);
+    }
+}
+
+/**
+ * @brief Add the counts of a histogram to another.
+ *
+ * @param target Histogram to add to.
+ * @param source Histogram to add.
+ */
+void merge_histogram(Histogram &target,
+                     const Histogram &source)
+{
+    for (const auto &[value, count] : source) {
+        target[value] += count;
+    }
+}
+
+/**
+ * @brief Map a file and add it to a summary.
+ *
+ * @param path Path to the snapshot file (e.g., "snapshots/host-1.json").
+ * @param summary Summary to add to.
+ *
+ * @return True if the file was read and is a snapshot, false otherwise.
+ */
+bool add_file(const std::string &path,
+              Summary &summary)
+{
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        ++summary.failed;
+        return false;
+    }
+    struct stat info{};
+    if (::fstat(fd, &info) != 0 || info.st_size <= 0) {
+        ::close(fd);
+        ++summary.failed;
+        return false;
+    }
+    const std::size_t size = static_cast<std::size_t>(info.st_size);
+    void *mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        ++summary.failed;
+        return false;
+    }
+    const bool added = add_snapshot(std::string_view(static_cast<const char *>(mapping), size), summary);
+    ::munmap(mapping, size);
+    return added;
+}
+
+/**
+ * @brief Format the most common values of a text field.
+ *
+ * @param title Title of the field (e.g., "CPU").
+ * @param counts Counts of the field.
+ * @param total Number of snapshots, for the percentages.
+ * @param output Report to append to.
+ */
+void format_counts(const std::string_view title,
+                   const Counts &counts,
+                   const std::size_t total,
+                   std::string &output)
+{
+    std::vector<std::pair<std::string_view, std::size_t>> sorted(counts.begin(), counts.end());
+    std::sort(sorted.begin(), sorted.end(), [](const auto &lhs, const auto &rhs) {
+        return lhs.second != rhs.second ? lhs.second > rhs.second : lhs.first < rhs.first;
+    });
+    fmt::format_to(std::back_inserter(output), "\n{} ({} distinct)\n", title, sorted.size());
+    for (std::size_t i = 0; i < std::min(sorted.size(), top_count); ++i) {
+        // Values are padded by display width, so that CPU and model names with wide characters keep the counts aligned
+        output.append("  ");
+        core::width::append_padded(sorted[i].first, 48, output);
+        fmt::format_to(std::back_inserter(output), " {:>8} {:>6.1f}%\n", sorted[i].second,
+                       100.0 * static_cast<double>(sorted[i].second) / static_cast<double>(std::max<std::size_t>(total, 1)));
+    }
+    if (sorted.size() > top_count) {
+        fmt::format_to(std::back_inserter(output), "  ({} more)\n", sorted.size() - top_count);
+    }
+}
+
+/**
+ * @brief Format the 50th, 90th and 99th percentiles of a histogram.
+ *
+ * @param histogram Histogram to format.
+ *
+ * @return Percentiles (e.g., "p50 138, p90 412, p99 980").
+ */
+[[nodiscard]] std::string format_percentiles(const Histogram &histogram)
+{
+    return fmt::format("p50 {}, p90 {}, p99 {}",
+                       get_percentile(histogram, 50.0).value_or(0),
+                       get_percentile(histogram, 90.0).value_or(0),
+                       get_percentile(histogram, 99.0).value_or(0));
+}
+
+}  // namespace
+
+void Summary::merge(const Summary &other)
+{
+    this->snapshots += other.snapshots;
+    this->failed += other.failed;
+    this->failed_paths.insert(this->failed_paths.end(), other.failed_paths.begin(), other.failed_paths.end());
+    for (const auto &[value, count] : other.os_versions) {
+        this->os_versions[value] += count;
+    }
+    for (const auto &[value, count] : other.models) {
+        this->models[value] += count;
+    }
+    for (const auto &[value, count] : other.cpus) {
+        this->cpus[value] += count;
+    }
+    merge_histogram(this->memory_gib, other.memory_gib);
+    merge_histogram(this->packages, other.packages);
+    for (const auto &[os, histogram] : other.packages_by_os) {
+        merge_histogram(this->packages_by_os[os], histogram);
+    }
+}
+
+bool add_snapshot(const std::string_view json,
+                  Summary &summary)
+{
+    // Scan for the "fields" object and read only its string values; everything else (e.g., "profile") is skipped
+    core::json::Scanner scanner(json);
+    if (scanner.next().type != core::json::TokenType::ObjectBegin) {
+        ++summary.failed;
+        return false;
+    }
+    std::string_view os;
+    std::string_view packages;
+    bool found = false;
+    std::string key;
+    for (core::json::Token name = scanner.next(); name.type == core::json::TokenType::Key; name = scanner.next()) {
+        if (name.text != "fields" || scanner.next().type != core::json::TokenType::ObjectBegin) {
+            if (name.text != "fields" && !scanner.skip_value()) {
+                break;
+            }
+            continue;
+        }
+        found = true;
+        for (core::json::Token field = scanner.next(); field.type == core::json::TokenType::Key; field = scanner.next()) {
+            const core::json::Token value = scanner.next();
+
+            // Nested values (e.g., a package list added by a collector) are skipped as a whole
+            if (value.type == core::json::TokenType::ArrayBegin || value.type == core::json::TokenType::ObjectBegin) {
+                for (const std::size_t depth = scanner.depth(); scanner.depth() >= depth;) {
+                    const core::json::TokenType type = scanner.next().type;
+                    if (type == core::json::TokenType::End || type == core::json::TokenType::Error) {
+                        break;
+                    }
+                }
+                continue;
+            }
+            if (value.type != core::json::TokenType::String || value.text.substr(0, 7) == "Unknown") {
+                continue;
+            }
+            if (field.text == "OS") {
+                os = value.text;
+            }
+            else if (field.text == "Model") {
+                count_value(summary.models, value.text, key);
+            }
+            else if (field.text == "CPU") {
+                count_value(summary.cpus, value.text, key);
+            }
+            else if (field.text == "Memory") {
+                if (const auto gib = parse_memory_gib(value.text)) {
+                    ++summary.memory_gib[*gib];
+                }
+            }
+            else if (field.text == "Packages") {
+                packages = value.text;
+            }
+        }
+    }
+    if (!found) {
+        ++summary.failed;
+        return false;
+    }
+
+    // The package count is grouped by OS version, so both are only counted once all fields are read
+    ++summary.snapshots;
+    if (!os.empty()) {
+        count_value(summary.os_versions, os, key);
+    }
+    if (const auto count = parse_leading_number(packages)) {
+        ++summary.packages[*count];
+        if (!os.empty()) {
+            ++summary.packages_by_os[key][*count];
+        }
+    }
+    return true;
+}
+
+std::vector<std::string> expand_paths(const std::vector<std::string> &paths)
+{
+    std::vector<std::string> files;
+    for (const std::string &path : paths) {
+        std::error_code ec;
+        if (!std::filesystem::is_directory(path, ec)) {
+            files.push_back(path);
+            continue;
+        }
+        const std::size_t first = files.size();
+        for (std::filesystem::directory_iterator it(path, ec), end; !ec && it != end; it.increment(ec)) {
+            if (it->path().extension() == ".json") {
+                files.push_back(it->path().string());
+            }
+        }
+        std::sort(files.begin() + static_cast<std::ptrdiff_t>(first), files.end());
+    }
+    return files;
+}
+
+Summary aggregate(const std::vector<std::string> &paths,
+                  const std::size_t thread_count)
+{
+    const std::size_t hardware_threads = std::max(1U, std::thread::hardware_concurrency());
+    const std::size_t threads_to_use = std::max<std::size_t>(1, std::min(thread_count == 0 ? hardware_threads : thread_count, (paths.size() + batch_size - 1) / batch_size));
+    std::vector<Summary> summaries(threads_to_use);
+    std::atomic<std::size_t> next_index{0};
+
+    const auto worker = [&](const std::size_t thread_index) {
+        Summary &summary = summaries[thread_index];
+        for (std::size_t begin = next_index.fetch_add(batch_size, std::memory_order_relaxed); begin < paths.size(); begin = next_index.fetch_add(batch_size, std::memory_order_relaxed)) {
+            for (std::size_t i = begin; i < std::min(begin + batch_size, paths.size()); ++i) {
+                if (!add_file(paths[i], summary)) {
+                    summary.failed_paths.push_back(paths[i]);
+                }
+            }
+        }
+    };
+    std::vector<std::thread> threads;
+    threads.reserve(threads_to_use - 1);
+    for (std::size_t t = 1; t < threads_to_use; ++t) {
+        threads.emplace_back(worker, t);
+    }
+    worker(0);
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    // Merge the per-thread summaries into the first one
+    for (std::size_t t = 1; t < threads_to_use; ++t) {
+        summaries.front().merge(summaries[t]);
+    }
+
+    // Threads claim batches in any order, so the failures are sorted to be reported the same way on every run
+    std::sort(summaries.front().failed_paths.begin(), summaries.front().failed_paths.end());
+    return std::move(summaries.front());
+}
+
+std::optional<std::uint64_t> get_percentile(const Histogram &histogram,
+                                            const double percentile)
+{
+    std::size_t total = 0;
+    for (const auto &[value, count] : histogram) {
+        total += count;
+    }
+    if (total == 0) {
+        return std::nullopt;
+    }
+
+    // Nearest-rank method: the value at rank ceil(p / 100 * n), counting from 1
+    const double rank = std::max(1.0, percentile / 100.0 * static_cast<double>(total));
+    std::size_t seen = 0;
+    for (const auto &[value, count] : histogram) {
+        seen += count;
+        if (static_cast<double>(seen) >= rank) {
+            return value;
+        }
+    }
+    return histogram.rbegin()->first;
+}
+
+std::string format_summary(const Summary &summary)
+{
+    std::string output = fmt::format("Snapshots: {} ({} failed)\n", summary.snapshots, summary.failed);
+    format_counts("OS", summary.os_versions, summary.snapshots, output);
+    format_counts("Model", summary.models, summary.snapshots, output);
+    format_counts("CPU", summary.cpus, summary.snapshots, output);
+
+    fmt::format_to(std::back_inserter(output), "\nMemory\n");
+    for (const auto &[gib, count] : summary.memory_gib) {
+        fmt::format_to(std::back_inserter(output), "  {:<48} {:>8} {:>6.1f}%\n", fmt::format("{} GiB", gib), count,
+                       100.0 * static_cast<double>(count) / static_cast<double>(std::max<std::size_t>(summary.snapshots, 1)));
+    }
+
+    fmt::format_to(std::back_inserter(output), "\nPackages\n  {:<48} {}\n", "All", format_percentiles(summary.packages));
+    std::vector<std::string_view> os_versions;
+    for (const auto &[os, histogram] : summary.packages_by_os) {
+        os_versions.push_back(os);
+    }
+    std::sort(os_versions.begin(), os_versions.end());
+    for (const std::string_view os : os_versions) {
+        fmt::format_to(std::back_inserter(output), "  {:<48} {}\n", os, format_percentiles(summary.packages_by_os.at(std::string(os))));
+    }
+    return output;
+}
+
+}  // namespace core::aggregate
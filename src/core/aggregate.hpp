@@ -0,0 +1,144 @@
+/**
+ * @file aggregate.hpp
+ *
+ * @brief Aggregate JSON snapshots of many hosts into fleet-wide summaries.
+ */
+
+#pragma once
+
+#include <cstddef>        // for std::size_t
+#include <cstdint>        // for std::uint64_t
+#include <map>            // for std::map
+#include <optional>       // for std::optional
+#include <string>         // for std::string
+#include <string_view>    // for std::string_view
+#include <unordered_map>  // for std::unordered_map
+#include <vector>         // for std::vector
+
+namespace core::aggregate {
+
+/**
+ * @brief Histogram of a numeric value, ordered by value, so that percentiles can be read from it.
+ */
+using Histogram = std::map<std::uint64_t, std::size_t>;
+
+/**
+ * @brief Number of hosts per value of a text field (e.g., "Apple M1 Pro" -> 4200).
+ */
+using Counts = std::unordered_map<std::string, std::size_t>;
+
+/**
+ * @brief Struct that represents the summary of a set of snapshots.
+ *
+ * Every member can be merged by adding counts, so that each thread builds its own summary without sharing anything, and the summaries are merged at the end.
+ */
+struct Summary final {
+    /**
+     * @brief Number of snapshots that were read and parsed (e.g., "20000").
+     */
+    std::size_t snapshots = 0;
+
+    /**
+     * @brief Number of files that could not be read or are not snapshots (e.g., "3").
+     */
+    std::size_t failed = 0;
+
+    /**
+     * @brief Paths of the files that could not be read or are not snapshots, sorted (e.g., "snapshots/notes.json").
+     */
+    std::vector<std::string> failed_paths;
+
+    /**
+     * @brief Hosts per OS version (e.g., "macOS 14.6.1 (arm64)").
+     */
+    Counts os_versions;
+
+    /**
+     * @brief Hosts per model (e.g., "MacBook Pro (14-inch, 2021)").
+     */
+    Counts models;
+
+    /**
+     * @brief Hosts per CPU brand (e.g., "Apple M1 Pro").
+     */
+    Counts cpus;
+
+    /**
+     * @brief Hosts per total memory, rounded to GiB (e.g., "16").
+     */
+    Histogram memory_gib;
+
+    /**
+     * @brief Hosts per number of packages (e.g., "138").
+     */
+    Histogram packages;
+
+    /**
+     * @brief Hosts per number of packages, grouped by OS version.
+     */
+    std::unordered_map<std::string, Histogram> packages_by_os;
+
+    /**
+     * @brief Add the counts of another summary to this one.
+     *
+     * @param other Summary to merge.
+     */
+    void merge(const Summary &other);
+};
+
+/**
+ * @brief Add a snapshot to a summary.
+ *
+ * A snapshot is the output of "applefetch --json" (e.g., "{\"fields\":{\"OS\":\"macOS 14.6.1 (arm64)\",...}}"). Fields that are missing or unknown are not counted.
+ *
+ * @param json Contents of the snapshot.
+ * @param summary Summary to add to.
+ *
+ * @return True if the snapshot was parsed, false otherwise (counted as failed).
+ */
+bool add_snapshot(const std::string_view json,
+                  Summary &summary);
+
+/**
+ * @brief Expand directories into the snapshot files they contain.
+ *
+ * @param paths Paths to snapshot files or to directories of "*.json" snapshots (e.g., {"snapshots/"}).
+ *
+ * @return Paths to snapshot files, directories expanded in sorted order.
+ */
+[[nodiscard]] std::vector<std::string> expand_paths(const std::vector<std::string> &paths);
+
+/**
+ * @brief Read and aggregate snapshot files in parallel.
+ *
+ * Files are memory-mapped and parsed by a pool of threads. Threads claim small batches of files from a shared counter, so a thread that finishes early takes over the remaining work instead of idling. Each thread fills its own summary, and the summaries are merged once all files are parsed.
+ *
+ * @param paths Paths to snapshot files.
+ * @param thread_count Number of threads, 0 for one per hardware thread.
+ *
+ * @return Summary of all snapshots.
+ */
+[[nodiscard]] Summary aggregate(const std::vector<std::string> &paths,
+                                const std::size_t thread_count = 0);
+
+/**
+ * @brief Get a percentile of a histogram.
+ *
+ * @param histogram Histogram to read.
+ * @param percentile Percentile between 0 and 100 (e.g., "90").
+ *
+ * @return Smallest value such that at least "percentile" percent of the counts are less than or equal to it, std::nullopt if the histogram is empty.
+ */
+[[nodiscard]] std::optional<std::uint64_t> get_percentile(const Histogram &histogram,
+                                                          const double percentile);
+
+/**
+ * @brief Format a summary as a report, with the most common values of every field first.
+ *
+ * @param summary Summary to format.
+ *
+ * @return Report, with a newline after every row.
+ */
+[[nodiscard]] std::string format_summary(const Summary &summary);
+
+}  // namespace core::aggregate
@@ -0,0 +1,33 @@
+/**
+ * @file alloc.cpp
+ */
+
+#include <atomic>   // for std::atomic, std::memory_order_relaxed
+#include <cstdint>  // for std::uint64_t
+
+#include "alloc.hpp"
+
+namespace core::alloc {
+
+namespace detail {
+
+std::atomic<std::uint64_t> allocations{0};
+std::atomic<std::uint64_t> deallocations{0};
+std::atomic<std::uint64_t> bytes{0};
+std::atomic<bool> installed{false};
+
+}  // namespace detail
+
+bool is_enabled() noexcept
+{
+    return detail::installed.load(std::memory_order_relaxed);
+}
+
+Counters get_counters() noexcept
+{
+    return {detail::allocations.load(std::memory_order_relaxed),
+            detail::deallocations.load(std::memory_order_relaxed),
+            detail::bytes.load(std::memory_order_relaxed)};
+}
+
+}  // namespace core::alloc
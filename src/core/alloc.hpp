@@ -0,0 +1,64 @@
+/**
+ * @file alloc.hpp
+ *
+ * @brief Count heap allocations made through global operator new.
+ */
+
+#pragma once
+
+#include <atomic>   // for std::atomic
+#include <cstdint>  // for std::uint64_t
+
+namespace core::alloc {
+
+/**
+ * @brief Struct that represents allocation counters, either absolute or as a delta.
+ */
+struct Counters final {
+    /**
+     * @brief Number of calls to operator new (e.g., "42").
+     */
+    std::uint64_t allocations = 0;
+
+    /**
+     * @brief Number of calls to operator delete with a non-null pointer (e.g., "40").
+     */
+    std::uint64_t deallocations = 0;
+
+    /**
+     * @brief Number of bytes requested from operator new (e.g., "8192").
+     */
+    std::uint64_t bytes = 0;
+};
+
+/**
+ * @brief Check whether allocations are counted.
+ *
+ * @return True if the allocation hook (alloc_hook.cpp) is linked into the executable (e.g., built with ENABLE_ALLOC_STATS), false otherwise.
+ */
+[[nodiscard]] bool is_enabled() noexcept;
+
+/**
+ * @brief Get the allocation counters of the whole process.
+ *
+ * @return Counters since the start of the process, all zero if counting is not enabled.
+ */
+[[nodiscard]] Counters get_counters() noexcept;
+
+namespace detail {
+
+/**
+ * @brief Counters incremented by the allocation hook; relaxed atomics, so that allocations on worker threads are counted too.
+ */
+extern std::atomic<std::uint64_t> allocations;
+extern std::atomic<std::uint64_t> deallocations;
+extern std::atomic<std::uint64_t> bytes;
+
+/**
+ * @brief Set by the allocation hook when it is linked in.
+ */
+extern std::atomic<bool> installed;
+
+}  // namespace detail
+
+}  // namespace core::alloc
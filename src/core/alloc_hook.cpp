@@ -0,0 +1,188 @@
+/**
+ * @file alloc_hook.cpp
+ *
+ * @brief Replace global operator new and delete with counting versions.
+ *
+ * This file is not part of the library: it is compiled into an executable only when allocations should be counted (ENABLE_ALLOC_STATS, and always for the tests), so that regular builds keep the default allocator untouched.
+ */
+
+#include <atomic>   // for std::memory_order_relaxed
+#include <cstddef>  // for std::size_t
+#include <cstdlib>  // for std::malloc, std::free
+#include <new>      // for std::bad_alloc, std::nothrow_t, std::align_val_t, std::get_new_handler, std::new_handler
+#include <stdlib.h>  // for ::posix_memalign
+
+#include "alloc.hpp"
+
+namespace {
+
+/**
+ * @brief Count an allocation.
+ *
+ * @param size Number of bytes requested (e.g., "64").
+ */
+void record_allocation(const std::size_t size) noexcept
+{
+    core::alloc::detail::allocations.fetch_add(1, std::memory_order_relaxed);
+    core::alloc::detail::bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Count a deallocation.
+ *
+ * @param pointer Pointer being freed; null pointers are not counted.
+ */
+void record_deallocation(const void *pointer) noexcept
+{
+    if (pointer) {
+        core::alloc::detail::deallocations.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Allocate memory the way the default operator new does, calling the new-handler until it succeeds.
+ *
+ * @param size Number of bytes (e.g., "64").
+ * @param alignment Alignment in bytes, 0 for the default alignment of malloc().
+ *
+ * @return Pointer to the memory if succeeded, nullptr if there is no new-handler.
+ */
+[[nodiscard]] void *allocate(std::size_t size,
+                             const std::size_t alignment) noexcept
+{
+    record_allocation(size);
+    size = size == 0 ? 1 : size;
+    while (true) {
+        void *pointer = nullptr;
+        if (alignment == 0) {
+            pointer = std::malloc(size);
+        }
+        else if (::posix_memalign(&pointer, alignment, size) != 0) {
+            pointer = nullptr;
+        }
+        if (pointer) {
+            return pointer;
+        }
+        const std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            return nullptr;
+        }
+        try {
+            handler();
+        }
+        catch (...) {
+            return nullptr;
+        }
+    }
+}
+
+/**
+ * @brief Mark the hook as installed during static initialization.
+ */
+const bool installed = [] {
+    core::alloc::detail::installed.store(true, std::memory_order_relaxed);
+    return true;
+}();
+
+}  // namespace
+
+void *operator new(const std::size_t size)
+{
+    if (void *pointer = allocate(size, 0)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](const std::size_t size)
+{
+    return ::operator new(size);
+}
+
+void *operator new(const std::size_t size,
+                   const std::align_val_t alignment)
+{
+    if (void *pointer = allocate(size, static_cast<std::size_t>(alignment))) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](const std::size_t size,
+                     const std::align_val_t alignment)
+{
+    return ::operator new(size, alignment);
+}
+
+void *operator new(const std::size_t size,
+                   const std::nothrow_t &) noexcept
+{
+    return allocate(size, 0);
+}
+
+void *operator new[](const std::size_t size,
+                     const std::nothrow_t &) noexcept
+{
+    return allocate(size, 0);
+}
+
+void operator delete(void *pointer) noexcept
+{
+    record_deallocation(pointer);
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept
+{
+    ::operator delete(pointer);
+}
+
+void operator delete(void *pointer,
+                     std::size_t) noexcept
+{
+    ::operator delete(pointer);
+}
+
+void operator delete[](void *pointer,
+                       std::size_t) noexcept
+{
+    ::operator delete(pointer);
+}
+
+void operator delete(void *pointer,
+                     std::align_val_t) noexcept
+{
+    ::operator delete(pointer);
+}
+
+void operator delete[](void *pointer,
+                       std::align_val_t) noexcept
+{
+    ::operator delete(pointer);
+}
+
+void operator delete(void *pointer,
+                     std::size_t,
+                     std::align_val_t) noexcept
+{
+    ::operator delete(pointer);
+}
+
+void operator delete[](void *pointer,
+                       std::size_t,
+                       std::align_val_t) noexcept
+{
+    ::operator delete(pointer);
+}
+
+void operator delete(void *pointer,
+                     const std::nothrow_t &) noexcept
+{
+    ::operator delete(pointer);
+}
+
+void operator delete[](void *pointer,
+                       const std::nothrow_t &) noexcept
+{
+    ::operator delete(pointer);
+}
@@ -2,7 +2,13 @@
  * @file args.cpp
  */
 
-#include <string>  // for std::string
+#include <charconv>      // for std::from_chars
+#include <cstdint>       // for std::uint64_t
+#include <optional>      // for std::optional, std::nullopt
+#include <string>        // for std::string
+#include <string_view>   // for std::string_view
+#include <system_error>  // for std::errc
+#include <vector>        // for std::vector
 
 #include <fmt/core.h>
 
@@ -11,6 +17,27 @@
 
 namespace core::args {
 
+namespace {
+
+/**
+ * @brief Get the value of an option passed as "--name=value".
+ *
+ * @param arg Command-line argument (e.g., "--image=logo.png").
+ * @param prefix Name of the option, including the equals sign (e.g., "--image=").
+ *
+ * @return Value (e.g., "logo.png") if the argument is the option with a non-empty value, std::nullopt otherwise.
+ */
+[[nodiscard]] std::optional<std::string_view> get_option_value(const std::string_view arg,
+                                                               const std::string_view prefix)
+{
+    if (arg.size() > prefix.size() && arg.substr(0, prefix.size()) == prefix) {
+        return arg.substr(prefix.size());
+    }
+    return std::nullopt;
+}
+
+}  // namespace
+
 Args::Args(const int argc,
            char **argv)
 {
@@ -18,29 +45,120 @@ Args::Args(const int argc,
     if (argc == 1) {
         return;
     }
-    // If one or more arguments
-    else {
-        // Define the formatted help message
-        const std::string help_message =
-            "Usage: applefetch [-h] [-v]\n"
-            "\n"
-            "CLI system information tool, inspired by neofetch.\n"
-            "\n"
-            "Optional arguments:\n"
-            "  -h, --help     prints help message and exits\n"
-            "  -v, --version  prints version and exits\n";
-
-        // Get the first argument as a string
-        const std::string arg = argv[1];
+
+    // Define the formatted help message
+    const std::string help_message =
+        "Usage: applefetch [-h] [-v] [--image=PATH] [--json] [--profile] [--alloc-stats] [--watch]\n"
+        "                  [--record=FILE] [--replay=FILE] [--summarize=FILE] [--window=SECONDS] [--follow]\n"
+        "                  [--dump[=PATTERN]] [--inventory]\n"
+        "       applefetch aggregate PATH...\n"
+        "       applefetch diff [--json] OLD NEW\n"
+        "\n"
+        "CLI system information tool, inspired by neofetch.\n"
+        "\n"
+        "Commands:\n"
+        "  aggregate PATH...  summarizes --json snapshots (files, or directories of *.json files)\n"
+        "  diff OLD NEW       compares two --json snapshots, exits with 2 if they differ\n"
+        "\n"
+        "Optional arguments:\n"
+        "  -h, --help     prints help message and exits\n"
+        "  -v, --version  prints version and exits\n"
+        "  --image=PATH   prints a PNG image instead of the logo (kitty or sixel graphics)\n"
+        "  --json         prints the fields as JSON\n"
+        "  --profile      prints the cost of every probe (time, context switches, page faults, syscalls)\n"
+        "  --alloc-stats  prints the heap allocations of every probe and render stage\n"
+        "  --watch        refreshes uptime, memory and load every second until interrupted\n"
+        "  --record=FILE  records memory, swap, load and uptime into a ring file every second\n"
+        "  --replay=FILE  prints a recording, averaged over windows of --window seconds (default: 60)\n"
+        "  --summarize=FILE\n"
+        "                 prints the min/avg/max of a recording over its last --window seconds (default: all)\n"
+        "  --window=SECONDS\n"
+        "                 sets the time window of --replay and --summarize\n"
+        "  --follow       keeps replaying samples as they are recorded\n"
+        "  --dump[=PATTERN]\n"
+        "                 prints the kernel variables (sysctl, /proc/sys) whose names match a glob, as NDJSON with --json\n"
+        "  --inventory    prints the PCI and USB devices with their vendor and device names\n";
+
+    // Every argument after the "aggregate" command is a snapshot file or directory
+    if (std::string_view(argv[1]) == "aggregate") {
+        if (argc == 2) {
+            throw ArgsError(fmt::format("Error: Missing snapshot paths for aggregate\n\n{}", help_message));
+        }
+        this->aggregate_paths.assign(argv + 2, argv + argc);
+        return;
+    }
+
+    // The "diff" command takes exactly two snapshots, and "--json" to print the changes as JSON
+    if (std::string_view(argv[1]) == "diff") {
+        for (int i = 2; i < argc; ++i) {
+            if (std::string_view(argv[i]) == "--json") {
+                this->json = true;
+            }
+            else {
+                this->diff_paths.emplace_back(argv[i]);
+            }
+        }
+        if (this->diff_paths.size() != 2) {
+            throw ArgsError(fmt::format("Error: Expected two snapshots for diff\n\n{}", help_message));
+        }
+        return;
+    }
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
 
         if (arg == "-h" || arg == "--help") {
-            // If "-h" or "--help" is passed as the first argument, throw ArgsMessage with the help message
+            // If "-h" or "--help" is passed, throw ArgsMessage with the help message
             throw ArgsMessage(help_message);
         }
         else if (arg == "-v" || arg == "--version") {
-            // If "-v" or "--version" is passed as the first argument, throw ArgsMessage with the version
+            // If "-v" or "--version" is passed, throw ArgsMessage with the version
             throw ArgsMessage(fmt::format("{}", PROJECT_VERSION));
         }
+        else if (const auto image = get_option_value(arg, "--image=")) {
+            this->image_path = std::string(*image);
+        }
+        else if (arg == "--json") {
+            this->json = true;
+        }
+        else if (arg == "--profile") {
+            this->profile = true;
+        }
+        else if (arg == "--alloc-stats") {
+            this->alloc_stats = true;
+        }
+        else if (arg == "--watch") {
+            this->watch = true;
+        }
+        else if (const auto record = get_option_value(arg, "--record=")) {
+            this->record_path = std::string(*record);
+        }
+        else if (const auto replay = get_option_value(arg, "--replay=")) {
+            this->replay_path = std::string(*replay);
+        }
+        else if (const auto summarize = get_option_value(arg, "--summarize=")) {
+            this->summarize_path = std::string(*summarize);
+        }
+        else if (const auto window = get_option_value(arg, "--window=")) {
+            std::uint64_t seconds = 0;
+            const auto [end, error] = std::from_chars(window->data(), window->data() + window->size(), seconds);
+            if (error != std::errc() || end != window->data() + window->size() || seconds == 0) {
+                throw ArgsError(fmt::format("Error: Invalid window: {}\n\n{}", *window, help_message));
+            }
+            this->window_seconds = seconds;
+        }
+        else if (arg == "--follow") {
+            this->follow = true;
+        }
+        else if (arg == "--dump") {
+            this->dump_pattern = std::string();
+        }
+        else if (const auto dump = get_option_value(arg, "--dump=")) {
+            this->dump_pattern = std::string(*dump);
+        }
+        else if (arg == "--inventory") {
+            this->inventory = true;
+        }
         else {
             // Otherwise, throw ArgsError with the help message
             throw ArgsError(fmt::format("Error: Invalid argument: {}\n\n{}", arg, help_message));
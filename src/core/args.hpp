@@ -6,7 +6,11 @@
 
 #pragma once
 
+#include <cstdint>    // for std::uint64_t
+#include <optional>   // for std::optional
 #include <stdexcept>  // for std::runtime_error
+#include <string>     // for std::string
+#include <vector>     // for std::vector
 
 namespace core::args {
 
@@ -54,6 +58,76 @@ class Args final {
      */
     explicit Args(const int argc,
                   char **argv);
+
+    /**
+     * @brief Path to an image to print instead of the ASCII logo (e.g., "~/Pictures/logo.png"), set by "--image=PATH".
+     */
+    std::optional<std::string> image_path;
+
+    /**
+     * @brief Whether to print the fields as JSON instead of next to the logo, set by "--json".
+     */
+    bool json = false;
+
+    /**
+     * @brief Whether to measure the cost of every probe and print it after the fields, set by "--profile".
+     */
+    bool profile = false;
+
+    /**
+     * @brief Whether to count the heap allocations of every probe and render stage and print them after the fields, set by "--alloc-stats".
+     */
+    bool alloc_stats = false;
+
+    /**
+     * @brief Whether to keep refreshing the volatile fields (uptime and memory) in place, set by "--watch".
+     */
+    bool watch = false;
+
+    /**
+     * @brief Path to a ring file to record memory, swap, load and uptime into every second (e.g., "memory.ring"), set by "--record=FILE".
+     */
+    std::optional<std::string> record_path;
+
+    /**
+     * @brief Path to a ring file to print as one row per time window, set by "--replay=FILE".
+     */
+    std::optional<std::string> replay_path;
+
+    /**
+     * @brief Path to a ring file to print the minimum, average and maximum of every field of, set by "--summarize=FILE".
+     */
+    std::optional<std::string> summarize_path;
+
+    /**
+     * @brief Length of the time window in seconds (e.g., "60"), set by "--window=SECONDS".
+     */
+    std::optional<std::uint64_t> window_seconds;
+
+    /**
+     * @brief Whether to keep replaying samples as they are recorded, set by "--follow".
+     */
+    bool follow = false;
+
+    /**
+     * @brief Pattern of the kernel variables to dump (e.g., "kern.*version"), empty to dump all of them, set by "--dump" or "--dump=PATTERN".
+     */
+    std::optional<std::string> dump_pattern;
+
+    /**
+     * @brief Whether to list the PCI and USB devices instead of fetching, set by "--inventory".
+     */
+    bool inventory = false;
+
+    /**
+     * @brief Paths to snapshot files or directories to aggregate (e.g., {"snapshots/"}), set by the "aggregate PATH..." command; empty if not aggregating.
+     */
+    std::vector<std::string> aggregate_paths;
+
+    /**
+     * @brief Paths to the old and new snapshots to compare (e.g., {"before.json", "after.json"}), set by the "diff OLD NEW" command; empty if not comparing.
+     */
+    std::vector<std::string> diff_paths;
 };
 
 }  // namespace core::args
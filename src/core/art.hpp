@@ -0,0 +1,331 @@
+/**
+ * @file art.hpp
+ *
+ * @brief Compile ASCII art with color markers into pre-escaped rows at compile time.
+ */
+
+#pragma once
+
+#include <array>        // for std::array
+#include <cstddef>      // for std::size_t
+#include <string_view>  // for std::string_view
+
+#include "width.hpp"
+
+namespace core::art {
+
+/**
+ * @brief Reset escape that ends every colored row, so that rows can be printed independently.
+ */
+inline constexpr std::string_view reset = "\033[0m";
+
+/**
+ * @brief Struct that represents the location and visible width of a single row.
+ */
+struct Row final {
+    /**
+     * @brief Offset of the row in the colored buffer.
+     */
+    std::size_t colored_offset = 0;
+
+    /**
+     * @brief Size of the colored row in bytes, including escapes.
+     */
+    std::size_t colored_size = 0;
+
+    /**
+     * @brief Offset of the row in the plain buffer.
+     */
+    std::size_t plain_offset = 0;
+
+    /**
+     * @brief Size of the plain row in bytes.
+     */
+    std::size_t plain_size = 0;
+
+    /**
+     * @brief Number of terminal columns the row occupies (e.g., "14").
+     */
+    std::size_t width = 0;
+};
+
+/**
+ * @brief Non-owning view of compiled art, so that arts of different sizes can be used interchangeably.
+ */
+struct View final {
+    /**
+     * @brief All colored rows, back to back.
+     */
+    std::string_view colored;
+
+    /**
+     * @brief All plain rows, back to back.
+     */
+    std::string_view plain;
+
+    /**
+     * @brief Pointer to the first row.
+     */
+    const Row *rows = nullptr;
+
+    /**
+     * @brief Number of rows (e.g., "9").
+     */
+    std::size_t row_count = 0;
+
+    /**
+     * @brief Width of the widest row (e.g., "15").
+     */
+    std::size_t width = 0;
+
+    /**
+     * @brief Get the bytes of a row.
+     *
+     * @param index Index of the row (e.g., "0").
+     * @param color_enabled Whether to return the colored or the plain row.
+     *
+     * @return Bytes of the row, without a newline.
+     */
+    [[nodiscard]] constexpr std::string_view get_row(const std::size_t index,
+                                                     const bool color_enabled) const noexcept
+    {
+        const Row &row = this->rows[index];
+        return color_enabled ? this->colored.substr(row.colored_offset, row.colored_size) : this->plain.substr(row.plain_offset, row.plain_size);
+    }
+};
+
+/**
+ * @brief Art compiled into colored and plain buffers.
+ *
+ * @tparam ColoredSize Size of the colored buffer in bytes.
+ * @tparam PlainSize Size of the plain buffer in bytes.
+ * @tparam RowCount Number of rows.
+ */
+template <std::size_t ColoredSize, std::size_t PlainSize, std::size_t RowCount>
+struct Art final {
+    /**
+     * @brief Colored rows, back to back.
+     */
+    std::array<char, ColoredSize> colored{};
+
+    /**
+     * @brief Plain rows, back to back.
+     */
+    std::array<char, PlainSize> plain{};
+
+    /**
+     * @brief Location of every row.
+     */
+    std::array<Row, RowCount> rows{};
+
+    /**
+     * @brief Width of the widest row.
+     */
+    std::size_t width = 0;
+
+    /**
+     * @brief Get a non-owning view of the art.
+     *
+     * @return View that is valid for as long as the art.
+     */
+    [[nodiscard]] constexpr View get_view() const noexcept
+    {
+        return {std::string_view(this->colored.data(), ColoredSize), std::string_view(this->plain.data(), PlainSize), this->rows.data(), RowCount, this->width};
+    }
+};
+
+/**
+ * @brief Remove the newline that follows the opening of a raw string literal, and the one before its closing.
+ *
+ * @param art Art (e.g., "\n  /\\\n /  \\\n").
+ *
+ * @return Art without the surrounding newlines (e.g., "  /\\\n /  \\").
+ */
+[[nodiscard]] constexpr std::string_view trim(std::string_view art) noexcept
+{
+    if (!art.empty() && art.front() == '\n') {
+        art.remove_prefix(1);
+    }
+    if (!art.empty() && art.back() == '\n') {
+        art.remove_suffix(1);
+    }
+    return art;
+}
+
+/**
+ * @brief Check whether a character is a color marker, i.e., "$1" to "$9" switch to that palette entry.
+ *
+ * @param art Art.
+ * @param i Position of the character.
+ *
+ * @return True if a marker starts at the position, false otherwise.
+ */
+[[nodiscard]] constexpr bool is_marker(const std::string_view art,
+                                       const std::size_t i) noexcept
+{
+    return art[i] == '$' && i + 1 < art.size() && art[i + 1] >= '1' && art[i + 1] <= '9';
+}
+
+/**
+ * @brief Count the rows of art.
+ *
+ * @param art Art, as a raw string literal.
+ *
+ * @return Number of rows (e.g., "9").
+ */
+[[nodiscard]] constexpr std::size_t count_rows(const std::string_view art) noexcept
+{
+    const std::string_view trimmed = trim(art);
+    std::size_t rows = 1;
+    for (const char c : trimmed) {
+        rows += c == '\n' ? 1 : 0;
+    }
+    return rows;
+}
+
+/**
+ * @brief Get the size of the plain buffer, i.e., the art without markers and newlines.
+ *
+ * @param art Art, as a raw string literal.
+ *
+ * @return Size in bytes.
+ */
+[[nodiscard]] constexpr std::size_t get_plain_size(const std::string_view art) noexcept
+{
+    const std::string_view trimmed = trim(art);
+    std::size_t size = 0;
+    for (std::size_t i = 0; i < trimmed.size(); ++i) {
+        if (is_marker(trimmed, i)) {
+            ++i;
+        }
+        else if (trimmed[i] != '\n') {
+            ++size;
+        }
+    }
+    return size;
+}
+
+/**
+ * @brief Get the size of the colored buffer, i.e., the art with markers replaced by escapes, every row restarting its color and ending with a reset.
+ *
+ * @tparam PaletteSize Number of colors in the palette.
+ * @param art Art, as a raw string literal.
+ * @param palette Escape of every color (e.g., {"\033[32m", "\033[33m"}).
+ *
+ * @return Size in bytes.
+ */
+template <std::size_t PaletteSize>
+[[nodiscard]] constexpr std::size_t get_colored_size(const std::string_view art,
+                                                     const std::array<std::string_view, PaletteSize> &palette) noexcept
+{
+    const std::string_view trimmed = trim(art);
+    std::size_t size = 0;
+    std::size_t color = PaletteSize;
+    bool row_start = true;
+    for (std::size_t i = 0; i < trimmed.size(); ++i) {
+        if (row_start && color < PaletteSize && !is_marker(trimmed, i)) {
+            size += palette[color].size();
+        }
+        row_start = false;
+        if (is_marker(trimmed, i)) {
+            color = static_cast<std::size_t>(trimmed[i + 1] - '1');
+            size += palette[color].size();
+            ++i;
+        }
+        else if (trimmed[i] == '\n') {
+            size += reset.size();
+            row_start = true;
+        }
+        else {
+            ++size;
+        }
+    }
+    return size + reset.size();
+}
+
+/**
+ * @brief Compile art into colored and plain rows.
+ *
+ * @tparam ColoredSize Size of the colored buffer, from get_colored_size().
+ * @tparam PlainSize Size of the plain buffer, from get_plain_size().
+ * @tparam RowCount Number of rows, from count_rows().
+ * @tparam PaletteSize Number of colors in the palette.
+ * @param art Art, as a raw string literal. "$1" to "$9" switch to the corresponding palette entry, which stays active across rows.
+ * @param palette Escape of every color (e.g., {"\033[32m", "\033[33m"}).
+ *
+ * @return Compiled art.
+ */
+template <std::size_t ColoredSize, std::size_t PlainSize, std::size_t RowCount, std::size_t PaletteSize>
+[[nodiscard]] constexpr Art<ColoredSize, PlainSize, RowCount> compile(const std::string_view art,
+                                                                      const std::array<std::string_view, PaletteSize> &palette) noexcept
+{
+    const std::string_view trimmed = trim(art);
+    Art<ColoredSize, PlainSize, RowCount> result;
+    std::size_t colored = 0;
+    std::size_t plain = 0;
+    std::size_t row = 0;
+    std::size_t color = PaletteSize;
+    const auto append = [&result, &colored](const std::string_view bytes) {
+        for (const char c : bytes) {
+            result.colored[colored++] = c;
+        }
+    };
+    const auto finish_row = [&]() {
+        append(reset);
+        Row &current = result.rows[row];
+        current.colored_size = colored - current.colored_offset;
+        current.plain_size = plain - current.plain_offset;
+        current.width = core::width::measure(std::string_view(result.plain.data() + current.plain_offset, current.plain_size));
+        result.width = current.width > result.width ? current.width : result.width;
+    };
+
+    bool row_start = true;
+    for (std::size_t i = 0; i < trimmed.size(); ++i) {
+        if (row_start) {
+            result.rows[row].colored_offset = colored;
+            result.rows[row].plain_offset = plain;
+            if (color < PaletteSize && !is_marker(trimmed, i)) {
+                append(palette[color]);
+            }
+            row_start = false;
+        }
+        if (is_marker(trimmed, i)) {
+            color = static_cast<std::size_t>(trimmed[i + 1] - '1');
+            append(palette[color]);
+            ++i;
+        }
+        else if (trimmed[i] == '\n') {
+            finish_row();
+            ++row;
+            row_start = true;
+        }
+        else {
+            result.colored[colored++] = trimmed[i];
+            result.plain[plain++] = trimmed[i];
+        }
+    }
+    if (row_start) {
+        result.rows[row].colored_offset = colored;
+        result.rows[row].plain_offset = plain;
+    }
+    finish_row();
+    return result;
+}
+
+/**
+ * @brief Art compiled at compile time, with the buffer sizes derived from the art itself.
+ *
+ * Example:
+ * @code
+ * constexpr std::string_view text = "$1/\\\n$2\\/";
+ * constexpr std::array<std::string_view, 2> palette = {"\033[32m", "\033[33m"};
+ * constexpr core::art::View view = core::art::compiled<text, palette>.get_view();
+ * @endcode
+ *
+ * @tparam Text Art, as a raw string literal with static storage.
+ * @tparam Palette Escape of every color, with static storage.
+ */
+template <const std::string_view &Text, const auto &Palette>
+inline constexpr auto compiled = compile<get_colored_size(Text, Palette), get_plain_size(Text), count_rows(Text)>(Text, Palette);
+
+}  // namespace core::art
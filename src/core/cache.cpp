@@ -0,0 +1,140 @@
+/**
+ * @file cache.cpp
+ */
+
+#include <cstdint>       // for std::uint64_t
+#include <filesystem>    // for std::filesystem
+#include <fstream>       // for std::ifstream, std::ofstream
+#include <ios>           // for std::ios, std::streamsize
+#include <iterator>      // for std::istreambuf_iterator
+#include <optional>      // for std::optional, std::nullopt
+#include <string>        // for std::string, std::getline
+#include <string_view>   // for std::string_view
+#include <system_error>  // for std::error_code
+#include <unistd.h>      // for getpid
+
+#include "cache.hpp"
+#include "env.hpp"
+#include "profile.hpp"
+#include "text.hpp"
+
+namespace core::cache {
+
+namespace {
+
+/**
+ * @brief Get the path of the file that holds a cached value.
+ *
+ * The file name is the 64-bit FNV-1a hash of the key. The key itself is stored in the file, so that hash collisions are detected on load.
+ *
+ * @param key Unique key of the value.
+ *
+ * @return Path to the cache file if succeeded, std::nullopt otherwise.
+ */
+[[nodiscard]] std::optional<std::filesystem::path> get_file_path(const std::string &key)
+{
+    const auto directory = get_directory();
+    if (!directory) {
+        return std::nullopt;
+    }
+    std::uint64_t hash = 14695981039346656037ULL;
+    for (const char c : key) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ULL;
+    }
+    std::string name;
+    core::text::append_hex(hash, 16, name);
+    return *directory / name;
+}
+
+}  // namespace
+
+std::optional<std::filesystem::path> get_directory()
+{
+    if (const auto dir = core::env::get_variable("APPLEFETCH_CACHE_DIR"); dir && !dir->empty()) {
+        return std::filesystem::path(*dir);
+    }
+    if (const auto xdg = core::env::get_variable("XDG_CACHE_HOME"); xdg && !xdg->empty()) {
+        return std::filesystem::path(*xdg) / "applefetch";
+    }
+    if (const auto home = core::env::get_variable("HOME"); home && !home->empty()) {
+#if defined(__APPLE__)
+        return std::filesystem::path(*home) / "Library" / "Caches" / "applefetch";
+#else
+        return std::filesystem::path(*home) / ".cache" / "applefetch";
+#endif
+    }
+    return std::nullopt;
+}
+
+std::optional<std::string> load(const std::string &key)
+{
+    const core::profile::Scope scope("core::cache::load");
+    const auto path = get_file_path(key);
+    if (!path) {
+        return std::nullopt;
+    }
+    std::ifstream file(*path, std::ios::binary);
+    if (!file) {
+        return std::nullopt;
+    }
+
+    // First line is the key, the rest of the file is the value
+    std::string stored_key;
+    if (!std::getline(file, stored_key) || stored_key != key) {
+        return std::nullopt;
+    }
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+bool store(const std::string &key,
+           const std::string &value)
+{
+    const core::profile::Scope scope("core::cache::store");
+    const auto path = get_file_path(key);
+    if (!path) {
+        return false;
+    }
+
+    // First line is the key, the rest of the file is the value
+    std::string content;
+    content.reserve(key.size() + 1 + value.size());
+    content.append(key).push_back('\n');
+    content.append(value);
+    return write_atomically(*path, content);
+}
+
+bool write_atomically(const std::filesystem::path &path,
+                      const std::string_view content)
+{
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+    if (ec) {
+        return false;
+    }
+
+    // Write to a unique temporary file, then atomically replace the old content
+    std::filesystem::path temp_path = path;
+    std::string suffix = ".";
+    core::text::append_integer(getpid(), suffix);
+    temp_path += suffix + ".tmp";
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+        if (!file.write(content.data(), static_cast<std::streamsize>(content.size())).flush()) {
+            file.close();
+            std::filesystem::remove(temp_path, ec);
+            return false;
+        }
+    }
+    std::filesystem::rename(temp_path, path, ec);
+    if (ec) {
+        std::filesystem::remove(temp_path, ec);
+        return false;
+    }
+    return true;
+}
+
+}  // namespace core::cache
@@ -0,0 +1,64 @@
+/**
+ * @file cache.hpp
+ *
+ * @brief Persist small values between runs.
+ */
+
+#pragma once
+
+#include <filesystem>   // for std::filesystem::path
+#include <optional>     // for std::optional
+#include <string>       // for std::string
+#include <string_view>  // for std::string_view
+
+namespace core::cache {
+
+/**
+ * @brief Get the directory where cached values are stored.
+ *
+ * The first available location is used: $APPLEFETCH_CACHE_DIR, $XDG_CACHE_HOME/applefetch, then "~/Library/Caches/applefetch" on macOS or "~/.cache/applefetch" elsewhere.
+ *
+ * @return Path to the cache directory (e.g., "/Users/user/Library/Caches/applefetch") if succeeded, std::nullopt otherwise (e.g., $HOME is not set).
+ *
+ * @note The directory is not created by this function.
+ */
+[[nodiscard]] std::optional<std::filesystem::path> get_directory();
+
+/**
+ * @brief Load a cached value.
+ *
+ * The caller is expected to encode everything that invalidates the value into the key (e.g., device, inode, mtime and size of a file).
+ *
+ * @param key Unique key of the value (e.g., "shell-version:16777232:1152921500312:1722470400:1377872").
+ *
+ * @return Cached value if found (e.g., "5.9"), std::nullopt otherwise.
+ */
+[[nodiscard]] std::optional<std::string> load(const std::string &key);
+
+/**
+ * @brief Store a value in the cache, replacing any previous value with the same key.
+ *
+ * The value is written to a temporary file first and then renamed, so concurrent readers never see a partially written value.
+ *
+ * @param key Unique key of the value (e.g., "shell-version:16777232:1152921500312:1722470400:1377872").
+ * @param value Value to store (e.g., "5.9"). It may contain arbitrary bytes.
+ *
+ * @return True if succeeded, false otherwise.
+ */
+bool store(const std::string &key,
+           const std::string &value);
+
+/**
+ * @brief Write a file in the cache directory (e.g., an index built from a database), replacing it atomically.
+ *
+ * The content is written to a temporary file next to the file first and then renamed over it, so concurrent readers see either the old or the new content. Missing parent directories are created.
+ *
+ * @param path Path to the file (e.g., "/Users/user/Library/Caches/applefetch/pci.ids.index").
+ * @param content Content of the file. It may contain arbitrary bytes.
+ *
+ * @return True if succeeded, false otherwise.
+ */
+bool write_atomically(const std::filesystem::path &path,
+                      const std::string_view content);
+
+}  // namespace core::cache
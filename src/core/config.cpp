@@ -0,0 +1,148 @@
+/**
+ * @file config.cpp
+ */
+
+#include <algorithm>     // for std::min
+#include <charconv>      // for std::from_chars
+#include <chrono>        // for std::chrono::milliseconds, std::chrono::seconds, std::chrono::minutes, std::chrono::hours
+#include <cstddef>       // for std::size_t
+#include <cstdint>       // for std::uint64_t
+#include <filesystem>    // for std::filesystem
+#include <fstream>       // for std::ifstream
+#include <ios>           // for std::ios
+#include <iterator>      // for std::istreambuf_iterator
+#include <optional>      // for std::optional, std::nullopt
+#include <string>        // for std::string
+#include <string_view>   // for std::string_view
+#include <system_error>  // for std::error_code, std::errc
+#include <vector>        // for std::vector
+
+#include <fmt/core.h>
+
+#include "config.hpp"
+#include "env.hpp"
+
+namespace core::config {
+
+namespace {
+
+/**
+ * @brief Remove leading and trailing spaces and tabs.
+ *
+ * @param text Text to trim (e.g., "  run = ls ").
+ *
+ * @return Trimmed text (e.g., "run = ls").
+ */
+[[nodiscard]] std::string_view trim(std::string_view text) noexcept
+{
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t' || text.back() == '\r')) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+}  // namespace
+
+std::optional<std::string_view> Section::get(const std::string_view key) const noexcept
+{
+    for (auto it = this->entries.rbegin(); it != this->entries.rend(); ++it) {
+        if (it->first == key) {
+            return it->second;
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<std::filesystem::path> get_path()
+{
+    if (const auto path = core::env::get_variable("APPLEFETCH_CONFIG"); path && !path->empty()) {
+        return std::filesystem::path(*path);
+    }
+    if (const auto xdg = core::env::get_variable("XDG_CONFIG_HOME"); xdg && !xdg->empty()) {
+        return std::filesystem::path(*xdg) / "applefetch" / "config";
+    }
+    if (const auto home = core::env::get_variable("HOME"); home && !home->empty()) {
+        return std::filesystem::path(*home) / ".config" / "applefetch" / "config";
+    }
+    return std::nullopt;
+}
+
+std::vector<Section> parse(const std::string_view text,
+                           const std::string &origin)
+{
+    std::vector<Section> sections;
+    std::size_t line_number = 0;
+    for (std::size_t start = 0; start < text.size(); ++line_number) {
+        const std::size_t end = std::min(text.find('\n', start), text.size());
+        const std::string_view line = trim(text.substr(start, end - start));
+        start = end + 1;
+        if (line.empty() || line.front() == '#' || line.front() == ';') {
+            continue;
+        }
+
+        // "[kind name]", where the name may contain spaces (e.g., "[command Git branch]")
+        if (line.front() == '[') {
+            const std::string_view header = trim(line.substr(1, line.size() - 1 - (line.back() == ']' ? 1 : 0)));
+            const std::size_t separator = header.find_first_of(" \t");
+            if (line.back() != ']' || separator == std::string_view::npos) {
+                throw ConfigError(fmt::format("Invalid config: {}:{} (Expected a \"[kind name]\" header)", origin, line_number + 1));
+            }
+            sections.push_back(Section{std::string(header.substr(0, separator)), std::string(trim(header.substr(separator))), {}, line_number + 1});
+            continue;
+        }
+
+        const std::size_t equals = line.find('=');
+        if (equals == std::string_view::npos || trim(line.substr(0, equals)).empty()) {
+            throw ConfigError(fmt::format("Invalid config: {}:{} (Expected \"key = value\")", origin, line_number + 1));
+        }
+        if (sections.empty()) {
+            throw ConfigError(fmt::format("Invalid config: {}:{} (Entry outside of a section)", origin, line_number + 1));
+        }
+        sections.back().entries.emplace_back(trim(line.substr(0, equals)), trim(line.substr(equals + 1)));
+    }
+    return sections;
+}
+
+std::vector<Section> load()
+{
+    const auto path = get_path();
+    std::error_code error;
+    if (!path || !std::filesystem::exists(*path, error)) {
+        return {};
+    }
+    std::ifstream file(*path, std::ios::binary);
+    if (!file) {
+        throw ConfigError(fmt::format("Failed to read config: {}", path->string()));
+    }
+    const std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return parse(text, path->string());
+}
+
+std::optional<std::chrono::milliseconds> parse_duration(const std::string_view text)
+{
+    std::uint64_t count = 0;
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), count);
+    if (error != std::errc()) {
+        return std::nullopt;
+    }
+    const std::string_view unit = trim(std::string_view(end, static_cast<std::size_t>(text.data() + text.size() - end)));
+    const auto value = static_cast<std::chrono::milliseconds::rep>(count);
+    if (unit == "ms") {
+        return std::chrono::milliseconds(value);
+    }
+    if (unit == "s") {
+        return std::chrono::seconds(value);
+    }
+    if (unit == "m") {
+        return std::chrono::minutes(value);
+    }
+    if (unit == "h") {
+        return std::chrono::hours(value);
+    }
+    return std::nullopt;
+}
+
+}  // namespace core::config
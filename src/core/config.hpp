@@ -0,0 +1,111 @@
+/**
+ * @file config.hpp
+ *
+ * @brief Read the configuration file.
+ */
+
+#pragma once
+
+#include <chrono>       // for std::chrono::milliseconds
+#include <cstddef>      // for std::size_t
+#include <filesystem>   // for std::filesystem::path
+#include <optional>     // for std::optional
+#include <stdexcept>    // for std::runtime_error
+#include <string>       // for std::string
+#include <string_view>  // for std::string_view
+#include <utility>      // for std::pair
+#include <vector>       // for std::vector
+
+namespace core::config {
+
+/**
+ * @brief Exceptions raised when the configuration file is invalid. The message includes the path, the line and the reason.
+ *
+ * This class extends "std::runtime_error".
+ *
+ * @note This class is marked as `final` to prevent inheritance.
+ */
+class ConfigError final : public std::runtime_error {
+  public:
+    using std::runtime_error::runtime_error;
+};
+
+/**
+ * @brief Struct that represents a section of the configuration file (e.g., "[command VPN]").
+ */
+struct Section final {
+    /**
+     * @brief Kind of the section, the first word of the header (e.g., "command").
+     */
+    std::string kind;
+
+    /**
+     * @brief Name of the section, the rest of the header (e.g., "VPN").
+     */
+    std::string name;
+
+    /**
+     * @brief Entries of the section, in order (e.g., {{"run", "scutil --nc list"}}).
+     */
+    std::vector<std::pair<std::string, std::string>> entries;
+
+    /**
+     * @brief Line of the header, for error messages (e.g., "3").
+     */
+    std::size_t line = 0;
+
+    /**
+     * @brief Get the value of an entry.
+     *
+     * @param key Key of the entry (e.g., "run").
+     *
+     * @return Value of the last entry with this key (e.g., "scutil --nc list"), std::nullopt if there is none.
+     */
+    [[nodiscard]] std::optional<std::string_view> get(const std::string_view key) const noexcept;
+};
+
+/**
+ * @brief Get the path of the configuration file.
+ *
+ * The first available location is used: $APPLEFETCH_CONFIG, $XDG_CONFIG_HOME/applefetch/config, then "~/.config/applefetch/config".
+ *
+ * @return Path to the configuration file (e.g., "/Users/user/.config/applefetch/config") if succeeded, std::nullopt otherwise (e.g., $HOME is not set).
+ *
+ * @note The file may not exist.
+ */
+[[nodiscard]] std::optional<std::filesystem::path> get_path();
+
+/**
+ * @brief Parse a configuration file.
+ *
+ * The file is made of sections, each starting with a "[kind name]" header, followed by "key = value" entries. Blank lines and lines starting with '#' or ';' are ignored.
+ *
+ * @param text Contents of the file (e.g., "[command VPN]\nrun = scutil --nc list\n").
+ * @param origin Name of the file for error messages (e.g., "config").
+ *
+ * @return Sections, in order.
+ *
+ * @throws ConfigError If a line is neither a header nor an entry, or an entry comes before the first header.
+ */
+[[nodiscard]] std::vector<Section> parse(const std::string_view text,
+                                         const std::string &origin);
+
+/**
+ * @brief Read and parse the configuration file.
+ *
+ * @return Sections, in order; empty if there is no configuration file.
+ *
+ * @throws ConfigError If the file exists but cannot be read or parsed.
+ */
+[[nodiscard]] std::vector<Section> load();
+
+/**
+ * @brief Parse a duration with a unit.
+ *
+ * @param text Duration (e.g., "500ms", "2s", "5m" or "1h").
+ *
+ * @return Duration if succeeded, std::nullopt otherwise (e.g., no unit).
+ */
+[[nodiscard]] std::optional<std::chrono::milliseconds> parse_duration(const std::string_view text);
+
+}  // namespace core::config
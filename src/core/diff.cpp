@@ -0,0 +1,308 @@
+/**
+ * @file diff.cpp
+ */
+
+#include <algorithm>    // for std::find, std::sort, std::unique
+#include <array>        // for std::array
+#include <cstddef>      // for std::size_t
+#include <fstream>      // for std::ifstream
+#include <ios>          // for std::ios, std::streamsize
+#include <iterator>     // for std::back_inserter
+#include <optional>     // for std::optional, std::nullopt
+#include <string>       // for std::string
+#include <string_view>  // for std::string_view
+#include <utility>      // for std::move
+#include <vector>       // for std::vector
+
+#include <fmt/core.h>
+
+#include "diff.hpp"
+#include "json.hpp"
+
+namespace core::diff {
+
+namespace {
+
+/**
+ * @brief Fields that change on their own while the configuration stays the same, which are never drift.
+ */
+constexpr std::array<std::string_view, 3> volatile_fields = {"Load", "Uptime", "Users"};
+
+/**
+ * @brief Get the part of a value that is compared for drift.
+ *
+ * @param field Title of the field (e.g., "Memory").
+ * @param text Value of the field (e.g., "10.16GiB / 16.00GiB (63%)").
+ *
+ * @return Total memory for "Memory" (e.g., "16.00GiB"), the whole value otherwise.
+ */
+[[nodiscard]] std::string_view get_comparable(const std::string_view field,
+                                              const std::string_view text) noexcept
+{
+    if (field != "Memory") {
+        return text;
+    }
+    const std::size_t separator = text.find(" / ");
+    if (separator == std::string_view::npos) {
+        return text;
+    }
+    const std::string_view total = text.substr(separator + 3);
+    return total.substr(0, total.find(" ("));
+}
+
+/**
+ * @brief Get the items of a field, treating a scalar as a list of one item.
+ *
+ * @param value Value of the field, nullptr if the field is missing.
+ * @param scalar Storage for the item of a scalar.
+ *
+ * @return Sorted items, empty if the field is missing.
+ */
+[[nodiscard]] const std::vector<std::string> &get_items(const Value *value,
+                                                        std::vector<std::string> &scalar)
+{
+    if (value && value->is_list) {
+        return value->items;
+    }
+    scalar.clear();
+    if (value) {
+        scalar.push_back(value->text);
+    }
+    return scalar;
+}
+
+/**
+ * @brief Compare one field and append a change if it drifted.
+ *
+ * @param field Title of the field (e.g., "OS").
+ * @param old_value Old value, nullptr if the field was missing.
+ * @param new_value New value, nullptr if the field is missing.
+ * @param changes Changes to append to.
+ */
+void add_change(const std::string_view field,
+                const Value *old_value,
+                const Value *new_value,
+                std::vector<Change> &changes)
+{
+    if ((old_value && old_value->is_list) || (new_value && new_value->is_list)) {
+        Change change{std::string(field), true, std::nullopt, std::nullopt, {}, {}};
+        std::vector<std::string> old_scalar;
+        std::vector<std::string> new_scalar;
+        difference(get_items(old_value, old_scalar), get_items(new_value, new_scalar), change.added, change.removed);
+        if (!change.added.empty() || !change.removed.empty()) {
+            changes.push_back(std::move(change));
+        }
+        return;
+    }
+    if (old_value && new_value && get_comparable(field, old_value->text) == get_comparable(field, new_value->text)) {
+        return;
+    }
+    Change change{std::string(field), false, std::nullopt, std::nullopt, {}, {}};
+    if (old_value) {
+        change.old_value = old_value->text;
+    }
+    if (new_value) {
+        change.new_value = new_value->text;
+    }
+    changes.push_back(std::move(change));
+}
+
+/**
+ * @brief Format a list of items as a JSON array.
+ *
+ * @param items Items to format.
+ * @param output String to append to.
+ */
+void append_json_array(const std::vector<std::string> &items,
+                       std::string &output)
+{
+    output += '[';
+    for (std::size_t i = 0; i < items.size(); ++i) {
+        output.append(i == 0 ? "" : ",").append(core::json::quote(items[i]));
+    }
+    output += ']';
+}
+
+}  // namespace
+
+std::optional<Snapshot> parse_snapshot(const std::string_view json)
+{
+    core::json::Scanner scanner(json);
+    if (scanner.next().type != core::json::TokenType::ObjectBegin) {
+        return std::nullopt;
+    }
+    Snapshot snapshot;
+    std::vector<std::string_view> views;
+    bool found = false;
+    for (core::json::Token name = scanner.next(); name.type == core::json::TokenType::Key; name = scanner.next()) {
+        if (name.text != "fields") {
+            if (!scanner.skip_value()) {
+                return std::nullopt;
+            }
+            continue;
+        }
+        if (scanner.next().type != core::json::TokenType::ObjectBegin) {
+            return std::nullopt;
+        }
+        found = true;
+        for (core::json::Token field = scanner.next(); field.type == core::json::TokenType::Key; field = scanner.next()) {
+            Value &value = snapshot[core::json::unescape(field.text)];
+            const core::json::Token token = scanner.next();
+            if (token.type == core::json::TokenType::String) {
+                value.text = core::json::unescape(token.text);
+                continue;
+            }
+            if (token.type != core::json::TokenType::ArrayBegin) {
+                return std::nullopt;
+            }
+
+            // Lists are sorted once here, so that comparing them is a single merge pass; views into the document are sorted rather than strings, which are slower to swap
+            value.is_list = true;
+            views.clear();
+            bool escaped = false;
+            for (core::json::Token item = scanner.next(); item.type != core::json::TokenType::ArrayEnd; item = scanner.next()) {
+                if (item.type != core::json::TokenType::String) {
+                    return std::nullopt;
+                }
+                views.push_back(item.text);
+                escaped = escaped || item.text.find('\\') != std::string_view::npos;
+            }
+            std::sort(views.begin(), views.end());
+            views.erase(std::unique(views.begin(), views.end()), views.end());
+            value.items.reserve(views.size());
+            for (const std::string_view view : views) {
+                value.items.push_back(core::json::unescape(view));
+            }
+
+            // Decoding escapes can change the order and make distinct items equal, which is rare enough to sort again
+            if (escaped) {
+                std::sort(value.items.begin(), value.items.end());
+                value.items.erase(std::unique(value.items.begin(), value.items.end()), value.items.end());
+            }
+        }
+    }
+    if (!found) {
+        return std::nullopt;
+    }
+    return snapshot;
+}
+
+Snapshot read_snapshot(const std::string &path)
+{
+    // Read in one call; snapshots with large lists are hundreds of KiB, too many for a character iterator
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    std::string json;
+    if (file) {
+        json.resize(static_cast<std::size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(json.data(), static_cast<std::streamsize>(json.size()));
+    }
+    if (!file) {
+        throw DiffError(fmt::format("Failed to read snapshot: {}", path));
+    }
+    auto snapshot = parse_snapshot(json);
+    if (!snapshot) {
+        throw DiffError(fmt::format("Failed to parse snapshot: {} (Expected the output of --json)", path));
+    }
+    return std::move(*snapshot);
+}
+
+void difference(const std::vector<std::string> &old_items,
+                const std::vector<std::string> &new_items,
+                std::vector<std::string> &added,
+                std::vector<std::string> &removed)
+{
+    auto old_it = old_items.begin();
+    auto new_it = new_items.begin();
+    while (old_it != old_items.end() && new_it != new_items.end()) {
+        if (*old_it < *new_it) {
+            removed.push_back(*old_it++);
+        }
+        else if (*new_it < *old_it) {
+            added.push_back(*new_it++);
+        }
+        else {
+            ++old_it;
+            ++new_it;
+        }
+    }
+    removed.insert(removed.end(), old_it, old_items.end());
+    added.insert(added.end(), new_it, new_items.end());
+}
+
+std::vector<Change> compare(const Snapshot &old_snapshot,
+                            const Snapshot &new_snapshot)
+{
+    // Both snapshots are ordered by title, so fields are paired by merging them
+    std::vector<Change> changes;
+    auto old_it = old_snapshot.begin();
+    auto new_it = new_snapshot.begin();
+    while (old_it != old_snapshot.end() || new_it != new_snapshot.end()) {
+        std::string_view field;
+        const Value *old_value = nullptr;
+        const Value *new_value = nullptr;
+        if (new_it == new_snapshot.end() || (old_it != old_snapshot.end() && old_it->first < new_it->first)) {
+            field = old_it->first;
+            old_value = &(old_it++)->second;
+        }
+        else if (old_it == old_snapshot.end() || new_it->first < old_it->first) {
+            field = new_it->first;
+            new_value = &(new_it++)->second;
+        }
+        else {
+            field = old_it->first;
+            old_value = &(old_it++)->second;
+            new_value = &(new_it++)->second;
+        }
+        if (std::find(volatile_fields.begin(), volatile_fields.end(), field) == volatile_fields.end()) {
+            add_change(field, old_value, new_value, changes);
+        }
+    }
+    return changes;
+}
+
+std::string format_report(const std::vector<Change> &changes)
+{
+    if (changes.empty()) {
+        return "No drift\n";
+    }
+    std::string output;
+    for (const Change &change : changes) {
+        if (!change.is_list) {
+            fmt::format_to(std::back_inserter(output), "{}: {} -> {}\n", change.field, change.old_value.value_or("(missing)"), change.new_value.value_or("(missing)"));
+            continue;
+        }
+        fmt::format_to(std::back_inserter(output), "{}: +{} -{}\n", change.field, change.added.size(), change.removed.size());
+        for (const std::string &item : change.added) {
+            output.append("  + ").append(item) += '\n';
+        }
+        for (const std::string &item : change.removed) {
+            output.append("  - ").append(item) += '\n';
+        }
+    }
+    return output;
+}
+
+std::string format_json(const std::vector<Change> &changes)
+{
+    std::string output = fmt::format(R"({{"drift":{},"changes":[)", !changes.empty());
+    for (std::size_t i = 0; i < changes.size(); ++i) {
+        const Change &change = changes[i];
+        output.append(i == 0 ? "{" : ",{").append(R"("field":)").append(core::json::quote(change.field));
+        if (change.is_list) {
+            output.append(R"(,"added":)");
+            append_json_array(change.added, output);
+            output.append(R"(,"removed":)");
+            append_json_array(change.removed, output);
+        }
+        else {
+            output.append(R"(,"old":)").append(change.old_value ? core::json::quote(*change.old_value) : "null");
+            output.append(R"(,"new":)").append(change.new_value ? core::json::quote(*change.new_value) : "null");
+        }
+        output += '}';
+    }
+    output += "]}";
+    return output;
+}
+
+}  // namespace core::diff
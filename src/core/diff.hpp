@@ -0,0 +1,162 @@
+/**
+ * @file diff.hpp
+ *
+ * @brief Compare two JSON snapshots of a host field by field, to detect configuration drift.
+ */
+
+#pragma once
+
+#include <functional>   // for std::less
+#include <map>          // for std::map
+#include <optional>     // for std::optional
+#include <stdexcept>    // for std::runtime_error
+#include <string>       // for std::string
+#include <string_view>  // for std::string_view
+#include <vector>       // for std::vector
+
+namespace core::diff {
+
+/**
+ * @brief Exceptions raised when a snapshot cannot be read or parsed. The message includes the path and the reason.
+ *
+ * This class extends "std::runtime_error".
+ *
+ * @note This class is marked as `final` to prevent inheritance.
+ */
+class DiffError final : public std::runtime_error {
+  public:
+    using std::runtime_error::runtime_error;
+};
+
+/**
+ * @brief Exit code when the snapshots differ; 1 is already used for errors.
+ */
+inline constexpr int drift_exit_code = 2;
+
+/**
+ * @brief Struct that represents the value of a snapshot field.
+ */
+struct Value final {
+    /**
+     * @brief Value of a scalar field (e.g., "macOS 14.6.1 (arm64)").
+     */
+    std::string text;
+
+    /**
+     * @brief Items of a list field, sorted and without duplicates (e.g., {"git", "zlib"}).
+     */
+    std::vector<std::string> items;
+
+    /**
+     * @brief Whether the field is a list (a JSON array) rather than a scalar.
+     */
+    bool is_list = false;
+};
+
+/**
+ * @brief Fields of a snapshot by title (e.g., "OS").
+ */
+using Snapshot = std::map<std::string, Value, std::less<>>;
+
+/**
+ * @brief Struct that represents the change of one field between two snapshots.
+ */
+struct Change final {
+    /**
+     * @brief Title of the field (e.g., "OS").
+     */
+    std::string field;
+
+    /**
+     * @brief Whether the field is a list, in which case only "added" and "removed" are set.
+     */
+    bool is_list = false;
+
+    /**
+     * @brief Old value of a scalar field, std::nullopt if the field was missing.
+     */
+    std::optional<std::string> old_value;
+
+    /**
+     * @brief New value of a scalar field, std::nullopt if the field is missing.
+     */
+    std::optional<std::string> new_value;
+
+    /**
+     * @brief Items of a list field that were added, sorted (e.g., {"git"}).
+     */
+    std::vector<std::string> added;
+
+    /**
+     * @brief Items of a list field that were removed, sorted (e.g., {"zlib"}).
+     */
+    std::vector<std::string> removed;
+};
+
+/**
+ * @brief Parse a snapshot.
+ *
+ * A snapshot is the output of "applefetch --json" (e.g., "{\"fields\":{\"OS\":\"macOS 14.6.1 (arm64)\",...}}"). Values of "fields" may be strings or arrays of strings (e.g., a package list added by a collector); everything outside "fields" is ignored.
+ *
+ * @param json Contents of the snapshot.
+ *
+ * @return Snapshot if succeeded, std::nullopt otherwise (e.g., no "fields" object, or a nested object in it).
+ */
+[[nodiscard]] std::optional<Snapshot> parse_snapshot(const std::string_view json);
+
+/**
+ * @brief Read and parse a snapshot file.
+ *
+ * @param path Path to the snapshot (e.g., "before.json").
+ *
+ * @return Snapshot.
+ *
+ * @throws DiffError If the file cannot be read or is not a snapshot.
+ */
+[[nodiscard]] Snapshot read_snapshot(const std::string &path);
+
+/**
+ * @brief Compute the set difference of two sorted lists in a single merge pass.
+ *
+ * @param old_items Old items, sorted and without duplicates.
+ * @param new_items New items, sorted and without duplicates.
+ * @param added Items only in "new_items" are appended here, in order.
+ * @param removed Items only in "old_items" are appended here, in order.
+ */
+void difference(const std::vector<std::string> &old_items,
+                const std::vector<std::string> &new_items,
+                std::vector<std::string> &added,
+                std::vector<std::string> &removed);
+
+/**
+ * @brief Compare two snapshots field by field.
+ *
+ * Volatile values are not drift: "Uptime", "Load" and "Users" are ignored, and only the total of "Memory" is compared, not the usage.
+ *
+ * @param old_snapshot Snapshot taken first.
+ * @param new_snapshot Snapshot taken last.
+ *
+ * @return Changed, added and removed fields, ordered by title; empty if there is no drift.
+ */
+[[nodiscard]] std::vector<Change> compare(const Snapshot &old_snapshot,
+                                          const Snapshot &new_snapshot);
+
+/**
+ * @brief Format changes as a compact report, one line per scalar field and per list item.
+ *
+ * @param changes Changes to format.
+ *
+ * @return Report (e.g., "OS: macOS 14.6.1 (arm64) -> macOS 15.0 (arm64)\n"), "No drift\n" if there are no changes.
+ */
+[[nodiscard]] std::string format_report(const std::vector<Change> &changes);
+
+/**
+ * @brief Format changes as a JSON object.
+ *
+ * @param changes Changes to format.
+ *
+ * @return JSON object (e.g., "{\"drift\":true,\"changes\":[{\"field\":\"OS\",\"old\":\"...\",\"new\":\"...\"}]}").
+ */
+[[nodiscard]] std::string format_json(const std::vector<Change> &changes);
+
+}  // namespace core::diff
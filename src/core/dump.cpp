@@ -0,0 +1,665 @@
+/**
+ * @file dump.cpp
+ */
+
+#include <algorithm>           // for std::max, std::min, std::sort
+#include <array>               // for std::array
+#include <condition_variable>  // for std::condition_variable
+#include <cstddef>             // for std::size_t
+#include <cstdio>              // for std::FILE, std::fwrite, std::fflush
+#include <dirent.h>            // for ::fdopendir, ::readdir, ::closedir, ::dirfd, DIR, struct dirent, DT_DIR, DT_REG, DT_UNKNOWN
+#include <fcntl.h>             // for ::openat, AT_FDCWD, O_RDONLY, O_DIRECTORY, O_CLOEXEC
+#include <filesystem>          // for std::filesystem::path
+#include <mutex>               // for std::mutex, std::lock_guard, std::unique_lock
+#include <string>              // for std::string
+#include <string_view>         // for std::string_view
+#include <sys/stat.h>          // for ::fstatat, struct stat, S_ISDIR, S_ISREG
+#include <sys/types.h>         // for ssize_t
+#include <thread>              // for std::thread
+#include <unistd.h>            // for ::read, ::close
+#include <utility>             // for std::move
+#include <vector>              // for std::vector
+
+#if defined(__APPLE__)
+#include <cstdint>     // for std::int64_t, std::uint32_t, std::uint64_t
+#include <cstring>     // for std::memcpy, std::strlen
+#include <iterator>    // for std::back_inserter
+#include <sys/time.h>  // for struct timeval
+#endif
+
+#include <fmt/core.h>
+
+#include "dump.hpp"
+#include "json.hpp"
+#if defined(__APPLE__)
+#include "sysctl.hpp"
+#endif
+
+namespace core::dump {
+
+namespace {
+
+/**
+ * @brief Size of the buffer a value is read into; longer values are truncated.
+ */
+constexpr std::size_t value_buffer_size = 16384;
+
+/**
+ * @brief Number of subtrees to aim for per thread when splitting the tree, so that a large subtree (e.g., "net.ipv4") does not keep one thread busy while the others idle.
+ */
+constexpr std::size_t units_per_thread = 8;
+
+/**
+ * @brief Maximum depth at which directories are split into units; deeper subtrees are always walked by a single thread.
+ */
+constexpr std::size_t max_split_depth = 3;
+
+/**
+ * @brief Check whether a literal piece of a pattern matches a text at a position, where "?" matches any character.
+ *
+ * @param text Text to match (e.g., "kern.osversion").
+ * @param position Position in the text (e.g., "5").
+ * @param piece Piece to match (e.g., "os?ersion").
+ *
+ * @return True if the piece fits and matches, false otherwise.
+ */
+[[nodiscard]] bool piece_matches_at(const std::string_view text,
+                                    const std::size_t position,
+                                    const std::string_view piece) noexcept
+{
+    if (position > text.size() || piece.size() > text.size() - position) {
+        return false;
+    }
+    for (std::size_t i = 0; i < piece.size(); ++i) {
+        if (piece[i] != '?' && piece[i] != text[position + i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Append one variable to an output buffer.
+ *
+ * @param name Name of the variable (e.g., "kernel.ostype").
+ * @param value Value, without the trailing newline (e.g., "Linux").
+ * @param format Output format.
+ * @param separator Separator between name and value in text output (e.g., " = ").
+ * @param output String to append to.
+ */
+void append_entry(const std::string_view name,
+                  const std::string_view value,
+                  const Format format,
+                  const std::string_view separator,
+                  std::string &output)
+{
+    if (format == Format::Ndjson) {
+        output.append("{\"name\":").append(core::json::quote(name)).append(",\"value\":").append(core::json::quote(value)).append("}\n");
+        return;
+    }
+
+    // Values with several lines (e.g., "dev.cdrom.info") get one line each, so that every line can be grepped by name
+    for (std::size_t start = 0;;) {
+        const std::size_t end = std::min(value.find('\n', start), value.size());
+        output.append(name).append(separator).append(value.substr(start, end - start)).push_back('\n');
+        if (end >= value.size()) {
+            break;
+        }
+        start = end + 1;
+    }
+}
+
+/**
+ * @brief Append a file or directory name to a variable name, turning dots into slashes.
+ *
+ * @param component File or directory name (e.g., "eth0.100").
+ * @param name String to append to (e.g., "net.ipv4.conf." becomes "net.ipv4.conf.eth0/100").
+ */
+void append_component(const std::string_view component,
+                      std::string &name)
+{
+    for (const char c : component) {
+        name.push_back(c == '.' ? '/' : c);
+    }
+}
+
+/**
+ * @brief Struct that represents an entry of a directory.
+ */
+struct Entry final {
+    /**
+     * @brief File or directory name (e.g., "ostype").
+     */
+    std::string name;
+
+    /**
+     * @brief Whether the entry is a directory.
+     */
+    bool directory = false;
+};
+
+/**
+ * @brief Open a directory relative to another one, so that the kernel does not resolve the whole path again.
+ *
+ * @param parent_fd File descriptor of the parent directory, or AT_FDCWD for a path relative to the working directory.
+ * @param path Path to the directory, relative to the parent (e.g., "ipv4").
+ *
+ * @return Directory stream if succeeded, nullptr otherwise.
+ */
+[[nodiscard]] DIR *open_directory(const int parent_fd,
+                                  const char *path) noexcept
+{
+    const int fd = ::openat(parent_fd, path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        return nullptr;
+    }
+    DIR *directory = ::fdopendir(fd);
+    if (!directory) {
+        ::close(fd);
+    }
+    return directory;
+}
+
+/**
+ * @brief List the files and directories of a directory, sorted by name.
+ *
+ * @param directory Directory stream, which is left open.
+ *
+ * @return Entries.
+ */
+[[nodiscard]] std::vector<Entry> list_directory(DIR *directory)
+{
+    std::vector<Entry> entries;
+    while (const struct dirent *entry = ::readdir(directory)) {
+        const std::string_view name = entry->d_name;
+        if (name == "." || name == "..") {
+            continue;
+        }
+
+        // procfs and most file systems report the type, so only the others cost a stat() per entry
+        bool is_directory = entry->d_type == DT_DIR;
+        bool is_file = entry->d_type == DT_REG;
+        if (entry->d_type == DT_UNKNOWN) {
+            struct stat info;
+            if (::fstatat(::dirfd(directory), entry->d_name, &info, 0) == 0) {
+                is_directory = S_ISDIR(info.st_mode);
+                is_file = S_ISREG(info.st_mode);
+            }
+        }
+        if (is_directory || is_file) {
+            entries.push_back({std::string(name), is_directory});
+        }
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) {
+        return a.name < b.name;
+    });
+    return entries;
+}
+
+/**
+ * @brief List the files and directories of a directory, sorted by name.
+ *
+ * @param path Path to the directory (e.g., "/proc/sys/kernel").
+ *
+ * @return Entries if succeeded, empty otherwise.
+ */
+[[nodiscard]] std::vector<Entry> list_directory(const std::string &path)
+{
+    DIR *directory = open_directory(AT_FDCWD, path.c_str());
+    if (!directory) {
+        return {};
+    }
+    std::vector<Entry> entries = list_directory(directory);
+    ::closedir(directory);
+    return entries;
+}
+
+/**
+ * @brief Struct that represents a part of the tree that is walked by one thread, and its output.
+ */
+struct Unit final {
+    /**
+     * @brief Path to the file or directory (e.g., "/proc/sys/net/ipv4").
+     */
+    std::string path;
+
+    /**
+     * @brief Name of the file, or prefix of the variables in the directory including the trailing dot (e.g., "net.ipv4.").
+     */
+    std::string name;
+
+    /**
+     * @brief Whether the unit is a directory.
+     */
+    bool directory = false;
+
+    /**
+     * @brief Depth of the unit below the root (e.g., "2" for "net.ipv4.").
+     */
+    std::size_t depth = 0;
+
+    /**
+     * @brief Formatted variables of the unit, written once the unit is done.
+     */
+    std::string output;
+
+    /**
+     * @brief Number of variables in the output (e.g., "42").
+     */
+    std::size_t count = 0;
+};
+
+/**
+ * @brief Class that walks units, reading every value into the same buffer.
+ *
+ * @note This class is marked as `final` to prevent inheritance.
+ */
+class Walker final {
+  public:
+    /**
+     * @brief Construct a new Walker object.
+     *
+     * @param pattern Pattern the names must match.
+     * @param format Output format.
+     */
+    explicit Walker(const Pattern &pattern,
+                    const Format format)
+        : pattern_(pattern),
+          format_(format)
+    {
+    }
+
+    /**
+     * @brief Walk a unit and write its variables to its output.
+     *
+     * @param unit Unit to walk.
+     */
+    void walk(Unit &unit)
+    {
+        if (!unit.directory) {
+            this->read_variable(AT_FDCWD, unit.path.c_str(), unit.name, unit);
+        }
+        else if (DIR *directory = open_directory(AT_FDCWD, unit.path.c_str())) {
+            this->walk_directory(directory, unit.name, unit);
+        }
+    }
+
+  private:
+    /**
+     * @brief Walk a directory recursively, in name order, opening every entry relative to it.
+     *
+     * @param directory Directory stream, which is closed when done.
+     * @param prefix Prefix of the variables in the directory (e.g., "net.ipv4.").
+     * @param unit Unit to write to.
+     */
+    void walk_directory(DIR *directory,
+                        const std::string &prefix,
+                        Unit &unit)
+    {
+        const int fd = ::dirfd(directory);
+        std::string name = prefix;
+        for (const Entry &entry : list_directory(directory)) {
+            name.resize(prefix.size());
+            append_component(entry.name, name);
+            if (entry.directory) {
+                name.push_back('.');
+                if (!this->pattern_.may_match_below(name)) {
+                    continue;
+                }
+                if (DIR *child = open_directory(fd, entry.name.c_str())) {
+                    this->walk_directory(child, name, unit);
+                }
+            }
+            else if (this->pattern_.matches(name)) {
+                this->read_variable(fd, entry.name.c_str(), name, unit);
+            }
+        }
+        ::closedir(directory);
+    }
+
+    /**
+     * @brief Read a variable and append it to the output of a unit, unless it cannot be read.
+     *
+     * @param directory_fd File descriptor of the directory of the file, or AT_FDCWD.
+     * @param path Path to the file, relative to the directory (e.g., "ostype").
+     * @param name Name of the variable (e.g., "kernel.ostype").
+     * @param unit Unit to write to.
+     */
+    void read_variable(const int directory_fd,
+                       const char *path,
+                       const std::string_view name,
+                       Unit &unit)
+    {
+        const int fd = ::openat(directory_fd, path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return;
+        }
+        // Kernel variables are returned whole by the first read and end with a newline, which saves the read that would return 0
+        std::size_t size = 0;
+        ssize_t bytes_read = 0;
+        while (size < this->buffer_.size() && (bytes_read = ::read(fd, this->buffer_.data() + size, this->buffer_.size() - size)) > 0) {
+            size += static_cast<std::size_t>(bytes_read);
+            if (size < this->buffer_.size() && size > 0 && this->buffer_[size - 1] == '\n') {
+                break;
+            }
+        }
+        ::close(fd);
+
+        // Write-only files open but fail to read (e.g., "vm.drop_caches" as root), which is not a value
+        if (bytes_read < 0) {
+            return;
+        }
+        std::string_view value(this->buffer_.data(), size);
+        if (!value.empty() && value.back() == '\n') {
+            value.remove_suffix(1);
+        }
+        append_entry(name, value, this->format_, " = ", unit.output);
+        ++unit.count;
+    }
+
+    /**
+     * @brief Pattern the names must match.
+     */
+    const Pattern &pattern_;
+
+    /**
+     * @brief Output format.
+     */
+    const Format format_;
+
+    /**
+     * @brief Buffer that values are read into.
+     */
+    std::array<char, value_buffer_size> buffer_;
+};
+
+/**
+ * @brief Split a tree into units, in name order, by replacing directories with their entries until there are enough units.
+ *
+ * @param root Root of the tree (e.g., "/proc/sys").
+ * @param pattern Pattern the names must match, used to leave out whole subtrees.
+ * @param target Number of units to aim for (e.g., "64").
+ *
+ * @return Units, in name order.
+ */
+[[nodiscard]] std::vector<Unit> split_tree(const std::string &root,
+                                           const Pattern &pattern,
+                                           const std::size_t target)
+{
+    std::vector<Unit> units;
+    units.push_back({root, "", true, 0, {}, 0});
+    for (std::size_t depth = 0; depth < max_split_depth && units.size() < target; ++depth) {
+        std::vector<Unit> split;
+        for (Unit &unit : units) {
+            if (!unit.directory || unit.depth != depth) {
+                split.push_back(std::move(unit));
+                continue;
+            }
+            for (const Entry &entry : list_directory(unit.path)) {
+                std::string name = unit.name;
+                append_component(entry.name, name);
+                if (entry.directory) {
+                    name.push_back('.');
+                    if (!pattern.may_match_below(name)) {
+                        continue;
+                    }
+                }
+                else if (!pattern.matches(name)) {
+                    continue;
+                }
+                split.push_back({unit.path + '/' + entry.name, std::move(name), entry.directory, depth + 1, {}, 0});
+            }
+        }
+        units = std::move(split);
+    }
+    return units;
+}
+
+#if defined(__APPLE__)
+/**
+ * @brief Format the raw value of a sysctl variable as text, the way "sysctl" prints it.
+ *
+ * @param kind Kind of the variable (e.g., CTLTYPE_INT).
+ * @param format Format of the variable (e.g., "IU", "S,timeval").
+ * @param raw Raw bytes of the value.
+ * @param value String to replace with the formatted value.
+ *
+ * @return True if the value could be formatted, false otherwise (e.g., an opaque structure).
+ */
+[[nodiscard]] bool format_value(const unsigned int kind,
+                                const std::string_view format,
+                                const std::string &raw,
+                                std::string &value)
+{
+    value.clear();
+    const auto append_numbers = [&raw, &value](auto zero) {
+        using Number = decltype(zero);
+        for (std::size_t offset = 0; offset + sizeof(Number) <= raw.size(); offset += sizeof(Number)) {
+            Number number;
+            std::memcpy(&number, raw.data() + offset, sizeof(Number));
+            fmt::format_to(std::back_inserter(value), "{}{}", offset == 0 ? "" : " ", number);
+        }
+        return true;
+    };
+    const bool is_unsigned = format.size() > 1 && format[1] == 'U';
+    switch (kind & CTLTYPE) {
+    case CTLTYPE_STRING:
+        value.assign(raw.c_str(), std::strlen(raw.c_str()));
+        return true;
+    case CTLTYPE_INT:
+        if (!format.empty() && format[0] == 'L') {
+            return is_unsigned ? append_numbers(0UL) : append_numbers(0L);
+        }
+        return is_unsigned ? append_numbers(0U) : append_numbers(0);
+    case CTLTYPE_QUAD:
+        return is_unsigned ? append_numbers(std::uint64_t{0}) : append_numbers(std::int64_t{0});
+    default:
+        break;
+    }
+
+    // Of the structures, only the ones "sysctl" knows how to print are printed
+    if (format == "S,timeval" && raw.size() == sizeof(struct timeval)) {
+        struct timeval time;
+        std::memcpy(&time, raw.data(), sizeof(time));
+        fmt::format_to(std::back_inserter(value), "{{ sec = {}, usec = {} }}", time.tv_sec, time.tv_usec);
+        return true;
+    }
+    if (format == "S,loadavg") {
+        struct RawLoadavg {
+            std::uint32_t ldavg[3];
+            long fscale;
+        } load;
+        if (raw.size() != sizeof(load)) {
+            return false;
+        }
+        std::memcpy(&load, raw.data(), sizeof(load));
+        const double scale = load.fscale > 0 ? static_cast<double>(load.fscale) : 1.0;
+        fmt::format_to(std::back_inserter(value), "{{ {:.2f} {:.2f} {:.2f} }}", load.ldavg[0] / scale, load.ldavg[1] / scale, load.ldavg[2] / scale);
+        return true;
+    }
+    return false;
+}
+#endif
+
+}  // namespace
+
+Pattern::Pattern(const std::string_view text)
+    : has_star_(text.find('*') != std::string_view::npos),
+      leading_star_(!text.empty() && text.front() == '*'),
+      trailing_star_(!text.empty() && text.back() == '*')
+{
+    // Runs of stars are one star, so empty pieces are dropped
+    for (std::size_t start = 0; start <= text.size();) {
+        const std::size_t end = std::min(text.find('*', start), text.size());
+        if (end > start) {
+            this->pieces_.emplace_back(text.substr(start, end - start));
+        }
+        start = end + 1;
+    }
+}
+
+bool Pattern::matches(const std::string_view name) const noexcept
+{
+    if (this->pieces_.empty()) {
+        return true;
+    }
+
+    // Without a star, the pattern is a name or the root of a subtree
+    if (!this->has_star_) {
+        const std::string &piece = this->pieces_.front();
+        if (!piece_matches_at(name, 0, piece)) {
+            return false;
+        }
+        return name.size() == piece.size() || piece.back() == '.' || name[piece.size()] == '.';
+    }
+
+    // The first and last pieces are anchored unless a star is outside of them, the others match as early as possible
+    std::size_t first = 0;
+    std::size_t last = this->pieces_.size();
+    std::size_t position = 0;
+    std::size_t end = name.size();
+    if (!this->leading_star_) {
+        if (!piece_matches_at(name, 0, this->pieces_.front())) {
+            return false;
+        }
+        position = this->pieces_.front().size();
+        ++first;
+    }
+    if (!this->trailing_star_ && last > first) {
+        const std::string &piece = this->pieces_.back();
+        if (piece.size() > end - position || !piece_matches_at(name, end - piece.size(), piece)) {
+            return false;
+        }
+        end -= piece.size();
+        --last;
+    }
+    for (std::size_t i = first; i < last; ++i) {
+        const std::string &piece = this->pieces_[i];
+        bool found = false;
+        for (; position + piece.size() <= end; ++position) {
+            if (piece_matches_at(name, position, piece)) {
+                found = true;
+                position += piece.size();
+                break;
+            }
+        }
+        if (!found) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Pattern::may_match_below(const std::string_view prefix) const noexcept
+{
+    // Only the literal head of the pattern can rule a subtree out, since a star may match any rest
+    if (this->pieces_.empty() || this->leading_star_) {
+        return true;
+    }
+    const std::string &head = this->pieces_.front();
+    const std::size_t length = std::min(head.size(), prefix.size());
+    if (!piece_matches_at(prefix.substr(0, length), 0, std::string_view(head).substr(0, length))) {
+        return false;
+    }
+
+    // A pattern without a star names a subtree, so the prefix must not continue its last component (e.g., "vmx." for "vm")
+    return this->has_star_ || prefix.size() <= head.size() || head.back() == '.' || prefix[head.size()] == '.';
+}
+
+std::size_t dump_tree(const std::filesystem::path &root,
+                      const Pattern &pattern,
+                      const Format format,
+                      std::FILE *output,
+                      const std::size_t thread_count)
+{
+    const std::size_t hardware_threads = std::max(1U, std::thread::hardware_concurrency());
+    const std::size_t threads_to_use = thread_count == 0 ? hardware_threads : thread_count;
+    std::vector<Unit> units = split_tree(root.string(), pattern, threads_to_use * units_per_thread);
+
+    // Threads claim units in order, and this thread writes every unit as soon as it and the ones before it are done
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::size_t next_unit = 0;
+    std::vector<bool> done(units.size(), false);
+    const auto worker = [&]() {
+        Walker walker(pattern, format);
+        for (;;) {
+            std::size_t index = 0;
+            {
+                const std::lock_guard<std::mutex> lock(mutex);
+                if (next_unit == units.size()) {
+                    return;
+                }
+                index = next_unit++;
+            }
+            walker.walk(units[index]);
+            {
+                const std::lock_guard<std::mutex> lock(mutex);
+                done[index] = true;
+            }
+            condition.notify_one();
+        }
+    };
+    std::vector<std::thread> threads;
+    threads.reserve(std::min(threads_to_use, units.size()));
+    for (std::size_t t = 0; t < std::min(threads_to_use, units.size()); ++t) {
+        threads.emplace_back(worker);
+    }
+
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < units.size(); ++i) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [&done, i] {
+                return done[i];
+            });
+        }
+        std::fwrite(units[i].output.data(), 1, units[i].output.size(), output);
+        count += units[i].count;
+        std::string().swap(units[i].output);
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    std::fflush(output);
+    return count;
+}
+
+std::size_t dump(const Pattern &pattern,
+                 const Format format,
+                 std::FILE *output)
+{
+#if defined(__APPLE__)
+    // The MIB tree can only be walked one OID after the other, and reading it is much cheaper than printing it anyway
+    std::size_t count = 0;
+    core::sysctl::Oid oid;
+    std::array<char, 256> name;
+    std::array<char, 64> value_format;
+    std::string raw;
+    std::string value;
+    std::string line;
+    while (const auto next = core::sysctl::get_next_oid(oid)) {
+        oid = *next;
+        unsigned int kind = 0;
+        if (!core::sysctl::get_oid_name(oid, name.data(), name.size()) || !pattern.matches(name.data())) {
+            continue;
+        }
+        if (!core::sysctl::get_oid_format(oid, kind, value_format.data(), value_format.size()) || (kind & CTLTYPE) == CTLTYPE_NODE) {
+            continue;
+        }
+        if (!core::sysctl::get_raw_value(oid, raw) || !format_value(kind, value_format.data(), raw, value)) {
+            continue;
+        }
+        line.clear();
+        append_entry(name.data(), value, format, ": ", line);
+        std::fwrite(line.data(), 1, line.size(), output);
+        ++count;
+    }
+    std::fflush(output);
+    return count;
+#else
+    return dump_tree("/proc/sys", pattern, format, output);
+#endif
+}
+
+}  // namespace core::dump
@@ -0,0 +1,123 @@
+/**
+ * @file dump.hpp
+ *
+ * @brief Dump kernel variables (sysctl on macOS, /proc/sys on Linux) whose names match a pattern.
+ */
+
+#pragma once
+
+#include <cstddef>      // for std::size_t
+#include <cstdio>       // for std::FILE
+#include <filesystem>   // for std::filesystem::path
+#include <string>       // for std::string
+#include <string_view>  // for std::string_view
+#include <vector>       // for std::vector
+
+namespace core::dump {
+
+/**
+ * @brief Output format of a dump.
+ */
+enum class Format {
+    /**
+     * @brief One "NAME = VALUE" line per variable ("NAME: VALUE" on macOS), as printed by "sysctl -a".
+     */
+    Text,
+
+    /**
+     * @brief One JSON object per line (e.g., {"name":"kernel.ostype","value":"Linux"}).
+     */
+    Ndjson,
+};
+
+/**
+ * @brief Class that represents a pattern for variable names, compiled once before the traversal.
+ *
+ * A pattern is a glob, where "*" matches any run of characters (dots included) and "?" matches one character (e.g., "net.ipv4.*forward*"). A pattern without "*" also matches the variables below it (e.g., "vm" matches "vm.swappiness"), like "sysctl vm". An empty pattern matches everything.
+ *
+ * @note This class is marked as `final` to prevent inheritance.
+ */
+class Pattern final {
+  public:
+    /**
+     * @brief Construct a new Pattern object.
+     *
+     * @param text Pattern to compile (e.g., "kern.*version").
+     */
+    explicit Pattern(const std::string_view text);
+
+    /**
+     * @brief Check whether a variable name matches the pattern.
+     *
+     * @param name Name of the variable (e.g., "kern.osversion").
+     *
+     * @return True if the name matches, false otherwise.
+     */
+    [[nodiscard]] bool matches(const std::string_view name) const noexcept;
+
+    /**
+     * @brief Check whether any variable below a prefix could match the pattern, so that a subtree can be skipped without being read.
+     *
+     * @param prefix Prefix shared by all variables of the subtree, including the trailing dot (e.g., "net.ipv4.").
+     *
+     * @return False if no name that starts with the prefix can match, true otherwise.
+     */
+    [[nodiscard]] bool may_match_below(const std::string_view prefix) const noexcept;
+
+  private:
+    /**
+     * @brief Literal pieces between the stars, where "?" still matches any character (e.g., {"kern.", "version"} for "kern.*version").
+     */
+    std::vector<std::string> pieces_;
+
+    /**
+     * @brief Whether the pattern has at least one star, as opposed to a name or a subtree.
+     */
+    bool has_star_ = false;
+
+    /**
+     * @brief Whether the pattern starts with a star, so that the first piece may match anywhere.
+     */
+    bool leading_star_ = false;
+
+    /**
+     * @brief Whether the pattern ends with a star, so that the last piece may be followed by anything.
+     */
+    bool trailing_star_ = false;
+};
+
+/**
+ * @brief Dump the variables of a /proc/sys-like tree, walking its subtrees on several threads.
+ *
+ * Variables are named after their path with dots (e.g., "kernel/ostype" becomes "kernel.ostype", and a dot in a file name becomes a slash, like sysctl(8) on Linux). They are printed in name order, and each subtree is written as soon as it and the ones before it are done. Files that cannot be read (e.g., write-only ones) are skipped.
+ *
+ * @param root Root of the tree (e.g., "/proc/sys").
+ * @param pattern Pattern the names must match.
+ * @param format Output format.
+ * @param output File to write to (e.g., stdout).
+ * @param thread_count Number of threads to walk on, or 0 to use all hardware threads.
+ *
+ * @return Number of variables written.
+ */
+std::size_t dump_tree(const std::filesystem::path &root,
+                      const Pattern &pattern,
+                      const Format format,
+                      std::FILE *output,
+                      const std::size_t thread_count = 0);
+
+/**
+ * @brief Dump the kernel variables of this system.
+ *
+ * On macOS, the MIB tree is walked with "sysctl.next" queries; on Linux, /proc/sys is walked with dump_tree().
+ *
+ * @param pattern Pattern the names must match.
+ * @param format Output format.
+ * @param output File to write to (e.g., stdout).
+ *
+ * @return Number of variables written.
+ */
+std::size_t dump(const Pattern &pattern,
+                 const Format format,
+                 std::FILE *output);
+
+}  // namespace core::dump
@@ -0,0 +1,279 @@
+/**
+ * @file graphics.cpp
+ */
+
+#include <algorithm>    // for std::fill, std::max, std::min
+#include <cstddef>      // for std::size_t
+#include <cstdint>      // for std::uint8_t, std::uint32_t, std::uint64_t
+#include <cstring>      // for std::memset
+#include <iterator>     // for std::back_inserter
+#include <string>       // for std::string
+#include <string_view>  // for std::string_view
+#include <vector>       // for std::vector
+
+#include <fmt/core.h>
+
+#include "graphics.hpp"
+#include "png.hpp"
+
+namespace core::graphics {
+
+namespace {
+
+/**
+ * @brief Palette index of transparent pixels.
+ */
+constexpr std::uint8_t transparent = 255;
+
+/**
+ * @brief Number of levels per channel of the color cube.
+ */
+constexpr unsigned cube_levels = 6;
+
+/**
+ * @brief Largest number of base64 bytes per kitty escape, as required by the protocol.
+ */
+constexpr std::size_t kitty_chunk_size = 4096;
+
+/**
+ * @brief Append the base64 encoding of bytes.
+ *
+ * @param data Bytes to encode.
+ * @param size Number of bytes.
+ * @param output String to append to.
+ */
+void append_base64(const std::uint8_t *data,
+                   const std::size_t size,
+                   std::string &output)
+{
+    constexpr std::string_view alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::size_t i = 0;
+    for (; i + 3 <= size; i += 3) {
+        const std::uint32_t triple = (static_cast<std::uint32_t>(data[i]) << 16) | (static_cast<std::uint32_t>(data[i + 1]) << 8) | data[i + 2];
+        const char quad[] = {alphabet[triple >> 18], alphabet[(triple >> 12) & 63], alphabet[(triple >> 6) & 63], alphabet[triple & 63]};
+        output.append(quad, 4);
+    }
+    if (i < size) {
+        const std::uint32_t triple = (static_cast<std::uint32_t>(data[i]) << 16) | (i + 1 < size ? static_cast<std::uint32_t>(data[i + 1]) << 8 : 0);
+        output.push_back(alphabet[triple >> 18]);
+        output.push_back(alphabet[(triple >> 12) & 63]);
+        output.push_back(i + 1 < size ? alphabet[(triple >> 6) & 63] : '=');
+        output.push_back('=');
+    }
+}
+
+/**
+ * @brief Quantize every pixel to the color cube.
+ *
+ * The loop only uses shifts, multiplies and compares on contiguous bytes, so the compiler vectorizes it (e.g., with NEON structure loads).
+ *
+ * @param image Image to quantize.
+ *
+ * @return Palette index of every pixel, or "transparent".
+ */
+[[nodiscard]] std::vector<std::uint8_t> quantize(const core::png::Image &image)
+{
+    const std::size_t count = image.width * image.height;
+    std::vector<std::uint8_t> indices(count);
+    const std::uint8_t *pixels = image.pixels.data();
+    for (std::size_t i = 0; i < count; ++i) {
+        const unsigned r = (pixels[i * 4] * cube_levels) >> 8;
+        const unsigned g = (pixels[i * 4 + 1] * cube_levels) >> 8;
+        const unsigned b = (pixels[i * 4 + 2] * cube_levels) >> 8;
+        const auto index = static_cast<std::uint8_t>(r * cube_levels * cube_levels + g * cube_levels + b);
+        indices[i] = pixels[i * 4 + 3] < 128 ? transparent : index;
+    }
+    return indices;
+}
+
+/**
+ * @brief Append one run of identical sixels, using run-length encoding when it is shorter.
+ *
+ * @param sixel Sixel character (e.g., '~').
+ * @param count Number of repetitions (e.g., "12").
+ * @param output String to append to.
+ */
+void append_run(const char sixel,
+                const std::size_t count,
+                std::string &output)
+{
+    if (count > 3) {
+        fmt::format_to(std::back_inserter(output), "!{}{}", count, sixel);
+    }
+    else {
+        output.append(count, sixel);
+    }
+}
+
+}  // namespace
+
+core::png::Image downscale(const core::png::Image &image,
+                           const std::size_t width,
+                           const std::size_t height)
+{
+    core::png::Image result;
+    result.width = width;
+    result.height = height;
+    result.pixels.resize(width * height * 4);
+
+    // Alpha-weighted sums of the source rows covered by one output row
+    std::vector<std::uint32_t> sums(image.width * 4);
+    for (std::size_t oy = 0; oy < height; ++oy) {
+        const std::size_t y0 = oy * image.height / height;
+        const std::size_t y1 = std::max(y0 + 1, (oy + 1) * image.height / height);
+        std::fill(sums.begin(), sums.end(), 0);
+        for (std::size_t y = y0; y < y1; ++y) {
+            const std::uint8_t *row = image.pixels.data() + y * image.width * 4;
+            for (std::size_t i = 0; i < image.width * 4; i += 4) {
+                const std::uint32_t alpha = row[i + 3];
+                sums[i] += row[i] * alpha;
+                sums[i + 1] += row[i + 1] * alpha;
+                sums[i + 2] += row[i + 2] * alpha;
+                sums[i + 3] += alpha;
+            }
+        }
+
+        // Sum the columns covered by each output pixel
+        std::uint8_t *out = result.pixels.data() + oy * width * 4;
+        for (std::size_t ox = 0; ox < width; ++ox, out += 4) {
+            const std::size_t x0 = ox * image.width / width;
+            const std::size_t x1 = std::max(x0 + 1, (ox + 1) * image.width / width);
+            std::uint64_t r = 0;
+            std::uint64_t g = 0;
+            std::uint64_t b = 0;
+            std::uint64_t a = 0;
+            for (std::size_t x = x0; x < x1; ++x) {
+                r += sums[x * 4];
+                g += sums[x * 4 + 1];
+                b += sums[x * 4 + 2];
+                a += sums[x * 4 + 3];
+            }
+            const std::uint64_t count = (x1 - x0) * (y1 - y0);
+            if (a == 0) {
+                out[0] = out[1] = out[2] = out[3] = 0;
+                continue;
+            }
+            out[0] = static_cast<std::uint8_t>((r + a / 2) / a);
+            out[1] = static_cast<std::uint8_t>((g + a / 2) / a);
+            out[2] = static_cast<std::uint8_t>((b + a / 2) / a);
+            out[3] = static_cast<std::uint8_t>((a + count / 2) / count);
+        }
+    }
+    return result;
+}
+
+std::string encode_kitty(const core::png::Image &image,
+                         const std::size_t columns,
+                         const std::size_t rows)
+{
+    std::string payload;
+    payload.reserve((image.pixels.size() + 2) / 3 * 4);
+    append_base64(image.pixels.data(), image.pixels.size(), payload);
+
+    // The payload is split into chunks; only the first one carries the control data, "m" tells whether more follow
+    std::string output;
+    output.reserve(payload.size() + (payload.size() / kitty_chunk_size + 1) * 16 + 64);
+    const bool chunked = payload.size() > kitty_chunk_size;
+    for (std::size_t offset = 0; offset < payload.size() || offset == 0; offset += kitty_chunk_size) {
+        const bool more = offset + kitty_chunk_size < payload.size();
+        output.append("\033_G");
+        if (offset == 0) {
+            fmt::format_to(std::back_inserter(output), "a=T,f=32,s={},v={},c={},r={},q=2", image.width, image.height, columns, rows);
+            if (chunked) {
+                output.append(",m=1");
+            }
+        }
+        else {
+            output.append(more ? "m=1" : "m=0");
+        }
+        output.push_back(';');
+        output.append(payload, offset, kitty_chunk_size);
+        output.append("\033\\");
+    }
+    return output;
+}
+
+std::string encode_sixel(const core::png::Image &image)
+{
+    const std::size_t width = image.width;
+    const std::size_t height = image.height;
+    const std::vector<std::uint8_t> indices = quantize(image);
+    constexpr std::size_t palette_size = cube_levels * cube_levels * cube_levels;
+
+    // "P2=1" keeps transparent pixels untouched, the raster attributes give the size in pixels
+    std::string output;
+    output.reserve(width * height / 2 + 4096);
+    fmt::format_to(std::back_inserter(output), "\033P0;1;0q\"1;1;{};{}", width, height);
+
+    // Define only the colors that are used, each channel as a percentage
+    std::vector<bool> used(palette_size, false);
+    for (const std::uint8_t index : indices) {
+        if (index != transparent) {
+            used[index] = true;
+        }
+    }
+    for (std::size_t i = 0; i < palette_size; ++i) {
+        if (used[i]) {
+            const std::size_t r = i / (cube_levels * cube_levels);
+            const std::size_t g = i / cube_levels % cube_levels;
+            const std::size_t b = i % cube_levels;
+            fmt::format_to(std::back_inserter(output), "#{};2;{};{};{}", i, r * 20, g * 20, b * 20);
+        }
+    }
+
+    // Each band is six pixel rows; every color used in the band is drawn as one pass over it
+    std::vector<std::uint8_t> bits(palette_size * width, 0);
+    std::vector<std::uint8_t> band_colors;
+    band_colors.reserve(palette_size);
+    std::vector<bool> in_band(palette_size, false);
+    for (std::size_t band = 0; band < height; band += 6) {
+        const std::size_t band_height = std::min<std::size_t>(6, height - band);
+        for (std::size_t r = 0; r < band_height; ++r) {
+            const std::uint8_t *row = indices.data() + (band + r) * width;
+            for (std::size_t x = 0; x < width; ++x) {
+                const std::uint8_t index = row[x];
+                if (index == transparent) {
+                    continue;
+                }
+                if (!in_band[index]) {
+                    in_band[index] = true;
+                    band_colors.push_back(index);
+                }
+                bits[index * width + x] = static_cast<std::uint8_t>(bits[index * width + x] | (1U << r));
+            }
+        }
+
+        for (std::size_t c = 0; c < band_colors.size(); ++c) {
+            const std::uint8_t index = band_colors[c];
+            std::uint8_t *color_bits = bits.data() + index * width;
+            if (c != 0) {
+                output.push_back('$');
+            }
+            fmt::format_to(std::back_inserter(output), "#{}", index);
+
+            // Trailing empty sixels are not needed
+            std::size_t end = width;
+            while (end > 0 && color_bits[end - 1] == 0) {
+                --end;
+            }
+            for (std::size_t x = 0; x < end;) {
+                std::size_t run = 1;
+                while (x + run < end && color_bits[x + run] == color_bits[x]) {
+                    ++run;
+                }
+                append_run(static_cast<char>('?' + color_bits[x]), run, output);
+                x += run;
+            }
+            std::memset(color_bits, 0, width);
+            in_band[index] = false;
+        }
+        band_colors.clear();
+        if (band + 6 < height) {
+            output.push_back('-');
+        }
+    }
+    output.append("\033\\");
+    return output;
+}
+
+}  // namespace core::graphics
@@ -0,0 +1,55 @@
+/**
+ * @file graphics.hpp
+ *
+ * @brief Scale images and encode them for terminal graphics protocols.
+ */
+
+#pragma once
+
+#include <cstddef>  // for std::size_t
+#include <string>   // for std::string
+
+#include "png.hpp"
+
+namespace core::graphics {
+
+/**
+ * @brief Downscale an image with an alpha-weighted box filter.
+ *
+ * Each output pixel is the average of the source pixels it covers, weighted by their alpha, so that transparent pixels do not darken the edges.
+ *
+ * @param image Source image.
+ * @param width Target width in pixels, at most the source width (e.g., "256").
+ * @param height Target height in pixels, at most the source height (e.g., "256").
+ *
+ * @return Downscaled image.
+ */
+[[nodiscard]] core::png::Image downscale(const core::png::Image &image,
+                                         const std::size_t width,
+                                         const std::size_t height);
+
+/**
+ * @brief Encode an image with the kitty graphics protocol, as raw RGBA pixels.
+ *
+ * @param image Image to encode.
+ * @param columns Number of terminal columns the image is scaled to (e.g., "32").
+ * @param rows Number of terminal rows the image is scaled to (e.g., "14").
+ *
+ * @return Escape sequences that display the image at the cursor.
+ */
+[[nodiscard]] std::string encode_kitty(const core::png::Image &image,
+                                       const std::size_t columns,
+                                       const std::size_t rows);
+
+/**
+ * @brief Encode an image as sixel graphics.
+ *
+ * Pixels are quantized to a 6x6x6 color cube; pixels with less than 50% alpha are left transparent.
+ *
+ * @param image Image to encode.
+ *
+ * @return Escape sequence that displays the image at the cursor.
+ */
+[[nodiscard]] std::string encode_sixel(const core::png::Image &image);
+
+}  // namespace core::graphics
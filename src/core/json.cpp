@@ -0,0 +1,312 @@
+/**
+ * @file json.cpp
+ */
+
+#include <array>        // for std::array
+#include <cstddef>      // for std::size_t
+#include <cstdint>      // for std::uint32_t, std::uint64_t
+#include <string>       // for std::string
+#include <string_view>  // for std::string_view
+
+#include "json.hpp"
+
+namespace core::json {
+
+namespace {
+
+/**
+ * @brief Check whether a character is JSON whitespace.
+ *
+ * @param c Character to check (e.g., ' ').
+ *
+ * @return True if the character is whitespace, false otherwise.
+ */
+[[nodiscard]] constexpr bool is_whitespace(const char c) noexcept
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+/**
+ * @brief Parse four hexadecimal digits.
+ *
+ * @param text Text that starts with four hexadecimal digits (e.g., "00e9").
+ * @param value Parsed value (e.g., "0xe9").
+ *
+ * @return True if succeeded, false otherwise.
+ */
+[[nodiscard]] bool parse_hex4(const std::string_view text,
+                              std::uint32_t &value) noexcept
+{
+    if (text.size() < 4) {
+        return false;
+    }
+    value = 0;
+    for (std::size_t i = 0; i < 4; ++i) {
+        const char c = text[i];
+        std::uint32_t digit = 0;
+        if (c >= '0' && c <= '9') {
+            digit = static_cast<std::uint32_t>(c - '0');
+        }
+        else if (c >= 'a' && c <= 'f') {
+            digit = static_cast<std::uint32_t>(c - 'a' + 10);
+        }
+        else if (c >= 'A' && c <= 'F') {
+            digit = static_cast<std::uint32_t>(c - 'A' + 10);
+        }
+        else {
+            return false;
+        }
+        value = (value << 4) | digit;
+    }
+    return true;
+}
+
+/**
+ * @brief Append a Unicode code point as UTF-8.
+ *
+ * @param code_point Code point to append (e.g., "0xe9").
+ * @param output String to append to.
+ */
+void append_utf8(const std::uint32_t code_point,
+                 std::string &output)
+{
+    if (code_point < 0x80) {
+        output += static_cast<char>(code_point);
+    }
+    else if (code_point < 0x800) {
+        output += static_cast<char>(0xC0 | (code_point >> 6));
+        output += static_cast<char>(0x80 | (code_point & 0x3F));
+    }
+    else if (code_point < 0x10000) {
+        output += static_cast<char>(0xE0 | (code_point >> 12));
+        output += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        output += static_cast<char>(0x80 | (code_point & 0x3F));
+    }
+    else {
+        output += static_cast<char>(0xF0 | (code_point >> 18));
+        output += static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+        output += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        output += static_cast<char>(0x80 | (code_point & 0x3F));
+    }
+}
+
+/**
+ * @brief Struct that represents how a byte is written inside a JSON string.
+ */
+struct Escape final {
+    /**
+     * @brief Escape sequence (e.g., "\\u001b").
+     */
+    std::array<char, 6> text;
+
+    /**
+     * @brief Length of the escape sequence, 0 if the byte is copied as is.
+     */
+    std::size_t length;
+};
+
+/**
+ * @brief Escape sequence of every byte, computed at compile time so that quoting only looks bytes up.
+ *
+ * Quotes, backslashes and control characters are escaped; every other byte, including UTF-8 sequences, is copied as is.
+ */
+constexpr std::array<Escape, 256> escapes = []() {
+    std::array<Escape, 256> table{};
+    constexpr std::string_view digits = "0123456789abcdef";
+    for (std::size_t c = 0; c < 0x20; ++c) {
+        table[c] = {{'\\', 'u', '0', '0', digits[c >> 4], digits[c & 0xF]}, 6};
+    }
+    table['"'] = {{'\\', '"'}, 2};
+    table['\\'] = {{'\\', '\\'}, 2};
+    table['\n'] = {{'\\', 'n'}, 2};
+    table['\r'] = {{'\\', 'r'}, 2};
+    table['\t'] = {{'\\', 't'}, 2};
+    return table;
+}();
+
+}  // namespace
+
+Scanner::Scanner(const std::string_view input) noexcept
+    : input_(input)
+{
+}
+
+Token Scanner::next() noexcept
+{
+    while (this->position_ < this->input_.size()) {
+        const char c = this->input_[this->position_];
+
+        // Separators only change whether the next string is a key
+        if (is_whitespace(c) || c == ':') {
+            ++this->position_;
+            continue;
+        }
+        if (c == ',') {
+            ++this->position_;
+            this->expect_key_ = this->depth_ > 0 && ((this->object_bits_ >> (this->depth_ - 1)) & 1U) != 0;
+            continue;
+        }
+
+        // Containers
+        if (c == '{' || c == '[') {
+            if (this->depth_ >= max_depth) {
+                return {TokenType::Error, this->input_.substr(this->position_, 1)};
+            }
+            const bool is_object = (c == '{');
+            const std::uint64_t bit = std::uint64_t{1} << this->depth_;
+            this->object_bits_ = is_object ? (this->object_bits_ | bit) : (this->object_bits_ & ~bit);
+            ++this->depth_;
+            this->expect_key_ = is_object;
+            return {is_object ? TokenType::ObjectBegin : TokenType::ArrayBegin, this->input_.substr(this->position_++, 1)};
+        }
+        if (c == '}' || c == ']') {
+            if (this->depth_ == 0) {
+                return {TokenType::Error, this->input_.substr(this->position_, 1)};
+            }
+            --this->depth_;
+            this->expect_key_ = false;
+            return {c == '}' ? TokenType::ObjectEnd : TokenType::ArrayEnd, this->input_.substr(this->position_++, 1)};
+        }
+
+        // Strings, keeping escape sequences as they are
+        if (c == '"') {
+            const std::size_t begin = ++this->position_;
+            while (this->position_ < this->input_.size() && this->input_[this->position_] != '"') {
+                this->position_ += (this->input_[this->position_] == '\\') ? 2U : 1U;
+            }
+            if (this->position_ >= this->input_.size()) {
+                return {TokenType::Error, this->input_.substr(begin - 1)};
+            }
+            const std::string_view text = this->input_.substr(begin, this->position_++ - begin);
+            if (this->expect_key_) {
+                this->expect_key_ = false;
+                return {TokenType::Key, text};
+            }
+            return {TokenType::String, text};
+        }
+
+        // Numbers and literals
+        const std::size_t begin = this->position_;
+        while (this->position_ < this->input_.size()) {
+            const char d = this->input_[this->position_];
+            if (is_whitespace(d) || d == ',' || d == ':' || d == '}' || d == ']') {
+                break;
+            }
+            ++this->position_;
+        }
+        const std::string_view text = this->input_.substr(begin, this->position_ - begin);
+        if (text == "true") {
+            return {TokenType::True, text};
+        }
+        if (text == "false") {
+            return {TokenType::False, text};
+        }
+        if (text == "null") {
+            return {TokenType::Null, text};
+        }
+        if (c == '-' || (c >= '0' && c <= '9')) {
+            return {TokenType::Number, text};
+        }
+        return {TokenType::Error, text};
+    }
+    return {TokenType::End, {}};
+}
+
+bool Scanner::skip_value() noexcept
+{
+    const Token token = this->next();
+    if (token.type == TokenType::Error || token.type == TokenType::End) {
+        return false;
+    }
+    if (token.type != TokenType::ObjectBegin && token.type != TokenType::ArrayBegin) {
+        return true;
+    }
+    // Consume tokens until the container opened above is closed again
+    const std::size_t target_depth = this->depth_ - 1;
+    while (this->depth_ > target_depth) {
+        const TokenType type = this->next().type;
+        if (type == TokenType::Error || type == TokenType::End) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::size_t Scanner::depth() const noexcept
+{
+    return this->depth_;
+}
+
+std::string unescape(const std::string_view raw)
+{
+    std::string output;
+    output.reserve(raw.size());
+    for (std::size_t i = 0; i < raw.size(); ++i) {
+        if (raw[i] != '\\' || i + 1 >= raw.size()) {
+            output += raw[i];
+            continue;
+        }
+        const char escaped = raw[++i];
+        switch (escaped) {
+        case 'b':
+            output += '\b';
+            break;
+        case 'f':
+            output += '\f';
+            break;
+        case 'n':
+            output += '\n';
+            break;
+        case 'r':
+            output += '\r';
+            break;
+        case 't':
+            output += '\t';
+            break;
+        case 'u': {
+            std::uint32_t code_point = 0;
+            if (!parse_hex4(raw.substr(i + 1), code_point)) {
+                output += "\\u";
+                break;
+            }
+            i += 4;
+            // Combine UTF-16 surrogate pairs (e.g., "🍎")
+            std::uint32_t low = 0;
+            if (code_point >= 0xD800 && code_point <= 0xDBFF && raw.substr(i + 1, 2) == "\\u" && parse_hex4(raw.substr(i + 3), low) &&
+                low >= 0xDC00 && low <= 0xDFFF) {
+                code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+                i += 6;
+            }
+            append_utf8(code_point, output);
+            break;
+        }
+        default:
+            // Covers '"', '\\' and '/', which decode to themselves
+            output += escaped;
+            break;
+        }
+    }
+    return output;
+}
+
+std::string quote(const std::string_view text)
+{
+    // Runs of bytes that need no escaping are appended at once
+    std::string output;
+    output.reserve(text.size() + 2);
+    output += '"';
+    std::size_t run_start = 0;
+    for (std::size_t i = 0; i < text.size(); ++i) {
+        const Escape &escape = escapes[static_cast<unsigned char>(text[i])];
+        if (escape.length == 0) {
+            continue;
+        }
+        output.append(text, run_start, i - run_start).append(escape.text.data(), escape.length);
+        run_start = i + 1;
+    }
+    output.append(text, run_start, text.size() - run_start);
+    output += '"';
+    return output;
+}
+
+}  // namespace core::json
@@ -0,0 +1,140 @@
+/**
+ * @file json.hpp
+ *
+ * @brief Scan JSON documents without building a tree, and quote strings for writing them.
+ */
+
+#pragma once
+
+#include <cstddef>      // for std::size_t
+#include <cstdint>      // for std::uint64_t
+#include <string>       // for std::string
+#include <string_view>  // for std::string_view
+
+namespace core::json {
+
+/**
+ * @brief Type of a token produced by the scanner.
+ */
+enum class TokenType {
+    ObjectBegin,
+    ObjectEnd,
+    ArrayBegin,
+    ArrayEnd,
+    Key,
+    String,
+    Number,
+    True,
+    False,
+    Null,
+    End,
+    Error,
+};
+
+/**
+ * @brief Struct that represents a single token.
+ */
+struct Token final {
+    /**
+     * @brief Type of the token (e.g., "TokenType::Key").
+     */
+    TokenType type = TokenType::End;
+
+    /**
+     * @brief Raw text of the token, pointing into the scanned document (e.g., "full_name" for a key).
+     *
+     * @note For keys and strings, the quotes are removed, but escape sequences are not decoded (see unescape()).
+     */
+    std::string_view text;
+};
+
+/**
+ * @brief Class that scans a JSON document token by token.
+ *
+ * The scanner never allocates; tokens are views into the input, which must outlive the scanner. It is lenient: it does not validate the full grammar, only enough to tell keys from values and to track nesting.
+ *
+ * @note This class is marked as `final` to prevent inheritance.
+ */
+class Scanner final {
+  public:
+    /**
+     * @brief Construct a new Scanner object.
+     *
+     * @param input JSON document to scan (e.g., "{\"installed_on_request\":true}").
+     */
+    explicit Scanner(const std::string_view input) noexcept;
+
+    /**
+     * @brief Read the next token.
+     *
+     * @return Next token. TokenType::End is returned at the end of the input, TokenType::Error on malformed input or excessive nesting.
+     */
+    [[nodiscard]] Token next() noexcept;
+
+    /**
+     * @brief Skip the next value, including all nested values if it is an object or array.
+     *
+     * This is typically called after reading a key whose value is not needed.
+     *
+     * @return True if succeeded, false on malformed input.
+     */
+    bool skip_value() noexcept;
+
+    /**
+     * @brief Get the current nesting depth.
+     *
+     * @return Number of open objects and arrays (e.g., "1" inside the top-level object).
+     */
+    [[nodiscard]] std::size_t depth() const noexcept;
+
+  private:
+    /**
+     * @brief Maximum supported nesting depth.
+     */
+    static constexpr std::size_t max_depth = 64;
+
+    /**
+     * @brief Document being scanned.
+     */
+    std::string_view input_;
+
+    /**
+     * @brief Offset of the next unread character.
+     */
+    std::size_t position_ = 0;
+
+    /**
+     * @brief Number of open objects and arrays.
+     */
+    std::size_t depth_ = 0;
+
+    /**
+     * @brief Bit N is set if the container at depth N+1 is an object.
+     */
+    std::uint64_t object_bits_ = 0;
+
+    /**
+     * @brief Whether the next string in the current object is a key.
+     */
+    bool expect_key_ = false;
+};
+
+/**
+ * @brief Decode the escape sequences of a raw string token.
+ *
+ * @param raw Raw string token text (e.g., "caf\\u00e9").
+ *
+ * @return Decoded UTF-8 string (e.g., "café"). Invalid escape sequences are kept verbatim.
+ */
+[[nodiscard]] std::string unescape(const std::string_view raw);
+
+/**
+ * @brief Quote a string for a JSON document, escaping quotes, backslashes and control characters.
+ *
+ * @param text UTF-8 string (e.g., "Apple \"M1\"").
+ *
+ * @return JSON string, including the quotes (e.g., "\"Apple \\\"M1\\\"\"").
+ */
+[[nodiscard]] std::string quote(const std::string_view text);
+
+}  // namespace core::json
@@ -0,0 +1,150 @@
+/**
+ * @file layout.cpp
+ */
+
+#include <algorithm>    // for std::max
+#include <cstddef>      // for std::size_t
+#include <string>       // for std::string
+#include <string_view>  // for std::string_view
+#include <vector>       // for std::vector
+
+#include "art.hpp"
+#include "layout.hpp"
+#include "text.hpp"
+
+namespace core::layout {
+
+namespace {
+
+/**
+ * @brief Escape that starts a title (bold yellow).
+ */
+constexpr std::string_view title_style = "\033[1m\033[33m";
+
+/**
+ * @brief Escape that starts a value (white).
+ */
+constexpr std::string_view value_style = "\033[37m";
+
+/**
+ * @brief Get the number of bytes a field takes once rendered, without the newline.
+ *
+ * @param field Field to measure.
+ * @param color_enabled Whether to use colors.
+ *
+ * @return Number of bytes.
+ */
+[[nodiscard]] std::size_t get_field_size(const Field &field,
+                                         const bool color_enabled) noexcept
+{
+    std::size_t size = field.title.size() + 2 + field.value.size();
+    if (color_enabled) {
+        size += title_style.size() + value_style.size() + 2 * core::art::reset.size();
+    }
+    return size;
+}
+
+/**
+ * @brief Append a field as "Title: Value", with or without colors.
+ *
+ * @param field Field to append.
+ * @param color_enabled Whether to use colors.
+ * @param output String to append to.
+ */
+void append_field(const Field &field,
+                  const bool color_enabled,
+                  std::string &output)
+{
+    if (color_enabled) {
+        output.append(title_style).append(field.title).append(": ").append(core::art::reset);
+        output.append(value_style).append(field.value).append(core::art::reset);
+    }
+    else {
+        output.append(field.title).append(": ").append(field.value);
+    }
+}
+
+}  // namespace
+
+std::string render(const core::art::View &logo,
+                   const std::vector<Field> &fields,
+                   const bool color_enabled)
+{
+    std::string output;
+    render(logo, fields, color_enabled, output);
+    return output;
+}
+
+void render(const core::art::View &logo,
+            const std::vector<Field> &fields,
+            const bool color_enabled,
+            std::string &output)
+{
+    const std::size_t row_count = std::max(logo.row_count, fields.size());
+    const std::size_t column = logo.width + gap;
+
+    // Compute the exact size, so that the output is allocated once
+    std::size_t size = (color_enabled ? logo.colored.size() : logo.plain.size()) + row_count * (column + 1);
+    for (const Field &field : fields) {
+        size += get_field_size(field, color_enabled);
+    }
+    output.clear();
+    output.reserve(size);
+
+    for (std::size_t i = 0; i < row_count; ++i) {
+        const bool has_field = i < fields.size();
+        if (i < logo.row_count) {
+            output.append(logo.get_row(i, color_enabled));
+            if (has_field) {
+                output.append(column - logo.rows[i].width, ' ');
+            }
+        }
+        else if (has_field) {
+            output.append(column, ' ');
+        }
+        if (has_field) {
+            append_field(fields[i], color_enabled, output);
+        }
+        output.push_back('\n');
+    }
+}
+
+std::string render_image(const std::string &image,
+                         const std::size_t columns,
+                         const std::size_t rows,
+                         const std::vector<Field> &fields,
+                         const bool color_enabled)
+{
+    const std::size_t row_count = std::max(rows, fields.size());
+    std::string move_right = "\033[";
+    core::text::append_unsigned(columns + gap, move_right);
+    move_right.push_back('C');
+
+    std::size_t size = image.size() + row_count * (move_right.size() + 1) + 32;
+    for (const Field &field : fields) {
+        size += get_field_size(field, color_enabled);
+    }
+    std::string output;
+    output.reserve(size);
+
+    // Scroll first, so that the image is not cut off at the bottom of the screen, then draw it and restore the cursor to its top-left corner
+    if (row_count > 0) {
+        output.append(row_count, '\n');
+        output.append("\033[");
+        core::text::append_unsigned(row_count, output);
+        output.push_back('A');
+    }
+    output.append("\0337").append(image).append("\0338");
+
+    // Fields are printed to the right of the image by moving the cursor, as the image is not made of characters
+    for (std::size_t i = 0; i < row_count; ++i) {
+        if (i < fields.size()) {
+            output.append(move_right);
+            append_field(fields[i], color_enabled, output);
+        }
+        output.push_back('\n');
+    }
+    return output;
+}
+
+}  // namespace core::layout
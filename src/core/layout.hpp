@@ -0,0 +1,86 @@
+/**
+ * @file layout.hpp
+ *
+ * @brief Lay out the logo and the fields side by side.
+ */
+
+#pragma once
+
+#include <cstddef>  // for std::size_t
+#include <string>   // for std::string
+#include <vector>   // for std::vector
+
+#include "art.hpp"
+
+namespace core::layout {
+
+/**
+ * @brief Number of spaces between the logo and the fields.
+ */
+inline constexpr std::size_t gap = 3;
+
+/**
+ * @brief Struct that represents a single field.
+ */
+struct Field final {
+    /**
+     * @brief Title of the field (e.g., "CPU").
+     */
+    std::string title;
+
+    /**
+     * @brief Value of the field (e.g., "Apple M1 Pro").
+     */
+    std::string value;
+};
+
+/**
+ * @brief Render the logo and the fields side by side.
+ *
+ * The output is sized once up front, then every logo row, padding and field is appended in place, so no allocation happens per line. Rows are padded using the visible widths computed at compile time, never by measuring the escaped bytes.
+ *
+ * @param logo Logo to print on the left.
+ * @param fields Fields to print on the right, one per row.
+ * @param color_enabled Whether to use colors (false if NO_COLOR is set).
+ *
+ * @return Rendered output, with a newline after every row.
+ */
+[[nodiscard]] std::string render(const core::art::View &logo,
+                                 const std::vector<Field> &fields,
+                                 const bool color_enabled);
+
+/**
+ * @brief Render the logo and the fields side by side into an existing string, reusing its capacity.
+ *
+ * Used to redraw the same fetch repeatedly without allocating once the string has grown to its final size.
+ *
+ * @param logo Logo to print on the left.
+ * @param fields Fields to print on the right, one per row.
+ * @param color_enabled Whether to use colors (false if NO_COLOR is set).
+ * @param output String to replace with the rendered output.
+ */
+void render(const core::art::View &logo,
+            const std::vector<Field> &fields,
+            const bool color_enabled,
+            std::string &output);
+
+/**
+ * @brief Render an image and the fields side by side.
+ *
+ * The image is drawn first with the cursor saved and restored around it, then every field is printed after moving the cursor past the image's columns.
+ *
+ * @param image Escape sequences that display the image at the cursor.
+ * @param columns Number of terminal columns the image occupies (e.g., "32").
+ * @param rows Number of terminal rows the image occupies (e.g., "14").
+ * @param fields Fields to print on the right, one per row.
+ * @param color_enabled Whether to use colors (false if NO_COLOR is set).
+ *
+ * @return Rendered output, with a newline after every row.
+ */
+[[nodiscard]] std::string render_image(const std::string &image,
+                                       const std::size_t columns,
+                                       const std::size_t rows,
+                                       const std::vector<Field> &fields,
+                                       const bool color_enabled);
+
+}  // namespace core::layout
@@ -0,0 +1,245 @@
+/**
+ * @file perfect_hash.hpp
+ *
+ * @brief Compile-time minimal perfect hash map for string keys.
+ */
+
+#pragma once
+
+#include <array>        // for std::array
+#include <cstddef>      // for std::size_t
+#include <cstdint>      // for std::uint32_t
+#include <optional>     // for std::optional, std::nullopt
+#include <stdexcept>    // for std::logic_error
+#include <string_view>  // for std::string_view
+
+namespace core::perfect_hash {
+
+/**
+ * @brief Struct that represents a single key-value pair.
+ */
+struct Entry final {
+    /**
+     * @brief Key (e.g., "MacBookPro18,3").
+     */
+    std::string_view key;
+
+    /**
+     * @brief Value (e.g., "MacBook Pro (14-inch, 2021)").
+     */
+    std::string_view value;
+};
+
+/**
+ * @brief Hash a key with a seed, using FNV-1a followed by the MurmurHash3 finalizer so that different seeds give independent results.
+ *
+ * @param key Key to hash (e.g., "MacBookPro18,3").
+ * @param seed Seed (e.g., "0").
+ *
+ * @return 32-bit hash.
+ */
+[[nodiscard]] constexpr std::uint32_t hash(const std::string_view key,
+                                           const std::uint32_t seed) noexcept
+{
+    std::uint32_t h = 2166136261U ^ (seed * 0x9e3779b9U);
+    for (const char c : key) {
+        h = (h ^ static_cast<unsigned char>(c)) * 16777619U;
+    }
+    h ^= h >> 16;
+    h *= 0x85ebca6bU;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35U;
+    h ^= h >> 16;
+    return h;
+}
+
+/**
+ * @brief Minimal perfect hash map, built entirely at compile time with "hash and displace".
+ *
+ * Keys are first split into buckets by hash(key, 0). Then, starting with the largest bucket, a seed is searched for each bucket that sends all of its keys to free slots. A lookup is therefore two hashes, two array reads and one key comparison, with no heap use and no static initialization at runtime.
+ *
+ * @tparam N Number of entries (e.g., "89").
+ */
+template <std::size_t N>
+class Map final {
+    static_assert(N > 0, "Map requires at least one entry");
+
+  public:
+    /**
+     * @brief Build the map. Meant to be used in a constexpr context, where duplicate keys fail the build.
+     *
+     * @param entries Entries, in any order.
+     */
+    constexpr explicit Map(const Entry (&entries)[N])
+    {
+        // Group the entries by bucket with a counting sort
+        std::array<std::size_t, bucket_count + 1> bucket_start{};
+        for (const Entry &entry : entries) {
+            ++bucket_start[get_bucket(entry.key) + 1];
+        }
+        std::size_t largest_bucket = 0;
+        for (std::size_t b = 0; b < bucket_count; ++b) {
+            largest_bucket = bucket_start[b + 1] > largest_bucket ? bucket_start[b + 1] : largest_bucket;
+            bucket_start[b + 1] += bucket_start[b];
+        }
+        std::array<std::size_t, N> order{};
+        std::array<std::size_t, bucket_count> filled{};
+        for (std::size_t i = 0; i < N; ++i) {
+            const std::size_t b = get_bucket(entries[i].key);
+            order[bucket_start[b] + filled[b]++] = i;
+        }
+
+        // Place the buckets from the largest to the smallest, while the table is still mostly empty
+        std::array<bool, N> taken{};
+        for (std::size_t size = largest_bucket; size > 0; --size) {
+            for (std::size_t b = 0; b < bucket_count; ++b) {
+                const std::size_t first = bucket_start[b];
+                if (bucket_start[b + 1] - first != size) {
+                    continue;
+                }
+                for (std::uint32_t seed = 1;; ++seed) {
+                    if (seed > max_seed) {
+                        throw std::logic_error("Map failed to find a seed; are there duplicate keys?");
+                    }
+                    if (fits(entries, order, first, size, seed, taken)) {
+                        for (std::size_t k = first; k < first + size; ++k) {
+                            const std::size_t slot = get_slot(entries[order[k]].key, seed);
+                            taken[slot] = true;
+                            this->slots_[slot] = entries[order[k]];
+                        }
+                        this->seeds_[b] = seed;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Find the value of a key.
+     *
+     * @param key Key to find (e.g., "MacBookPro18,3").
+     *
+     * @return Value (e.g., "MacBook Pro (14-inch, 2021)") if found, std::nullopt otherwise.
+     */
+    [[nodiscard]] constexpr std::optional<std::string_view> find(const std::string_view key) const noexcept
+    {
+        const Entry &entry = this->slots_[get_slot(key, this->seeds_[get_bucket(key)])];
+        if (entry.key != key) {
+            return std::nullopt;
+        }
+        return entry.value;
+    }
+
+    /**
+     * @brief Get a pointer to the first entry, in slot order.
+     *
+     * @return Pointer to the first entry.
+     */
+    [[nodiscard]] constexpr const Entry *begin() const noexcept
+    {
+        return this->slots_.data();
+    }
+
+    /**
+     * @brief Get a pointer past the last entry.
+     *
+     * @return Pointer past the last entry.
+     */
+    [[nodiscard]] constexpr const Entry *end() const noexcept
+    {
+        return this->slots_.data() + N;
+    }
+
+    /**
+     * @brief Get the number of entries.
+     *
+     * @return Number of entries (e.g., "89").
+     */
+    [[nodiscard]] static constexpr std::size_t size() noexcept
+    {
+        return N;
+    }
+
+  private:
+    /**
+     * @brief Number of buckets; two keys per bucket on average keeps the seed search short enough for the compiler.
+     */
+    static constexpr std::size_t bucket_count = (N + 1) / 2;
+
+    /**
+     * @brief Upper bound of the seed search, only reached if two keys are identical.
+     */
+    static constexpr std::uint32_t max_seed = 1U << 16;
+
+    /**
+     * @brief Get the bucket of a key.
+     *
+     * @param key Key (e.g., "MacBookPro18,3").
+     *
+     * @return Bucket index.
+     */
+    [[nodiscard]] static constexpr std::size_t get_bucket(const std::string_view key) noexcept
+    {
+        return hash(key, 0) % bucket_count;
+    }
+
+    /**
+     * @brief Get the slot of a key for a given seed.
+     *
+     * @param key Key (e.g., "MacBookPro18,3").
+     * @param seed Seed of the key's bucket.
+     *
+     * @return Slot index.
+     */
+    [[nodiscard]] static constexpr std::size_t get_slot(const std::string_view key,
+                                                        const std::uint32_t seed) noexcept
+    {
+        return hash(key, seed) % N;
+    }
+
+    /**
+     * @brief Check whether a seed sends all keys of a bucket to distinct free slots.
+     *
+     * @param entries All entries.
+     * @param order Entry indices grouped by bucket.
+     * @param first Position of the bucket's first key in "order".
+     * @param size Number of keys in the bucket.
+     * @param seed Seed to try.
+     * @param taken Slots that are already used.
+     *
+     * @return True if the seed fits, false otherwise.
+     */
+    [[nodiscard]] static constexpr bool fits(const Entry (&entries)[N],
+                                             const std::array<std::size_t, N> &order,
+                                             const std::size_t first,
+                                             const std::size_t size,
+                                             const std::uint32_t seed,
+                                             const std::array<bool, N> &taken) noexcept
+    {
+        for (std::size_t k = first; k < first + size; ++k) {
+            const std::size_t slot = get_slot(entries[order[k]].key, seed);
+            if (taken[slot]) {
+                return false;
+            }
+            for (std::size_t j = first; j < k; ++j) {
+                if (get_slot(entries[order[j]].key, seed) == slot) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Seed of each bucket.
+     */
+    std::array<std::uint32_t, bucket_count> seeds_{};
+
+    /**
+     * @brief Entries, indexed by slot.
+     */
+    std::array<Entry, N> slots_{};
+};
+
+}  // namespace core::perfect_hash
@@ -0,0 +1,287 @@
+/**
+ * @file png.cpp
+ */
+
+#include <array>        // for std::array
+#include <cstddef>      // for std::size_t
+#include <cstdint>      // for std::uint8_t, std::uint32_t
+#include <cstring>      // for std::memcpy, std::memmove
+#include <optional>     // for std::optional, std::nullopt
+#include <string_view>  // for std::string_view
+#include <utility>      // for std::move
+#include <vector>       // for std::vector
+
+#define ZLIB_CONST
+#include <zlib.h>  // for z_stream, inflateInit, inflate, inflateEnd, Z_OK, Z_STREAM_END, Z_NO_FLUSH
+
+#include "png.hpp"
+
+namespace core::png {
+
+namespace {
+
+/**
+ * @brief Largest number of pixels that is decoded (e.g., 8192x8192), to reject corrupt headers before allocating.
+ */
+constexpr std::size_t max_pixels = std::size_t{1} << 26;
+
+/**
+ * @brief Read a big-endian 32-bit integer.
+ *
+ * @param data Pointer to four bytes.
+ *
+ * @return Integer (e.g., "1024").
+ */
+[[nodiscard]] std::uint32_t read_u32(const unsigned char *data) noexcept
+{
+    return (static_cast<std::uint32_t>(data[0]) << 24) | (static_cast<std::uint32_t>(data[1]) << 16) |
+           (static_cast<std::uint32_t>(data[2]) << 8) | static_cast<std::uint32_t>(data[3]);
+}
+
+/**
+ * @brief Paeth predictor, as defined by the PNG specification.
+ *
+ * @param a Left byte.
+ * @param b Upper byte.
+ * @param c Upper-left byte.
+ *
+ * @return Predicted byte.
+ */
+[[nodiscard]] std::uint8_t paeth(const int a,
+                                 const int b,
+                                 const int c) noexcept
+{
+    const int p = a + b - c;
+    const int pa = p > a ? p - a : a - p;
+    const int pb = p > b ? p - b : b - p;
+    const int pc = p > c ? p - c : c - p;
+    return static_cast<std::uint8_t>(pa <= pb && pa <= pc ? a : (pb <= pc ? b : c));
+}
+
+/**
+ * @brief Reverse the filter of every scanline in place.
+ *
+ * @param data Inflated image data, one filter byte followed by "stride" bytes per row.
+ * @param height Number of rows.
+ * @param stride Number of bytes per row, without the filter byte.
+ * @param bpp Number of bytes per complete pixel, rounded up to one.
+ *
+ * @return True if succeeded, false if an unknown filter was found.
+ */
+[[nodiscard]] bool unfilter(std::vector<std::uint8_t> &data,
+                            const std::size_t height,
+                            const std::size_t stride,
+                            const std::size_t bpp) noexcept
+{
+    const std::vector<std::uint8_t> zero_row(stride, 0);
+    const std::uint8_t *previous = zero_row.data();
+    for (std::size_t y = 0; y < height; ++y) {
+        std::uint8_t *row = data.data() + y * (stride + 1) + 1;
+        switch (row[-1]) {
+        case 0:  // None
+            break;
+        case 1:  // Sub
+            for (std::size_t x = bpp; x < stride; ++x) {
+                row[x] = static_cast<std::uint8_t>(row[x] + row[x - bpp]);
+            }
+            break;
+        case 2:  // Up
+            for (std::size_t x = 0; x < stride; ++x) {
+                row[x] = static_cast<std::uint8_t>(row[x] + previous[x]);
+            }
+            break;
+        case 3:  // Average
+            for (std::size_t x = 0; x < bpp; ++x) {
+                row[x] = static_cast<std::uint8_t>(row[x] + (previous[x] >> 1));
+            }
+            for (std::size_t x = bpp; x < stride; ++x) {
+                row[x] = static_cast<std::uint8_t>(row[x] + ((row[x - bpp] + previous[x]) >> 1));
+            }
+            break;
+        case 4:  // Paeth
+            for (std::size_t x = 0; x < bpp; ++x) {
+                row[x] = static_cast<std::uint8_t>(row[x] + previous[x]);
+            }
+            for (std::size_t x = bpp; x < stride; ++x) {
+                row[x] = static_cast<std::uint8_t>(row[x] + paeth(row[x - bpp], previous[x], previous[x - bpp]));
+            }
+            break;
+        default:
+            return false;
+        }
+        previous = row;
+    }
+    return true;
+}
+
+}  // namespace
+
+std::optional<Image> decode(const std::string_view data)
+{
+    constexpr std::string_view signature("\x89PNG\r\n\x1a\n", 8);
+    if (data.substr(0, signature.size()) != signature) {
+        return std::nullopt;
+    }
+
+    // Header fields
+    std::size_t width = 0;
+    std::size_t height = 0;
+    unsigned bit_depth = 0;
+    unsigned color_type = 0;
+    std::array<std::array<std::uint8_t, 4>, 256> palette{};
+    for (auto &entry : palette) {
+        entry = {0, 0, 0, 255};
+    }
+
+    // Image data is inflated straight from the chunks, without concatenating them first
+    z_stream stream{};
+    if (inflateInit(&stream) != Z_OK) {
+        return std::nullopt;
+    }
+    std::vector<std::uint8_t> inflated;
+    bool finished = false;
+    bool valid = true;
+
+    const auto *bytes = reinterpret_cast<const unsigned char *>(data.data());
+    std::size_t position = signature.size();
+    while (valid && position + 12 <= data.size()) {
+        const std::size_t length = read_u32(bytes + position);
+        const std::string_view type(data.data() + position + 4, 4);
+        const unsigned char *chunk = bytes + position + 8;
+        if (length > data.size() - position - 12) {
+            valid = false;
+            break;
+        }
+        position += length + 12;
+
+        if (type == "IHDR") {
+            if (length != 13) {
+                valid = false;
+                break;
+            }
+            width = read_u32(chunk);
+            height = read_u32(chunk + 4);
+            bit_depth = chunk[8];
+            color_type = chunk[9];
+            const bool interlaced = chunk[12] != 0;
+            const bool depth_valid = (color_type == 0 && (bit_depth == 1 || bit_depth == 2 || bit_depth == 4 || bit_depth == 8 || bit_depth == 16)) ||
+                                     (color_type == 3 && (bit_depth == 1 || bit_depth == 2 || bit_depth == 4 || bit_depth == 8)) ||
+                                     ((color_type == 2 || color_type == 4 || color_type == 6) && (bit_depth == 8 || bit_depth == 16));
+            if (width == 0 || height == 0 || width > max_pixels / height || interlaced || !depth_valid) {
+                valid = false;
+                break;
+            }
+        }
+        else if (type == "PLTE") {
+            for (std::size_t i = 0; i < length / 3 && i < palette.size(); ++i) {
+                palette[i] = {chunk[i * 3], chunk[i * 3 + 1], chunk[i * 3 + 2], 255};
+            }
+        }
+        else if (type == "tRNS" && color_type == 3) {
+            for (std::size_t i = 0; i < length && i < palette.size(); ++i) {
+                palette[i][3] = chunk[i];
+            }
+        }
+        else if (type == "IDAT" && !finished) {
+            if (inflated.empty()) {
+                if (width == 0) {
+                    valid = false;
+                    break;
+                }
+                const std::size_t channels = color_type == 0 || color_type == 3 ? 1 : color_type == 4 ? 2 : color_type == 2 ? 3 : 4;
+                inflated.resize(height * ((width * channels * bit_depth + 7) / 8 + 1));
+                stream.next_out = inflated.data();
+                stream.avail_out = static_cast<uInt>(inflated.size());
+            }
+            stream.next_in = chunk;
+            stream.avail_in = static_cast<uInt>(length);
+            const int result = inflate(&stream, Z_NO_FLUSH);
+            finished = result == Z_STREAM_END;
+            valid = result == Z_OK || finished;
+        }
+        else if (type == "IEND") {
+            break;
+        }
+    }
+    inflateEnd(&stream);
+    if (!valid || !finished || stream.avail_out != 0) {
+        return std::nullopt;
+    }
+
+    // Undo the per-row filters
+    const std::size_t channels = color_type == 0 || color_type == 3 ? 1 : color_type == 4 ? 2 : color_type == 2 ? 3 : 4;
+    const std::size_t bits_per_pixel = channels * bit_depth;
+    const std::size_t stride = (width * bits_per_pixel + 7) / 8;
+    if (!unfilter(inflated, height, stride, bits_per_pixel >= 8 ? bits_per_pixel / 8 : 1)) {
+        return std::nullopt;
+    }
+
+    Image image;
+    image.width = width;
+    image.height = height;
+
+    // RGBA8 rows are already in the right format, so only the filter bytes are squeezed out in place
+    if (color_type == 6 && bit_depth == 8) {
+        for (std::size_t y = 0; y < height; ++y) {
+            std::memmove(inflated.data() + y * stride, inflated.data() + y * (stride + 1) + 1, stride);
+        }
+        inflated.resize(height * stride);
+        image.pixels = std::move(inflated);
+        return image;
+    }
+
+    // Otherwise, convert to RGBA8
+    image.pixels.resize(width * height * 4);
+    const std::size_t step = bit_depth == 16 ? 2 : 1;
+    for (std::size_t y = 0; y < height; ++y) {
+        const std::uint8_t *row = inflated.data() + y * (stride + 1) + 1;
+        std::uint8_t *out = image.pixels.data() + y * width * 4;
+        for (std::size_t x = 0; x < width; ++x, out += 4) {
+            if (bit_depth < 8) {
+                // Sub-byte samples are packed from the most significant bit
+                const std::size_t bit = x * bit_depth;
+                const unsigned mask = (1U << bit_depth) - 1;
+                const unsigned sample = (static_cast<unsigned>(row[bit / 8]) >> (8 - bit_depth - bit % 8)) & mask;
+                if (color_type == 3) {
+                    std::memcpy(out, palette[sample].data(), 4);
+                }
+                else {
+                    const auto gray = static_cast<std::uint8_t>(sample * 255 / mask);
+                    out[0] = out[1] = out[2] = gray;
+                    out[3] = 255;
+                }
+                continue;
+            }
+            // 16-bit samples are big-endian, so their first byte is the 8-bit approximation
+            const std::uint8_t *sample = row + x * channels * step;
+            switch (color_type) {
+            case 0:
+                out[0] = out[1] = out[2] = sample[0];
+                out[3] = 255;
+                break;
+            case 2:
+                out[0] = sample[0];
+                out[1] = sample[step];
+                out[2] = sample[2 * step];
+                out[3] = 255;
+                break;
+            case 3:
+                std::memcpy(out, palette[sample[0]].data(), 4);
+                break;
+            case 4:
+                out[0] = out[1] = out[2] = sample[0];
+                out[3] = sample[step];
+                break;
+            default:
+                out[0] = sample[0];
+                out[1] = sample[step];
+                out[2] = sample[2 * step];
+                out[3] = sample[3 * step];
+                break;
+            }
+        }
+    }
+    return image;
+}
+
+}  // namespace core::png
@@ -0,0 +1,48 @@
+/**
+ * @file png.hpp
+ *
+ * @brief Decode PNG images.
+ */
+
+#pragma once
+
+#include <cstddef>      // for std::size_t
+#include <cstdint>      // for std::uint8_t
+#include <optional>     // for std::optional
+#include <string_view>  // for std::string_view
+#include <vector>       // for std::vector
+
+namespace core::png {
+
+/**
+ * @brief Struct that represents a decoded image.
+ */
+struct Image final {
+    /**
+     * @brief Width in pixels (e.g., "1024").
+     */
+    std::size_t width = 0;
+
+    /**
+     * @brief Height in pixels (e.g., "1024").
+     */
+    std::size_t height = 0;
+
+    /**
+     * @brief Pixels in RGBA order, 8 bits per channel, row by row without padding.
+     */
+    std::vector<std::uint8_t> pixels;
+};
+
+/**
+ * @brief Decode a PNG image.
+ *
+ * All color types and bit depths are supported (16-bit channels are reduced to 8 bits, palette transparency is honored). Interlaced images are not supported.
+ *
+ * @param data Contents of the PNG file.
+ *
+ * @return Decoded image if succeeded, std::nullopt otherwise (e.g., invalid or interlaced image).
+ */
+[[nodiscard]] std::optional<Image> decode(const std::string_view data);
+
+}  // namespace core::png
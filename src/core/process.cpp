@@ -0,0 +1,167 @@
+/**
+ * @file process.cpp
+ */
+
+#include <algorithm>     // for std::min
+#include <array>         // for std::array
+#include <charconv>      // for std::from_chars
+#include <cstddef>       // for std::size_t
+#include <cstdint>       // for std::uint32_t
+#include <cstdio>        // for std::snprintf
+#include <cstring>       // for std::memcpy
+#include <optional>      // for std::optional, std::nullopt
+#include <string>        // for std::string
+#include <string_view>   // for std::string_view
+#include <sys/types.h>   // for pid_t, ssize_t
+#include <system_error>  // for std::errc
+#include <unistd.h>      // for getppid, ::read, ::close, ::readlink
+
+#if defined(__APPLE__)
+#include <libproc.h>        // for proc_pidinfo, proc_pidpath, PROC_PIDPATHINFO_MAXSIZE
+#include <sys/proc_info.h>  // for proc_bsdshortinfo, PROC_PIDT_SHORTBSDINFO, PROC_PIDT_SHORTBSDINFO_SIZE
+#else
+#include <fcntl.h>  // for ::open, O_RDONLY, O_CLOEXEC
+#endif
+
+#include "process.hpp"
+#include "profile.hpp"
+
+namespace core::process {
+
+namespace {
+
+/**
+ * @brief Copy a possibly unterminated name into the fixed-size name buffer of a process, truncating if needed.
+ *
+ * @param name Name to copy (e.g., "zsh").
+ * @param process Process to copy the name into.
+ */
+void set_name(const std::string_view name,
+              Process &process) noexcept
+{
+    const std::size_t length = std::min(name.size(), process.name.size() - 1);
+    std::memcpy(process.name.data(), name.data(), length);
+    process.name[length] = '\0';
+}
+
+/**
+ * @brief Read the parent process ID and the short name of a single process.
+ *
+ * @param pid Process ID to read (e.g., "4242").
+ * @param process Process to fill in.
+ *
+ * @return True if succeeded, false otherwise (e.g., the process exited or is not accessible).
+ */
+[[nodiscard]] bool read_process(const pid_t pid,
+                                Process &process) noexcept
+{
+    process.pid = pid;
+
+#if defined(__APPLE__)
+    // The short BSD info is readable for processes of other users too (e.g., "login", which is owned by root)
+    struct proc_bsdshortinfo info{};
+    if (proc_pidinfo(pid, PROC_PIDT_SHORTBSDINFO, 0, &info, PROC_PIDT_SHORTBSDINFO_SIZE) != PROC_PIDT_SHORTBSDINFO_SIZE) {
+        return false;
+    }
+    process.ppid = static_cast<pid_t>(info.pbsi_ppid);
+
+    // The command name is not null-terminated if it is exactly MAXCOMLEN characters long
+    const std::string_view comm(info.pbsi_comm, sizeof(info.pbsi_comm));
+    set_name(comm.substr(0, comm.find('\0')), process);
+    return true;
+#else
+    std::array<char, 32> path;
+    std::snprintf(path.data(), path.size(), "/proc/%d/stat", static_cast<int>(pid));
+
+    const int fd = ::open(path.data(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    std::array<char, 512> buffer;
+    const ssize_t bytes_read = ::read(fd, buffer.data(), buffer.size());
+    ::close(fd);
+    if (bytes_read <= 0) {
+        return false;
+    }
+
+    // Format is "<pid> (<comm>) <state> <ppid> ...", where <comm> may itself contain spaces and parentheses, so the last ')' is used
+    const std::string_view stat(buffer.data(), static_cast<std::size_t>(bytes_read));
+    const std::size_t open_paren = stat.find('(');
+    const std::size_t close_paren = stat.rfind(')');
+    if (open_paren == std::string_view::npos || close_paren == std::string_view::npos || close_paren < open_paren ||
+        close_paren + 4 >= stat.size()) {
+        return false;
+    }
+    set_name(stat.substr(open_paren + 1, close_paren - open_paren - 1), process);
+
+    // Skip ") S " to reach the parent process ID
+    const char *ppid_begin = stat.data() + close_paren + 4;
+    const char *ppid_end = stat.data() + stat.size();
+    int ppid = 0;
+    if (std::from_chars(ppid_begin, ppid_end, ppid).ec != std::errc()) {
+        return false;
+    }
+    process.ppid = static_cast<pid_t>(ppid);
+    return true;
+#endif
+}
+
+/**
+ * @brief Walk the chain of parent processes, starting from getppid().
+ *
+ * @return Ancestry, from the parent process to the furthest readable ancestor (excluding PID 1 and the kernel).
+ */
+[[nodiscard]] Ancestry walk_ancestry() noexcept
+{
+    Ancestry ancestry;
+    pid_t pid = getppid();
+    while (pid > 1 && ancestry.size < ancestry.processes.size()) {
+        Process &process = ancestry.processes[ancestry.size];
+        if (!read_process(pid, process)) {
+            break;
+        }
+        ++ancestry.size;
+        // Guard against a process that reports itself as its own parent
+        if (process.ppid == pid) {
+            break;
+        }
+        pid = process.ppid;
+    }
+    return ancestry;
+}
+
+}  // namespace
+
+const Ancestry &get_ancestry()
+{
+    // Initialized once (thread-safe), then reused for the rest of the session
+    static const Ancestry ancestry = [] {
+        const core::profile::Scope scope("core::process::get_ancestry");
+        return walk_ancestry();
+    }();
+    return ancestry;
+}
+
+std::optional<std::string> get_executable_path(const pid_t pid)
+{
+#if defined(__APPLE__)
+    std::array<char, PROC_PIDPATHINFO_MAXSIZE> buffer;
+    const int length = proc_pidpath(pid, buffer.data(), static_cast<std::uint32_t>(buffer.size()));
+    if (length <= 0) {
+        return std::nullopt;
+    }
+    return std::string(buffer.data(), static_cast<std::size_t>(length));
+#else
+    std::array<char, 32> path;
+    std::snprintf(path.data(), path.size(), "/proc/%d/exe", static_cast<int>(pid));
+
+    std::array<char, 4096> buffer;
+    const ssize_t length = ::readlink(path.data(), buffer.data(), buffer.size());
+    if (length <= 0 || static_cast<std::size_t>(length) >= buffer.size()) {
+        return std::nullopt;
+    }
+    return std::string(buffer.data(), static_cast<std::size_t>(length));
+#endif
+}
+
+}  // namespace core::process
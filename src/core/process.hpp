@@ -0,0 +1,110 @@
+/**
+ * @file process.hpp
+ *
+ * @brief Get information about the parent processes.
+ */
+
+#pragma once
+
+#include <array>        // for std::array
+#include <cstddef>      // for std::size_t
+#include <optional>     // for std::optional
+#include <string>       // for std::string
+#include <string_view>  // for std::string_view
+#include <sys/types.h>  // for pid_t
+
+namespace core::process {
+
+/**
+ * @brief Maximum number of ancestors that are walked, starting from the parent process.
+ */
+inline constexpr std::size_t max_depth = 32;
+
+/**
+ * @brief Struct that represents a single process in the ancestry.
+ *
+ * The name is stored inline, so that the whole ancestry can be kept without heap allocations.
+ */
+struct Process final {
+    /**
+     * @brief Process ID (e.g., "4242").
+     */
+    pid_t pid = 0;
+
+    /**
+     * @brief Parent process ID (e.g., "4241").
+     */
+    pid_t ppid = 0;
+
+    /**
+     * @brief Null-terminated short process name (e.g., "zsh"), as reported by the kernel.
+     *
+     * @note Login shells are reported with a leading dash (e.g., "-zsh").
+     */
+    std::array<char, 32> name{};
+
+    /**
+     * @brief Get the process name as a string view.
+     *
+     * @return Process name (e.g., "zsh").
+     */
+    [[nodiscard]] std::string_view get_name() const noexcept
+    {
+        return std::string_view(this->name.data());
+    }
+};
+
+/**
+ * @brief Struct that represents the chain of parent processes, from the nearest (parent) to the furthest (e.g., "launchd" or "init").
+ */
+struct Ancestry final {
+    /**
+     * @brief Fixed-size storage for the processes; only the first "size" entries are valid.
+     */
+    std::array<Process, max_depth> processes{};
+
+    /**
+     * @brief Number of valid processes (e.g., "4").
+     */
+    std::size_t size = 0;
+
+    /**
+     * @brief Get a pointer to the first process.
+     *
+     * @return Pointer to the parent process.
+     */
+    [[nodiscard]] const Process *begin() const noexcept
+    {
+        return this->processes.data();
+    }
+
+    /**
+     * @brief Get a pointer past the last valid process.
+     *
+     * @return Pointer past the furthest ancestor.
+     */
+    [[nodiscard]] const Process *end() const noexcept
+    {
+        return this->processes.data() + this->size;
+    }
+};
+
+/**
+ * @brief Get the chain of parent processes of the current process.
+ *
+ * The chain is walked once, starting from getppid(), reading each ancestor exactly once ("proc_pidinfo()" on macOS, "/proc/<pid>/stat" on Linux). The result is cached for the lifetime of the process, so repeated calls (e.g., from prompts or long-running callers) are free.
+ *
+ * @return Reference to the cached ancestry. It is empty if the parent process could not be read.
+ */
+[[nodiscard]] const Ancestry &get_ancestry();
+
+/**
+ * @brief Get the full path to the executable of a process.
+ *
+ * @param pid Process ID (e.g., "4242").
+ *
+ * @return Path to the executable (e.g., "/bin/zsh") if succeeded, std::nullopt otherwise.
+ */
+[[nodiscard]] std::optional<std::string> get_executable_path(const pid_t pid);
+
+}  // namespace core::process
@@ -0,0 +1,338 @@
+/**
+ * @file profile.cpp
+ */
+
+#include <array>           // for std::array
+#include <chrono>          // for std::chrono
+#include <cstddef>         // for std::size_t
+#include <cstdint>         // for std::uint64_t
+#include <iterator>        // for std::back_inserter
+#include <optional>        // for std::optional, std::nullopt
+#include <string>          // for std::string
+#include <string_view>     // for std::string_view
+#include <sys/resource.h>  // for ::getrusage, struct rusage, RUSAGE_SELF, RUSAGE_CHILDREN
+#include <sys/time.h>      // for struct timeval
+#include <unistd.h>        // for ::close, ::read, ::syscall
+#include <vector>          // for std::vector
+
+#if defined(__linux__)
+#include <cerrno>              // for errno, EACCES, EPERM
+#include <fstream>             // for std::ifstream
+#include <linux/perf_event.h>  // for perf_event_attr, PERF_TYPE_SOFTWARE, PERF_TYPE_TRACEPOINT, PERF_COUNT_SW_*, PERF_FLAG_FD_CLOEXEC
+#include <sys/syscall.h>       // for SYS_perf_event_open
+#endif
+
+#include <fmt/core.h>
+
+#include "alloc.hpp"
+#include "json.hpp"
+#include "profile.hpp"
+
+namespace core::profile {
+
+namespace {
+
+/**
+ * @brief Profiler that scopes record into, nullptr if none. Scopes on other threads (e.g., workers) see nullptr and are not recorded.
+ */
+thread_local Profiler *active = nullptr;
+
+/**
+ * @brief Indices of the counters in Profiler::fds_.
+ */
+enum Counter : std::size_t {
+    TaskClock,
+    ContextSwitches,
+    PageFaults,
+    CpuMigrations,
+    Syscalls,
+};
+
+#if defined(__linux__)
+/**
+ * @brief Open a counter for the calling process, inherited by threads and child processes created after it.
+ *
+ * Kernel-side counting is tried first. If perf_event_paranoid forbids it, events that also happen in user space are opened for user space only. Events that only happen in the kernel (e.g., context switches, system calls) are not, as they would always read 0.
+ *
+ * @param type Type of the event (e.g., "PERF_TYPE_SOFTWARE").
+ * @param config Event (e.g., "PERF_COUNT_SW_TASK_CLOCK").
+ * @param user_fallback Whether to count user space only if kernel-side counting is forbidden.
+ *
+ * @return File descriptor if succeeded, -1 otherwise.
+ */
+[[nodiscard]] int open_counter(const std::uint32_t type,
+                               const std::uint64_t config,
+                               const bool user_fallback) noexcept
+{
+    perf_event_attr attr{};
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.inherit = 1;
+    attr.exclude_hv = 1;
+    long fd = ::syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+    if (fd < 0 && user_fallback && (errno == EACCES || errno == EPERM)) {
+        attr.exclude_kernel = 1;
+        fd = ::syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+    }
+    return static_cast<int>(fd);
+}
+
+/**
+ * @brief Get the ID of the raw_syscalls:sys_enter tracepoint, which fires once per system call.
+ *
+ * @return ID if tracefs is mounted and readable, std::nullopt otherwise.
+ */
+[[nodiscard]] std::optional<std::uint64_t> get_syscall_tracepoint()
+{
+    for (const char *path : {"/sys/kernel/tracing/events/raw_syscalls/sys_enter/id", "/sys/kernel/debug/tracing/events/raw_syscalls/sys_enter/id"}) {
+        std::ifstream file(path);
+        std::uint64_t id = 0;
+        if (file >> id) {
+            return id;
+        }
+    }
+    return std::nullopt;
+}
+#endif
+
+/**
+ * @brief Read a perf_event counter.
+ *
+ * @param fd File descriptor of the counter.
+ *
+ * @return Value if succeeded, std::nullopt otherwise.
+ */
+[[nodiscard]] std::optional<std::uint64_t> read_counter(const int fd) noexcept
+{
+    std::uint64_t value = 0;
+    if (fd < 0 || ::read(fd, &value, sizeof(value)) != static_cast<long>(sizeof(value))) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+/**
+ * @brief Convert a timeval to nanoseconds.
+ *
+ * @param time Time (e.g., "{1, 500000}").
+ *
+ * @return Nanoseconds (e.g., "1500000000").
+ */
+[[nodiscard]] std::uint64_t to_ns(const timeval &time) noexcept
+{
+    return static_cast<std::uint64_t>(time.tv_sec) * 1'000'000'000 + static_cast<std::uint64_t>(time.tv_usec) * 1'000;
+}
+
+/**
+ * @brief Subtract counters, saturating at zero.
+ *
+ * @param end Counters at the end of a sample.
+ * @param start Counters at the start of a sample.
+ *
+ * @return Delta.
+ */
+[[nodiscard]] Counters subtract(const Counters &end,
+                                const Counters &start) noexcept
+{
+    const auto minus = [](const std::uint64_t lhs, const std::uint64_t rhs) {
+        return lhs > rhs ? lhs - rhs : 0;
+    };
+    Counters delta;
+    delta.wall_ns = minus(end.wall_ns, start.wall_ns);
+    delta.task_clock_ns = minus(end.task_clock_ns, start.task_clock_ns);
+    delta.context_switches = minus(end.context_switches, start.context_switches);
+    delta.page_faults = minus(end.page_faults, start.page_faults);
+    if (end.cpu_migrations && start.cpu_migrations) {
+        delta.cpu_migrations = minus(*end.cpu_migrations, *start.cpu_migrations);
+    }
+    if (end.syscalls && start.syscalls) {
+        delta.syscalls = minus(*end.syscalls, *start.syscalls);
+    }
+    if (end.allocations && start.allocations) {
+        delta.allocations = minus(*end.allocations, *start.allocations);
+    }
+    if (end.allocated_bytes && start.allocated_bytes) {
+        delta.allocated_bytes = minus(*end.allocated_bytes, *start.allocated_bytes);
+    }
+    return delta;
+}
+
+/**
+ * @brief Format an optional counter for the table.
+ *
+ * @param value Counter.
+ *
+ * @return Value (e.g., "42"), or "-" if not available.
+ */
+[[nodiscard]] std::string format_optional(const std::optional<std::uint64_t> &value)
+{
+    return value ? fmt::format("{}", *value) : "-";
+}
+
+/**
+ * @brief Format an optional counter for JSON.
+ *
+ * @param value Counter.
+ *
+ * @return Value (e.g., "42"), or "null" if not available.
+ */
+[[nodiscard]] std::string format_optional_json(const std::optional<std::uint64_t> &value)
+{
+    return value ? fmt::format("{}", *value) : "null";
+}
+
+}  // namespace
+
+Profiler::Profiler()
+{
+    this->fds_.fill(-1);
+#if defined(__linux__)
+    this->fds_[TaskClock] = open_counter(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK, true);
+    if (this->fds_[TaskClock] >= 0) {
+        this->fds_[ContextSwitches] = open_counter(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, false);
+        this->fds_[PageFaults] = open_counter(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS, true);
+        this->fds_[CpuMigrations] = open_counter(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS, false);
+        if (const auto tracepoint = get_syscall_tracepoint()) {
+            this->fds_[Syscalls] = open_counter(PERF_TYPE_TRACEPOINT, *tracepoint, false);
+        }
+    }
+#endif
+    active = this;
+}
+
+Profiler::~Profiler()
+{
+    for (const int fd : this->fds_) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+    if (active == this) {
+        active = nullptr;
+    }
+}
+
+Source Profiler::get_source() const noexcept
+{
+    return this->fds_[TaskClock] >= 0 ? Source::PerfEvent : Source::Rusage;
+}
+
+std::size_t Profiler::begin(const std::string_view name)
+{
+    const std::size_t index = this->samples_.size();
+    this->samples_.push_back({std::string(name), this->depth_, {}});
+    ++this->depth_;
+    // Read last, so that the bookkeeping above is not attributed to the sample
+    this->starts_.push_back(this->read());
+    return index;
+}
+
+void Profiler::end(const std::size_t index) noexcept
+{
+    const Counters now = this->read();
+    this->samples_[index].counters = subtract(now, this->starts_[index]);
+    --this->depth_;
+}
+
+const std::vector<Sample> &Profiler::get_samples() const noexcept
+{
+    return this->samples_;
+}
+
+Counters Profiler::read() const noexcept
+{
+    Counters counters;
+    if (core::alloc::is_enabled()) {
+        const core::alloc::Counters allocations = core::alloc::get_counters();
+        counters.allocations = allocations.allocations;
+        counters.allocated_bytes = allocations.bytes;
+    }
+    counters.wall_ns = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    if (this->get_source() == Source::PerfEvent) {
+        counters.task_clock_ns = read_counter(this->fds_[TaskClock]).value_or(0);
+        counters.context_switches = read_counter(this->fds_[ContextSwitches]).value_or(0);
+        counters.page_faults = read_counter(this->fds_[PageFaults]).value_or(0);
+        counters.cpu_migrations = read_counter(this->fds_[CpuMigrations]);
+        counters.syscalls = read_counter(this->fds_[Syscalls]);
+        return counters;
+    }
+
+    // Children only count once they have been waited for, which every primitive that spawns a command does before returning
+    for (const int who : {RUSAGE_SELF, RUSAGE_CHILDREN}) {
+        struct rusage usage{};
+        if (::getrusage(who, &usage) != 0) {
+            continue;
+        }
+        counters.task_clock_ns += to_ns(usage.ru_utime) + to_ns(usage.ru_stime);
+        counters.context_switches += static_cast<std::uint64_t>(usage.ru_nvcsw + usage.ru_nivcsw);
+        counters.page_faults += static_cast<std::uint64_t>(usage.ru_minflt + usage.ru_majflt);
+    }
+    return counters;
+}
+
+Scope::Scope(const std::string_view name)
+    : profiler_(active)
+{
+    if (this->profiler_) {
+        this->index_ = this->profiler_->begin(name);
+    }
+}
+
+Scope::~Scope()
+{
+    if (this->profiler_) {
+        this->profiler_->end(this->index_);
+    }
+}
+
+std::string format_table(const Profiler &profiler)
+{
+    constexpr std::size_t name_width = 32;
+    std::string output = fmt::format("Profile ({})\n", profiler.get_source() == Source::PerfEvent ? "perf_event" : "getrusage");
+    fmt::format_to(std::back_inserter(output), "{:<{}} {:>9} {:>9} {:>8} {:>8} {:>6} {:>9}\n",
+                   "Probe", name_width, "Wall ms", "CPU ms", "Ctx sw", "Faults", "Migr", "Syscalls");
+    for (const Sample &sample : profiler.get_samples()) {
+        const Counters &c = sample.counters;
+        fmt::format_to(std::back_inserter(output), "{:<{}} {:>9.3f} {:>9.3f} {:>8} {:>8} {:>6} {:>9}\n",
+                       std::string(sample.depth * 2, ' ') + sample.name, name_width,
+                       static_cast<double>(c.wall_ns) / 1e6, static_cast<double>(c.task_clock_ns) / 1e6,
+                       c.context_switches, c.page_faults, format_optional(c.cpu_migrations), format_optional(c.syscalls));
+    }
+    return output;
+}
+
+std::string format_allocations(const Profiler &profiler)
+{
+    if (!core::alloc::is_enabled()) {
+        return "Allocations are not counted in this build (configure with -DENABLE_ALLOC_STATS=ON)\n";
+    }
+    constexpr std::size_t name_width = 32;
+    std::string output = "Allocations\n";
+    fmt::format_to(std::back_inserter(output), "{:<{}} {:>8} {:>12}\n", "Probe", name_width, "Count", "Bytes");
+    for (const Sample &sample : profiler.get_samples()) {
+        fmt::format_to(std::back_inserter(output), "{:<{}} {:>8} {:>12}\n",
+                       std::string(sample.depth * 2, ' ') + sample.name, name_width,
+                       format_optional(sample.counters.allocations), format_optional(sample.counters.allocated_bytes));
+    }
+    return output;
+}
+
+std::string format_json(const Profiler &profiler)
+{
+    std::string output = fmt::format(R"({{"source":"{}","samples":[)", profiler.get_source() == Source::PerfEvent ? "perf_event" : "getrusage");
+    bool first = true;
+    for (const Sample &sample : profiler.get_samples()) {
+        const Counters &c = sample.counters;
+        fmt::format_to(std::back_inserter(output),
+                       R"({}{{"name":{},"depth":{},"wall_ns":{},"task_clock_ns":{},"context_switches":{},"page_faults":{},"cpu_migrations":{},"syscalls":{},"allocations":{},"allocated_bytes":{}}})",
+                       first ? "" : ",", core::json::quote(sample.name), sample.depth, c.wall_ns, c.task_clock_ns,
+                       c.context_switches, c.page_faults, format_optional_json(c.cpu_migrations), format_optional_json(c.syscalls),
+                       format_optional_json(c.allocations), format_optional_json(c.allocated_bytes));
+        first = false;
+    }
+    output += "]}";
+    return output;
+}
+
+}  // namespace core::profile
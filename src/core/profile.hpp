@@ -0,0 +1,240 @@
+/**
+ * @file profile.hpp
+ *
+ * @brief Attribute the cost of every probe to the resources it used.
+ */
+
+#pragma once
+
+#include <array>        // for std::array
+#include <cstddef>      // for std::size_t
+#include <cstdint>      // for std::uint64_t
+#include <optional>     // for std::optional
+#include <string>       // for std::string
+#include <string_view>  // for std::string_view
+#include <vector>       // for std::vector
+
+namespace core::profile {
+
+/**
+ * @brief Where the counters are read from.
+ */
+enum class Source {
+    PerfEvent,
+    Rusage,
+};
+
+/**
+ * @brief Struct that represents resource counters, either absolute or as a delta.
+ */
+struct Counters final {
+    /**
+     * @brief Wall-clock time in nanoseconds (e.g., "1250000").
+     */
+    std::uint64_t wall_ns = 0;
+
+    /**
+     * @brief CPU time of the process and its children in nanoseconds (e.g., "980000").
+     */
+    std::uint64_t task_clock_ns = 0;
+
+    /**
+     * @brief Number of voluntary and involuntary context switches (e.g., "3").
+     */
+    std::uint64_t context_switches = 0;
+
+    /**
+     * @brief Number of minor and major page faults (e.g., "120").
+     */
+    std::uint64_t page_faults = 0;
+
+    /**
+     * @brief Number of migrations between CPUs, std::nullopt if not available (getrusage does not report it).
+     */
+    std::optional<std::uint64_t> cpu_migrations;
+
+    /**
+     * @brief Number of system calls, std::nullopt if not available (the syscall tracepoint needs perf_event_paranoid <= 1 and a readable tracefs).
+     */
+    std::optional<std::uint64_t> syscalls;
+
+    /**
+     * @brief Number of heap allocations, std::nullopt if not counted (see core::alloc::is_enabled()).
+     */
+    std::optional<std::uint64_t> allocations;
+
+    /**
+     * @brief Number of bytes allocated on the heap, std::nullopt if not counted.
+     */
+    std::optional<std::uint64_t> allocated_bytes;
+};
+
+/**
+ * @brief Struct that represents the cost of one probe or primitive.
+ */
+struct Sample final {
+    /**
+     * @brief Name of the probe (e.g., "Packages") or primitive (e.g., "core::shell::get_output").
+     */
+    std::string name;
+
+    /**
+     * @brief Nesting depth, 0 for probes and 1 or more for the primitives they call.
+     */
+    std::size_t depth = 0;
+
+    /**
+     * @brief Counters spent between the start and the end of the probe, including nested primitives.
+     */
+    Counters counters;
+};
+
+/**
+ * @brief Class that reads resource counters around probes.
+ *
+ * On Linux, perf_event software counters (task-clock, context-switches, page-faults, cpu-migrations) and, where allowed, the raw_syscalls:sys_enter tracepoint are opened for the process. They are inherited by threads and child processes, whose counts are added to the process when they exit, so the work of a thread or child process is charged to the sample that is open at that moment. For a probe that waits for its own workers or commands, that is the probe itself; the commands and plugins that run in the background during a fetch are charged mostly to the sample that joins them. Elsewhere, or if perf_event_open() is not permitted, getrusage() deltas of the process and its waited-for children are used instead.
+ *
+ * While a profiler exists, it is the active one on the thread that created it: every Scope on that thread records into it, while scopes on other threads are ignored (their cost is still counted in the enclosing sample). Only one profiler may exist at a time.
+ *
+ * @note This class is marked as `final` to prevent inheritance.
+ */
+class Profiler final {
+  public:
+    /**
+     * @brief Construct a new Profiler object, open the counters and make it the active profiler.
+     */
+    Profiler();
+
+    /**
+     * @brief Destroy the Profiler object, close the counters and deactivate it.
+     */
+    ~Profiler();
+
+    Profiler(const Profiler &) = delete;
+    Profiler &operator=(const Profiler &) = delete;
+
+    /**
+     * @brief Get the source of the counters.
+     *
+     * @return Source::PerfEvent if perf_event counters are open, Source::Rusage otherwise.
+     */
+    [[nodiscard]] Source get_source() const noexcept;
+
+    /**
+     * @brief Start a new sample.
+     *
+     * @param name Name of the probe or primitive (e.g., "Packages").
+     *
+     * @return Index of the sample, to be passed to end().
+     */
+    std::size_t begin(const std::string_view name);
+
+    /**
+     * @brief Finish a sample started by begin().
+     *
+     * @param index Index returned by begin().
+     */
+    void end(const std::size_t index) noexcept;
+
+    /**
+     * @brief Get all samples in the order they were started, so that primitives follow the probe that called them.
+     *
+     * @return Samples.
+     */
+    [[nodiscard]] const std::vector<Sample> &get_samples() const noexcept;
+
+  private:
+    /**
+     * @brief Read the current value of every counter.
+     *
+     * @return Absolute counters.
+     */
+    [[nodiscard]] Counters read() const noexcept;
+
+    /**
+     * @brief File descriptors of the perf_event counters (task-clock, context-switches, page-faults, cpu-migrations, syscalls), -1 if not open.
+     */
+    std::array<int, 5> fds_;
+
+    /**
+     * @brief Samples, in the order they were started.
+     */
+    std::vector<Sample> samples_;
+
+    /**
+     * @brief Absolute counters at the start of every sample.
+     */
+    std::vector<Counters> starts_;
+
+    /**
+     * @brief Number of samples that are started but not finished.
+     */
+    std::size_t depth_ = 0;
+};
+
+/**
+ * @brief Class that records the cost of the enclosing block into the active profiler, if any.
+ *
+ * Without an active profiler, this only checks a pointer, so it is cheap enough to leave in every primitive.
+ *
+ * @note This class is marked as `final` to prevent inheritance.
+ */
+class Scope final {
+  public:
+    /**
+     * @brief Construct a new Scope object and start a sample.
+     *
+     * @param name Name of the probe or primitive (e.g., "core::shell::get_output").
+     */
+    explicit Scope(const std::string_view name);
+
+    /**
+     * @brief Destroy the Scope object and finish its sample.
+     */
+    ~Scope();
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+  private:
+    /**
+     * @brief Profiler that was active when the scope started, nullptr if none.
+     */
+    Profiler *profiler_;
+
+    /**
+     * @brief Index of the sample in the profiler.
+     */
+    std::size_t index_ = 0;
+};
+
+/**
+ * @brief Format the samples as a table, one row per probe or primitive, with primitives indented under their probe.
+ *
+ * @param profiler Profiler to format.
+ *
+ * @return Table, with a newline after every row. Counters that are not available are shown as "-".
+ *
+ * @note Rows are per sample of the calling thread, so work done on other threads or in child processes appears in the row that was open when it finished (see Profiler).
+ */
+[[nodiscard]] std::string format_table(const Profiler &profiler);
+
+/**
+ * @brief Format the heap allocations of the samples as a table, one row per probe, primitive or render stage.
+ *
+ * @param profiler Profiler to format.
+ *
+ * @return Table, with a newline after every row, or a note that allocations are not counted in this build.
+ */
+[[nodiscard]] std::string format_allocations(const Profiler &profiler);
+
+/**
+ * @brief Format the samples as a JSON object.
+ *
+ * @param profiler Profiler to format.
+ *
+ * @return JSON object (e.g., "{\"source\":\"perf_event\",\"samples\":[...]}"). Counters that are not available are null.
+ */
+[[nodiscard]] std::string format_json(const Profiler &profiler);
+
+}  // namespace core::profile
@@ -0,0 +1,462 @@
+/**
+ * @file ring.cpp
+ */
+
+#include <algorithm>    // for std::copy_n, std::min
+#include <array>        // for std::array
+#include <atomic>       // for std::atomic, std::atomic_thread_fence, std::memory_order_acquire, std::memory_order_relaxed, std::memory_order_release
+#include <cerrno>       // for errno
+#include <cstddef>      // for std::size_t
+#include <cstdint>      // for std::uint32_t, std::uint64_t, std::uint8_t
+#include <cstdio>       // for std::rename
+#include <cstring>      // for std::memcpy, std::strerror
+#include <fcntl.h>      // for ::open, O_CREAT, O_RDONLY, O_RDWR, O_TRUNC
+#include <string>       // for std::string
+#include <sys/file.h>   // for ::flock, LOCK_EX, LOCK_NB
+#include <sys/mman.h>   // for ::mmap, ::munmap, MAP_FAILED, MAP_SHARED, PROT_READ, PROT_WRITE
+#include <sys/stat.h>   // for ::fstat, struct stat
+#include <sys/types.h>  // for off_t, ssize_t
+#include <unistd.h>     // for ::close, ::getpagesize, ::getpid, ::pread, ::pwrite, ::unlink
+#include <vector>       // for std::vector
+
+#include <fmt/core.h>
+
+#include "ring.hpp"
+
+namespace core::ring {
+
+namespace {
+
+/**
+ * @brief Bytes at the start of every ring file; the last two are the format version.
+ */
+constexpr std::array<char, 8> magic = {'A', 'F', 'R', 'I', 'N', 'G', '0', '1'};
+
+/**
+ * @brief Size of the file header in bytes.
+ */
+constexpr std::size_t header_size = 64;
+
+/**
+ * @brief Size of the header of every block in bytes.
+ */
+constexpr std::size_t block_header_size = 16;
+
+/**
+ * @brief Number of payload bytes in every block.
+ */
+constexpr std::size_t payload_size = block_size - block_header_size;
+
+/**
+ * @brief Largest size of a varint-encoded 64-bit value in bytes.
+ */
+constexpr std::size_t max_varint_size = 10;
+
+/**
+ * @brief Struct that represents the header at the start of the file.
+ */
+struct Header final {
+    /**
+     * @brief Always "magic".
+     */
+    std::array<char, 8> magic;
+
+    /**
+     * @brief Number of values in every sample (e.g., "11").
+     */
+    std::uint32_t field_count;
+
+    /**
+     * @brief Number of blocks in the ring (e.g., "16384").
+     */
+    std::uint32_t block_count;
+
+    /**
+     * @brief Number of blocks started since the file was created; the current block is "head - 1".
+     */
+    std::atomic<std::uint64_t> head;
+};
+
+/**
+ * @brief Struct that represents the header of a block.
+ */
+struct BlockHeader final {
+    /**
+     * @brief Sequence number of the block plus one, or 0 while the block is being reused.
+     */
+    std::atomic<std::uint64_t> sequence;
+
+    /**
+     * @brief Number of payload bytes committed by the writer; only these bytes may be read.
+     */
+    std::atomic<std::uint32_t> length;
+
+    /**
+     * @brief Unused, always 0.
+     */
+    std::uint32_t reserved;
+};
+
+static_assert(sizeof(Header) <= header_size, "the file header must fit into its reserved space");
+static_assert(sizeof(BlockHeader) == block_header_size, "the block header must have a fixed size");
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free && std::atomic<std::uint32_t>::is_always_lock_free,
+              "ring files are shared between processes, so their atomics must be lock-free");
+static_assert(max_field_count * max_varint_size <= payload_size, "a sample must always fit into an empty block");
+
+/**
+ * @brief Get the size of a ring file in bytes.
+ *
+ * @param block_count Number of blocks in the ring (e.g., "16384").
+ *
+ * @return Size in bytes (e.g., "8388672").
+ */
+[[nodiscard]] constexpr std::size_t get_file_size(const std::size_t block_count) noexcept
+{
+    return header_size + block_count * block_size;
+}
+
+/**
+ * @brief Get the header of the block at a position of the ring.
+ *
+ * @param data Start of the mapping.
+ * @param index Position of the block in the ring (e.g., "0").
+ *
+ * @return Block header.
+ */
+[[nodiscard]] BlockHeader &get_block(std::uint8_t *data,
+                                     const std::size_t index) noexcept
+{
+    return *static_cast<BlockHeader *>(static_cast<void *>(data + header_size + index * block_size));
+}
+
+/**
+ * @brief Get the header of the block at a position of a read-only ring.
+ *
+ * @param data Start of the mapping.
+ * @param index Position of the block in the ring (e.g., "0").
+ *
+ * @return Block header.
+ */
+[[nodiscard]] const BlockHeader &get_block(const std::uint8_t *data,
+                                           const std::size_t index) noexcept
+{
+    return *static_cast<const BlockHeader *>(static_cast<const void *>(data + header_size + index * block_size));
+}
+
+/**
+ * @brief Get the offset of the payload of the block at a position of the ring.
+ *
+ * @param index Position of the block in the ring (e.g., "0").
+ *
+ * @return Offset from the start of the mapping in bytes.
+ */
+[[nodiscard]] constexpr std::size_t get_payload_offset(const std::size_t index) noexcept
+{
+    return header_size + index * block_size + block_header_size;
+}
+
+/**
+ * @brief Read and validate the header of an open file.
+ *
+ * @param fd File descriptor of the file.
+ * @param field_count Number of values in every sample, set on success.
+ * @param block_count Number of blocks in the ring, set on success.
+ *
+ * @return True if the file is a complete ring file, false otherwise.
+ */
+[[nodiscard]] bool read_header(const int fd,
+                               std::size_t &field_count,
+                               std::size_t &block_count) noexcept
+{
+    std::array<char, 8> file_magic{};
+    std::uint32_t counts[2] = {};
+    struct stat info{};
+    if (::pread(fd, file_magic.data(), file_magic.size(), 0) != static_cast<ssize_t>(file_magic.size()) ||
+        ::pread(fd, counts, sizeof(counts), static_cast<off_t>(file_magic.size())) != static_cast<ssize_t>(sizeof(counts)) ||
+        ::fstat(fd, &info) != 0 || file_magic != magic || counts[0] == 0 || counts[0] > max_field_count || counts[1] == 0 ||
+        static_cast<std::size_t>(info.st_size) != get_file_size(counts[1])) {
+        return false;
+    }
+    field_count = counts[0];
+    block_count = counts[1];
+    return true;
+}
+
+/**
+ * @brief Create a new ring file next to the path and rename it into place, so that readers of a previous file keep their mapping.
+ *
+ * @param path Path to the ring file (e.g., "memory.ring").
+ * @param field_count Number of values in every sample (e.g., "11").
+ * @param block_count Number of blocks in the ring (e.g., "16384").
+ *
+ * @return File descriptor of the new file, locked exclusively, or -1 if failed (errno is set).
+ */
+[[nodiscard]] int create_file(const std::string &path,
+                              const std::size_t field_count,
+                              const std::size_t block_count)
+{
+    const std::string temp_path = fmt::format("{}.{}.tmp", path, ::getpid());
+    const int fd = ::open(temp_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return -1;
+    }
+
+    // Write every block instead of extending the file with a hole, so that appending never has to allocate disk space
+    std::array<std::uint8_t, block_size> zeros{};
+    std::array<std::uint8_t, header_size> header{};
+    const std::uint32_t counts[2] = {static_cast<std::uint32_t>(field_count), static_cast<std::uint32_t>(block_count)};
+    std::memcpy(header.data(), magic.data(), magic.size());
+    std::memcpy(header.data() + magic.size(), counts, sizeof(counts));
+    bool written = ::flock(fd, LOCK_EX | LOCK_NB) == 0 &&
+                   ::pwrite(fd, header.data(), header.size(), 0) == static_cast<ssize_t>(header.size());
+    for (std::size_t i = 0; written && i < block_count; ++i) {
+        written = ::pwrite(fd, zeros.data(), zeros.size(), static_cast<off_t>(header_size + i * block_size)) == static_cast<ssize_t>(zeros.size());
+    }
+    if (!written || std::rename(temp_path.c_str(), path.c_str()) != 0) {
+        const int error = errno;
+        ::close(fd);
+        ::unlink(temp_path.c_str());
+        errno = error;
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * @brief Describe why a ring file could not be used.
+ *
+ * @param action What failed (e.g., "open").
+ * @param path Path to the ring file (e.g., "memory.ring").
+ *
+ * @return Error message (e.g., "Failed to open ring file: memory.ring (No such file or directory)").
+ */
+[[nodiscard]] std::string describe_error(const char *action,
+                                         const std::string &path)
+{
+    return fmt::format("Failed to {} ring file: {} ({})", action, path, std::strerror(errno));
+}
+
+}  // namespace
+
+std::size_t encode_varint(std::uint64_t value,
+                          std::uint8_t *output) noexcept
+{
+    std::size_t size = 0;
+    while (value >= 0x80) {
+        output[size++] = static_cast<std::uint8_t>(value | 0x80);
+        value >>= 7;
+    }
+    output[size++] = static_cast<std::uint8_t>(value);
+    return size;
+}
+
+bool decode_varint(const std::uint8_t *&input,
+                   const std::uint8_t *end,
+                   std::uint64_t &value) noexcept
+{
+    value = 0;
+    for (unsigned shift = 0; input < end && shift < 7 * max_varint_size; shift += 7) {
+        const std::uint8_t byte = *input++;
+        value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+Writer::Writer(const std::string &path,
+               const std::size_t field_count,
+               const std::size_t block_count)
+    : field_count_(field_count),
+      block_count_(block_count),
+      previous_(field_count),
+      scratch_(field_count * max_varint_size)
+{
+    if (field_count == 0 || field_count > max_field_count || block_count == 0 || block_count > 0xffffffffU) {
+        throw RingError(fmt::format("Failed to create ring file: {} (Invalid layout: {} fields, {} blocks)", path, field_count, block_count));
+    }
+
+    // Continue an existing file with the same layout, otherwise replace it
+    this->fd_ = ::open(path.c_str(), O_RDWR);
+    if (this->fd_ >= 0) {
+        if (::flock(this->fd_, LOCK_EX | LOCK_NB) != 0) {
+            const std::string message = describe_error("lock", path);
+            ::close(this->fd_);
+            throw RingError(message + ", is it already being recorded?");
+        }
+        std::size_t existing_fields = 0;
+        std::size_t existing_blocks = 0;
+        if (!read_header(this->fd_, existing_fields, existing_blocks) || existing_fields != field_count || existing_blocks != block_count) {
+            ::close(this->fd_);
+            this->fd_ = -1;
+        }
+    }
+    if (this->fd_ < 0) {
+        this->fd_ = create_file(path, field_count, block_count);
+        if (this->fd_ < 0) {
+            throw RingError(describe_error("create", path));
+        }
+    }
+
+    this->size_ = get_file_size(block_count);
+    void *data = ::mmap(nullptr, this->size_, PROT_READ | PROT_WRITE, MAP_SHARED, this->fd_, 0);
+    if (data == MAP_FAILED) {
+        const std::string message = describe_error("map", path);
+        ::close(this->fd_);
+        throw RingError(message);
+    }
+    this->data_ = static_cast<std::uint8_t *>(data);
+
+    // Fault every page in now rather than on the first append to it
+    const std::size_t page_size = static_cast<std::size_t>(::getpagesize());
+    std::uint8_t checksum = 0;
+    for (std::size_t offset = 0; offset < this->size_; offset += page_size) {
+        checksum = static_cast<std::uint8_t>(checksum ^ static_cast<volatile const std::uint8_t *>(this->data_)[offset]);
+    }
+    static_cast<void>(checksum);
+
+    this->head_ = static_cast<Header *>(static_cast<void *>(this->data_))->head.load(std::memory_order_relaxed);
+    this->start_block();
+}
+
+Writer::~Writer()
+{
+    ::munmap(this->data_, this->size_);
+    ::close(this->fd_);
+}
+
+void Writer::append(const std::uint64_t *values) noexcept
+{
+    // Encode the difference to the previous sample, zigzag-encoded so that small decreases stay small
+    const auto encode = [this, values](const bool relative) {
+        std::size_t size = 0;
+        for (std::size_t i = 0; i < this->field_count_; ++i) {
+            const std::uint64_t delta = values[i] - (relative ? this->previous_[i] : 0);
+            size += encode_varint((delta << 1) ^ (0 - (delta >> 63)), this->scratch_.data() + size);
+        }
+        return size;
+    };
+
+    // The first sample of a block is encoded against zero, so that every block can be decoded on its own
+    std::size_t size = encode(this->length_ != 0);
+    if (this->length_ + size > payload_size) {
+        this->start_block();
+        size = encode(false);
+    }
+
+    // Write the payload first, then publish it by extending the committed length
+    const std::size_t index = (this->head_ - 1) % this->block_count_;
+    std::memcpy(this->data_ + get_payload_offset(index) + this->length_, this->scratch_.data(), size);
+    this->length_ += size;
+    get_block(this->data_, index).length.store(static_cast<std::uint32_t>(this->length_), std::memory_order_release);
+    std::copy_n(values, this->field_count_, this->previous_.begin());
+}
+
+void Writer::start_block() noexcept
+{
+    // Invalidate the block before its payload is overwritten, so that readers that are copying it discard their copy
+    BlockHeader &block = get_block(this->data_, this->head_ % this->block_count_);
+    block.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    block.length.store(0, std::memory_order_relaxed);
+    block.sequence.store(this->head_ + 1, std::memory_order_release);
+    ++this->head_;
+    static_cast<Header *>(static_cast<void *>(this->data_))->head.store(this->head_, std::memory_order_release);
+    this->length_ = 0;
+}
+
+Reader::Reader(const std::string &path)
+{
+    this->fd_ = ::open(path.c_str(), O_RDONLY);
+    if (this->fd_ < 0) {
+        throw RingError(describe_error("open", path));
+    }
+    if (!read_header(this->fd_, this->field_count_, this->block_count_)) {
+        ::close(this->fd_);
+        throw RingError(fmt::format("Failed to read ring file: {} (Not a ring file)", path));
+    }
+    this->size_ = get_file_size(this->block_count_);
+    const void *data = ::mmap(nullptr, this->size_, PROT_READ, MAP_SHARED, this->fd_, 0);
+    if (data == MAP_FAILED) {
+        const std::string message = describe_error("map", path);
+        ::close(this->fd_);
+        throw RingError(message);
+    }
+    this->data_ = static_cast<const std::uint8_t *>(data);
+    this->previous_.assign(this->field_count_, 0);
+}
+
+Reader::~Reader()
+{
+    ::munmap(const_cast<std::uint8_t *>(this->data_), this->size_);
+    ::close(this->fd_);
+}
+
+std::size_t Reader::get_field_count() const noexcept
+{
+    return this->field_count_;
+}
+
+std::vector<std::vector<std::uint64_t>> Reader::read()
+{
+    std::vector<std::vector<std::uint64_t>> samples;
+    const std::uint64_t head = static_cast<const Header *>(static_cast<const void *>(this->data_))->head.load(std::memory_order_acquire);
+
+    // Skip the blocks that were overwritten since the previous call
+    const std::uint64_t oldest = head > this->block_count_ ? head - this->block_count_ : 0;
+    if (this->block_ < oldest) {
+        this->block_ = oldest;
+        this->offset_ = 0;
+    }
+
+    std::array<std::uint8_t, payload_size> payload;
+    while (this->block_ < head) {
+        // Copy the committed bytes, then check that the block was not reused while copying
+        const std::size_t index = this->block_ % this->block_count_;
+        const BlockHeader &block = get_block(this->data_, index);
+        const std::uint64_t sequence = block.sequence.load(std::memory_order_acquire);
+        const std::size_t length = std::min<std::size_t>(block.length.load(std::memory_order_acquire), payload_size);
+        const bool valid = sequence == this->block_ + 1 && length >= this->offset_;
+        if (valid) {
+            std::memcpy(payload.data(), this->data_ + get_payload_offset(index) + this->offset_, length - this->offset_);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (!valid || block.sequence.load(std::memory_order_relaxed) != sequence) {
+            ++this->block_;
+            this->offset_ = 0;
+            continue;
+        }
+
+        // Decode every complete sample; the first one of a block is relative to zero
+        const std::uint8_t *input = payload.data();
+        const std::uint8_t *end = payload.data() + (length - this->offset_);
+        bool relative = this->offset_ != 0;
+        std::vector<std::uint64_t> values(this->field_count_);
+        while (input < end) {
+            bool decoded = true;
+            for (std::size_t i = 0; decoded && i < this->field_count_; ++i) {
+                std::uint64_t zigzag = 0;
+                decoded = decode_varint(input, end, zigzag);
+                values[i] = (relative ? this->previous_[i] : 0) + ((zigzag >> 1) ^ (0 - (zigzag & 1)));
+            }
+            if (!decoded) {
+                break;
+            }
+            this->previous_ = values;
+            samples.push_back(values);
+            relative = true;
+        }
+        this->offset_ = length;
+
+        // The current block may still grow, so it is continued on the next call
+        if (this->block_ + 1 == head) {
+            break;
+        }
+        ++this->block_;
+        this->offset_ = 0;
+    }
+    return samples;
+}
+
+}  // namespace core::ring
@@ -0,0 +1,238 @@
+/**
+ * @file ring.hpp
+ *
+ * @brief Record fixed-width samples into a memory-mapped ring file that other processes can follow.
+ */
+
+#pragma once
+
+#include <cstddef>    // for std::size_t
+#include <cstdint>    // for std::uint64_t, std::uint8_t
+#include <stdexcept>  // for std::runtime_error
+#include <string>     // for std::string
+#include <vector>     // for std::vector
+
+namespace core::ring {
+
+/**
+ * @brief Exceptions raised when a ring file cannot be created, opened or mapped. The message includes the path and the reason.
+ *
+ * This class extends "std::runtime_error".
+ *
+ * @note This class is marked as `final` to prevent inheritance.
+ */
+class RingError final : public std::runtime_error {
+  public:
+    using std::runtime_error::runtime_error;
+};
+
+/**
+ * @brief Size of a block in bytes, including its 16-byte header.
+ */
+inline constexpr std::size_t block_size = 512;
+
+/**
+ * @brief Largest number of values in a sample, so that a sample always fits into an empty block.
+ */
+inline constexpr std::size_t max_field_count = 48;
+
+/**
+ * @brief Append a value to a buffer as a LEB128 varint (7 bits per byte, least significant group first).
+ *
+ * @param value Value to encode (e.g., "300").
+ * @param output Buffer to write to; at least 10 bytes must be available.
+ *
+ * @return Number of bytes written (e.g., "2").
+ */
+std::size_t encode_varint(std::uint64_t value,
+                          std::uint8_t *output) noexcept;
+
+/**
+ * @brief Decode a LEB128 varint.
+ *
+ * @param input Pointer to the first byte, advanced past the varint on success.
+ * @param end Pointer past the last readable byte.
+ * @param value Decoded value (e.g., "300").
+ *
+ * @return True if succeeded, false if the varint is truncated or longer than 10 bytes.
+ */
+bool decode_varint(const std::uint8_t *&input,
+                   const std::uint8_t *end,
+                   std::uint64_t &value) noexcept;
+
+/**
+ * @brief Class that appends samples to a ring file.
+ *
+ * The file is a header followed by a fixed number of fixed-size blocks, used as a ring. The first sample of a block is stored as is, every later one as the difference to the previous sample, zigzag- and varint-encoded; slowly changing values (e.g., uptime, memory usage, cumulative counters) thus take one or two bytes each. When a sample does not fit into the current block, the oldest block is reused.
+ *
+ * Appending only writes to the mapping: it never calls into the kernel, waits for a reader or allocates, so the sampler is never blocked by the recording. The blocks are touched when the file is opened, so that appending does not fault pages in either. Only one writer may record into a file at a time, which is enforced with an advisory lock.
+ *
+ * @note This class is marked as `final` to prevent inheritance.
+ */
+class Writer final {
+  public:
+    /**
+     * @brief Construct a new Writer object, creating the file or continuing an existing one.
+     *
+     * An existing file with the same number of fields and blocks is continued in a new block; any other file at the path is atomically replaced, so that readers that still map it are not affected.
+     *
+     * @param path Path to the ring file (e.g., "memory.ring").
+     * @param field_count Number of values in every sample (e.g., "11"), at most "max_field_count".
+     * @param block_count Number of blocks in the ring (e.g., "16384" for 8 MiB).
+     *
+     * @throws RingError If the file cannot be created, locked or mapped.
+     */
+    explicit Writer(const std::string &path,
+                    const std::size_t field_count,
+                    const std::size_t block_count);
+
+    /**
+     * @brief Destroy the Writer object, unmap and unlock the file.
+     */
+    ~Writer();
+
+    Writer(const Writer &) = delete;
+    Writer &operator=(const Writer &) = delete;
+
+    /**
+     * @brief Append a sample.
+     *
+     * @param values Values of the sample; exactly "field_count" values are read.
+     */
+    void append(const std::uint64_t *values) noexcept;
+
+  private:
+    /**
+     * @brief Start the next block of the ring and make it the current one.
+     */
+    void start_block() noexcept;
+
+    /**
+     * @brief File descriptor of the ring file, locked exclusively.
+     */
+    int fd_ = -1;
+
+    /**
+     * @brief Start of the mapping.
+     */
+    std::uint8_t *data_ = nullptr;
+
+    /**
+     * @brief Size of the mapping in bytes.
+     */
+    std::size_t size_ = 0;
+
+    /**
+     * @brief Number of values in every sample.
+     */
+    std::size_t field_count_;
+
+    /**
+     * @brief Number of blocks in the ring.
+     */
+    std::size_t block_count_;
+
+    /**
+     * @brief Number of blocks started so far, including the current one; 0 if no block was started by this writer.
+     */
+    std::uint64_t head_ = 0;
+
+    /**
+     * @brief Number of payload bytes committed to the current block.
+     */
+    std::size_t length_ = 0;
+
+    /**
+     * @brief Previous sample, the base of the next difference.
+     */
+    std::vector<std::uint64_t> previous_;
+
+    /**
+     * @brief Encoded sample, before it is copied into the block.
+     */
+    std::vector<std::uint8_t> scratch_;
+};
+
+/**
+ * @brief Class that reads the samples of a ring file, following it while it is being written.
+ *
+ * Blocks are read optimistically: the block header is checked again after the payload is copied, so a block that the writer reused in the meantime is discarded instead of decoded. If the reader falls behind by more than the ring, the overwritten samples are skipped.
+ *
+ * @note This class is marked as `final` to prevent inheritance.
+ */
+class Reader final {
+  public:
+    /**
+     * @brief Construct a new Reader object and map the file read-only.
+     *
+     * @param path Path to the ring file (e.g., "memory.ring").
+     *
+     * @throws RingError If the file cannot be opened or mapped, or is not a ring file.
+     */
+    explicit Reader(const std::string &path);
+
+    /**
+     * @brief Destroy the Reader object and unmap the file.
+     */
+    ~Reader();
+
+    Reader(const Reader &) = delete;
+    Reader &operator=(const Reader &) = delete;
+
+    /**
+     * @brief Get the number of values in every sample.
+     *
+     * @return Number of values (e.g., "11").
+     */
+    [[nodiscard]] std::size_t get_field_count() const noexcept;
+
+    /**
+     * @brief Read the samples appended since the previous call (or all available samples on the first call).
+     *
+     * @return Samples, oldest first, each with "get_field_count()" values.
+     */
+    [[nodiscard]] std::vector<std::vector<std::uint64_t>> read();
+
+  private:
+    /**
+     * @brief File descriptor of the ring file.
+     */
+    int fd_ = -1;
+
+    /**
+     * @brief Start of the mapping.
+     */
+    const std::uint8_t *data_ = nullptr;
+
+    /**
+     * @brief Size of the mapping in bytes.
+     */
+    std::size_t size_ = 0;
+
+    /**
+     * @brief Number of values in every sample.
+     */
+    std::size_t field_count_ = 0;
+
+    /**
+     * @brief Number of blocks in the ring.
+     */
+    std::size_t block_count_ = 0;
+
+    /**
+     * @brief Sequence number of the block to read next.
+     */
+    std::uint64_t block_ = 0;
+
+    /**
+     * @brief Number of payload bytes of that block that were already decoded.
+     */
+    std::size_t offset_ = 0;
+
+    /**
+     * @brief Last decoded sample, the base of the next difference.
+     */
+    std::vector<std::uint64_t> previous_;
+};
+
+}  // namespace core::ring
@@ -2,20 +2,42 @@
  * @file shell.cpp
  */
 
-#include <array>     // for std::array
-#include <cstdio>    // for popen, pclose, FILE, fgets
-#include <memory>    // for std::unique_ptr
-#include <optional>  // for std::optional, std::nullopt
-#include <string>    // for std::string
+#include <algorithm>    // for std::min
+#include <array>        // for std::array
+#include <cerrno>       // for errno, EINTR
+#include <chrono>       // for std::chrono
+#include <csignal>      // for ::kill, SIGKILL
+#include <cstddef>      // for std::size_t
+#include <cstdio>       // for popen, pclose, FILE, fgets
+#include <fcntl.h>      // for ::fcntl, F_SETFD, FD_CLOEXEC, O_RDONLY, O_WRONLY
+#include <memory>       // for std::unique_ptr
+#include <optional>     // for std::optional, std::nullopt
+#include <poll.h>       // for ::poll, pollfd, POLLIN
+#include <spawn.h>      // for posix_spawn, posix_spawn_file_actions_t, posix_spawnattr_t
+#include <string>       // for std::string
+#include <sys/types.h>  // for pid_t, ssize_t
+#include <sys/wait.h>   // for ::waitpid, WNOHANG, WIFEXITED, WEXITSTATUS, WIFSIGNALED, WTERMSIG
+#include <thread>       // for std::this_thread
+#include <unistd.h>     // for ::pipe, ::read, ::close, STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO
+#include <utility>      // for std::move
+#include <vector>       // for std::vector
+
+#if defined(__APPLE__)
+#include <crt_externs.h>  // for _NSGetEnviron
+#else
+extern char **environ;
+#endif
 
 #include <fmt/core.h>
 
+#include "profile.hpp"
 #include "shell.hpp"
 
 namespace core::shell {
 
 std::optional<std::string> get_output(const std::string &command)
 {
+    const core::profile::Scope scope("core::shell::get_output");
     std::array<char, 128> buffer;
     std::string result;
     const std::unique_ptr<FILE, decltype(&pclose)> pipe(popen(command.c_str(), "r"), pclose);
@@ -38,4 +60,148 @@ std::optional<std::string> get_output(const std::string &command)
     return result;
 }
 
+std::optional<Output> run(const std::string &command,
+                          const std::chrono::milliseconds timeout,
+                          const std::size_t max_size)
+{
+    const core::profile::Scope scope("core::shell::run");
+    return spawn("/bin/sh", {"sh", "-c", command}, timeout, max_size);
+}
+
+std::optional<Output> spawn(const std::string &path,
+                            const std::vector<std::string> &arguments,
+                            const std::chrono::milliseconds timeout,
+                            const std::size_t max_size)
+{
+    std::array<int, 2> fds;
+    if (::pipe(fds.data()) != 0) {
+        return std::nullopt;
+    }
+    // The read end must not leak into the child, otherwise the pipe would never report EOF
+    ::fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+    posix_spawn_file_actions_adddup2(&actions, fds[1], STDOUT_FILENO);
+    posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+    posix_spawn_file_actions_addclose(&actions, fds[1]);
+
+    // Run in a new process group, so that grandchildren can be killed on timeout too
+    posix_spawnattr_t attributes;
+    posix_spawnattr_init(&attributes);
+    posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETPGROUP);
+    posix_spawnattr_setpgroup(&attributes, 0);
+
+    // posix_spawn() takes mutable strings, so the arguments are copied
+    std::vector<std::string> arguments_copy = arguments;
+    std::vector<char *> argv;
+    argv.reserve(arguments_copy.size() + 1);
+    for (std::string &argument : arguments_copy) {
+        argv.push_back(argument.data());
+    }
+    argv.push_back(nullptr);
+#if defined(__APPLE__)
+    char **envp = *_NSGetEnviron();
+#else
+    char **envp = environ;
+#endif
+
+    pid_t pid = 0;
+    const int spawn_result = posix_spawn(&pid, path.c_str(), &actions, &attributes, argv.data(), envp);
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attributes);
+    ::close(fds[1]);
+    if (spawn_result != 0) {
+        ::close(fds[0]);
+        return std::nullopt;
+    }
+
+    return wait_for_output(pid, fds[0], timeout, max_size);
+}
+
+std::optional<std::string> get_output(const std::string &command,
+                                      const std::chrono::milliseconds timeout)
+{
+    const core::profile::Scope scope("core::shell::get_output");
+    auto output = run(command, timeout);
+
+    // If failed to execute command, timed out or empty string, return nullopt
+    if (!output || output->timed_out || output->text.empty()) {
+        return std::nullopt;
+    }
+
+    return std::move(output->text);
+}
+
+Output wait_for_output(const pid_t pid,
+                       const int fd,
+                       const std::chrono::milliseconds timeout,
+                       const std::size_t max_size)
+{
+    // Read until EOF, until the deadline is reached or until enough output was captured
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    std::array<char, 4096> buffer;
+    Output output;
+    while (true) {
+        const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        if (remaining.count() <= 0) {
+            output.timed_out = true;
+            break;
+        }
+        if (output.text.size() >= max_size) {
+            output.truncated = true;
+            break;
+        }
+        pollfd pfd{fd, POLLIN, 0};
+        const int ready = ::poll(&pfd, 1, static_cast<int>(remaining.count()));
+        if (ready < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ready <= 0) {
+            output.timed_out = (ready == 0);
+            break;
+        }
+        const ssize_t bytes_read = ::read(fd, buffer.data(), std::min(buffer.size(), max_size - output.text.size()));
+        if (bytes_read < 0 && errno == EINTR) {
+            continue;
+        }
+        if (bytes_read <= 0) {
+            break;
+        }
+        output.text.append(buffer.data(), static_cast<std::size_t>(bytes_read));
+    }
+    ::close(fd);
+
+    // A child may close its output and keep running (e.g., "exec >/dev/null; sleep 60"), so the deadline still applies until it exits
+    int status = 0;
+    while (!output.timed_out && !output.truncated) {
+        const pid_t reaped = ::waitpid(pid, &status, WNOHANG);
+        if (reaped == pid || (reaped < 0 && errno != EINTR)) {
+            break;
+        }
+        if (std::chrono::steady_clock::now() >= deadline) {
+            output.timed_out = true;
+            break;
+        }
+        if (reaped == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    if (output.timed_out || output.truncated) {
+        ::kill(-pid, SIGKILL);
+        while (::waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+        }
+        return output;
+    }
+    if (WIFEXITED(status)) {
+        output.exit_code = WEXITSTATUS(status);
+    }
+    else if (WIFSIGNALED(status)) {
+        output.term_signal = WTERMSIG(status);
+    }
+
+    return output;
+}
+
 }  // namespace core::shell
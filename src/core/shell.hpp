@@ -6,11 +6,50 @@
 
 #pragma once
 
-#include <optional>  // for std::optional
-#include <string>    // for std::string
+#include <chrono>       // for std::chrono::milliseconds
+#include <cstddef>      // for std::size_t
+#include <optional>     // for std::optional
+#include <string>       // for std::string
+#include <sys/types.h>  // for pid_t
+#include <vector>       // for std::vector
 
 namespace core::shell {
 
+/**
+ * @brief Struct that represents how a command finished and what it printed.
+ */
+struct Output final {
+    /**
+     * @brief Standard output of the command, at most "max_size" bytes (e.g., "main\n").
+     */
+    std::string text;
+
+    /**
+     * @brief Exit status of the command (e.g., "0"), -1 if it was killed or terminated by a signal.
+     */
+    int exit_code = -1;
+
+    /**
+     * @brief Signal that terminated the command (e.g., "11" for a segmentation fault), 0 if it exited or was killed by us.
+     */
+    int term_signal = 0;
+
+    /**
+     * @brief Whether the command was killed because it did not finish before the timeout.
+     */
+    bool timed_out = false;
+
+    /**
+     * @brief Whether the command was killed because its output exceeded "max_size".
+     */
+    bool truncated = false;
+};
+
+/**
+ * @brief Default maximum number of bytes captured from a command.
+ */
+inline constexpr std::size_t default_max_size = 1024 * 1024;
+
 /**
  * @brief Get the output of a shell command as a string.
  *
@@ -22,4 +61,68 @@ namespace core::shell {
  */
 [[nodiscard]] std::optional<std::string> get_output(const std::string &command);
 
+/**
+ * @brief Get the output of a shell command as a string, giving up after a timeout.
+ *
+ * The command is run with "/bin/sh -c" in its own process group, with stdin and stderr redirected to "/dev/null". If it does not finish in time, the whole process group is killed.
+ *
+ * @param command Command to run (e.g., "/bin/zsh --version").
+ * @param timeout Maximum time to wait for the command to finish (e.g., "1000ms").
+ *
+ * @return Output of the command if succeeded (e.g., "zsh 5.9 (arm64-apple-darwin23.0)"), std::nullopt otherwise.
+ *
+ * @note std::nullopt is returned if the command fails to execute, times out, or the output is empty.
+ */
+[[nodiscard]] std::optional<std::string> get_output(const std::string &command,
+                                                    const std::chrono::milliseconds timeout);
+
+/**
+ * @brief Run a shell command with a timeout and a bound on the captured output.
+ *
+ * The command is run like get_output() with a timeout. Once "max_size" bytes have been read, the process group is killed rather than drained, so a runaway command costs neither time nor memory.
+ *
+ * @param command Command to run (e.g., "git branch --show-current").
+ * @param timeout Maximum time to wait for the command to finish (e.g., "1000ms").
+ * @param max_size Maximum number of bytes to capture (e.g., "4096").
+ *
+ * @return Output and exit status of the command if it could be started, std::nullopt otherwise.
+ */
+[[nodiscard]] std::optional<Output> run(const std::string &command,
+                                        const std::chrono::milliseconds timeout,
+                                        const std::size_t max_size = default_max_size);
+
+/**
+ * @brief Run an executable with a timeout and a bound on the captured output, without a shell.
+ *
+ * The executable is run like run(), in its own process group with stdin and stderr redirected to "/dev/null", and its arguments are passed as they are.
+ *
+ * @param path Path to the executable (e.g., "/usr/local/bin/applefetch").
+ * @param arguments Arguments, starting with the name of the program (e.g., {"applefetch", "--version"}).
+ * @param timeout Maximum time to wait for the executable to finish (e.g., "1000ms").
+ * @param max_size Maximum number of bytes to capture (e.g., "4096").
+ *
+ * @return Output and exit status of the executable if it could be started, std::nullopt otherwise.
+ */
+[[nodiscard]] std::optional<Output> spawn(const std::string &path,
+                                          const std::vector<std::string> &arguments,
+                                          const std::chrono::milliseconds timeout,
+                                          const std::size_t max_size = default_max_size);
+
+/**
+ * @brief Read the output of a child process until it closes it, then reap the child.
+ *
+ * If the deadline passes or "max_size" bytes were read first, the process group of the child is killed. The deadline also covers a child that closes its output and keeps running.
+ *
+ * @param pid Child process, leader of its own process group.
+ * @param fd Read end of a pipe connected to the output of the child; it is closed by this function.
+ * @param timeout Maximum time to wait for the child to finish (e.g., "1000ms").
+ * @param max_size Maximum number of bytes to read (e.g., "4096").
+ *
+ * @return Output and exit status of the child.
+ */
+[[nodiscard]] Output wait_for_output(const pid_t pid,
+                                     const int fd,
+                                     const std::chrono::milliseconds timeout,
+                                     const std::size_t max_size);
+
 }  // namespace core::shell
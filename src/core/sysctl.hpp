@@ -6,12 +6,17 @@
 
 #pragma once
 
+#include <array>         // for std::array
+#include <cerrno>        // for errno, ENOMEM
 #include <cstddef>       // for std::size_t
+#include <cstring>       // for std::memcpy
 #include <optional>      // for std::optional, std::nullopt
 #include <string>        // for std::string
-#include <sys/sysctl.h>  // for ::sysctl, ::sysctlbyname
+#include <sys/sysctl.h>  // for ::sysctl, ::sysctlbyname, CTL_MAXNAME
 #include <type_traits>   // for std::is_arithmetic_v, std::is_standard_layout_v, std::is_trivial_v
 
+#include "profile.hpp"
+
 namespace core::sysctl {
 
 /**
@@ -30,6 +35,7 @@ template <typename T>
     // Compile-time check for arithmetic type
     static_assert(std::is_arithmetic_v<T>, "get_value() requires an arithmetic type");
 
+    const core::profile::Scope scope("core::sysctl::get_value");
     T value{};
     std::size_t size = sizeof(T);
 
@@ -51,6 +57,7 @@ template <typename T>
  */
 [[nodiscard]] inline std::optional<std::string> get_value(const std::string &name)
 {
+    const core::profile::Scope scope("core::sysctl::get_value");
     std::size_t size = 0;
     // First call with nullptr to determine required buffer size
     if (::sysctlbyname(name.c_str(), nullptr, &size, nullptr, 0) != 0) {
@@ -92,6 +99,7 @@ template <typename T>
     // A POD type in C++ is a type that is compatible with C-style data structures
     static_assert(std::is_standard_layout_v<T> && std::is_trivial_v<T>, "get_value() requires a POD type");
 
+    const core::profile::Scope scope("core::sysctl::get_value");
     T value{};
     std::size_t size = sizeof(T);
 
@@ -102,4 +110,132 @@ template <typename T>
     return value;
 }
 
+/**
+ * @brief Struct that represents the numeric name (OID) of a sysctl variable (e.g., {1, 1} for "kern.ostype").
+ */
+struct Oid final {
+    /**
+     * @brief Components of the OID; only the first "size" are valid.
+     */
+    std::array<int, CTL_MAXNAME> parts{};
+
+    /**
+     * @brief Number of components (e.g., "2").
+     */
+    std::size_t size = 0;
+};
+
+/**
+ * @brief Get the OID that follows another one in the MIB tree, depth-first, skipping nodes.
+ *
+ * This uses the undocumented "sysctl.next" query ({0, 2, OID...}), which is also how "sysctl -a" walks the tree.
+ *
+ * @param oid OID to start after, or an empty OID to get the first variable.
+ *
+ * @return Next OID if any, std::nullopt at the end of the tree.
+ */
+[[nodiscard]] inline std::optional<Oid> get_next_oid(const Oid &oid)
+{
+    const core::profile::Scope scope("core::sysctl::get_next_oid");
+    std::array<int, CTL_MAXNAME + 2> query{0, 2};
+    std::size_t query_size = 2;
+    if (oid.size == 0) {
+        query[query_size++] = 1;
+    }
+    else {
+        std::memcpy(query.data() + 2, oid.parts.data(), oid.size * sizeof(int));
+        query_size += oid.size;
+    }
+    Oid next;
+    std::size_t size = sizeof(next.parts);
+    if (::sysctl(query.data(), static_cast<u_int>(query_size), next.parts.data(), &size, nullptr, 0) != 0) {
+        return std::nullopt;
+    }
+    next.size = size / sizeof(int);
+    return next;
+}
+
+/**
+ * @brief Get the name of a sysctl variable from its OID, using the "sysctl.name" query ({0, 1, OID...}).
+ *
+ * @param oid OID of the variable (e.g., {1, 1}).
+ * @param buffer Buffer to write the null-terminated name to.
+ * @param buffer_size Size of the buffer in bytes.
+ *
+ * @return True if succeeded, false otherwise.
+ */
+[[nodiscard]] inline bool get_oid_name(const Oid &oid,
+                                       char *buffer,
+                                       std::size_t buffer_size)
+{
+    const core::profile::Scope scope("core::sysctl::get_oid_name");
+    std::array<int, CTL_MAXNAME + 2> query{0, 1};
+    std::memcpy(query.data() + 2, oid.parts.data(), oid.size * sizeof(int));
+    return ::sysctl(query.data(), static_cast<u_int>(oid.size + 2), buffer, &buffer_size, nullptr, 0) == 0;
+}
+
+/**
+ * @brief Get the kind and format of a sysctl variable from its OID, using the "sysctl.oidfmt" query ({0, 4, OID...}).
+ *
+ * @param oid OID of the variable (e.g., {1, 21} for "kern.boottime").
+ * @param kind Kind of the variable, whose CTLTYPE bits are its type (e.g., CTLTYPE_STRUCT).
+ * @param format Buffer to write the null-terminated format to (e.g., "S,timeval").
+ * @param format_size Size of the buffer in bytes.
+ *
+ * @return True if succeeded, false otherwise.
+ */
+[[nodiscard]] inline bool get_oid_format(const Oid &oid,
+                                         unsigned int &kind,
+                                         char *format,
+                                         const std::size_t format_size)
+{
+    const core::profile::Scope scope("core::sysctl::get_oid_format");
+    std::array<int, CTL_MAXNAME + 2> query{0, 4};
+    std::memcpy(query.data() + 2, oid.parts.data(), oid.size * sizeof(int));
+    std::array<char, sizeof(unsigned int) + 64> buffer{};
+    std::size_t size = buffer.size();
+    if (::sysctl(query.data(), static_cast<u_int>(oid.size + 2), buffer.data(), &size, nullptr, 0) != 0 || size < sizeof(unsigned int)) {
+        return false;
+    }
+    std::memcpy(&kind, buffer.data(), sizeof(unsigned int));
+    std::size_t length = 0;
+    for (; length + 1 < format_size && sizeof(unsigned int) + length < size && buffer[sizeof(unsigned int) + length] != '\0'; ++length) {
+        format[length] = buffer[sizeof(unsigned int) + length];
+    }
+    format[length] = '\0';
+    return true;
+}
+
+/**
+ * @brief Get the raw value of a sysctl variable from its OID.
+ *
+ * @param oid OID of the variable.
+ * @param value String to replace with the raw bytes of the value, reusing its capacity.
+ *
+ * @return True if succeeded, false otherwise (e.g., the variable is write-only).
+ */
+[[nodiscard]] inline bool get_raw_value(const Oid &oid,
+                                        std::string &value)
+{
+    const core::profile::Scope scope("core::sysctl::get_raw_value");
+    auto *mib = const_cast<int *>(oid.parts.data());
+    const auto mib_len = static_cast<u_int>(oid.size);
+    for (int attempt = 0; attempt < 3; ++attempt) {
+        // The size may grow between the two calls (e.g., a process table), so retry if it no longer fits
+        std::size_t size = 0;
+        if (::sysctl(mib, mib_len, nullptr, &size, nullptr, 0) != 0) {
+            return false;
+        }
+        value.resize(size);
+        if (::sysctl(mib, mib_len, value.data(), &size, nullptr, 0) == 0) {
+            value.resize(size);
+            return true;
+        }
+        if (errno != ENOMEM) {
+            return false;
+        }
+    }
+    return false;
+}
+
 }  // namespace core::sysctl
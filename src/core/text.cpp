@@ -0,0 +1,287 @@
+/**
+ * @file text.cpp
+ */
+
+#include <algorithm>    // for std::min
+#include <array>        // for std::array
+#include <cmath>        // for std::fabs, std::floor, std::frexp, std::isfinite, std::ldexp, std::log10, std::signbit
+#include <cstddef>      // for std::size_t
+#include <cstdint>      // for std::int64_t, std::uint64_t, UINT64_MAX
+#include <cstdio>       // for std::snprintf
+#include <optional>     // for std::optional, std::nullopt
+#include <string>       // for std::string
+#include <string_view>  // for std::string_view
+
+#include "text.hpp"
+
+namespace core::text {
+
+namespace {
+
+/**
+ * @brief Decimal digits of every number from 0 to 99, so that integers are written two digits at a time.
+ */
+constexpr std::array<char, 200> digit_pairs = []() {
+    std::array<char, 200> pairs{};
+    for (std::size_t i = 0; i < 100; ++i) {
+        pairs[2 * i] = static_cast<char>('0' + i / 10);
+        pairs[2 * i + 1] = static_cast<char>('0' + i % 10);
+    }
+    return pairs;
+}();
+
+/**
+ * @brief Powers of ten that fit in 32 bits, the scales supported by round_scaled().
+ */
+constexpr std::array<std::uint64_t, 10> powers_of_ten = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+
+/**
+ * @brief Write an unsigned integer right-aligned at the end of a buffer.
+ *
+ * @param value Value to write (e.g., "1536").
+ * @param end End of the buffer, which must have room for 20 digits.
+ *
+ * @return Start of the digits.
+ */
+[[nodiscard]] char *write_digits(std::uint64_t value,
+                                 char *end) noexcept
+{
+    while (value >= 100) {
+        const std::size_t pair = static_cast<std::size_t>(value % 100) * 2;
+        value /= 100;
+        *--end = digit_pairs[pair + 1];
+        *--end = digit_pairs[pair];
+    }
+    if (value >= 10) {
+        const std::size_t pair = static_cast<std::size_t>(value) * 2;
+        *--end = digit_pairs[pair + 1];
+        *--end = digit_pairs[pair];
+    }
+    else {
+        *--end = static_cast<char>('0' + value);
+    }
+    return end;
+}
+
+/**
+ * @brief Round a non-negative number times a power of ten to an integer, exactly and half to even.
+ *
+ * The double is split into its 53-bit mantissa and binary exponent, the mantissa is multiplied by the power of ten in 128 bits, and the result is shifted by the exponent, so that no step is inexact.
+ *
+ * @param magnitude Finite, non-negative number (e.g., "11.138").
+ * @param scale Power of ten to multiply by, from 0 to 9 (e.g., "2").
+ *
+ * @return Rounded product (e.g., "1114"), std::nullopt if it does not fit in 64 bits.
+ */
+[[nodiscard]] std::optional<std::uint64_t> round_scaled(const double magnitude,
+                                                        const std::size_t scale) noexcept
+{
+    int exponent = 0;
+    const double fraction = std::frexp(magnitude, &exponent);
+    const auto mantissa = static_cast<std::uint64_t>(std::ldexp(fraction, 53));
+    exponent -= 53;
+
+    // The product is below 2^83, so it is kept as two 64-bit halves
+    const std::uint64_t factor = powers_of_ten[scale];
+    const std::uint64_t low_product = (mantissa & 0xFFFFFFFFULL) * factor;
+    const std::uint64_t high_product = (mantissa >> 32) * factor;
+    const std::uint64_t low = low_product + (high_product << 32);
+    const std::uint64_t high = (high_product >> 32) + (low < low_product ? 1 : 0);
+
+    if (exponent >= 0) {
+        if (high != 0 || exponent >= 64 || (exponent > 0 && (low >> (64 - exponent)) != 0)) {
+            return std::nullopt;
+        }
+        return low << exponent;
+    }
+    const auto shift = static_cast<std::size_t>(-exponent);
+    if (shift >= 128) {
+        return 0;
+    }
+
+    // Keep the bits above the shift, then round on the first bit below it and whether any bit below that one is set
+    const auto get_bit = [high, low](const std::size_t index) -> bool {
+        return index < 64 ? ((low >> index) & 1) != 0 : ((high >> (index - 64)) & 1) != 0;
+    };
+    const auto has_bits_below = [high, low](const std::size_t index) -> bool {
+        if (index <= 64) {
+            return index == 64 ? low != 0 : (low & ((1ULL << index) - 1)) != 0;
+        }
+        return low != 0 || (high & ((1ULL << (index - 64)) - 1)) != 0;
+    };
+    std::uint64_t quotient = 0;
+    if (shift < 64) {
+        if ((high >> shift) != 0) {
+            return std::nullopt;
+        }
+        quotient = (low >> shift) | (high << (64 - shift));
+    }
+    else {
+        quotient = high >> (shift - 64);
+    }
+    if (get_bit(shift - 1) && (has_bits_below(shift - 1) || (quotient & 1) != 0)) {
+        if (quotient == UINT64_MAX) {
+            return std::nullopt;
+        }
+        ++quotient;
+    }
+    return quotient;
+}
+
+/**
+ * @brief Append a scaled integer as a decimal number (e.g., "1114" with 2 decimals is "11.14").
+ *
+ * @param negative Whether to prepend a minus sign.
+ * @param scaled Number times 10 to the power of decimals.
+ * @param decimals Number of decimals.
+ * @param output String to append to.
+ */
+void append_scaled(const bool negative,
+                   const std::uint64_t scaled,
+                   const std::size_t decimals,
+                   std::string &output)
+{
+    std::array<char, 32> buffer;
+    char *const end = buffer.data() + buffer.size();
+    char *start = write_digits(scaled, end);
+    while (static_cast<std::size_t>(end - start) <= decimals) {
+        *--start = '0';
+    }
+    if (negative) {
+        output.push_back('-');
+    }
+    const std::size_t length = static_cast<std::size_t>(end - start);
+    output.append(start, length - decimals);
+    if (decimals > 0) {
+        output.push_back('.');
+        output.append(end - decimals, decimals);
+    }
+}
+
+/**
+ * @brief Append a number formatted by std::snprintf(), for the values outside the range of the exact path (e.g., "1e+20" or "inf").
+ *
+ * @param value Value to append.
+ * @param precision Number of decimals if fixed, ignored otherwise.
+ * @param fixed Whether to format like "%.*f", as opposed to "%g".
+ * @param output String to append to.
+ */
+void append_printf(const double value,
+                   const int precision,
+                   const bool fixed,
+                   std::string &output)
+{
+    std::array<char, 512> buffer;
+    const int length = fixed ? std::snprintf(buffer.data(), buffer.size(), "%.*f", precision, value) : std::snprintf(buffer.data(), buffer.size(), "%g", value);
+    if (length > 0) {
+        output.append(buffer.data(), std::min(static_cast<std::size_t>(length), buffer.size() - 1));
+    }
+}
+
+}  // namespace
+
+void append_unsigned(const std::uint64_t value,
+                     std::string &output)
+{
+    std::array<char, 20> buffer;
+    char *const end = buffer.data() + buffer.size();
+    const char *start = write_digits(value, end);
+    output.append(start, static_cast<std::size_t>(end - start));
+}
+
+void append_signed(const std::int64_t value,
+                   std::string &output)
+{
+    // The magnitude is computed in unsigned arithmetic, so that the minimum value does not overflow
+    if (value < 0) {
+        output.push_back('-');
+        append_unsigned(0 - static_cast<std::uint64_t>(value), output);
+    }
+    else {
+        append_unsigned(static_cast<std::uint64_t>(value), output);
+    }
+}
+
+void append_hex(const std::uint64_t value,
+                const std::size_t width,
+                std::string &output)
+{
+    constexpr std::string_view digits = "0123456789abcdef";
+    std::array<char, 16> buffer;
+    char *const end = buffer.data() + buffer.size();
+    char *start = end;
+    std::uint64_t remaining = value;
+    do {
+        *--start = digits[remaining & 0xF];
+        remaining >>= 4;
+    } while (remaining != 0);
+    const auto length = static_cast<std::size_t>(end - start);
+    if (width > length) {
+        output.append(width - length, '0');
+    }
+    output.append(start, length);
+}
+
+void append_fixed(const double value,
+                  const int precision,
+                  std::string &output)
+{
+    const auto scaled = std::isfinite(value) && precision >= 0 && precision < static_cast<int>(powers_of_ten.size()) ? round_scaled(std::fabs(value), static_cast<std::size_t>(precision)) : std::nullopt;
+    if (!scaled) {
+        append_printf(value, precision, true, output);
+        return;
+    }
+    append_scaled(std::signbit(value), *scaled, static_cast<std::size_t>(precision), output);
+}
+
+void append_general(const double value,
+                    std::string &output)
+{
+    if (!std::isfinite(value)) {
+        append_printf(value, 0, false, output);
+        return;
+    }
+    if (value == 0.0) {
+        output.append(std::signbit(value) ? "-0" : "0");
+        return;
+    }
+
+    // The decimal exponent is the one of the value rounded to 6 digits, so a first guess is corrected by the rounding
+    const double magnitude = std::fabs(value);
+    int exponent = static_cast<int>(std::floor(std::log10(magnitude)));
+    std::optional<std::uint64_t> scaled;
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        if (exponent < -4 || exponent > 5) {
+            break;
+        }
+        scaled = round_scaled(magnitude, static_cast<std::size_t>(5 - exponent));
+        if (scaled && *scaled >= 1000000) {
+            ++exponent;
+        }
+        else if (scaled && *scaled < 100000) {
+            --exponent;
+        }
+        else {
+            break;
+        }
+        scaled = std::nullopt;
+    }
+
+    // Outside of [1e-4, 1e6), the value is printed in scientific notation, which is left to std::snprintf()
+    if (!scaled) {
+        append_printf(value, 0, false, output);
+        return;
+    }
+    const std::size_t start = output.size();
+    append_scaled(std::signbit(value), *scaled, static_cast<std::size_t>(5 - exponent), output);
+    if (output.find('.', start) != std::string::npos) {
+        while (output.back() == '0') {
+            output.pop_back();
+        }
+        if (output.back() == '.') {
+            output.pop_back();
+        }
+    }
+}
+
+}  // namespace core::text
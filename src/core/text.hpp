@@ -0,0 +1,88 @@
+/**
+ * @file text.hpp
+ *
+ * @brief Append numbers to strings without a formatting library, for the output path of a fetch.
+ *
+ * Every function produces exactly the bytes of the corresponding fmt format specification, so that values read the same whichever path formatted them.
+ */
+
+#pragma once
+
+#include <cstddef>      // for std::size_t
+#include <cstdint>      // for std::int64_t, std::uint64_t
+#include <string>       // for std::string
+#include <type_traits>  // for std::is_signed_v
+
+namespace core::text {
+
+/**
+ * @brief Append an unsigned integer in decimal, like "{}".
+ *
+ * @param value Value to append (e.g., "1536").
+ * @param output String to append to.
+ */
+void append_unsigned(const std::uint64_t value,
+                     std::string &output);
+
+/**
+ * @brief Append a signed integer in decimal, like "{}".
+ *
+ * @param value Value to append (e.g., "-42").
+ * @param output String to append to.
+ */
+void append_signed(const std::int64_t value,
+                   std::string &output);
+
+/**
+ * @brief Append an integer of any type in decimal, like "{}", for system types whose signedness differs between platforms (e.g., "dev_t").
+ *
+ * @tparam Integer Type of the integer.
+ * @param value Value to append (e.g., "16777231").
+ * @param output String to append to.
+ */
+template <typename Integer>
+void append_integer(const Integer value,
+                    std::string &output)
+{
+    if constexpr (std::is_signed_v<Integer>) {
+        append_signed(static_cast<std::int64_t>(value), output);
+    }
+    else {
+        append_unsigned(static_cast<std::uint64_t>(value), output);
+    }
+}
+
+/**
+ * @brief Append an unsigned integer in lowercase hexadecimal, padded with zeros, like "{:0Nx}".
+ *
+ * @param value Value to append (e.g., "0x3e9b").
+ * @param width Minimum number of digits (e.g., "16").
+ * @param output String to append to.
+ */
+void append_hex(const std::uint64_t value,
+                const std::size_t width,
+                std::string &output);
+
+/**
+ * @brief Append a floating-point number with a fixed number of decimals, like "{:.Nf}".
+ *
+ * The value is rounded exactly, half to even, from its binary representation, as printf() and fmt do.
+ *
+ * @param value Value to append (e.g., "11.138").
+ * @param precision Number of decimals (e.g., "2" for "11.14").
+ * @param output String to append to.
+ */
+void append_fixed(const double value,
+                  const int precision,
+                  std::string &output);
+
+/**
+ * @brief Append a floating-point number with up to 6 significant digits and without trailing zeros, like "{:g}".
+ *
+ * @param value Value to append (e.g., "1.5", "0.333333").
+ * @param output String to append to.
+ */
+void append_general(const double value,
+                    std::string &output);
+
+}  // namespace core::text
@@ -0,0 +1,66 @@
+/**
+ * @file thread.hpp
+ *
+ * @brief Run work on other threads.
+ */
+
+#pragma once
+
+#include <thread>   // for std::thread
+#include <utility>  // for std::forward
+
+namespace core::thread {
+
+/**
+ * @brief Class that runs a function on a thread and joins it when it goes out of scope, so that an exception thrown meanwhile does not destroy a joinable thread.
+ *
+ * @note This class is marked as `final` to prevent inheritance.
+ */
+class JoiningThread final {
+  public:
+    /**
+     * @brief Start the thread.
+     *
+     * @tparam Function Type of the function.
+     * @param function Function to run, which must not throw.
+     */
+    template <typename Function>
+    explicit JoiningThread(Function &&function)
+        : thread_(std::forward<Function>(function))
+    {
+    }
+
+    /**
+     * @brief Wait for the thread, if it was not joined yet.
+     */
+    ~JoiningThread()
+    {
+        this->join();
+    }
+
+    // Disable copy semantics, as a thread can only be joined once
+    JoiningThread(const JoiningThread &) = delete;
+    JoiningThread &operator=(const JoiningThread &) = delete;
+
+    // Allow moving into a container, but not assigning over a running thread
+    JoiningThread(JoiningThread &&) noexcept = default;
+    JoiningThread &operator=(JoiningThread &&) = delete;
+
+    /**
+     * @brief Wait for the thread.
+     */
+    void join()
+    {
+        if (this->thread_.joinable()) {
+            this->thread_.join();
+        }
+    }
+
+  private:
+    /**
+     * @brief Thread that runs the function.
+     */
+    std::thread thread_;
+};
+
+}  // namespace core::thread
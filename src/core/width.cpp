@@ -0,0 +1,100 @@
+/**
+ * @file width.cpp
+ */
+
+#include <cstddef>      // for std::size_t
+#include <cstdint>      // for std::uint64_t
+#include <cstring>      // for std::memcpy
+#include <string>       // for std::string
+#include <string_view>  // for std::string_view
+
+#include "width.hpp"
+
+namespace core::width {
+
+namespace {
+
+/**
+ * @brief Word with every byte set to 1, to broadcast a byte to all lanes.
+ */
+constexpr std::uint64_t ones = 0x0101010101010101ULL;
+
+/**
+ * @brief Word with the high bit of every byte set.
+ */
+constexpr std::uint64_t high_bits = 0x8080808080808080ULL;
+
+/**
+ * @brief Find the bytes of a word that are not printable ASCII, i.e., outside of space to "~".
+ *
+ * Subtracting a broadcast byte borrows into the high bit of every lane below it; masking with the complement of the word keeps only lanes that were below 0x80 to begin with. A borrow can spill into the next lane and flag it too, but only above a lane that is flagged anyway, so the lowest flag is always exact.
+ *
+ * @param word Eight bytes, loaded in native order.
+ *
+ * @return Word with the high bit set in the lane of every such byte, and maybe some lanes above them; zero if all bytes are printable.
+ */
+[[nodiscard]] constexpr std::uint64_t get_unprintable(const std::uint64_t word) noexcept
+{
+    const std::uint64_t below_space = (word - ones * 0x20) & ~word;
+    const std::uint64_t del = word ^ (ones * 0x7F);
+    const std::uint64_t is_del = (del - ones) & ~del;
+    return (word | below_space | is_del) & high_bits;
+}
+
+/**
+ * @brief Count the printable bytes at the start of a word, from the lowest flag of get_unprintable().
+ *
+ * @param unprintable Result of get_unprintable(), not zero.
+ *
+ * @return Number of bytes before the first one that is not printable (e.g., "3").
+ */
+[[nodiscard]] std::size_t count_printable(const std::uint64_t unprintable) noexcept
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    return static_cast<std::size_t>(__builtin_ctzll(unprintable)) / 8;
+#else
+    // The first byte is the highest lane here, whose flag may come from a borrow, so the decoder takes over from it
+    static_cast<void>(unprintable);
+    return 0;
+#endif
+}
+
+}  // namespace
+
+std::size_t get_width(const std::string_view text) noexcept
+{
+    std::size_t width = 0;
+    std::size_t i = 0;
+    while (i < text.size()) {
+        if (i + sizeof(std::uint64_t) <= text.size()) {
+            std::uint64_t word;
+            std::memcpy(&word, text.data() + i, sizeof(word));
+            const std::uint64_t unprintable = get_unprintable(word);
+            if (unprintable == 0) {
+                width += sizeof(word);
+                i += sizeof(word);
+                continue;
+            }
+
+            // Printable bytes before the first other one are counted at once, so that only that character is decoded
+            const std::size_t printable = count_printable(unprintable);
+            width += printable;
+            i += printable;
+        }
+        width += detail::step(text, i);
+    }
+    return width;
+}
+
+void append_padded(const std::string_view text,
+                   const std::size_t columns,
+                   std::string &output)
+{
+    output.append(text);
+    const std::size_t width = get_width(text);
+    if (width < columns) {
+        output.append(columns - width, ' ');
+    }
+}
+
+}  // namespace core::width
@@ -0,0 +1,223 @@
+/**
+ * @file width.hpp
+ *
+ * @brief Measure how many terminal columns a UTF-8 string occupies, skipping ANSI escape sequences.
+ */
+
+#pragma once
+
+#include <array>        // for std::array
+#include <cstddef>      // for std::size_t
+#include <string>       // for std::string
+#include <string_view>  // for std::string_view
+
+#include "width_tables.hpp"
+
+namespace core::width {
+
+/**
+ * @brief Check whether a codepoint is in a table of sorted ranges, with a binary search.
+ *
+ * @tparam Size Number of ranges in the table.
+ * @param codepoint Codepoint to look up (e.g., "U+4E00").
+ * @param ranges Table to search.
+ *
+ * @return True if a range contains the codepoint, false otherwise.
+ */
+template <std::size_t Size>
+[[nodiscard]] constexpr bool contains(const char32_t codepoint,
+                                      const std::array<Range, Size> &ranges) noexcept
+{
+    if (codepoint < ranges.front().first || codepoint > ranges.back().last) {
+        return false;
+    }
+    std::size_t low = 0;
+    std::size_t high = Size;
+    while (low < high) {
+        const std::size_t middle = low + (high - low) / 2;
+        if (codepoint > ranges[middle].last) {
+            low = middle + 1;
+        }
+        else if (codepoint < ranges[middle].first) {
+            high = middle;
+        }
+        else {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Get the number of terminal columns a codepoint occupies, like wcwidth() but the same on every platform.
+ *
+ * @param codepoint Codepoint to measure (e.g., "U+4E00").
+ *
+ * @return 0 for control, combining and format characters, 2 for wide and fullwidth characters, 1 otherwise.
+ */
+[[nodiscard]] constexpr std::size_t get_codepoint_width(const char32_t codepoint) noexcept
+{
+    if (codepoint < 0x20 || (codepoint >= 0x7F && codepoint < 0xA0)) {
+        return 0;
+    }
+    if (codepoint < 0x300) {
+        return 1;
+    }
+    // The tables are disjoint, so the shorter one is searched first
+    if (contains(codepoint, wide_ranges)) {
+        return 2;
+    }
+    return contains(codepoint, zero_ranges) ? 0 : 1;
+}
+
+namespace detail {
+
+/**
+ * @brief Get the position after an escape sequence.
+ *
+ * CSI sequences (e.g., colors, "ESC [ 1 ; 33 m") end with a byte from "@" to "~". OSC, DCS, APC and PM strings (e.g., hyperlinks, "ESC ] 8 ; ; URL ESC \") end with BEL or ST. Any other sequence is ESC, optional intermediate bytes and a final byte (e.g., "ESC 7", "ESC ( B").
+ *
+ * @param text Text to read.
+ * @param i Position of the ESC byte.
+ *
+ * @return Position of the first byte after the sequence, the end of the text if it is truncated.
+ */
+[[nodiscard]] constexpr std::size_t skip_escape(const std::string_view text,
+                                                std::size_t i) noexcept
+{
+    if (++i == text.size()) {
+        return i;
+    }
+    const char introducer = text[i++];
+    if (introducer == '[') {
+        while (i < text.size() && (text[i] < '@' || text[i] > '~')) {
+            ++i;
+        }
+        return i < text.size() ? i + 1 : i;
+    }
+    if (introducer == ']' || introducer == 'P' || introducer == '_' || introducer == '^') {
+        for (; i < text.size(); ++i) {
+            if (text[i] == '\a') {
+                return i + 1;
+            }
+            if (text[i] == '\033' && i + 1 < text.size() && text[i + 1] == '\\') {
+                return i + 2;
+            }
+        }
+        return i;
+    }
+    if (introducer >= ' ' && introducer <= '/') {
+        while (i < text.size() && text[i] >= ' ' && text[i] <= '/') {
+            ++i;
+        }
+        return i < text.size() ? i + 1 : i;
+    }
+    return i;
+}
+
+/**
+ * @brief Measure the character or escape sequence at a position, and move past it.
+ *
+ * Invalid UTF-8 (e.g., a stray continuation byte, an overlong or truncated sequence) takes one column per byte, like the replacement character a terminal would show.
+ *
+ * @param text Text to read.
+ * @param i Position to read, updated to the next one.
+ *
+ * @return Number of columns (e.g., "2").
+ */
+[[nodiscard]] constexpr std::size_t step(const std::string_view text,
+                                         std::size_t &i) noexcept
+{
+    const auto lead = static_cast<unsigned char>(text[i]);
+    if (lead == 0x1B) {
+        i = skip_escape(text, i);
+        return 0;
+    }
+    if (lead < 0x80) {
+        ++i;
+        return get_codepoint_width(lead);
+    }
+
+    // Reject the ranges of second bytes that would encode overlong forms, surrogates or values past U+10FFFF
+    std::size_t length = 0;
+    unsigned char low = 0x80;
+    unsigned char high = 0xBF;
+    if (lead >= 0xC2 && lead <= 0xDF) {
+        length = 2;
+    }
+    else if (lead >= 0xE0 && lead <= 0xEF) {
+        length = 3;
+        if (lead == 0xE0) {
+            low = 0xA0;
+        }
+        else if (lead == 0xED) {
+            high = 0x9F;
+        }
+    }
+    else if (lead >= 0xF0 && lead <= 0xF4) {
+        length = 4;
+        if (lead == 0xF0) {
+            low = 0x90;
+        }
+        else if (lead == 0xF4) {
+            high = 0x8F;
+        }
+    }
+    if (length == 0 || i + length > text.size()) {
+        ++i;
+        return 1;
+    }
+    auto codepoint = static_cast<char32_t>(lead & (0x7FU >> length));
+    for (std::size_t j = 1; j < length; ++j) {
+        const auto byte = static_cast<unsigned char>(text[i + j]);
+        if (byte < (j == 1 ? low : 0x80) || byte > (j == 1 ? high : 0xBF)) {
+            ++i;
+            return 1;
+        }
+        codepoint = (codepoint << 6) | (byte & 0x3FU);
+    }
+    i += length;
+    return get_codepoint_width(codepoint);
+}
+
+}  // namespace detail
+
+/**
+ * @brief Measure a string one character at a time, usable at compile time (e.g., for logos).
+ *
+ * @param text UTF-8 text, possibly with escape sequences (e.g., "\033[1mApple M1\033[0m").
+ *
+ * @return Number of terminal columns (e.g., "8").
+ */
+[[nodiscard]] constexpr std::size_t measure(const std::string_view text) noexcept
+{
+    std::size_t width = 0;
+    for (std::size_t i = 0; i < text.size();) {
+        width += detail::step(text, i);
+    }
+    return width;
+}
+
+/**
+ * @brief Measure a string, with a fast path for printable ASCII.
+ *
+ * Eight bytes are checked at once, as a 64-bit word, for any byte that is not printable ASCII (a control character, DEL, ESC or part of a multibyte sequence); words without one take eight columns. Only the characters of the other words are decoded and looked up, so long outputs that are mostly ASCII (e.g., inventories, package lists) cost about one comparison per eight bytes.
+ *
+ * @param text UTF-8 text, possibly with escape sequences (e.g., "Apple M1 Pro").
+ *
+ * @return Number of terminal columns (e.g., "12"), the same as measure().
+ */
+[[nodiscard]] std::size_t get_width(const std::string_view text) noexcept;
+
+/**
+ * @brief Append a string, then spaces up to a number of terminal columns, like "{:<N}" but by display width rather than by codepoint.
+ *
+ * @param text Text to append (e.g., "日本語").
+ * @param columns Number of columns to fill (e.g., "8"); nothing is added to text that is already as wide.
+ * @param output String to append to (e.g., "日本語  ").
+ */
+void append_padded(const std::string_view text,
+                   const std::size_t columns,
+                   std::string &output);
+
+}  // namespace core::width
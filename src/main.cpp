@@ -2,13 +2,14 @@
  * @file main.cpp
  */
 
-#include <cstdlib>    // for EXIT_FAILURE, EXIT_SUCCESS
-#include <exception>  // for std::exception
-
-#include <fmt/core.h>
+#include <cstdio>       // for std::fputs, stdout, stderr
+#include <cstdlib>      // for EXIT_FAILURE, EXIT_SUCCESS
+#include <exception>    // for std::exception
+#include <string_view>  // for std::string_view
 
 #include "app.hpp"
 #include "core/args.hpp"
+#include "modules/plugins.hpp"
 
 /**
  * @brief Entry-point of the application.
@@ -22,24 +23,30 @@ int main(int argc,
          char **argv)
 {
     try {
-        // Parse command-line arguments, but do not pass them, as this class only checks for "--help" or "--version"
-        core::args::Args(argc, argv);
+        // Isolated plugins are probed by a new process of this executable, which only prints their values
+        if (argc > 1 && std::string_view(argv[1]) == modules::plugins::host_argument) {
+            return modules::plugins::run_host(argc, argv);
+        }
+
+        // Parse command-line arguments, which throws on "--help", "--version" or invalid arguments
+        const core::args::Args args(argc, argv);
 
-        // Run the application
-        app::run();
+        // Run the application, whose exit code reports drift for "diff"
+        return app::run(args);
     }
     catch (const core::args::ArgsMessage &e) {
         // User requested help or version
-        fmt::print("{}\n", e.what());
+        std::fputs(e.what(), stdout);
+        std::fputs("\n", stdout);
         return EXIT_SUCCESS;
     }
     catch (const std::exception &e) {
-        fmt::print(stderr, "{}\n", e.what());
+        std::fputs(e.what(), stderr);
+        std::fputs("\n", stderr);
         return EXIT_FAILURE;
     }
     catch (...) {
-        fmt::print(stderr, "Error: Unknown\n");
+        std::fputs("Error: Unknown\n", stderr);
         return EXIT_FAILURE;
     }
-    return EXIT_SUCCESS;
 }
@@ -0,0 +1,188 @@
+/**
+ * @file cgroup.cpp
+ */
+
+#include <algorithm>     // for std::min
+#include <array>         // for std::array
+#include <charconv>      // for std::from_chars
+#include <cstddef>       // for std::size_t
+#include <cstdint>       // for std::uint64_t
+#include <fcntl.h>       // for ::open, O_RDONLY, O_CLOEXEC
+#include <filesystem>    // for std::filesystem
+#include <fstream>       // for std::ifstream
+#include <optional>      // for std::optional, std::nullopt
+#include <string>        // for std::string, std::getline
+#include <string_view>   // for std::string_view
+#include <sys/types.h>   // for ssize_t
+#include <system_error>  // for std::errc
+#include <unistd.h>      // for ::read, ::close
+
+#include "cgroup.hpp"
+
+namespace modules::cgroup {
+
+namespace {
+
+/**
+ * @brief Size of the buffer that holds all controller files of a sample; "memory.stat" is about 1.5 KiB.
+ */
+constexpr std::size_t buffer_size = 16384;
+
+/**
+ * @brief Read a whole file into a buffer.
+ *
+ * @param path Null-terminated path to the file (e.g., "/sys/fs/cgroup/memory.max").
+ * @param buffer Buffer to read into.
+ * @param size Size of the buffer in bytes.
+ *
+ * @return Number of bytes read if succeeded, std::nullopt otherwise (e.g., the file does not exist).
+ */
+[[nodiscard]] std::optional<std::size_t> read_file(const char *path,
+                                                   char *buffer,
+                                                   const std::size_t size) noexcept
+{
+    const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return std::nullopt;
+    }
+    std::size_t length = 0;
+    for (ssize_t bytes_read; length < size && (bytes_read = ::read(fd, buffer + length, size - length)) > 0;) {
+        length += static_cast<std::size_t>(bytes_read);
+    }
+    ::close(fd);
+    return length;
+}
+
+/**
+ * @brief Parse an unsigned number at the start of a text.
+ *
+ * @param text Text to parse (e.g., "4294967296\n").
+ *
+ * @return Number if succeeded (e.g., "4294967296"), std::nullopt otherwise (e.g., "max").
+ */
+[[nodiscard]] std::optional<std::uint64_t> parse_number(const std::string_view text) noexcept
+{
+    std::uint64_t value = 0;
+    if (std::from_chars(text.data(), text.data() + text.size(), value).ec != std::errc()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+/**
+ * @brief Find the value of a key in a flat keyed file (e.g., "memory.stat", "cpu.stat").
+ *
+ * @param text Contents of the file (e.g., "anon 1048576\nfile 268435456\n").
+ * @param key Key to find (e.g., "file").
+ *
+ * @return Value if found (e.g., "268435456"), 0 otherwise.
+ */
+[[nodiscard]] std::uint64_t find_key(const std::string_view text,
+                                     const std::string_view key) noexcept
+{
+    for (std::size_t start = 0; start < text.size();) {
+        const std::size_t end = std::min(text.find('\n', start), text.size());
+        const std::string_view line = text.substr(start, end - start);
+        if (line.size() > key.size() && line.compare(0, key.size(), key) == 0 && line[key.size()] == ' ') {
+            return parse_number(line.substr(key.size() + 1)).value_or(0);
+        }
+        start = end + 1;
+    }
+    return 0;
+}
+
+}  // namespace
+
+std::optional<std::filesystem::path> resolve_path(const std::filesystem::path &root,
+                                                  const std::filesystem::path &self_cgroup)
+{
+    // Version 1 hierarchies are listed as "<ID>:<CONTROLLERS>:<PATH>"; the unified one always has ID 0 and no controllers
+    std::ifstream file(self_cgroup);
+    for (std::string line; std::getline(file, line);) {
+        if (line.rfind("0::/", 0) != 0) {
+            continue;
+        }
+        const std::filesystem::path directory = root / std::string_view(line).substr(4);
+        if (!std::filesystem::exists(directory / "memory.current")) {
+            return std::nullopt;
+        }
+        return directory;
+    }
+    return std::nullopt;
+}
+
+Reader::Reader(const std::filesystem::path &directory)
+    : files_{(directory / "memory.current").string(),
+             (directory / "memory.max").string(),
+             (directory / "memory.stat").string(),
+             (directory / "cpu.max").string(),
+             (directory / "cpu.stat").string()}
+{
+}
+
+std::optional<Stats> Reader::read() const
+{
+    // Every file gets its own slice of the buffer, so that all of them are read before any is parsed
+    std::array<char, buffer_size> buffer;
+    std::array<std::string_view, 5> contents;
+    std::size_t used = 0;
+    for (std::size_t i = 0; i < this->files_.size(); ++i) {
+        const auto length = read_file(this->files_[i].c_str(), buffer.data() + used, buffer.size() - used);
+        if (!length && i < 3) {
+            return std::nullopt;
+        }
+        contents[i] = std::string_view(buffer.data() + used, length.value_or(0));
+        used += length.value_or(0);
+    }
+
+    Stats stats;
+    const auto current = parse_number(contents[0]);
+    if (!current) {
+        return std::nullopt;
+    }
+    stats.memory_current = *current;
+    stats.memory_max = parse_number(contents[1]);
+    stats.memory_inactive_file = find_key(contents[2], "inactive_file");
+
+    // "cpu.max" is "<QUOTA> <PERIOD>", where the quota is "max" if unlimited
+    const std::string_view cpu_max = contents[3];
+    if (const std::size_t space = cpu_max.find(' '); space != std::string_view::npos) {
+        stats.cpu_quota_us = parse_number(cpu_max);
+        stats.cpu_period_us = parse_number(cpu_max.substr(space + 1)).value_or(stats.cpu_period_us);
+    }
+    stats.cpu_usage_us = find_key(contents[4], "usage_usec");
+    stats.cpu_periods = find_key(contents[4], "nr_periods");
+    stats.cpu_throttled_periods = find_key(contents[4], "nr_throttled");
+    return stats;
+}
+
+const Reader *get_reader()
+{
+    static const std::optional<Reader> reader = []() -> std::optional<Reader> {
+        const auto directory = resolve_path("/sys/fs/cgroup", "/proc/self/cgroup");
+        if (!directory) {
+            return std::nullopt;
+        }
+        return Reader(*directory);
+    }();
+    return reader ? &*reader : nullptr;
+}
+
+const std::optional<Stats> &get_stats()
+{
+    static const std::optional<Stats> stats = []() -> std::optional<Stats> {
+        const Reader *reader = get_reader();
+        return reader ? reader->read() : std::nullopt;
+    }();
+    return stats;
+}
+
+std::optional<double> get_cpu_limit(const Stats &stats) noexcept
+{
+    if (!stats.cpu_quota_us || stats.cpu_period_us == 0) {
+        return std::nullopt;
+    }
+    return static_cast<double>(*stats.cpu_quota_us) / static_cast<double>(stats.cpu_period_us);
+}
+
+}  // namespace modules::cgroup
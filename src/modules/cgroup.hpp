@@ -0,0 +1,135 @@
+/**
+ * @file cgroup.hpp
+ *
+ * @brief Get the limits and usage of the cgroup v2 the process runs in (e.g., a container).
+ */
+
+#pragma once
+
+#include <array>       // for std::array
+#include <cstddef>     // for std::size_t
+#include <cstdint>     // for std::uint64_t
+#include <filesystem>  // for std::filesystem::path
+#include <optional>    // for std::optional
+#include <string>      // for std::string
+
+namespace modules::cgroup {
+
+/**
+ * @brief Struct that represents one sample of the memory and CPU controllers of a cgroup.
+ */
+struct Stats final {
+    /**
+     * @brief Memory charged to the cgroup in bytes, page cache included (e.g., "1288490188"), from "memory.current".
+     */
+    std::uint64_t memory_current = 0;
+
+    /**
+     * @brief Memory limit in bytes (e.g., "4294967296"), std::nullopt if unlimited, from "memory.max".
+     */
+    std::optional<std::uint64_t> memory_max;
+
+    /**
+     * @brief Page cache that can be reclaimed without swapping in bytes (e.g., "268435456"), from "inactive_file" in "memory.stat".
+     */
+    std::uint64_t memory_inactive_file = 0;
+
+    /**
+     * @brief CPU time the cgroup may use per period in microseconds (e.g., "200000" for 2 CPUs), std::nullopt if unlimited, from "cpu.max".
+     */
+    std::optional<std::uint64_t> cpu_quota_us;
+
+    /**
+     * @brief Length of a period in microseconds (e.g., "100000"), from "cpu.max".
+     */
+    std::uint64_t cpu_period_us = 100000;
+
+    /**
+     * @brief CPU time used since the cgroup was created in microseconds (e.g., "81234567"), from "usage_usec" in "cpu.stat".
+     */
+    std::uint64_t cpu_usage_us = 0;
+
+    /**
+     * @brief Number of periods with runnable threads (e.g., "1200"), from "nr_periods" in "cpu.stat".
+     */
+    std::uint64_t cpu_periods = 0;
+
+    /**
+     * @brief Number of periods in which the quota ran out (e.g., "36"), from "nr_throttled" in "cpu.stat".
+     */
+    std::uint64_t cpu_throttled_periods = 0;
+};
+
+/**
+ * @brief Resolve the cgroup v2 directory of a process.
+ *
+ * The unified hierarchy is the "0::" line of the cgroup file (e.g., "0::/system.slice/docker-4f3c.scope"), relative to where cgroup2 is mounted.
+ *
+ * @param root Mount point of the unified hierarchy (e.g., "/sys/fs/cgroup").
+ * @param self_cgroup Cgroup file of the process (e.g., "/proc/self/cgroup").
+ *
+ * @return Directory of the cgroup (e.g., "/sys/fs/cgroup/system.slice/docker-4f3c.scope") if succeeded, std::nullopt otherwise (e.g., cgroup v1 only, or not Linux).
+ */
+[[nodiscard]] std::optional<std::filesystem::path> resolve_path(const std::filesystem::path &root,
+                                                                const std::filesystem::path &self_cgroup);
+
+/**
+ * @brief Class that reads the controller files of one cgroup.
+ *
+ * The file paths are built once by the constructor, so that reading a sample does not allocate.
+ *
+ * @note This class is marked as `final` to prevent inheritance.
+ */
+class Reader final {
+  public:
+    /**
+     * @brief Construct a new Reader object.
+     *
+     * @param directory Directory of the cgroup (e.g., "/sys/fs/cgroup/system.slice/docker-4f3c.scope").
+     */
+    explicit Reader(const std::filesystem::path &directory);
+
+    /**
+     * @brief Read a sample of the cgroup.
+     *
+     * "memory.current", "memory.max", "memory.stat", "cpu.max" and "cpu.stat" are read back to back into one buffer before anything is parsed, so that the values are as close to a single point in time as cgroupfs allows.
+     *
+     * @return Sample if succeeded, std::nullopt otherwise (e.g., the memory controller is not enabled for the cgroup). Missing CPU files leave the CPU unlimited.
+     */
+    [[nodiscard]] std::optional<Stats> read() const;
+
+  private:
+    /**
+     * @brief Paths to "memory.current", "memory.max", "memory.stat", "cpu.max" and "cpu.stat", in that order.
+     */
+    std::array<std::string, 5> files_;
+};
+
+/**
+ * @brief Get the reader of the cgroup of this process.
+ *
+ * The cgroup is resolved from "/proc/self/cgroup" and "/sys/fs/cgroup" on first use, and kept for the lifetime of the process.
+ *
+ * @return Reader if the process runs in a cgroup v2 hierarchy, nullptr otherwise.
+ */
+[[nodiscard]] const Reader *get_reader();
+
+/**
+ * @brief Get the sample of the cgroup of this process that the modules of a fetch share.
+ *
+ * The files are read once, by the first caller, so that the CPU and memory fields of a fetch come from a single read. Refreshes (e.g., "--watch") read new samples with Reader::read().
+ *
+ * @return Sample if the process runs in a cgroup v2 hierarchy and it could be read, std::nullopt otherwise.
+ */
+[[nodiscard]] const std::optional<Stats> &get_stats();
+
+/**
+ * @brief Get the limit of a sample as a number of CPUs.
+ *
+ * @param stats Sample to read.
+ *
+ * @return Number of CPUs the quota allows (e.g., "2.5"), std::nullopt if unlimited.
+ */
+[[nodiscard]] std::optional<double> get_cpu_limit(const Stats &stats) noexcept;
+
+}  // namespace modules::cgroup
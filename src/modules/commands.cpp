@@ -0,0 +1,177 @@
+/**
+ * @file commands.cpp
+ */
+
+#include <charconv>      // for std::from_chars
+#include <chrono>        // for std::chrono
+#include <cstddef>       // for std::size_t
+#include <cstdint>       // for std::int64_t
+#include <string>        // for std::string
+#include <string_view>   // for std::string_view
+#include <system_error>  // for std::errc
+#include <thread>        // for std::thread
+#include <utility>       // for std::move
+#include <vector>        // for std::vector
+
+#include <fmt/core.h>
+
+#include "commands.hpp"
+#include "core/cache.hpp"
+#include "core/config.hpp"
+#include "core/shell.hpp"
+
+namespace modules::commands {
+
+namespace {
+
+/**
+ * @brief Get the current time as seconds since the epoch, which the cache stores expiry times in.
+ *
+ * @return Seconds since the epoch (e.g., "1722470400").
+ */
+[[nodiscard]] std::int64_t get_unix_time() noexcept
+{
+    return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Parse a duration entry of a command.
+ *
+ * @param section Section of the command.
+ * @param key Key of the entry (e.g., "timeout").
+ * @param fallback Duration if the entry is missing.
+ *
+ * @return Duration of the entry, "fallback" if it is missing.
+ *
+ * @throws core::config::ConfigError If the duration is invalid.
+ */
+[[nodiscard]] std::chrono::milliseconds get_duration(const core::config::Section &section,
+                                                     const std::string_view key,
+                                                     const std::chrono::milliseconds fallback)
+{
+    const auto text = section.get(key);
+    if (!text) {
+        return fallback;
+    }
+    const auto duration = core::config::parse_duration(*text);
+    if (!duration) {
+        throw core::config::ConfigError(fmt::format("Invalid config: [command {}] {} = {} (Expected a duration such as \"500ms\", \"2s\", \"5m\" or \"1h\")", section.name, key, *text));
+    }
+    return *duration;
+}
+
+/**
+ * @brief Run a command and turn its output into a value.
+ *
+ * @param command Command to run.
+ * @param succeeded Set to true if the value came from the output, false if it is an "Unknown" value.
+ *
+ * @return First line of the output without surrounding whitespace (e.g., "main"), "Unknown $TITLE ($REASON)" otherwise.
+ */
+[[nodiscard]] std::string run_command(const Command &command, bool &succeeded)
+{
+    succeeded = false;
+    const auto output = core::shell::run(command.run, command.timeout, max_output_size);
+    if (!output) {
+        return fmt::format("Unknown {} (Failed to run command)", command.title);
+    }
+    if (output->timed_out) {
+        return fmt::format("Unknown {} (Timed out after {} ms)", command.title, command.timeout.count());
+    }
+    if (!output->truncated && output->exit_code != 0) {
+        return output->exit_code < 0 ? fmt::format("Unknown {} (Killed by signal {})", command.title, output->term_signal)
+                                     : fmt::format("Unknown {} (Exited with status {})", command.title, output->exit_code);
+    }
+    std::string_view value(output->text);
+    value = value.substr(0, value.find('\n'));
+    while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) {
+        value.remove_prefix(1);
+    }
+    while (!value.empty() && (value.back() == ' ' || value.back() == '\t' || value.back() == '\r')) {
+        value.remove_suffix(1);
+    }
+    if (value.empty()) {
+        return fmt::format("Unknown {} (No output)", command.title);
+    }
+    succeeded = true;
+    return std::string(value);
+}
+
+/**
+ * @brief Get the value of a command from the cache, or run it and cache the value if it succeeded.
+ *
+ * @param command Command to run.
+ *
+ * @return Value of the command (e.g., "main").
+ */
+[[nodiscard]] std::string get_value(const Command &command)
+{
+    bool succeeded = false;
+    if (command.ttl.count() <= 0) {
+        return run_command(command, succeeded);
+    }
+
+    // Stored as "<expiry time>\n<value>"; changing the command changes the key, so a new command never sees an old value
+    const std::string cache_key = fmt::format("command:{}:{}", command.title, command.run);
+    const std::int64_t now = get_unix_time();
+    if (const auto cached = core::cache::load(cache_key)) {
+        std::int64_t expires_at = 0;
+        const auto [end, error] = std::from_chars(cached->data(), cached->data() + cached->size(), expires_at);
+        if (error == std::errc() && end != cached->data() + cached->size() && *end == '\n' && now < expires_at) {
+            return cached->substr(static_cast<std::size_t>(end - cached->data()) + 1);
+        }
+    }
+    std::string value = run_command(command, succeeded);
+    // A failure (e.g., a timeout while offline) is not stored, so the next fetch tries again instead of showing it for the whole TTL
+    if (succeeded) {
+        core::cache::store(cache_key, fmt::format("{}\n{}", now + command.ttl.count(), value));
+    }
+    return value;
+}
+
+}  // namespace
+
+std::vector<Command> get_commands(const std::vector<core::config::Section> &sections)
+{
+    std::vector<Command> commands;
+    for (const core::config::Section &section : sections) {
+        if (section.kind != "command") {
+            continue;
+        }
+        for (const auto &[key, value] : section.entries) {
+            if (key != "run" && key != "timeout" && key != "ttl") {
+                throw core::config::ConfigError(fmt::format("Invalid config: [command {}] {} (Unknown key, expected \"run\", \"timeout\" or \"ttl\")", section.name, key));
+            }
+        }
+        const auto run = section.get("run");
+        if (!run || run->empty()) {
+            throw core::config::ConfigError(fmt::format("Invalid config: [command {}] (Missing \"run\")", section.name));
+        }
+        Command command;
+        command.title = section.name;
+        command.run = std::string(*run);
+        command.timeout = get_duration(section, "timeout", command.timeout);
+        command.ttl = std::chrono::duration_cast<std::chrono::seconds>(get_duration(section, "ttl", command.ttl));
+        commands.push_back(std::move(command));
+    }
+    return commands;
+}
+
+std::vector<std::string> run_commands(const std::vector<Command> &commands)
+{
+    // Commands mostly wait on other processes, so every command gets its own thread regardless of the number of cores
+    std::vector<std::string> values(commands.size());
+    std::vector<std::thread> threads;
+    threads.reserve(commands.size());
+    for (std::size_t i = 0; i < commands.size(); ++i) {
+        threads.emplace_back([&commands, &values, i] {
+            values[i] = get_value(commands[i]);
+        });
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    return values;
+}
+
+}  // namespace modules::commands
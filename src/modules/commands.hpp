@@ -0,0 +1,72 @@
+/**
+ * @file commands.hpp
+ *
+ * @brief Run user-defined commands from the configuration file.
+ */
+
+#pragma once
+
+#include <chrono>   // for std::chrono::milliseconds, std::chrono::seconds
+#include <cstddef>  // for std::size_t
+#include <string>   // for std::string
+#include <vector>   // for std::vector
+
+#include "core/config.hpp"
+
+namespace modules::commands {
+
+/**
+ * @brief Maximum number of bytes captured from a command; a field only shows its first line.
+ */
+inline constexpr std::size_t max_output_size = 4096;
+
+/**
+ * @brief Struct that represents a user-defined command (e.g., "[command Branch]").
+ */
+struct Command final {
+    /**
+     * @brief Title of the field (e.g., "Branch").
+     */
+    std::string title;
+
+    /**
+     * @brief Shell command whose first line of output is the value (e.g., "git branch --show-current").
+     */
+    std::string run;
+
+    /**
+     * @brief Maximum time to wait for the command (e.g., "1000ms").
+     */
+    std::chrono::milliseconds timeout{1000};
+
+    /**
+     * @brief How long the value is reused from the cache before running the command again (e.g., "300s"), 0 to run it every time.
+     */
+    std::chrono::seconds ttl{0};
+};
+
+/**
+ * @brief Get the commands defined in the configuration file.
+ *
+ * Every "[command TITLE]" section defines a command with the keys "run" (required), "timeout" and "ttl" (durations such as "500ms", "2s", "5m" or "1h"). Other sections are ignored.
+ *
+ * @param sections Sections of the configuration file.
+ *
+ * @return Commands, in the order of the file.
+ *
+ * @throws core::config::ConfigError If a command has no "run", an unknown key or an invalid duration.
+ */
+[[nodiscard]] std::vector<Command> get_commands(const std::vector<core::config::Section> &sections);
+
+/**
+ * @brief Run commands concurrently, reusing cached values that have not expired.
+ *
+ * Every command runs in its own thread with its own timeout, so the slowest command bounds the total time. Values of commands with a TTL are stored in the persistent cache, failures included, so a slow or broken check runs at most once per TTL.
+ *
+ * @param commands Commands to run.
+ *
+ * @return Values, in the order of the commands (e.g., {"main"}); "Unknown $TITLE ($REASON)" for the commands that failed.
+ */
+[[nodiscard]] std::vector<std::string> run_commands(const std::vector<Command> &commands);
+
+}  // namespace modules::commands
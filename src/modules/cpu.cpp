@@ -2,21 +2,667 @@
  * @file cpu.cpp
  */
 
-#include <string>  // for std::string
+#include <algorithm>         // for std::find, std::find_if, std::max, std::stable_sort
+#include <charconv>          // for std::from_chars
+#include <cstddef>           // for std::size_t
+#include <cstdint>           // for std::uint32_t, std::uint64_t
+#include <dirent.h>          // for ::fdopendir, ::readdir, ::closedir, DIR, struct dirent
+#include <fcntl.h>           // for ::open, ::openat, O_RDONLY, O_DIRECTORY, O_CLOEXEC
+#include <filesystem>        // for std::filesystem::path
+#include <initializer_list>  // for std::initializer_list
+#include <optional>          // for std::optional, std::nullopt
+#include <string>            // for std::string, std::getline, std::to_string
+#include <string_view>       // for std::string_view
+#include <sys/types.h>       // for ssize_t
+#include <system_error>      // for std::errc
+#include <unistd.h>          // for ::read, ::close, ::sysconf, _SC_NPROCESSORS_ONLN
+#include <utility>           // for std::pair, std::move
+#include <vector>            // for std::vector
 
-#include "core/sysctl.hpp"
+#if defined(__linux__)
+#include <fstream>  // for std::ifstream
+#endif
+
+#include "cgroup.hpp"
 #include "cpu.hpp"
+#include "core/cache.hpp"
+#include "core/text.hpp"
+#if defined(__APPLE__)
+#include "core/sysctl.hpp"
+#endif
 
 namespace modules::cpu {
 
-std::string get_cpu_model()
+namespace {
+
+/**
+ * @brief Get the CPU model as reported by the host.
+ *
+ * @return CPU model string (e.g., "Apple M1 Pro", "AMD EPYC 7763 64-Core Processor") if succeeded, "Unknown CPU model ($REASON)" otherwise.
+ */
+[[nodiscard]] std::string get_host_cpu_model()
 {
+#if defined(__APPLE__)
     if (const auto cpu_model_opt = core::sysctl::get_value("machdep.cpu.brand_string")) {
         return *cpu_model_opt;
     }
     else {
         return "Unknown CPU model (Failed to get machdep.cpu.brand_string)";
     }
+#elif defined(__linux__)
+    // Every processor has its own entry, but they share the model on everything this runs on
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    for (std::string line; std::getline(cpuinfo, line);) {
+        if (line.rfind("model name", 0) != 0) {
+            continue;
+        }
+        if (const std::size_t colon = line.find(": "); colon != std::string::npos) {
+            return line.substr(colon + 2);
+        }
+    }
+    return "Unknown CPU model (Failed to read /proc/cpuinfo)";
+#else
+    return "Unknown CPU model (Unsupported platform)";
+#endif
+}
+
+/**
+ * @brief Size of a page, the largest a sysfs attribute can be.
+ */
+constexpr std::size_t page_size = 4096;
+
+/**
+ * @brief Class that reads a batch of small files relative to one directory into one buffer.
+ *
+ * Paths are added first and read back to back by execute(), so that a batch costs one open and one read per file, without a path lookup from the root or an allocation per file.
+ *
+ * @note This class is marked as `final` to prevent inheritance.
+ */
+class ReadPlan final {
+  public:
+    /**
+     * @brief Construct a new ReadPlan object and open the directory.
+     *
+     * @param root Directory the paths are relative to (e.g., "/sys/devices/system/cpu").
+     */
+    explicit ReadPlan(const std::filesystem::path &root)
+        : fd_(::open(root.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC))
+    {
+    }
+
+    /**
+     * @brief Destroy the ReadPlan object and close the directory.
+     */
+    ~ReadPlan()
+    {
+        if (this->fd_ >= 0) {
+            ::close(this->fd_);
+        }
+    }
+
+    ReadPlan(const ReadPlan &) = delete;
+    ReadPlan &operator=(const ReadPlan &) = delete;
+
+    /**
+     * @brief Check whether the directory could be opened.
+     *
+     * @return True if it could, false otherwise.
+     */
+    [[nodiscard]] bool is_open() const noexcept
+    {
+        return this->fd_ >= 0;
+    }
+
+    /**
+     * @brief Add a file to the next batch.
+     *
+     * @param path Path relative to the directory (e.g., "cpu0/topology/thread_siblings_list").
+     *
+     * @return Index of the file in the batch.
+     */
+    std::size_t add(std::string path)
+    {
+        this->paths_.push_back(std::move(path));
+        return this->paths_.size() - 1;
+    }
+
+    /**
+     * @brief Read every file of the batch; missing files read as empty.
+     */
+    void execute()
+    {
+        this->slices_.assign(this->paths_.size(), {0, 0});
+        std::size_t used = 0;
+        for (std::size_t i = 0; i < this->paths_.size(); ++i) {
+            const int fd = ::openat(this->fd_, this->paths_[i].c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) {
+                continue;
+            }
+            if (this->buffer_.size() - used < page_size) {
+                this->buffer_.resize(std::max(this->buffer_.size() * 2, used + page_size));
+            }
+            const ssize_t length = ::read(fd, this->buffer_.data() + used, this->buffer_.size() - used);
+            ::close(fd);
+            if (length > 0) {
+                this->slices_[i] = {used, static_cast<std::size_t>(length)};
+                used += static_cast<std::size_t>(length);
+            }
+        }
+        this->paths_.clear();
+    }
+
+    /**
+     * @brief Get the contents of a file of the last batch, without the trailing newline.
+     *
+     * @param index Index returned by add().
+     *
+     * @return Contents (e.g., "0-1"), empty if the file could not be read.
+     */
+    [[nodiscard]] std::string_view get(const std::size_t index) const noexcept
+    {
+        std::string_view text(this->buffer_.data() + this->slices_[index].first, this->slices_[index].second);
+        while (!text.empty() && (text.back() == '\n' || text.back() == ' ')) {
+            text.remove_suffix(1);
+        }
+        return text;
+    }
+
+    /**
+     * @brief List the entries of a subdirectory, unsorted.
+     *
+     * @param path Path relative to the directory (e.g., "cpu0/cache").
+     *
+     * @return Names of the entries, empty if the subdirectory does not exist.
+     */
+    [[nodiscard]] std::vector<std::string> list(const std::string &path) const
+    {
+        std::vector<std::string> names;
+        const int fd = ::openat(this->fd_, path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        DIR *directory = fd < 0 ? nullptr : ::fdopendir(fd);
+        if (!directory) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+            return names;
+        }
+        while (const struct dirent *entry = ::readdir(directory)) {
+            if (entry->d_name[0] != '.') {
+                names.emplace_back(entry->d_name);
+            }
+        }
+        ::closedir(directory);
+        return names;
+    }
+
+  private:
+    /**
+     * @brief File descriptor of the directory.
+     */
+    int fd_;
+
+    /**
+     * @brief Paths of the next batch.
+     */
+    std::vector<std::string> paths_;
+
+    /**
+     * @brief Contents of the files of the last batch, back to back; only grown, so that later batches reuse it.
+     */
+    std::vector<char> buffer_;
+
+    /**
+     * @brief Offset and length of every file of the last batch in the buffer.
+     */
+    std::vector<std::pair<std::size_t, std::size_t>> slices_;
+};
+
+/**
+ * @brief Parse an unsigned number, followed by nothing but a size suffix.
+ *
+ * @param text Text to parse (e.g., "3228000", "1024K").
+ *
+ * @return Number if succeeded, with "K" and "M" applied (e.g., "1048576" for "1024K"), std::nullopt otherwise.
+ */
+[[nodiscard]] std::optional<std::uint64_t> parse_size(const std::string_view text) noexcept
+{
+    std::uint64_t value = 0;
+    const auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (ec != std::errc() || end == text.data()) {
+        return std::nullopt;
+    }
+    const std::string_view suffix(end, static_cast<std::size_t>(text.data() + text.size() - end));
+    if (suffix.empty()) {
+        return value;
+    }
+    if (suffix == "K") {
+        return value * 1024;
+    }
+    if (suffix == "M") {
+        return value * 1024 * 1024;
+    }
+    return std::nullopt;
+}
+
+/**
+ * @brief Call a function for every CPU of a list.
+ *
+ * @tparam Function Type of the function.
+ * @param list CPU list, as printed by the kernel (e.g., "0-3,8,10-11").
+ * @param function Function called with every CPU number, in order.
+ */
+template <typename Function>
+void for_each_cpu(const std::string_view list,
+                  const Function &function)
+{
+    const char *position = list.data();
+    const char *const end = list.data() + list.size();
+    while (position < end) {
+        std::uint32_t first = 0;
+        auto result = std::from_chars(position, end, first);
+        if (result.ec != std::errc()) {
+            return;
+        }
+        std::uint32_t last = first;
+        if (result.ptr < end && *result.ptr == '-') {
+            result = std::from_chars(result.ptr + 1, end, last);
+            if (result.ec != std::errc()) {
+                return;
+            }
+        }
+        for (std::uint32_t cpu = first; cpu <= last; ++cpu) {
+            function(cpu);
+        }
+        position = result.ptr < end && *result.ptr == ',' ? result.ptr + 1 : end;
+    }
+}
+
+/**
+ * @brief Add the caches of the representative CPU of a cluster to a topology.
+ *
+ * A cache shared by no more CPUs than the cluster has is assumed to repeat across the cluster (e.g., one L2 per core), while one shared beyond it (e.g., an L3 shared by all clusters) is only counted once.
+ *
+ * @param plan Plan whose last batch holds the level, type, size and shared CPU list of every cache, in that order.
+ * @param first_index Index of the first file of the caches in the batch.
+ * @param cache_count Number of caches.
+ * @param threads Number of hardware threads of the cluster.
+ * @param shared Shared caches already counted (e.g., "3:Unified:0-23").
+ * @param topology Topology to add the caches to.
+ */
+void add_caches(const ReadPlan &plan,
+                const std::size_t first_index,
+                const std::size_t cache_count,
+                const std::uint32_t threads,
+                std::vector<std::string> &shared,
+                Topology &topology)
+{
+    for (std::size_t i = 0; i < cache_count; ++i) {
+        const std::size_t index = first_index + i * 4;
+        const std::string_view level = plan.get(index);
+        const std::string_view type = plan.get(index + 1);
+        const auto size = parse_size(plan.get(index + 2));
+        std::uint32_t sharing = 0;
+        for_each_cpu(plan.get(index + 3), [&sharing](const std::uint32_t) { ++sharing; });
+        if (!size || sharing == 0) {
+            continue;
+        }
+        std::uint64_t total = *size * ((threads + sharing - 1) / sharing);
+        if (sharing > threads) {
+            std::string key = std::string(level) + ':' + std::string(type) + ':' + std::string(plan.get(index + 3));
+            if (std::find(shared.begin(), shared.end(), key) != shared.end()) {
+                continue;
+            }
+            shared.push_back(std::move(key));
+            total = *size;
+        }
+        if (level == "1" && type == "Data") {
+            topology.l1d_bytes += total;
+        }
+        else if (level == "1" && type == "Instruction") {
+            topology.l1i_bytes += total;
+        }
+        else if (level == "2") {
+            topology.l2_bytes += total;
+        }
+        else if (level == "3") {
+            topology.l3_bytes += total;
+        }
+    }
+}
+
+#if defined(__APPLE__)
+/**
+ * @brief Read the topology from the sysctl variables.
+ *
+ * Every number is read into 64 bits, as the variables are a mix of 32 and 64-bit integers and a larger buffer accepts both.
+ *
+ * @return Topology, without clusters if the variables could not be read.
+ */
+[[nodiscard]] Topology read_sysctl_topology()
+{
+    const auto get_number = [](const std::string &name) -> std::uint64_t {
+        return core::sysctl::get_value<std::uint64_t>(name).value_or(0);
+    };
+    Topology topology;
+    const std::uint64_t level_count = get_number("hw.nperflevels");
+
+    // Intel chips have a single level, described by the "hw.*" variables, with per-core L1 and L2 caches
+    if (level_count == 0) {
+        Cluster cluster;
+        cluster.cores = static_cast<std::uint32_t>(get_number("hw.physicalcpu"));
+        cluster.threads = static_cast<std::uint32_t>(get_number("hw.logicalcpu"));
+        cluster.max_frequency_hz = get_number("hw.cpufrequency_max");
+        if (cluster.cores == 0) {
+            return topology;
+        }
+        topology.l1d_bytes = get_number("hw.l1dcachesize") * cluster.cores;
+        topology.l1i_bytes = get_number("hw.l1icachesize") * cluster.cores;
+        topology.l2_bytes = get_number("hw.l2cachesize") * cluster.cores;
+        topology.l3_bytes = get_number("hw.l3cachesize");
+        topology.clusters.push_back(std::move(cluster));
+        return topology;
+    }
+
+    // Level 0 is the fastest; every level shares an L2 between "cpusperl2" CPUs
+    for (std::uint64_t level = 0; level < level_count; ++level) {
+        const std::string prefix = "hw.perflevel" + std::to_string(level) + ".";
+        Cluster cluster;
+        cluster.name = core::sysctl::get_value(prefix + "name").value_or("");
+        cluster.cores = static_cast<std::uint32_t>(get_number(prefix + "physicalcpu"));
+        cluster.threads = static_cast<std::uint32_t>(get_number(prefix + "logicalcpu"));
+        if (cluster.cores == 0) {
+            continue;
+        }
+        const std::uint64_t cpus_per_l2 = get_number(prefix + "cpusperl2");
+        topology.l1d_bytes += get_number(prefix + "l1dcachesize") * cluster.cores;
+        topology.l1i_bytes += get_number(prefix + "l1icachesize") * cluster.cores;
+        topology.l2_bytes += get_number(prefix + "l2cachesize") * (cpus_per_l2 == 0 ? 1 : (cluster.threads + cpus_per_l2 - 1) / cpus_per_l2);
+        topology.l3_bytes += get_number(prefix + "l3cachesize");
+        topology.clusters.push_back(std::move(cluster));
+    }
+    return topology;
+}
+#endif
+
+/**
+ * @brief Get an identifier of the current boot, which changes on every reboot.
+ *
+ * @return Identifier (e.g., "4AB3B5E2-6C36-4F1B-9A1D-2C8A4A0C4F2E") if succeeded, std::nullopt otherwise.
+ */
+[[nodiscard]] std::optional<std::string> get_boot_id()
+{
+#if defined(__APPLE__)
+    return core::sysctl::get_value("kern.bootsessionuuid");
+#else
+    std::ifstream file("/proc/sys/kernel/random/boot_id");
+    std::string boot_id;
+    if (!std::getline(file, boot_id) || boot_id.empty()) {
+        return std::nullopt;
+    }
+    return boot_id;
+#endif
+}
+
+/**
+ * @brief Serialize a topology for the cache.
+ *
+ * @param topology Topology to serialize.
+ *
+ * @return Cache sizes on the first line, then one line per cluster (e.g., "131072 196608 4194304 0\n8 8 0 Performance\n").
+ */
+[[nodiscard]] std::string serialize_topology(const Topology &topology)
+{
+    std::string output;
+    for (const std::uint64_t bytes : {topology.l1d_bytes, topology.l1i_bytes, topology.l2_bytes, topology.l3_bytes}) {
+        core::text::append_unsigned(bytes, output);
+        output.push_back(' ');
+    }
+    output.back() = '\n';
+    for (const Cluster &cluster : topology.clusters) {
+        core::text::append_unsigned(cluster.cores, output);
+        output.push_back(' ');
+        core::text::append_unsigned(cluster.threads, output);
+        output.push_back(' ');
+        core::text::append_unsigned(cluster.max_frequency_hz, output);
+        output.push_back(' ');
+        output.append(cluster.name).push_back('\n');
+    }
+    return output;
+}
+
+/**
+ * @brief Parse a topology serialized by serialize_topology().
+ *
+ * @param text Serialized topology.
+ *
+ * @return Topology if succeeded, std::nullopt otherwise (e.g., the cache was written by another version).
+ */
+[[nodiscard]] std::optional<Topology> parse_topology(const std::string_view text)
+{
+    const char *position = text.data();
+    const char *const end = text.data() + text.size();
+    const auto read_number = [&position, end](const char separator) -> std::optional<std::uint64_t> {
+        std::uint64_t value = 0;
+        const auto result = std::from_chars(position, end, value);
+        if (result.ec != std::errc() || result.ptr == end || *result.ptr != separator) {
+            return std::nullopt;
+        }
+        position = result.ptr + 1;
+        return value;
+    };
+
+    Topology topology;
+    for (std::uint64_t *bytes : {&topology.l1d_bytes, &topology.l1i_bytes, &topology.l2_bytes, &topology.l3_bytes}) {
+        const auto value = read_number(bytes == &topology.l3_bytes ? '\n' : ' ');
+        if (!value) {
+            return std::nullopt;
+        }
+        *bytes = *value;
+    }
+    while (position < end) {
+        const auto cores = read_number(' ');
+        const auto threads = cores ? read_number(' ') : std::nullopt;
+        const auto frequency = threads ? read_number(' ') : std::nullopt;
+        const char *const line_end = frequency ? std::find(position, end, '\n') : end;
+        if (!frequency || line_end == end) {
+            return std::nullopt;
+        }
+        topology.clusters.push_back({std::string(position, line_end), static_cast<std::uint32_t>(*cores), static_cast<std::uint32_t>(*threads), *frequency});
+        position = line_end + 1;
+    }
+    if (topology.clusters.empty()) {
+        return std::nullopt;
+    }
+    return topology;
+}
+
+/**
+ * @brief Append a size in bytes with the largest binary unit that keeps it at least 1 (e.g., "16 MiB", "1.5 MiB", "512 KiB").
+ *
+ * @param bytes Size in bytes.
+ * @param output String to append to.
+ */
+void append_size(const std::uint64_t bytes,
+                 std::string &output)
+{
+    if (bytes >= 1024 * 1024) {
+        core::text::append_general(static_cast<double>(bytes) / (1024.0 * 1024.0), output);
+        output.append(" MiB");
+    }
+    else {
+        core::text::append_general(static_cast<double>(bytes) / 1024.0, output);
+        output.append(" KiB");
+    }
+}
+
+}  // namespace
+
+std::string get_cpu_model()
+{
+    std::string model = get_host_cpu_model();
+
+    // A CPU quota caps how much of the host the container can use, whatever the number of online processors
+    // Only the quota is shown: the model is a static field, so a live value (e.g., throttling) would be reported as drift
+    const auto &stats = modules::cgroup::get_stats();
+    const auto limit = stats ? modules::cgroup::get_cpu_limit(*stats) : std::nullopt;
+    if (!limit) {
+        return model;
+    }
+    const long online = ::sysconf(_SC_NPROCESSORS_ONLN);
+    model.append(" (");
+    core::text::append_general(*limit, model);
+    if (online > 0) {
+        model.append(" of ");
+        core::text::append_signed(online, model);
+    }
+    model.append(" CPUs in container)");
+    return model;
+}
+
+Topology read_sysfs_topology(const std::filesystem::path &root)
+{
+    Topology topology;
+    ReadPlan plan(root);
+    if (!plan.is_open()) {
+        return topology;
+    }
+    plan.add("online");
+    plan.execute();
+    std::vector<std::uint32_t> cpus;
+    for_each_cpu(plan.get(0), [&cpus](const std::uint32_t cpu) { cpus.push_back(cpu); });
+
+    // Every CPU is both a thread of its core and a member of a cluster, so these are the only files read for all of them
+    for (const std::uint32_t cpu : cpus) {
+        const std::string directory = "cpu" + std::to_string(cpu);
+        plan.add(directory + "/topology/thread_siblings_list");
+        plan.add(directory + "/cpufreq/cpuinfo_max_freq");
+    }
+    plan.execute();
+
+    // A core is counted by its first thread; without cpufreq (e.g., in a VM), all CPUs form a single cluster
+    std::vector<std::uint32_t> representatives;
+    for (std::size_t i = 0; i < cpus.size(); ++i) {
+        const std::string_view siblings = plan.get(2 * i);
+        std::uint32_t first_sibling = 0;
+        if (std::from_chars(siblings.data(), siblings.data() + siblings.size(), first_sibling).ec != std::errc()) {
+            first_sibling = cpus[i];
+        }
+        const std::uint64_t frequency_hz = parse_size(plan.get(2 * i + 1)).value_or(0) * 1000;
+        auto cluster = std::find_if(topology.clusters.begin(), topology.clusters.end(), [frequency_hz](const Cluster &candidate) { return candidate.max_frequency_hz == frequency_hz; });
+        if (cluster == topology.clusters.end()) {
+            topology.clusters.push_back({"", 0, 0, frequency_hz});
+            representatives.push_back(cpus[i]);
+            cluster = topology.clusters.end() - 1;
+        }
+        ++cluster->threads;
+        if (first_sibling == cpus[i]) {
+            ++cluster->cores;
+        }
+    }
+
+    // Caches are the same for every CPU of a cluster, so only its first CPU is read
+    std::vector<std::pair<std::size_t, std::size_t>> cache_ranges;
+    for (const std::uint32_t cpu : representatives) {
+        const std::string directory = "cpu" + std::to_string(cpu) + "/cache";
+        std::size_t cache_count = 0;
+        std::size_t first_index = 0;
+        for (const std::string &name : plan.list(directory)) {
+            if (name.rfind("index", 0) != 0) {
+                continue;
+            }
+            const std::string cache = directory + '/' + name + '/';
+            const std::size_t index = plan.add(cache + "level");
+            plan.add(cache + "type");
+            plan.add(cache + "size");
+            plan.add(cache + "shared_cpu_list");
+            first_index = cache_count == 0 ? index : first_index;
+            ++cache_count;
+        }
+        cache_ranges.emplace_back(first_index, cache_count);
+    }
+    plan.execute();
+    std::vector<std::string> shared;
+    for (std::size_t i = 0; i < topology.clusters.size(); ++i) {
+        add_caches(plan, cache_ranges[i].first, cache_ranges[i].second, topology.clusters[i].threads, shared, topology);
+    }
+
+    // Clusters are sorted once their caches were added, as the ranges follow the order they were found in
+    std::stable_sort(topology.clusters.begin(), topology.clusters.end(), [](const Cluster &left, const Cluster &right) {
+        return left.max_frequency_hz > right.max_frequency_hz;
+    });
+    return topology;
+}
+
+std::optional<Topology> get_topology()
+{
+    // Processors do not come and go until a reboot in practice, so the boot identifier is the whole cache key
+    const auto boot_id = get_boot_id();
+    const std::string cache_key = "cpu-topology:" + boot_id.value_or("");
+    if (boot_id) {
+        if (const auto cached = core::cache::load(cache_key)) {
+            if (auto topology = parse_topology(*cached)) {
+                return topology;
+            }
+        }
+    }
+
+#if defined(__APPLE__)
+    Topology topology = read_sysctl_topology();
+#else
+    Topology topology = read_sysfs_topology("/sys/devices/system/cpu");
+#endif
+    if (topology.clusters.empty()) {
+        return std::nullopt;
+    }
+    if (boot_id) {
+        core::cache::store(cache_key, serialize_topology(topology));
+    }
+    return topology;
+}
+
+std::string format_topology(const Topology &topology)
+{
+    std::string output;
+    for (const Cluster &cluster : topology.clusters) {
+        if (!output.empty()) {
+            output.append(" + ");
+        }
+        core::text::append_unsigned(cluster.cores, output);
+        if (!cluster.name.empty()) {
+            output.append(" ").append(cluster.name);
+        }
+        output.append(cluster.cores == 1 ? " core" : " cores");
+        if (cluster.threads != cluster.cores) {
+            output.append(" (");
+            core::text::append_unsigned(cluster.threads, output);
+            output.append(" threads)");
+        }
+        if (cluster.max_frequency_hz != 0) {
+            output.append(" @ ");
+            core::text::append_fixed(static_cast<double>(cluster.max_frequency_hz) / 1e9, 2, output);
+            output.append(" GHz");
+        }
+    }
+    if (topology.l2_bytes != 0) {
+        output.append(", L2 ");
+        append_size(topology.l2_bytes, output);
+    }
+    if (topology.l3_bytes != 0) {
+        output.append(", L3 ");
+        append_size(topology.l3_bytes, output);
+    }
+    return output;
+}
+
+std::string get_cpu_topology()
+{
+    if (const auto topology = get_topology()) {
+        return format_topology(*topology);
+    }
+#if defined(__APPLE__)
+    return "Unknown CPU topology (Failed to get hw.physicalcpu)";
+#else
+    return "Unknown CPU topology (Failed to read /sys/devices/system/cpu)";
+#endif
 }
 
 }  // namespace modules::cpu
@@ -6,15 +6,112 @@
 
 #pragma once
 
-#include <string>  // for std::string
+#include <cstdint>     // for std::uint32_t, std::uint64_t
+#include <filesystem>  // for std::filesystem::path
+#include <optional>    // for std::optional
+#include <string>      // for std::string
+#include <vector>      // for std::vector
 
 namespace modules::cpu {
 
+/**
+ * @brief Struct that represents a group of identical cores (e.g., the performance cores of an Apple Silicon chip).
+ */
+struct Cluster final {
+    /**
+     * @brief Name of the performance level (e.g., "Performance"), empty if the platform does not name them (e.g., Linux).
+     */
+    std::string name;
+
+    /**
+     * @brief Number of physical cores (e.g., "8").
+     */
+    std::uint32_t cores = 0;
+
+    /**
+     * @brief Number of hardware threads (e.g., "16" with SMT).
+     */
+    std::uint32_t threads = 0;
+
+    /**
+     * @brief Maximum frequency in Hz (e.g., "3228000000"), 0 if unknown (e.g., Apple Silicon does not report it).
+     */
+    std::uint64_t max_frequency_hz = 0;
+};
+
+/**
+ * @brief Struct that represents the topology of the processors: clusters of cores and total cache sizes.
+ */
+struct Topology final {
+    /**
+     * @brief Clusters, fastest first.
+     */
+    std::vector<Cluster> clusters;
+
+    /**
+     * @brief Total L1 data cache over all cores in bytes (e.g., "1310720").
+     */
+    std::uint64_t l1d_bytes = 0;
+
+    /**
+     * @brief Total L1 instruction cache over all cores in bytes (e.g., "2097152").
+     */
+    std::uint64_t l1i_bytes = 0;
+
+    /**
+     * @brief Total L2 cache in bytes (e.g., "16777216").
+     */
+    std::uint64_t l2_bytes = 0;
+
+    /**
+     * @brief Total L3 cache in bytes (e.g., "33554432"), 0 if there is none.
+     */
+    std::uint64_t l3_bytes = 0;
+};
+
 /**
  * @brief Get the CPU model as a string.
  *
- * @return CPU model string (e.g., "Apple M1 Pro") if succeeded, "Unknown CPU model ($REASON)" otherwise.
+ * If the process runs in a cgroup v2 with a CPU quota (e.g., a container started with "--cpus=2"), the number of CPUs the quota allows is appended.
+ *
+ * @return CPU model string (e.g., "Apple M1 Pro", "AMD EPYC 7763 64-Core Processor (2 of 16 CPUs in container)") if succeeded, "Unknown CPU model ($REASON)" otherwise.
  */
 [[nodiscard]] std::string get_cpu_model();
 
+/**
+ * @brief Read the topology from a sysfs CPU directory.
+ *
+ * The files are read in three batches (the online CPUs, then the thread siblings and maximum frequency of every CPU, then the caches of one CPU per cluster), each through one directory descriptor into one buffer, instead of walking the tree file by file. Cores with the same maximum frequency form a cluster.
+ *
+ * @param root Directory of the CPUs (e.g., "/sys/devices/system/cpu").
+ *
+ * @return Topology, without clusters if the directory could not be read.
+ */
+[[nodiscard]] Topology read_sysfs_topology(const std::filesystem::path &root);
+
+/**
+ * @brief Get the topology of the processors.
+ *
+ * On macOS, it is read from the "hw.perflevel*" sysctl variables (or "hw.*" on chips with a single level); on Linux, from sysfs. The topology cannot change until a reboot, so it is cached on disk keyed by the boot session, and later runs only read the cache.
+ *
+ * @return Topology if succeeded, std::nullopt otherwise.
+ */
+[[nodiscard]] std::optional<Topology> get_topology();
+
+/**
+ * @brief Format a topology as a string.
+ *
+ * @param topology Topology to format.
+ *
+ * @return Formatted topology (e.g., "8 Performance cores + 2 Efficiency cores, L2 16 MiB", "64 cores (128 threads) @ 3.53 GHz, L2 32 MiB, L3 256 MiB").
+ */
+[[nodiscard]] std::string format_topology(const Topology &topology);
+
+/**
+ * @brief Get the topology of the processors as a string.
+ *
+ * @return Formatted topology if succeeded, "Unknown CPU topology ($REASON)" otherwise.
+ */
+[[nodiscard]] std::string get_cpu_topology();
+
 }  // namespace modules::cpu
@@ -2,32 +2,123 @@
  * @file display.cpp
  */
 
-#include <CoreGraphics/CoreGraphics.h>  // for CGDirectDisplayID, CGMainDisplayID, CGDisplayPixelsWide, CGDisplayPixelsHigh, CGDisplayCopyDisplayMode, CGDisplayModeGetRefreshRate, CGDisplayModeRelease
-#include <cmath>                        // for std::round
-#include <cstddef>                      // for std::size_t
+#include <algorithm>     // for std::sort, std::stable_partition
+#include <array>         // for std::array
+#include <charconv>      // for std::from_chars
+#include <chrono>        // for std::chrono::steady_clock
+#include <cmath>         // for std::round
+#include <cstddef>       // for std::size_t, std::ptrdiff_t
+#include <cstdint>       // for std::uint8_t, std::uint32_t
+#include <filesystem>    // for std::filesystem
+#include <fstream>       // for std::ifstream
+#include <functional>    // for std::function
+#include <ios>           // for std::ios, std::streamsize
+#include <string>        // for std::string, std::getline
+#include <string_view>   // for std::string_view
+#include <system_error>  // for std::error_code, std::errc
+#include <utility>       // for std::move
+#include <vector>        // for std::vector
+
+#if defined(__APPLE__)
+#include <CoreGraphics/CoreGraphics.h>  // for CGGetActiveDisplayList, CGDisplayPixelsWide, CGDisplayPixelsHigh, CGDisplayIsMain, CGDisplayCopyDisplayMode, CGDisplayModeGetRefreshRate, CGDisplayModeGetWidth, CGDisplayModeGetPixelWidth, CGDisplayModeRelease, CGDisplayRegisterReconfigurationCallback, CGDisplayRemoveReconfigurationCallback, CFRunLoopRunInMode
 #include <memory>                       // for std::unique_ptr
-#include <string>                       // for std::string
 #include <type_traits>                  // for std::remove_pointer_t
+#elif defined(__linux__)
+#include <linux/netlink.h>  // for sockaddr_nl, NETLINK_KOBJECT_UEVENT
+#include <sys/socket.h>     // for ::socket, ::bind, ::recv, AF_NETLINK, SOCK_DGRAM, SOCK_NONBLOCK, SOCK_CLOEXEC
+#include <sys/types.h>      // for ssize_t
+#include <unistd.h>         // for ::close
+#endif
 
-#include <fmt/core.h>
-
+#include "core/text.hpp"
 #include "display.hpp"
 
 namespace modules::display {
 
-std::string get_resolution()
+namespace {
+
+/**
+ * @brief Read the first line of a file.
+ *
+ * @param path Path to the file (e.g., "/sys/class/drm/card0-eDP-1/status").
+ *
+ * @return First line without the newline (e.g., "connected"), empty if the file cannot be read.
+ */
+[[nodiscard]] std::string read_line(const std::filesystem::path &path)
+{
+    std::string line;
+    std::ifstream file(path);
+    std::getline(file, line);
+    return line;
+}
+
+/**
+ * @brief Compute the refresh rate of the preferred timing of an EDID.
+ *
+ * The first detailed timing descriptor (bytes 54 to 71) is the preferred mode; its refresh rate is the pixel clock divided by the total (active and blanking) pixels per frame.
+ *
+ * @param path Path to the EDID (e.g., "/sys/class/drm/card0-eDP-1/edid").
+ *
+ * @return Refresh rate in Hz (e.g., "60.0"), 0 if the EDID cannot be read or has no preferred timing.
+ */
+[[nodiscard]] double read_edid_refresh_rate(const std::filesystem::path &path)
+{
+    std::array<char, 128> raw{};
+    std::ifstream file(path, std::ios::binary);
+    if (!file.read(raw.data(), static_cast<std::streamsize>(raw.size()))) {
+        return 0.0;
+    }
+    const auto byte = [&raw](const std::size_t index) {
+        return static_cast<std::uint32_t>(static_cast<std::uint8_t>(raw[index]));
+    };
+    constexpr std::array<std::uint8_t, 8> header = {0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00};
+    for (std::size_t i = 0; i < header.size(); ++i) {
+        if (byte(i) != header[i]) {
+            return 0.0;
+        }
+    }
+
+    // The pixel clock is in units of 10 kHz, and the high bits of the sizes are packed into shared nibbles
+    const std::uint32_t pixel_clock = byte(54) | byte(55) << 8;
+    const std::uint32_t horizontal = (byte(56) | (byte(58) & 0xF0) << 4) + (byte(57) | (byte(58) & 0x0F) << 8);
+    const std::uint32_t vertical = (byte(59) | (byte(61) & 0xF0) << 4) + (byte(60) | (byte(61) & 0x0F) << 8);
+    if (pixel_clock == 0 || horizontal == 0 || vertical == 0) {
+        return 0.0;
+    }
+    return static_cast<double>(pixel_clock) * 10000.0 / (static_cast<double>(horizontal) * static_cast<double>(vertical));
+}
+
+#if defined(__APPLE__)
+/**
+ * @brief Invalidate a watcher once a display reconfiguration completed.
+ *
+ * @param display_id Display that changed.
+ * @param flags What changed; the callback runs once before (kCGDisplayBeginConfigurationFlag) and once after the change.
+ * @param user_info Watcher to invalidate.
+ */
+void on_reconfiguration(const CGDirectDisplayID display_id,
+                        const CGDisplayChangeSummaryFlags flags,
+                        void *user_info)
 {
-    const CGDirectDisplayID display_id = CGMainDisplayID();
-    const std::size_t width = CGDisplayPixelsWide(display_id);
-    const std::size_t height = CGDisplayPixelsHigh(display_id);
-    if (width == 0 || height == 0) {
-        return "Unknown resolution (Both width and height are 0)";
+    static_cast<void>(display_id);
+    if ((flags & kCGDisplayBeginConfigurationFlag) == 0) {
+        static_cast<Watcher *>(user_info)->invalidate();
     }
-    return fmt::format("{}x{}", width, height);
 }
+#endif
 
-std::string get_refresh_rate()
+}  // namespace
+
+Topology get_topology()
 {
+#if defined(__APPLE__)
+    Topology topology;
+    std::array<CGDirectDisplayID, max_display_count> display_ids{};
+    std::uint32_t count = 0;
+    if (CGGetActiveDisplayList(static_cast<std::uint32_t>(display_ids.size()), display_ids.data(), &count) != kCGErrorSuccess) {
+        return topology;
+    }
+
     // Custom deleter for CGDisplayModeRef
     const auto cg_display_mode_deleter = [](const CGDisplayModeRef mode) {
         if (mode) {
@@ -35,16 +126,186 @@ std::string get_refresh_rate()
         }
     };
 
-    const std::unique_ptr<std::remove_pointer_t<CGDisplayModeRef>, decltype(cg_display_mode_deleter)> mode(
-        CGDisplayCopyDisplayMode(CGMainDisplayID()), cg_display_mode_deleter);
+    for (std::uint32_t i = 0; i < count && topology.count < max_display_count; ++i) {
+        Display &display = topology.displays[topology.count++];
+        display.width = CGDisplayPixelsWide(display_ids[i]);
+        display.height = CGDisplayPixelsHigh(display_ids[i]);
+        display.main = CGDisplayIsMain(display_ids[i]) != 0;
+        const std::unique_ptr<std::remove_pointer_t<CGDisplayModeRef>, decltype(cg_display_mode_deleter)> mode(
+            CGDisplayCopyDisplayMode(display_ids[i]), cg_display_mode_deleter);
+        if (!mode) {
+            continue;
+        }
+        display.refresh_rate = CGDisplayModeGetRefreshRate(mode.get());
+        if (const std::size_t points = CGDisplayModeGetWidth(mode.get()); points != 0) {
+            display.scale = static_cast<double>(CGDisplayModeGetPixelWidth(mode.get())) / static_cast<double>(points);
+        }
+    }
+    std::stable_partition(topology.displays.begin(), topology.displays.begin() + static_cast<std::ptrdiff_t>(topology.count), [](const Display &display) {
+        return display.main;
+    });
+    return topology;
+#else
+    return read_drm_topology("/sys/class/drm");
+#endif
+}
+
+Topology read_drm_topology(const std::filesystem::path &root)
+{
+    // Connectors are named "card<N>-<TYPE>-<M>" (e.g., "card0-eDP-1"), next to the cards themselves ("card0")
+    std::vector<std::filesystem::path> connectors;
+    std::error_code error;
+    for (std::filesystem::directory_iterator it(root, error), end; !error && it != end; it.increment(error)) {
+        const std::string name = it->path().filename().string();
+        if (name.rfind("card", 0) == 0 && name.find('-') != std::string::npos) {
+            connectors.push_back(it->path());
+        }
+    }
+    std::sort(connectors.begin(), connectors.end());
+
+    // The built-in panel of a laptop is the main display, so internal connectors come first (e.g., "card0-eDP-1" before "card0-HDMI-A-1")
+    std::stable_partition(connectors.begin(), connectors.end(), [](const std::filesystem::path &connector) {
+        const std::string name = connector.filename().string();
+        const std::string_view type = std::string_view(name).substr(name.find('-') + 1);
+        return type.rfind("eDP", 0) == 0 || type.rfind("LVDS", 0) == 0 || type.rfind("DSI", 0) == 0;
+    });
+
+    Topology topology;
+    for (const std::filesystem::path &connector : connectors) {
+        if (topology.count == max_display_count) {
+            break;
+        }
+
+        // A connected output can still be disabled (e.g., the panel of a closed laptop)
+        if (read_line(connector / "status") != "connected" || read_line(connector / "enabled") == "disabled") {
+            continue;
+        }
+
+        // Modes are listed as "<WIDTH>x<HEIGHT>", preferred first
+        const std::string mode = read_line(connector / "modes");
+        Display display;
+        const char *end = mode.data() + mode.size();
+        const auto [width_end, width_error] = std::from_chars(mode.data(), end, display.width);
+        if (width_error != std::errc() || width_end == end || *width_end != 'x' ||
+            std::from_chars(width_end + 1, end, display.height).ec != std::errc() || display.width == 0 || display.height == 0) {
+            continue;
+        }
+        display.refresh_rate = read_edid_refresh_rate(connector / "edid");
+        display.main = topology.count == 0;
+        topology.displays[topology.count++] = display;
+    }
+    return topology;
+}
+
+void format_topology(const Topology &topology,
+                     std::string &output)
+{
+    if (topology.count == 0) {
+        output.assign("Unknown displays (No active display)");
+        return;
+    }
+    output.clear();
+    for (std::size_t i = 0; i < topology.count; ++i) {
+        const Display &display = topology.displays[i];
+        if (i > 0) {
+            output.append(", ");
+        }
+        core::text::append_integer(display.width, output);
+        output.push_back('x');
+        core::text::append_integer(display.height, output);
+        if (display.refresh_rate > 0.0) {
+            output.append(" @ ");
+            core::text::append_signed(static_cast<int>(std::round(display.refresh_rate)), output);
+            output.append(" Hz");
+        }
+
+        // The main display is only worth naming if there are several
+        const bool scaled = display.scale > 1.0;
+        const bool main = display.main && topology.count > 1;
+        if (scaled) {
+            output.append(" (");
+            core::text::append_general(display.scale, output);
+            output.append(main ? "x, main)" : "x)");
+        }
+        else if (main) {
+            output.append(" (main)");
+        }
+    }
+}
+
+std::string get_displays()
+{
+    std::string output;
+    format_topology(get_topology(), output);
+    return output;
+}
 
-    if (!mode) {
-        return "Unknown refresh rate (Failed to get display mode)";
+Watcher::Watcher(std::function<Topology()> query)
+    : query_(std::move(query))
+{
+#if defined(__APPLE__)
+    this->subscribed_ = CGDisplayRegisterReconfigurationCallback(on_reconfiguration, this) == kCGErrorSuccess;
+#elif defined(__linux__)
+    // Subscribe to the kernel uevent multicast group, which needs no privileges and no udev daemon
+    this->uevent_fd_ = ::socket(AF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_KOBJECT_UEVENT);
+    sockaddr_nl address{};
+    address.nl_family = AF_NETLINK;
+    address.nl_groups = 1;
+    if (this->uevent_fd_ >= 0 && ::bind(this->uevent_fd_, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0) {
+        ::close(this->uevent_fd_);
+        this->uevent_fd_ = -1;
+    }
+    this->subscribed_ = this->uevent_fd_ >= 0;
+#endif
+}
+
+Watcher::~Watcher()
+{
+#if defined(__APPLE__)
+    if (this->subscribed_) {
+        CGDisplayRemoveReconfigurationCallback(on_reconfiguration, this);
+    }
+#elif defined(__linux__)
+    if (this->uevent_fd_ >= 0) {
+        ::close(this->uevent_fd_);
+    }
+#endif
+}
+
+bool Watcher::refresh()
+{
+#if defined(__APPLE__)
+    // Reconfiguration callbacks are delivered through the run loop, which a command-line tool never runs otherwise
+    CFRunLoopRunInMode(kCFRunLoopDefaultMode, 0.0, true);
+#elif defined(__linux__)
+    // A uevent is "ACTION@DEVPATH" followed by null-terminated "KEY=VALUE" pairs; connector changes come from the "drm" subsystem
+    std::array<char, 4096> buffer;
+    for (ssize_t length; this->uevent_fd_ >= 0 && (length = ::recv(this->uevent_fd_, buffer.data(), buffer.size(), 0)) > 0;) {
+        if (std::string_view(buffer.data(), static_cast<std::size_t>(length)).find(std::string_view("\0SUBSYSTEM=drm\0", 15)) != std::string_view::npos) {
+            this->invalidate();
+        }
+    }
+#endif
+    const auto now = std::chrono::steady_clock::now();
+    if (!this->subscribed_ && now - this->queried_at_ >= fallback_interval) {
+        this->invalidate();
     }
+    if (!this->stale_.exchange(false)) {
+        return false;
+    }
+    this->topology_ = this->query_();
+    this->queried_at_ = now;
+    return true;
+}
 
-    // Return rounded refresh rate with " Hz" suffix
-    const double refresh_rate = CGDisplayModeGetRefreshRate(mode.get());
-    return fmt::format("{} Hz", static_cast<int>(std::round(refresh_rate)));
+const Topology &Watcher::get_topology() const noexcept
+{
+    return this->topology_;
+}
+
+void Watcher::invalidate() noexcept
+{
+    this->stale_ = true;
 }
 
 }  // namespace modules::display
@@ -6,22 +6,182 @@
 
 #pragma once
 
-#include <string>  // for std::string
+#include <array>       // for std::array
+#include <atomic>      // for std::atomic
+#include <chrono>      // for std::chrono::steady_clock
+#include <cstddef>     // for std::size_t
+#include <filesystem>  // for std::filesystem::path
+#include <functional>  // for std::function
+#include <string>      // for std::string
 
 namespace modules::display {
 
 /**
- * @brief Get the screen resolution as a string.
+ * @brief Struct that represents an active display.
+ */
+struct Display final {
+    /**
+     * @brief Width in points, i.e., pixels divided by the scale (e.g., "1512").
+     */
+    std::size_t width = 0;
+
+    /**
+     * @brief Height in points (e.g., "982").
+     */
+    std::size_t height = 0;
+
+    /**
+     * @brief Refresh rate in Hz (e.g., "120.0"), 0 if unknown.
+     */
+    double refresh_rate = 0.0;
+
+    /**
+     * @brief Number of pixels per point (e.g., "2.0" on Retina displays).
+     */
+    double scale = 1.0;
+
+    /**
+     * @brief Whether this is the main display (the one with the menu bar on macOS, the built-in panel or else the first connected one on Linux).
+     */
+    bool main = false;
+};
+
+/**
+ * @brief Largest number of displays enumerated; more are ignored.
+ */
+inline constexpr std::size_t max_display_count = 8;
+
+/**
+ * @brief Struct that represents the active displays, held inline so that storing them never allocates.
+ */
+struct Topology final {
+    /**
+     * @brief Active displays, the first "count" are valid.
+     */
+    std::array<Display, max_display_count> displays{};
+
+    /**
+     * @brief Number of active displays (e.g., "2").
+     */
+    std::size_t count = 0;
+};
+
+/**
+ * @brief Enumerate every active display at once.
+ *
+ * On macOS, the active display list of CoreGraphics is used; elsewhere, the DRM connectors in "/sys/class/drm".
+ *
+ * @return Active displays, main display first; empty if none could be found.
+ */
+[[nodiscard]] Topology get_topology();
+
+/**
+ * @brief Read the connected displays from a DRM sysfs tree.
+ *
+ * Every "card*-*" connector whose "status" is "connected" is a display. The resolution is the first (preferred) mode in "modes", and the refresh rate is computed from the preferred timing in "edid". Internal connectors (eDP, LVDS and DSI, e.g., the panel of a laptop) come first, then the others by name; the first active one is the main display.
+ *
+ * @param root Path to the DRM class directory (e.g., "/sys/class/drm").
  *
- * @return Screen resolution (e.g., "1512x982") if succeeded, "Unknown resolution ($REASON)" otherwise.
+ * @return Connected displays; empty if the directory cannot be read.
  */
-[[nodiscard]] std::string get_resolution();
+[[nodiscard]] Topology read_drm_topology(const std::filesystem::path &root);
 
 /**
- * @brief Get the screen refresh rate as an integer.
+ * @brief Format the displays, reusing the capacity of the output.
  *
- * @return Screen refresh rate (e.g., "120 Hz") if succeeded, "Unknown refresh rate ($REASON)" otherwise.
+ * @param topology Displays to format.
+ * @param output String to overwrite (e.g., "1512x982 @ 120 Hz (2x, main), 2560x1440 @ 60 Hz"), "Unknown displays (No active display)" if there is none.
  */
-[[nodiscard]] std::string get_refresh_rate();
+void format_topology(const Topology &topology,
+                     std::string &output);
+
+/**
+ * @brief Get every active display as a string.
+ *
+ * @return Displays (e.g., "1512x982 @ 120 Hz (2x, main), 2560x1440 @ 60 Hz") if succeeded, "Unknown displays ($REASON)" otherwise.
+ */
+[[nodiscard]] std::string get_displays();
+
+/**
+ * @brief Class that holds the display topology and queries it again only after the displays changed.
+ *
+ * Long-running modes call refresh() every tick; the topology is only queried when a change notification arrived: a display reconfiguration callback on macOS, and a DRM uevent from the kernel (what udev listens to) on Linux. If notifications are unavailable, the topology is queried again at most every "fallback_interval".
+ *
+ * @note This class is marked as `final` to prevent inheritance.
+ */
+class Watcher final {
+  public:
+    /**
+     * @brief Interval after which the topology is queried again if change notifications are unavailable.
+     */
+    static constexpr std::chrono::seconds fallback_interval{10};
+
+    /**
+     * @brief Construct a new Watcher object and subscribe to change notifications. The topology is queried on the first refresh.
+     *
+     * @param query Function that queries the topology (e.g., "get_topology").
+     */
+    explicit Watcher(std::function<Topology()> query = modules::display::get_topology);
+
+    /**
+     * @brief Destroy the Watcher object and unsubscribe from change notifications.
+     */
+    ~Watcher();
+
+    Watcher(const Watcher &) = delete;
+    Watcher &operator=(const Watcher &) = delete;
+
+    /**
+     * @brief Query the topology again if the displays changed since the last refresh.
+     *
+     * @return True if the topology was queried again, false if it is unchanged.
+     */
+    [[nodiscard]] bool refresh();
+
+    /**
+     * @brief Get the topology of the last refresh.
+     *
+     * @return Active displays.
+     */
+    [[nodiscard]] const Topology &get_topology() const noexcept;
+
+    /**
+     * @brief Mark the topology as changed, so that the next refresh queries it again. Called by the change notifications.
+     */
+    void invalidate() noexcept;
+
+  private:
+    /**
+     * @brief Function that queries the topology.
+     */
+    std::function<Topology()> query_;
+
+    /**
+     * @brief Topology of the last refresh.
+     */
+    Topology topology_{};
+
+    /**
+     * @brief Whether the displays changed since the last refresh; set from the notification callback.
+     */
+    std::atomic<bool> stale_{true};
+
+    /**
+     * @brief Whether change notifications are delivered; if not, the topology is queried again after "fallback_interval".
+     */
+    bool subscribed_ = false;
+
+    /**
+     * @brief Time of the last query.
+     */
+    std::chrono::steady_clock::time_point queried_at_{};
+
+#if defined(__linux__)
+    /**
+     * @brief Netlink socket that receives kernel uevents, -1 if none.
+     */
+    int uevent_fd_ = -1;
+#endif
+};
 
 }  // namespace modules::display
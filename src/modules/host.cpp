@@ -2,23 +2,331 @@
  * @file host.cpp
  */
 
-#include <algorithm>      // for std::remove_if, std::all_of
-#include <cctype>         // for std::isspace, std::isdigit
+#include <algorithm>      // for std::min
+#include <array>          // for std::array
+#include <cctype>         // for std::isdigit
+#include <chrono>         // for std::chrono::milliseconds
 #include <cstddef>        // for std::size_t
-#include <ctime>          // for std::time_t, std::time, std::difftime
-#include <exception>      // for std::exception
-#include <string>         // for std::string, std::to_string, std::stoi
+#include <cstring>        // for std::memchr, std::memcmp
+#include <cstdint>        // for std::uint64_t
+#include <ctime>          // for std::time_t, std::time, ::clock_gettime, CLOCK_BOOTTIME
+#include <fcntl.h>        // for ::open, O_RDONLY, O_CLOEXEC
+#include <fstream>        // for std::ifstream
+#include <istream>        // for std::getline
+#include <optional>       // for std::optional, std::nullopt
+#include <string>         // for std::string
+#include <string_view>    // for std::string_view
+#include <sys/mman.h>     // for ::mmap, ::munmap, PROT_READ, MAP_PRIVATE, MAP_FAILED
+#include <sys/stat.h>     // for ::stat, S_ISREG
 #include <sys/utsname.h>  // for utsname, uname
+#include <unistd.h>       // for ::close
+#include <utility>        // for std::pair, std::make_pair
 
-#include <fmt/core.h>
-
+#include "core/cache.hpp"
 #include "core/env.hpp"
+#include "core/process.hpp"
 #include "core/shell.hpp"
-#include "core/sysctl.hpp"
+#include "core/text.hpp"
 #include "host.hpp"
+#include "models.hpp"
+
+#if defined(__APPLE__)
+#include "core/sysctl.hpp"
+#endif
 
 namespace modules::host {
 
+namespace {
+
+/**
+ * @brief Kind of a well-known process found among the ancestors.
+ */
+enum class ProcessKind {
+    Shell,
+    Terminal,
+};
+
+/**
+ * @brief Struct that maps a kernel process name to a display name.
+ */
+struct KnownProcess final {
+    std::string_view process_name;
+    std::string_view display_name;
+    ProcessKind kind;
+};
+
+/**
+ * @brief Lookup table of well-known shells and terminal emulators, keyed by the short process name reported by the kernel.
+ *
+ * @note The table lives in read-only memory, so looking up a process does not allocate.
+ */
+constexpr std::array<KnownProcess, 32> known_processes = {{
+    {"zsh", "zsh", ProcessKind::Shell},
+    {"bash", "bash", ProcessKind::Shell},
+    {"fish", "fish", ProcessKind::Shell},
+    {"sh", "sh", ProcessKind::Shell},
+    {"dash", "dash", ProcessKind::Shell},
+    {"ksh", "ksh", ProcessKind::Shell},
+    {"mksh", "mksh", ProcessKind::Shell},
+    {"tcsh", "tcsh", ProcessKind::Shell},
+    {"csh", "csh", ProcessKind::Shell},
+    {"nu", "nushell", ProcessKind::Shell},
+    {"elvish", "elvish", ProcessKind::Shell},
+    {"xonsh", "xonsh", ProcessKind::Shell},
+    {"pwsh", "PowerShell", ProcessKind::Shell},
+    {"Terminal", "Apple Terminal", ProcessKind::Terminal},
+    {"iTerm2", "iTerm2", ProcessKind::Terminal},
+    {"kitty", "kitty", ProcessKind::Terminal},
+    {"alacritty", "Alacritty", ProcessKind::Terminal},
+    {"wezterm-gui", "WezTerm", ProcessKind::Terminal},
+    {"ghostty", "Ghostty", ProcessKind::Terminal},
+    {"Hyper", "Hyper", ProcessKind::Terminal},
+    {"Warp", "Warp", ProcessKind::Terminal},
+    {"tabby", "Tabby", ProcessKind::Terminal},
+    {"Code Helper", "Visual Studio Code", ProcessKind::Terminal},
+    {"tmux", "tmux", ProcessKind::Terminal},
+    {"tmux: server", "tmux", ProcessKind::Terminal},
+    {"screen", "GNU Screen", ProcessKind::Terminal},
+    {"gnome-terminal-", "GNOME Terminal", ProcessKind::Terminal},
+    {"konsole", "Konsole", ProcessKind::Terminal},
+    {"xterm", "xterm", ProcessKind::Terminal},
+    {"foot", "foot", ProcessKind::Terminal},
+    {"sshd", "SSH", ProcessKind::Terminal},
+    {"sshd-session", "SSH", ProcessKind::Terminal},
+}};
+
+/**
+ * @brief Find the nearest ancestor of a given kind.
+ *
+ * @param kind Kind of process to look for (e.g., "ProcessKind::Shell").
+ *
+ * @return Pair of the matching ancestor and its table entry if found, std::nullopt otherwise.
+ */
+[[nodiscard]] std::optional<std::pair<const core::process::Process *, const KnownProcess *>> find_ancestor(const ProcessKind kind)
+{
+    for (const core::process::Process &process : core::process::get_ancestry()) {
+        std::string_view name = process.get_name();
+        // Login shells are started with a leading dash (e.g., "-zsh")
+        if (!name.empty() && name.front() == '-') {
+            name.remove_prefix(1);
+        }
+        for (const KnownProcess &known : known_processes) {
+            if (known.kind == kind && known.process_name == name) {
+                return std::make_pair(&process, &known);
+            }
+        }
+    }
+    return std::nullopt;
+}
+
+/**
+ * @brief Version signatures embedded in shell binaries. The version number follows the signature directly.
+ *
+ * @note All signatures are tried for every binary, because the file name is not reliable (e.g., "/bin/sh" is bash on macOS).
+ */
+constexpr std::array<std::string_view, 2> version_signatures = {
+    "@(#)Bash version ",  // "@(#)Bash version 5.2.15(1) release GNU"
+    "zsh-",               // "zsh-5.9-0-g73d3173"
+};
+
+/**
+ * @brief Find the first occurrence of a needle in a memory region.
+ *
+ * The first byte of the needle is located with std::memchr, which is vectorized by the C library on both macOS and Linux, and only candidate positions are compared in full. This is much faster than a naive byte-by-byte search over multi-megabyte binaries.
+ *
+ * @param begin Pointer to the start of the region.
+ * @param end Pointer past the end of the region.
+ * @param needle String to look for (e.g., "zsh-"). Must not be empty.
+ *
+ * @return Pointer to the first occurrence if found, nullptr otherwise.
+ */
+[[nodiscard]] const char *find_substring(const char *begin,
+                                         const char *end,
+                                         const std::string_view needle) noexcept
+{
+    while (end - begin >= static_cast<std::ptrdiff_t>(needle.size())) {
+        const std::size_t search_length = static_cast<std::size_t>(end - begin) - needle.size() + 1;
+        const auto *candidate = static_cast<const char *>(std::memchr(begin, needle.front(), search_length));
+        if (!candidate) {
+            return nullptr;
+        }
+        if (std::memcmp(candidate, needle.data(), needle.size()) == 0) {
+            return candidate;
+        }
+        begin = candidate + 1;
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Extract a dotted version number (e.g., "5.9") from the start of a string.
+ *
+ * @param text Text that starts with the version number (e.g., "5.9-0-g73d3173").
+ *
+ * @return Version number if the text starts with a digit (e.g., "5.9"), std::nullopt otherwise.
+ */
+[[nodiscard]] std::optional<std::string> extract_version_number(const std::string_view text)
+{
+    std::size_t length = 0;
+    while (length < text.size() && (std::isdigit(static_cast<unsigned char>(text[length])) || text[length] == '.')) {
+        ++length;
+    }
+    // Strip trailing dots (e.g., "5.9." at the end of a sentence)
+    while (length > 0 && text[length - 1] == '.') {
+        --length;
+    }
+    if (length == 0 || !std::isdigit(static_cast<unsigned char>(text.front()))) {
+        return std::nullopt;
+    }
+    return std::string(text.substr(0, length));
+}
+
+/**
+ * @brief Find the version of a shell by searching its memory-mapped binary for a known signature.
+ *
+ * @param path Path to the shell binary (e.g., "/bin/zsh").
+ * @param size Size of the binary in bytes.
+ *
+ * @return Version string if found (e.g., "5.9"), std::nullopt otherwise.
+ */
+[[nodiscard]] std::optional<std::string> read_version_from_binary(const std::string &path,
+                                                                  const std::size_t size)
+{
+    if (size == 0) {
+        return std::nullopt;
+    }
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return std::nullopt;
+    }
+    void *mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        return std::nullopt;
+    }
+
+    std::optional<std::string> version;
+    const char *begin = static_cast<const char *>(mapping);
+    const char *end = begin + size;
+    for (const std::string_view signature : version_signatures) {
+        // A signature may also occur in unrelated strings (e.g., "zsh-newuser-install"), so keep searching until a version number follows it
+        for (const char *match = find_substring(begin, end, signature); match && !version; match = find_substring(match + 1, end, signature)) {
+            const char *version_begin = match + signature.size();
+            version = extract_version_number(std::string_view(version_begin, static_cast<std::size_t>(end - version_begin)).substr(0, 32));
+        }
+        if (version) {
+            break;
+        }
+    }
+    ::munmap(mapping, size);
+    return version;
+}
+
+/**
+ * @brief Find the version of a shell by running it with "--version".
+ *
+ * @param path Path to the shell binary (e.g., "/bin/zsh").
+ *
+ * @return Version string if found (e.g., "5.9"), std::nullopt otherwise.
+ */
+[[nodiscard]] std::optional<std::string> run_version_command(const std::string &path)
+{
+    // Quote the path for the shell, escaping any single quotes it may contain
+    std::string quoted_path = "'";
+    for (const char c : path) {
+        if (c == '\'') {
+            quoted_path += "'\\''";
+        }
+        else {
+            quoted_path += c;
+        }
+    }
+    quoted_path += "'";
+
+    const auto output = core::shell::get_output(quoted_path + " --version", std::chrono::milliseconds(1000));
+    if (!output) {
+        return std::nullopt;
+    }
+
+    // Use the first word of the first line that starts with a digit (e.g., "GNU bash, version 5.2.15(1)-release" -> "5.2.15")
+    const std::string_view first_line = std::string_view(*output).substr(0, output->find('\n'));
+    std::size_t position = 0;
+    while (position < first_line.size()) {
+        const std::size_t word_end = std::min(first_line.find(' ', position), first_line.size());
+        if (const auto version = extract_version_number(first_line.substr(position, word_end - position))) {
+            return version;
+        }
+        position = word_end + 1;
+    }
+    return std::nullopt;
+}
+
+#if !defined(__APPLE__)
+/**
+ * @brief Struct that represents the fields of "/etc/os-release" that are used.
+ */
+struct OsRelease final {
+    /**
+     * @brief "ID" (e.g., "linuxmint").
+     */
+    std::string id;
+
+    /**
+     * @brief "ID_LIKE" (e.g., "ubuntu debian").
+     */
+    std::string id_like;
+
+    /**
+     * @brief "PRETTY_NAME" (e.g., "Ubuntu 24.04 LTS").
+     */
+    std::string pretty_name;
+
+    /**
+     * @brief "NAME" (e.g., "Ubuntu").
+     */
+    std::string name;
+
+    /**
+     * @brief "VERSION_ID" (e.g., "24.04").
+     */
+    std::string version_id;
+};
+
+/**
+ * @brief Read the identification of the distribution, from "/etc/os-release" or its fallback "/usr/lib/os-release".
+ *
+ * @return Fields of the file, empty if the file or the field is missing.
+ */
+[[nodiscard]] OsRelease read_os_release()
+{
+    std::ifstream file("/etc/os-release");
+    if (!file) {
+        file.open("/usr/lib/os-release");
+    }
+    OsRelease release;
+    for (std::string line; std::getline(file, line);) {
+        const std::size_t equals = line.find('=');
+        if (equals == std::string::npos) {
+            continue;
+        }
+        const std::string_view key = std::string_view(line).substr(0, equals);
+        std::string *target = key == "ID" ? &release.id : key == "ID_LIKE" ? &release.id_like : key == "PRETTY_NAME" ? &release.pretty_name : key == "NAME" ? &release.name : key == "VERSION_ID" ? &release.version_id : nullptr;
+        if (!target) {
+            continue;
+        }
+        // Values may be quoted (e.g., ID_LIKE="ubuntu debian")
+        std::string_view value = std::string_view(line).substr(equals + 1);
+        if (value.size() >= 2 && (value.front() == '"' || value.front() == '\'') && value.back() == value.front()) {
+            value = value.substr(1, value.size() - 2);
+        }
+        target->assign(value);
+    }
+    return release;
+}
+#endif
+
+}  // namespace
+
 // std::string get_hostname()
 // {
 //     struct utsname uts;
@@ -30,22 +338,72 @@ namespace modules::host {
 
 std::string get_version()
 {
+#if defined(__APPLE__)
     if (const auto version_opt = core::sysctl::get_value("kern.osproductversion")) {
-        return fmt::format("macOS {}", *version_opt);
+        return "macOS " + *version_opt;
     }
     else {
         return "Unknown macOS version (Failed to get kern.osproductversion)";
     }
+#else
+    // Rolling distributions (e.g., Arch) have no "VERSION_ID", so "PRETTY_NAME" is preferred
+    const OsRelease release = read_os_release();
+    if (!release.pretty_name.empty()) {
+        return release.pretty_name;
+    }
+    if (!release.name.empty()) {
+        return release.version_id.empty() ? release.name : release.name + " " + release.version_id;
+    }
+    return "Unknown Linux version (Failed to read /etc/os-release)";
+#endif
+}
+
+std::string get_os_ids()
+{
+#if defined(__APPLE__)
+    return "macos";
+#else
+    const OsRelease release = read_os_release();
+    return release.id_like.empty() ? release.id : release.id + " " + release.id_like;
+#endif
 }
 
 std::string get_model_identifier()
 {
+#if defined(__APPLE__)
     if (const auto model_opt = core::sysctl::get_value("hw.model")) {
         return *model_opt;
     }
     else {
         return "Unknown model identifier (Failed to get hw.model)";
     }
+#else
+    const auto read_dmi = [](const char *path) {
+        std::string value;
+        std::ifstream file(path);
+        std::getline(file, value);
+        return value;
+    };
+    const std::string vendor = read_dmi("/sys/class/dmi/id/sys_vendor");
+    const std::string product = read_dmi("/sys/class/dmi/id/product_name");
+    if (product.empty()) {
+        return "Unknown model identifier (Failed to read /sys/class/dmi/id/product_name)";
+    }
+    // Intel Macs report the same identifier as "hw.model"
+    if (vendor.empty() || vendor == "Apple Inc.") {
+        return product;
+    }
+    return vendor + " " + product;
+#endif
+}
+
+std::string get_model_name()
+{
+    const std::string identifier = get_model_identifier();
+    if (const auto name_opt = models::find_name(identifier)) {
+        return std::string(*name_opt);
+    }
+    return identifier;
 }
 
 std::string get_architecture()
@@ -57,62 +415,144 @@ std::string get_architecture()
     return uts.machine;
 }
 
-std::string get_uptime()
+std::optional<std::uint64_t> get_uptime_seconds()
 {
-    const int mib[] = {CTL_KERN, KERN_BOOTTIME};
-    const std::size_t mib_len = sizeof(mib) / sizeof(int);
-
-    const auto boottime_opt = core::sysctl::get_value<struct timeval>(mib, mib_len);
+#if defined(__APPLE__)
+    // The boot time does not change while the system is running, so it is only queried once
+    static const auto boottime_opt = []() {
+        const int mib[] = {CTL_KERN, KERN_BOOTTIME};
+        const std::size_t mib_len = sizeof(mib) / sizeof(int);
+        return core::sysctl::get_value<struct timeval>(mib, mib_len);
+    }();
     if (!boottime_opt) {
-        return "Unknown uptime (Failed to get kern.boottime)";
+        return std::nullopt;
     }
 
-    const struct timeval boottime = *boottime_opt;
-    const std::time_t bsec = boottime.tv_sec;
+    const std::time_t bsec = boottime_opt->tv_sec;
     const std::time_t now = std::time(nullptr);
+    if (now < bsec) {
+        return 0;
+    }
+    return static_cast<std::uint64_t>(now - bsec);
+#else
+    // Unlike CLOCK_MONOTONIC, CLOCK_BOOTTIME keeps counting while the system is suspended, like "/proc/uptime"
+    struct timespec boottime{};
+    if (::clock_gettime(CLOCK_BOOTTIME, &boottime) != 0 || boottime.tv_sec < 0) {
+        return std::nullopt;
+    }
+    return static_cast<std::uint64_t>(boottime.tv_sec);
+#endif
+}
+
+std::string format_uptime(const std::uint64_t seconds)
+{
+    std::string output;
+    format_uptime(seconds, output);
+    return output;
+}
 
-    const int seconds = static_cast<int>(std::difftime(now, bsec));
-    const int days = seconds / (60 * 60 * 24);
-    const int hours = (seconds % (60 * 60 * 24)) / (60 * 60);
-    const int minutes = (seconds % (60 * 60)) / 60;
+void format_uptime(const std::uint64_t seconds,
+                   std::string &output)
+{
+    const std::uint64_t days = seconds / (60 * 60 * 24);
+    const std::uint64_t hours = (seconds % (60 * 60 * 24)) / (60 * 60);
+    const std::uint64_t minutes = (seconds % (60 * 60)) / 60;
 
-    return fmt::format("{}d {}h {}m", days, hours, minutes);
+    output.clear();
+    core::text::append_unsigned(days, output);
+    output.append("d ");
+    core::text::append_unsigned(hours, output);
+    output.append("h ");
+    core::text::append_unsigned(minutes, output);
+    output.push_back('m');
 }
 
-std::string get_packages()
+std::string get_uptime()
 {
-    // Attempt to get the number of packages, assuming brew is installed
-    if (auto output = core::shell::get_output("brew list | wc -l")) {
-        // Trim whitespace from the output
-        output->erase(std::remove_if(output->begin(), output->end(), std::isspace), output->end());
+    const auto seconds_opt = get_uptime_seconds();
+    if (!seconds_opt) {
+#if defined(__APPLE__)
+        return "Unknown uptime (Failed to get kern.boottime)";
+#else
+        return "Unknown uptime (Failed to get CLOCK_BOOTTIME)";
+#endif
+    }
+    return format_uptime(*seconds_opt);
+}
 
-        // Check if the output is a valid number
-        if (!output->empty() && std::all_of(output->begin(), output->end(), std::isdigit)) {
-            try {
-                // Convert to integer and back to string to normalize
-                const int package_count = std::stoi(*output);
-                return std::to_string(package_count);
-            }
-            catch (const std::exception &) {
-                // If std::stoi throws an exception, proceed to check if brew is installed
-                // This is unlikely after validation but included for safety
-            }
+std::string get_shell()
+{
+    // Prefer the shell that is actually running over the login shell from $SHELL
+    std::optional<std::string> path;
+    if (const auto shell_opt = find_ancestor(ProcessKind::Shell)) {
+        const auto [process, known] = *shell_opt;
+        path = core::process::get_executable_path(process->pid);
+        if (!path) {
+            return std::string(known->display_name);
         }
     }
+    else {
+        path = core::env::get_variable("SHELL");
+    }
+    if (!path || path->empty()) {
+        return "Unknown shell (No shell among parent processes and $SHELL is not set)";
+    }
 
-    // If we reach here, the command failed or output was invalid
-    // Now check if brew is installed
-    if (core::shell::get_output("command -v brew")) {
-        return "Unknown number of packages (Failed to get brew list)";
+    // Append the version if it can be found (e.g., "/bin/zsh 5.9")
+    if (const auto version = get_shell_version(*path)) {
+        return *path + " " + *version;
     }
-    else {
-        return "Unknown number of packages (Brew is not installed)";
+    return *path;
+}
+
+std::optional<std::string> get_shell_version(const std::string &path)
+{
+    struct stat file_stat;
+    if (::stat(path.c_str(), &file_stat) != 0 || !S_ISREG(file_stat.st_mode)) {
+        return std::nullopt;
     }
+
+    // Any change to the binary (e.g., an upgrade) changes at least one of these, so repeated runs only cost a stat
+#if defined(__APPLE__)
+    const auto &mtime = file_stat.st_mtimespec;
+#else
+    const auto &mtime = file_stat.st_mtim;
+#endif
+    std::string cache_key = "shell-version:";
+    core::text::append_integer(file_stat.st_dev, cache_key);
+    cache_key.push_back(':');
+    core::text::append_integer(file_stat.st_ino, cache_key);
+    cache_key.push_back(':');
+    core::text::append_integer(mtime.tv_sec, cache_key);
+    cache_key.push_back('.');
+    core::text::append_integer(mtime.tv_nsec, cache_key);
+    cache_key.push_back(':');
+    core::text::append_integer(file_stat.st_size, cache_key);
+    if (const auto cached = core::cache::load(cache_key)) {
+        return cached->empty() ? std::nullopt : cached;
+    }
+
+    // Search the binary first, only spawn the shell if no signature is found
+    std::optional<std::string> version = read_version_from_binary(path, static_cast<std::size_t>(file_stat.st_size));
+    if (!version) {
+        version = run_version_command(path);
+    }
+
+    // Failures are cached as an empty string, so that shells without a version (e.g., dash) are not spawned on every run
+    core::cache::store(cache_key, version.value_or(""));
+    return version;
 }
 
-std::string get_shell()
+std::string get_terminal()
 {
-    return core::env::get_variable("SHELL").value_or("Unknown shell");
+    if (const auto terminal_opt = find_ancestor(ProcessKind::Terminal)) {
+        return std::string(terminal_opt->second->display_name);
+    }
+    // Fall back to the variable set by most macOS terminals (e.g., "Apple_Terminal", "iTerm.app", "vscode")
+    if (const auto term_program = core::env::get_variable("TERM_PROGRAM"); term_program && !term_program->empty()) {
+        return *term_program;
+    }
+    return "Unknown terminal (No terminal emulator among parent processes)";
 }
 
 }  // namespace modules::host
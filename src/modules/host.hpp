@@ -6,7 +6,9 @@
 
 #pragma once
 
-#include <string>  // for std::string
+#include <cstdint>   // for std::uint64_t
+#include <optional>  // for std::optional
+#include <string>    // for std::string
 
 namespace modules::host {
 
@@ -20,19 +22,39 @@ namespace modules::host {
 // [[nodiscard]] std::string get_hostname();
 
 /**
- * @brief Get the macOS version.
+ * @brief Get the version of the operating system.
  *
- * @return macOS version string (e.g., "macOS 14.6.1") if succeeded, "Unknown macOS version ($REASON)" otherwise.
+ * On Linux, "PRETTY_NAME" (or "NAME" and "VERSION_ID") is read from "/etc/os-release".
+ *
+ * @return Version string (e.g., "macOS 14.6.1", "Ubuntu 24.04 LTS") if succeeded, "Unknown macOS version ($REASON)" or "Unknown Linux version ($REASON)" otherwise.
  */
 [[nodiscard]] std::string get_version();
 
+/**
+ * @brief Get the IDs of the operating system, for picking a logo.
+ *
+ * On Linux, "ID" and "ID_LIKE" are read from "/etc/os-release".
+ *
+ * @return Space-separated IDs from the most to the least specific (e.g., "macos" or "linuxmint ubuntu debian"), or an empty string if unknown.
+ */
+[[nodiscard]] std::string get_os_ids();
+
 /**
  * @brief Get the Apple model identifier.
  *
+ * On Linux, the DMI product name is used on Apple hardware (which matches "hw.model"), and "<sys_vendor> <product_name>" elsewhere.
+ *
  * @return Model identifier string (e.g., "MacBookPro18,3") if succeeded, "Unknown model identifier ($REASON)" otherwise.
  */
 [[nodiscard]] std::string get_model_identifier();
 
+/**
+ * @brief Get the marketing name of the model.
+ *
+ * @return Marketing name (e.g., "MacBook Pro (14-inch, 2021)") if the model is known, the model identifier (e.g., "Mac99,1") if not, "Unknown model identifier ($REASON)" otherwise.
+ */
+[[nodiscard]] std::string get_model_name();
+
 /**
  * @brief Get the system architecture.
  *
@@ -40,6 +62,33 @@ namespace modules::host {
  */
 [[nodiscard]] std::string get_architecture();
 
+/**
+ * @brief Get the system uptime in seconds.
+ *
+ * On macOS, the boot time is queried once and kept for the lifetime of the process, so repeated calls only cost a call to std::time(). On Linux, CLOCK_BOOTTIME is read, which is a single vDSO call.
+ *
+ * @return Uptime in seconds (e.g., "1556700") if succeeded, std::nullopt otherwise.
+ */
+[[nodiscard]] std::optional<std::uint64_t> get_uptime_seconds();
+
+/**
+ * @brief Format an uptime in seconds as a string.
+ *
+ * @param seconds Uptime in seconds (e.g., "1556700").
+ *
+ * @return Formatted uptime string (e.g., "18d 0h 25m").
+ */
+[[nodiscard]] std::string format_uptime(const std::uint64_t seconds);
+
+/**
+ * @brief Format an uptime in seconds into an existing string, reusing its capacity.
+ *
+ * @param seconds Uptime in seconds (e.g., "1556700").
+ * @param output String to replace with the formatted uptime (e.g., "18d 0h 25m").
+ */
+void format_uptime(const std::uint64_t seconds,
+                   std::string &output);
+
 /**
  * @brief Get the system uptime as a formatted string.
  *
@@ -48,17 +97,32 @@ namespace modules::host {
 [[nodiscard]] std::string get_uptime();
 
 /**
- * @brief Get the number of brew packages installed.
+ * @brief Get the shell that is running the program, including its version if known.
  *
- * @return Number of brew packages installed (e.g., "139") if succeeded, "Unknown number of packages ($REASON)" otherwise.
+ * The nearest shell among the parent processes is used. If none is found, the login shell from $SHELL is used instead.
+ *
+ * @return Shell string (e.g., "/bin/zsh 5.9") if succeeded, "Unknown shell ($REASON)" otherwise.
  */
-[[nodiscard]] std::string get_packages();
+[[nodiscard]] std::string get_shell();
 
 /**
- * @brief Get the shell used by the user.
+ * @brief Get the version of a shell binary without running it, if possible.
  *
- * @return Shell string (e.g., "/bin/zsh") if succeeded, "Unknown shell ($REASON)" otherwise.
+ * The binary is memory-mapped and searched for a known version signature. If none is found, the shell is run with "--version" and a timeout instead. The result (including failure) is cached on disk, keyed by the device, inode, mtime and size of the binary, so repeated runs only cost a stat.
+ *
+ * @param path Path to the shell binary (e.g., "/bin/zsh").
+ *
+ * @return Version string (e.g., "5.9") if succeeded, std::nullopt otherwise.
  */
-[[nodiscard]] std::string get_shell();
+[[nodiscard]] std::optional<std::string> get_shell_version(const std::string &path);
+
+/**
+ * @brief Get the terminal emulator that is running the program.
+ *
+ * The nearest known terminal emulator (or multiplexer) among the parent processes is used. If none is found, $TERM_PROGRAM is used instead.
+ *
+ * @return Terminal string (e.g., "iTerm2") if succeeded, "Unknown terminal ($REASON)" otherwise.
+ */
+[[nodiscard]] std::string get_terminal();
 
 }  // namespace modules::host
@@ -0,0 +1,125 @@
+/**
+ * @file image.cpp
+ */
+
+#include <algorithm>     // for std::max, std::min
+#include <charconv>      // for std::from_chars
+#include <cstddef>       // for std::size_t
+#include <filesystem>    // for std::filesystem
+#include <fstream>       // for std::ifstream
+#include <ios>           // for std::ios
+#include <iterator>      // for std::istreambuf_iterator
+#include <optional>      // for std::optional, std::nullopt
+#include <string>        // for std::string
+#include <sys/ioctl.h>   // for ::ioctl, TIOCGWINSZ, struct winsize
+#include <system_error>  // for std::error_code, std::errc
+#include <unistd.h>      // for STDOUT_FILENO
+
+#include <fmt/core.h>
+
+#include "core/cache.hpp"
+#include "core/env.hpp"
+#include "core/graphics.hpp"
+#include "core/png.hpp"
+#include "image.hpp"
+
+namespace modules::image {
+
+Protocol detect_protocol()
+{
+    if (core::env::get_variable("KITTY_WINDOW_ID")) {
+        return Protocol::Kitty;
+    }
+    if (const auto term = core::env::get_variable("TERM"); term && (*term == "xterm-kitty" || *term == "xterm-ghostty")) {
+        return Protocol::Kitty;
+    }
+    if (const auto program = core::env::get_variable("TERM_PROGRAM"); program && (*program == "ghostty" || *program == "WezTerm")) {
+        return Protocol::Kitty;
+    }
+    if (core::env::get_variable("KONSOLE_VERSION")) {
+        return Protocol::Kitty;
+    }
+    return Protocol::Sixel;
+}
+
+CellSize get_cell_size()
+{
+    struct winsize size{};
+    if (::ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) != 0 || size.ws_col == 0 || size.ws_row == 0 || size.ws_xpixel == 0 || size.ws_ypixel == 0) {
+        return {};
+    }
+    return {std::max<std::size_t>(1, size.ws_xpixel / size.ws_col), std::max<std::size_t>(1, size.ws_ypixel / size.ws_row)};
+}
+
+std::optional<Rendered> render(const std::string &png,
+                               const Protocol protocol,
+                               const CellSize &cell_size)
+{
+    const auto image = core::png::decode(png);
+    if (!image) {
+        return std::nullopt;
+    }
+
+    // Fit the image into "max_columns" cells without upscaling, keeping its aspect ratio
+    const std::size_t width = std::min(image->width, max_columns * cell_size.width);
+    const std::size_t height = std::max<std::size_t>(1, image->height * width / image->width);
+    const std::size_t columns = (width + cell_size.width - 1) / cell_size.width;
+    const std::size_t rows = (height + cell_size.height - 1) / cell_size.height;
+    const core::png::Image scaled = width == image->width ? *image : core::graphics::downscale(*image, width, height);
+
+    Rendered rendered;
+    rendered.escape = protocol == Protocol::Kitty ? core::graphics::encode_kitty(scaled, columns, rows) : core::graphics::encode_sixel(scaled);
+    rendered.columns = columns;
+    rendered.rows = rows;
+    return rendered;
+}
+
+std::optional<Rendered> get_image(const std::string &path)
+{
+    // Resolved so that every spelling of a path (e.g., "logo.png", "./logo.png", a symlink) shares one cache entry
+    std::error_code ec;
+    const auto canonical = std::filesystem::weakly_canonical(path, ec);
+    if (ec) {
+        return std::nullopt;
+    }
+    const auto mtime = std::filesystem::last_write_time(canonical, ec);
+    const auto size = std::filesystem::file_size(canonical, ec);
+    if (ec) {
+        return std::nullopt;
+    }
+    const Protocol protocol = detect_protocol();
+    const CellSize cell_size = get_cell_size();
+    const std::string cache_key = fmt::format("image:{}:{}:{}:{}:{}x{}:{}",
+                                              protocol == Protocol::Kitty ? "kitty" : "sixel",
+                                              mtime.time_since_epoch().count(),
+                                              size,
+                                              max_columns,
+                                              cell_size.width,
+                                              cell_size.height,
+                                              canonical.string());
+
+    // Stored as "<columns> <rows>\n<escape>"
+    if (const auto cached = core::cache::load(cache_key)) {
+        Rendered rendered;
+        const char *end = cached->data() + cached->size();
+        const auto [columns_end, columns_error] = std::from_chars(cached->data(), end, rendered.columns);
+        const auto [rows_end, rows_error] = std::from_chars(std::min(columns_end + 1, end), end, rendered.rows);
+        if (columns_error == std::errc() && rows_error == std::errc() && rows_end < end && *rows_end == '\n') {
+            rendered.escape.assign(rows_end + 1, end);
+            return rendered;
+        }
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return std::nullopt;
+    }
+    const std::string png((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    auto rendered = render(png, protocol, cell_size);
+    if (rendered) {
+        core::cache::store(cache_key, fmt::format("{} {}\n{}", rendered->columns, rendered->rows, rendered->escape));
+    }
+    return rendered;
+}
+
+}  // namespace modules::image
@@ -0,0 +1,103 @@
+/**
+ * @file image.hpp
+ *
+ * @brief Render an image for terminals that support graphics.
+ */
+
+#pragma once
+
+#include <cstddef>   // for std::size_t
+#include <optional>  // for std::optional
+#include <string>    // for std::string
+
+namespace modules::image {
+
+/**
+ * @brief Terminal graphics protocols.
+ */
+enum class Protocol {
+    Kitty,
+    Sixel,
+};
+
+/**
+ * @brief Struct that represents the size of a terminal cell in pixels.
+ */
+struct CellSize final {
+    /**
+     * @brief Width in pixels (e.g., "8").
+     */
+    std::size_t width = 8;
+
+    /**
+     * @brief Height in pixels (e.g., "16").
+     */
+    std::size_t height = 16;
+};
+
+/**
+ * @brief Struct that represents an image that is ready to be printed.
+ */
+struct Rendered final {
+    /**
+     * @brief Escape sequences that display the image at the cursor.
+     */
+    std::string escape;
+
+    /**
+     * @brief Number of terminal columns the image occupies (e.g., "32").
+     */
+    std::size_t columns = 0;
+
+    /**
+     * @brief Number of terminal rows the image occupies (e.g., "14").
+     */
+    std::size_t rows = 0;
+};
+
+/**
+ * @brief Largest number of terminal columns an image occupies.
+ */
+inline constexpr std::size_t max_columns = 32;
+
+/**
+ * @brief Detect the graphics protocol of the terminal.
+ *
+ * The kitty protocol is used in kitty, Ghostty, WezTerm and Konsole (detected from $TERM, $TERM_PROGRAM and $KITTY_WINDOW_ID), sixel everywhere else.
+ *
+ * @return Graphics protocol.
+ */
+[[nodiscard]] Protocol detect_protocol();
+
+/**
+ * @brief Get the size of a terminal cell from the window size of stdout.
+ *
+ * @return Cell size if the terminal reports its size in pixels, 8x16 otherwise.
+ */
+[[nodiscard]] CellSize get_cell_size();
+
+/**
+ * @brief Render a PNG image without caching: decode it, downscale it to at most "max_columns" cells, then encode it.
+ *
+ * @param png Contents of the PNG file.
+ * @param protocol Graphics protocol to encode for.
+ * @param cell_size Size of a terminal cell.
+ *
+ * @return Rendered image if succeeded, std::nullopt otherwise (e.g., the file is not a valid PNG).
+ */
+[[nodiscard]] std::optional<Rendered> render(const std::string &png,
+                                             const Protocol protocol,
+                                             const CellSize &cell_size);
+
+/**
+ * @brief Get a PNG image rendered for the current terminal.
+ *
+ * The rendered escape sequences are cached on disk, keyed by the path, mtime and size of the file, the protocol and the cell size, so repeated runs only replay bytes.
+ *
+ * @param path Path to the PNG file (e.g., "/Users/user/Pictures/logo.png").
+ *
+ * @return Rendered image if succeeded, std::nullopt otherwise (e.g., the file does not exist).
+ */
+[[nodiscard]] std::optional<Rendered> get_image(const std::string &path);
+
+}  // namespace modules::image
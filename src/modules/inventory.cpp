@@ -0,0 +1,868 @@
+/**
+ * @file inventory.cpp
+ */
+
+#include <algorithm>     // for std::max, std::min, std::sort, std::stable_sort, std::unique
+#include <array>         // for std::array
+#include <atomic>        // for std::atomic, std::memory_order_relaxed
+#include <cstddef>       // for std::size_t
+#include <cstdint>       // for std::uint16_t, std::uint32_t, std::uint64_t
+#include <cstring>       // for std::memcpy
+#include <dirent.h>      // for ::fdopendir, ::readdir, ::closedir, DIR, struct dirent
+#include <exception>     // for std::exception_ptr, std::current_exception, std::rethrow_exception
+#include <fcntl.h>       // for ::open, ::openat, O_RDONLY, O_DIRECTORY, O_CLOEXEC
+#include <filesystem>    // for std::filesystem
+#include <fstream>       // for std::ifstream
+#include <ios>           // for std::ios
+#include <iterator>      // for std::back_inserter, std::istreambuf_iterator, std::make_move_iterator
+#include <memory>        // for std::unique_ptr, std::make_unique
+#include <optional>      // for std::optional, std::nullopt
+#include <string>        // for std::string
+#include <string_view>   // for std::string_view
+#include <sys/mman.h>    // for ::mmap, ::munmap, PROT_READ, MAP_PRIVATE, MAP_FAILED
+#include <sys/stat.h>    // for ::stat, ::fstat, struct stat
+#include <sys/types.h>   // for ssize_t
+#include <system_error>  // for std::error_code
+#include <thread>        // for std::thread::hardware_concurrency
+#include <unistd.h>      // for ::read, ::close
+#include <utility>       // for std::move
+#include <vector>        // for std::vector
+
+#if defined(__APPLE__)
+#include <CoreFoundation/CoreFoundation.h>  // for CFTypeRef, CFDataRef, CFNumberRef, CFStringRef, CFRelease, CFGetTypeID, CFStringCreateWithCString, ...
+#include <IOKit/IOKitLib.h>                 // for IOServiceGetMatchingServices, IOServiceMatching, IOIteratorNext, IOObjectRelease, IORegistryEntryCreateCFProperty
+#endif
+
+#include <fmt/core.h>
+
+#include "core/cache.hpp"
+#include "core/env.hpp"
+#include "core/json.hpp"
+#include "core/thread.hpp"
+#include "core/width.hpp"
+#include "inventory.hpp"
+
+namespace modules::inventory {
+
+namespace {
+
+/**
+ * @brief Magic bytes at the start of an index file, including the layout version.
+ */
+constexpr std::array<char, 8> index_magic = {'A', 'F', 'I', 'D', 'X', '\0', '\0', '\1'};
+
+/**
+ * @brief Struct that represents the header of an index.
+ */
+struct IndexHeader final {
+    /**
+     * @brief Magic bytes (see "index_magic").
+     */
+    std::array<char, 8> magic;
+
+    /**
+     * @brief Size of the text database in bytes.
+     */
+    std::uint64_t source_size;
+
+    /**
+     * @brief Modification time of the text database in nanoseconds.
+     */
+    std::uint64_t source_mtime;
+
+    /**
+     * @brief Inode of the text database.
+     */
+    std::uint64_t source_inode;
+
+    /**
+     * @brief Number of vendor records, which follow the header.
+     */
+    std::uint32_t vendor_count;
+
+    /**
+     * @brief Number of device records, which follow the vendor records.
+     */
+    std::uint32_t device_count;
+};
+
+/**
+ * @brief Struct that represents a record of an index: a key and where its name is in the string pool, which follows the records.
+ */
+struct IndexRecord final {
+    /**
+     * @brief Vendor ID for vendors, vendor ID << 16 | device ID for devices.
+     */
+    std::uint32_t key;
+
+    /**
+     * @brief Offset of the name in the string pool.
+     */
+    std::uint32_t offset;
+
+    /**
+     * @brief Length of the name in bytes.
+     */
+    std::uint32_t length;
+};
+
+/**
+ * @brief Number of devices a thread claims at once; sysfs attributes are cheap, so a thread only pays off for a batch of devices.
+ */
+constexpr std::size_t devices_per_thread = 16;
+
+/**
+ * @brief Parse 4 hexadecimal digits.
+ *
+ * @param text Text to parse (e.g., "8086  Intel Corporation").
+ *
+ * @return Value if the text starts with 4 hexadecimal digits (e.g., "0x8086"), std::nullopt otherwise.
+ */
+[[nodiscard]] std::optional<std::uint16_t> parse_id(const std::string_view text) noexcept
+{
+    if (text.size() < 4) {
+        return std::nullopt;
+    }
+    std::uint32_t value = 0;
+    for (std::size_t i = 0; i < 4; ++i) {
+        const char c = text[i];
+        std::uint32_t digit = 0;
+        if (c >= '0' && c <= '9') {
+            digit = static_cast<std::uint32_t>(c - '0');
+        }
+        else if (c >= 'a' && c <= 'f') {
+            digit = static_cast<std::uint32_t>(c - 'a' + 10);
+        }
+        else if (c >= 'A' && c <= 'F') {
+            digit = static_cast<std::uint32_t>(c - 'A' + 10);
+        }
+        else {
+            return std::nullopt;
+        }
+        value = value << 4 | digit;
+    }
+    return static_cast<std::uint16_t>(value);
+}
+
+/**
+ * @brief Get the identity of a file, which changes whenever the file is replaced or modified.
+ *
+ * @param info Status of the file.
+ * @param size Size of the file in bytes.
+ * @param mtime Modification time of the file in nanoseconds.
+ * @param inode Inode of the file.
+ */
+void get_identity(const struct stat &info,
+                  std::uint64_t &size,
+                  std::uint64_t &mtime,
+                  std::uint64_t &inode) noexcept
+{
+#if defined(__APPLE__)
+    const auto &modified = info.st_mtimespec;
+#else
+    const auto &modified = info.st_mtim;
+#endif
+    size = static_cast<std::uint64_t>(info.st_size);
+    mtime = static_cast<std::uint64_t>(modified.tv_sec) * 1000000000ULL + static_cast<std::uint64_t>(modified.tv_nsec);
+    inode = static_cast<std::uint64_t>(info.st_ino);
+}
+
+/**
+ * @brief Check whether an index is complete and was built from a database with the given identity.
+ *
+ * @param index Index to check.
+ * @param size Size of the database in bytes.
+ * @param mtime Modification time of the database in nanoseconds.
+ * @param inode Inode of the database.
+ *
+ * @return True if the index can be used, false otherwise.
+ */
+[[nodiscard]] bool is_valid_index(const std::string_view index,
+                                  const std::uint64_t size,
+                                  const std::uint64_t mtime,
+                                  const std::uint64_t inode) noexcept
+{
+    IndexHeader header;
+    if (index.size() < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, index.data(), sizeof(header));
+    const std::uint64_t records_size = (static_cast<std::uint64_t>(header.vendor_count) + header.device_count) * sizeof(IndexRecord);
+    return header.magic == index_magic && header.source_size == size && header.source_mtime == mtime && header.source_inode == inode && sizeof(header) + records_size <= index.size();
+}
+
+/**
+ * @brief Find the first readable database among an override and the usual locations.
+ *
+ * @param variable Environment variable that overrides the location (e.g., "APPLEFETCH_PCI_IDS").
+ * @param file_name Name of the database (e.g., "pci.ids").
+ *
+ * @return Path to the database if found, std::nullopt otherwise.
+ */
+[[nodiscard]] std::optional<std::filesystem::path> find_database(const char *variable,
+                                                                 const std::string_view file_name)
+{
+    if (const auto path = core::env::get_variable(variable); path && !path->empty()) {
+        return std::filesystem::path(*path);
+    }
+    for (const char *directory : {"/usr/share/hwdata", "/usr/share/misc", "/usr/share", "/var/lib/usbutils", "/opt/homebrew/share", "/usr/local/share"}) {
+        std::error_code ec;
+        const std::filesystem::path path = std::filesystem::path(directory) / file_name;
+        if (std::filesystem::is_regular_file(path, ec)) {
+            return path;
+        }
+    }
+    return std::nullopt;
+}
+
+/**
+ * @brief Open a database, with its index in the cache directory.
+ *
+ * @param variable Environment variable that overrides the location (e.g., "APPLEFETCH_PCI_IDS").
+ * @param file_name Name of the database (e.g., "pci.ids").
+ *
+ * @return Database, which is not loaded if none was found.
+ */
+[[nodiscard]] std::unique_ptr<IdDatabase> open_database(const char *variable,
+                                                        const std::string_view file_name)
+{
+    const auto path = find_database(variable, file_name);
+    const auto cache_directory = core::cache::get_directory();
+    std::optional<std::filesystem::path> index_path;
+    if (cache_directory) {
+        index_path = *cache_directory / fmt::format("{}.index", file_name);
+    }
+    return std::make_unique<IdDatabase>(path.value_or(std::filesystem::path()), index_path);
+}
+
+/**
+ * @brief Read devices from a list of entries on several threads, each device into its own slot so that the order is kept.
+ *
+ * @param names Names of the entries, in order.
+ * @param read_device Function that reads one entry into a device, returning false to drop it.
+ *
+ * @return Devices that were read, in the order of the entries.
+ */
+template <typename ReadDevice>
+[[nodiscard]] std::vector<Device> read_in_parallel(const std::vector<std::string> &names,
+                                                   const ReadDevice &read_device)
+{
+    std::vector<Device> devices(names.size());
+    std::vector<unsigned char> found(names.size(), 0);
+    const std::size_t hardware_threads = std::max(1U, std::thread::hardware_concurrency());
+    const std::size_t thread_count = std::min(hardware_threads, names.size() / devices_per_thread + 1);
+    std::atomic<std::size_t> next_index{0};
+    const auto worker = [&]() {
+        for (std::size_t i = next_index.fetch_add(1, std::memory_order_relaxed); i < names.size(); i = next_index.fetch_add(1, std::memory_order_relaxed)) {
+            found[i] = read_device(names[i], devices[i]) ? 1 : 0;
+        }
+    };
+    std::vector<core::thread::JoiningThread> threads;
+    threads.reserve(thread_count - 1);
+    for (std::size_t t = 1; t < thread_count; ++t) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (core::thread::JoiningThread &thread : threads) {
+        thread.join();
+    }
+
+    std::vector<Device> result;
+    result.reserve(names.size());
+    for (std::size_t i = 0; i < names.size(); ++i) {
+        if (found[i] != 0) {
+            result.push_back(std::move(devices[i]));
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief List the entries of a sysfs directory, sorted by name.
+ *
+ * @param root Directory to list (e.g., "/sys/bus/pci/devices").
+ *
+ * @return Names of the entries, empty if the directory does not exist.
+ */
+[[nodiscard]] std::vector<std::string> list_entries(const std::filesystem::path &root)
+{
+    std::vector<std::string> names;
+    const int fd = ::open(root.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    DIR *directory = fd < 0 ? nullptr : ::fdopendir(fd);
+    if (!directory) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        return names;
+    }
+    while (const struct dirent *entry = ::readdir(directory)) {
+        if (entry->d_name[0] != '.') {
+            names.emplace_back(entry->d_name);
+        }
+    }
+    ::closedir(directory);
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+/**
+ * @brief Class that reads attribute files of the devices of one sysfs directory, relative to it.
+ *
+ * @note This class is marked as `final` to prevent inheritance.
+ */
+class AttributeReader final {
+  public:
+    /**
+     * @brief Construct a new AttributeReader object and open the directory.
+     *
+     * @param root Directory of the devices (e.g., "/sys/bus/pci/devices").
+     */
+    explicit AttributeReader(const std::filesystem::path &root)
+        : fd_(::open(root.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC))
+    {
+    }
+
+    /**
+     * @brief Destroy the AttributeReader object and close the directory.
+     */
+    ~AttributeReader()
+    {
+        if (this->fd_ >= 0) {
+            ::close(this->fd_);
+        }
+    }
+
+    AttributeReader(const AttributeReader &) = delete;
+    AttributeReader &operator=(const AttributeReader &) = delete;
+
+    /**
+     * @brief Read an attribute of a device, without the trailing newline.
+     *
+     * @param device Name of the device (e.g., "0000:00:02.0").
+     * @param attribute Name of the attribute (e.g., "vendor").
+     * @param value String to replace with the value (e.g., "0x8086").
+     *
+     * @return True if succeeded, false otherwise (e.g., the device has no such attribute).
+     */
+    [[nodiscard]] bool read(const std::string &device,
+                            const char *attribute,
+                            std::string &value) const
+    {
+        const std::string path = device + '/' + attribute;
+        const int fd = ::openat(this->fd_, path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return false;
+        }
+        std::array<char, 256> buffer;
+        const ssize_t size = ::read(fd, buffer.data(), buffer.size());
+        ::close(fd);
+        if (size <= 0) {
+            return false;
+        }
+        std::string_view text(buffer.data(), static_cast<std::size_t>(size));
+        while (!text.empty() && (text.back() == '\n' || text.back() == ' ')) {
+            text.remove_suffix(1);
+        }
+        value.assign(text);
+        return true;
+    }
+
+  private:
+    /**
+     * @brief File descriptor of the directory of the devices.
+     */
+    int fd_;
+};
+
+/**
+ * @brief Parse an ID attribute, with or without the "0x" prefix.
+ *
+ * @param text Value of the attribute (e.g., "0x8086", "046d").
+ *
+ * @return ID if valid, std::nullopt otherwise.
+ */
+[[nodiscard]] std::optional<std::uint16_t> parse_attribute_id(std::string_view text) noexcept
+{
+    if (text.substr(0, 2) == "0x") {
+        text.remove_prefix(2);
+    }
+    if (text.size() != 4) {
+        return std::nullopt;
+    }
+    return parse_id(text);
+}
+
+#if defined(__APPLE__)
+/**
+ * @brief Get a property of an IORegistry entry.
+ *
+ * @param service Registry entry.
+ * @param key Name of the property (e.g., "vendor-id").
+ *
+ * @return Property that the caller must release, nullptr if the entry has no such property.
+ */
+[[nodiscard]] CFTypeRef get_property(const io_registry_entry_t service,
+                                     const char *key)
+{
+    const CFStringRef name = CFStringCreateWithCString(kCFAllocatorDefault, key, kCFStringEncodingUTF8);
+    if (!name) {
+        return nullptr;
+    }
+    const CFTypeRef property = IORegistryEntryCreateCFProperty(service, name, kCFAllocatorDefault, 0);
+    CFRelease(name);
+    return property;
+}
+
+/**
+ * @brief Get a numeric property of an IORegistry entry, stored as a number or as little-endian data (e.g., "vendor-id" of a PCI device).
+ *
+ * @param service Registry entry.
+ * @param key Name of the property (e.g., "idVendor").
+ *
+ * @return Value if found, std::nullopt otherwise.
+ */
+[[nodiscard]] std::optional<std::uint32_t> get_number_property(const io_registry_entry_t service,
+                                                               const char *key)
+{
+    const CFTypeRef property = get_property(service, key);
+    if (!property) {
+        return std::nullopt;
+    }
+    std::optional<std::uint32_t> value;
+    if (CFGetTypeID(property) == CFNumberGetTypeID()) {
+        std::int64_t number = 0;
+        if (CFNumberGetValue(static_cast<CFNumberRef>(property), kCFNumberSInt64Type, &number)) {
+            value = static_cast<std::uint32_t>(number);
+        }
+    }
+    else if (CFGetTypeID(property) == CFDataGetTypeID()) {
+        const auto data = static_cast<CFDataRef>(property);
+        const CFIndex length = std::min<CFIndex>(CFDataGetLength(data), 4);
+        const UInt8 *bytes = CFDataGetBytePtr(data);
+        std::uint32_t number = 0;
+        for (CFIndex i = length; i > 0; --i) {
+            number = number << 8 | bytes[i - 1];
+        }
+        value = number;
+    }
+    CFRelease(property);
+    return value;
+}
+
+/**
+ * @brief Get a string property of an IORegistry entry.
+ *
+ * @param service Registry entry.
+ * @param key Name of the property (e.g., "USB Product Name").
+ *
+ * @return Value if found, empty otherwise.
+ */
+[[nodiscard]] std::string get_string_property(const io_registry_entry_t service,
+                                              const char *key)
+{
+    const CFTypeRef property = get_property(service, key);
+    if (!property) {
+        return {};
+    }
+    std::string value;
+    if (CFGetTypeID(property) == CFStringGetTypeID()) {
+        std::array<char, 256> buffer;
+        if (CFStringGetCString(static_cast<CFStringRef>(property), buffer.data(), static_cast<CFIndex>(buffer.size()), kCFStringEncodingUTF8)) {
+            value = buffer.data();
+        }
+    }
+    CFRelease(property);
+    return value;
+}
+
+/**
+ * @brief Read the devices of an IORegistry class.
+ *
+ * @param class_name Name of the class (e.g., "IOPCIDevice").
+ * @param read_device Function that reads one registry entry into a device, returning false to drop it.
+ *
+ * @return Devices, sorted by address.
+ */
+template <typename ReadDevice>
+[[nodiscard]] std::vector<Device> read_registry(const char *class_name,
+                                                const ReadDevice &read_device)
+{
+    // The matching dictionary is consumed by IOServiceGetMatchingServices(), and port 0 is the default main port
+    std::vector<Device> devices;
+    io_iterator_t iterator = 0;
+    if (IOServiceGetMatchingServices(0, IOServiceMatching(class_name), &iterator) != KERN_SUCCESS) {
+        return devices;
+    }
+    for (io_object_t service; (service = IOIteratorNext(iterator)) != 0;) {
+        Device device;
+        if (read_device(service, device)) {
+            devices.push_back(std::move(device));
+        }
+        IOObjectRelease(service);
+    }
+    IOObjectRelease(iterator);
+    std::sort(devices.begin(), devices.end(), [](const Device &a, const Device &b) {
+        return a.address < b.address;
+    });
+    return devices;
+}
+#endif
+
+}  // namespace
+
+IdDatabase::IdDatabase(const std::filesystem::path &ids_path,
+                       const std::optional<std::filesystem::path> &index_path)
+{
+    struct stat info;
+    if (ids_path.empty() || ::stat(ids_path.c_str(), &info) != 0) {
+        return;
+    }
+    std::uint64_t size = 0;
+    std::uint64_t mtime = 0;
+    std::uint64_t inode = 0;
+    get_identity(info, size, mtime, inode);
+
+    // An up-to-date index is mapped as is, so that nothing is parsed
+    if (index_path) {
+        const int fd = ::open(index_path->c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat index_info;
+        if (fd >= 0 && ::fstat(fd, &index_info) == 0 && index_info.st_size > 0) {
+            const auto mapping_size = static_cast<std::size_t>(index_info.st_size);
+            void *mapping = ::mmap(nullptr, mapping_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping != MAP_FAILED && is_valid_index(std::string_view(static_cast<const char *>(mapping), mapping_size), size, mtime, inode)) {
+                this->mapping_ = mapping;
+                this->mapping_size_ = mapping_size;
+                this->index_ = std::string_view(static_cast<const char *>(mapping), mapping_size);
+            }
+            else if (mapping != MAP_FAILED) {
+                ::munmap(mapping, mapping_size);
+            }
+        }
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        if (this->mapping_) {
+            return;
+        }
+    }
+
+    // Otherwise, the database is parsed once and the index is stored for the next runs
+    std::ifstream file(ids_path, std::ios::binary);
+    if (!file) {
+        return;
+    }
+    const std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    this->built_ = build_index(text, size, mtime, inode);
+    this->index_ = this->built_;
+    if (index_path) {
+        core::cache::write_atomically(*index_path, this->built_);
+    }
+}
+
+IdDatabase::~IdDatabase()
+{
+    if (this->mapping_) {
+        ::munmap(this->mapping_, this->mapping_size_);
+    }
+}
+
+bool IdDatabase::is_loaded() const noexcept
+{
+    return !this->index_.empty();
+}
+
+bool IdDatabase::is_mapped() const noexcept
+{
+    return this->mapping_ != nullptr;
+}
+
+std::optional<std::string_view> IdDatabase::find_vendor(const std::uint16_t vendor_id) const noexcept
+{
+    return this->find(0, vendor_id);
+}
+
+std::optional<std::string_view> IdDatabase::find_device(const std::uint16_t vendor_id,
+                                                        const std::uint16_t device_id) const noexcept
+{
+    return this->find(1, static_cast<std::uint32_t>(vendor_id) << 16 | device_id);
+}
+
+std::optional<std::string_view> IdDatabase::find(const std::size_t table,
+                                                 const std::uint32_t key) const noexcept
+{
+    if (this->index_.empty()) {
+        return std::nullopt;
+    }
+    IndexHeader header;
+    std::memcpy(&header, this->index_.data(), sizeof(header));
+    const std::size_t records_offset = sizeof(header) + (table == 0 ? 0 : header.vendor_count * sizeof(IndexRecord));
+    const std::size_t pool_offset = sizeof(header) + (static_cast<std::size_t>(header.vendor_count) + header.device_count) * sizeof(IndexRecord);
+    const std::size_t count = table == 0 ? header.vendor_count : header.device_count;
+
+    // Records are read with memcpy, since neither the mapping nor the string guarantee their alignment
+    const auto record_at = [this, records_offset](const std::size_t i) {
+        IndexRecord record;
+        std::memcpy(&record, this->index_.data() + records_offset + i * sizeof(IndexRecord), sizeof(record));
+        return record;
+    };
+    std::size_t low = 0;
+    std::size_t high = count;
+    while (low < high) {
+        const std::size_t middle = low + (high - low) / 2;
+        if (record_at(middle).key < key) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+    if (low == count) {
+        return std::nullopt;
+    }
+    const IndexRecord record = record_at(low);
+    if (record.key != key || pool_offset + record.offset + record.length > this->index_.size()) {
+        return std::nullopt;
+    }
+    return this->index_.substr(pool_offset + record.offset, record.length);
+}
+
+std::string build_index(const std::string_view text,
+                        const std::uint64_t source_size,
+                        const std::uint64_t source_mtime,
+                        const std::uint64_t source_inode)
+{
+    // Vendors start at the beginning of a line, their devices are indented by one tab, and subsystems by two
+    std::vector<IndexRecord> vendors;
+    std::vector<IndexRecord> devices;
+    std::string pool;
+    std::optional<std::uint16_t> vendor;
+    const auto add = [&pool](std::vector<IndexRecord> &records, const std::uint32_t key, const std::string_view line) {
+        std::string_view name = line.substr(std::min<std::size_t>(4, line.size()));
+        while (!name.empty() && (name.front() == ' ' || name.front() == '\t')) {
+            name.remove_prefix(1);
+        }
+        while (!name.empty() && (name.back() == ' ' || name.back() == '\r')) {
+            name.remove_suffix(1);
+        }
+        records.push_back({key, static_cast<std::uint32_t>(pool.size()), static_cast<std::uint32_t>(name.size())});
+        pool.append(name);
+    };
+    for (std::size_t start = 0; start < text.size();) {
+        const std::size_t end = std::min(text.find('\n', start), text.size());
+        const std::string_view line = text.substr(start, end - start);
+        start = end + 1;
+        if (line.empty() || line.front() == '#') {
+            continue;
+        }
+        if (line.front() != '\t') {
+            // The vendor list ends at the first other top-level list (e.g., "C 00  Unclassified device" for classes)
+            vendor = parse_id(line);
+            if (!vendor) {
+                break;
+            }
+            add(vendors, *vendor, line);
+        }
+        else if (vendor && line.size() > 1 && line[1] != '\t') {
+            if (const auto device = parse_id(line.substr(1))) {
+                add(devices, static_cast<std::uint32_t>(*vendor) << 16 | *device, line.substr(1));
+            }
+        }
+    }
+
+    // The databases are sorted, but the lookups must not depend on it; the first of duplicate IDs wins
+    for (std::vector<IndexRecord> *records : {&vendors, &devices}) {
+        std::stable_sort(records->begin(), records->end(), [](const IndexRecord &a, const IndexRecord &b) {
+            return a.key < b.key;
+        });
+        records->erase(std::unique(records->begin(), records->end(), [](const IndexRecord &a, const IndexRecord &b) {
+                           return a.key == b.key;
+                       }),
+                       records->end());
+    }
+
+    IndexHeader header;
+    header.magic = index_magic;
+    header.source_size = source_size;
+    header.source_mtime = source_mtime;
+    header.source_inode = source_inode;
+    header.vendor_count = static_cast<std::uint32_t>(vendors.size());
+    header.device_count = static_cast<std::uint32_t>(devices.size());
+    std::string index(sizeof(header) + (vendors.size() + devices.size()) * sizeof(IndexRecord), '\0');
+    std::memcpy(index.data(), &header, sizeof(header));
+    std::memcpy(index.data() + sizeof(header), vendors.data(), vendors.size() * sizeof(IndexRecord));
+    std::memcpy(index.data() + sizeof(header) + vendors.size() * sizeof(IndexRecord), devices.data(), devices.size() * sizeof(IndexRecord));
+    index.append(pool);
+    return index;
+}
+
+std::vector<Device> read_pci_devices(const std::filesystem::path &root)
+{
+    const AttributeReader reader(root);
+    return read_in_parallel(list_entries(root), [&reader](const std::string &name, Device &device) {
+        std::string value;
+        std::optional<std::uint16_t> vendor_id;
+        std::optional<std::uint16_t> device_id;
+        if (reader.read(name, "vendor", value)) {
+            vendor_id = parse_attribute_id(value);
+        }
+        if (reader.read(name, "device", value)) {
+            device_id = parse_attribute_id(value);
+        }
+        if (!vendor_id || !device_id) {
+            return false;
+        }
+        device.bus = "PCI";
+        device.address = name;
+        device.vendor_id = *vendor_id;
+        device.device_id = *device_id;
+        return true;
+    });
+}
+
+std::vector<Device> read_usb_devices(const std::filesystem::path &root)
+{
+    // Interfaces (e.g., "1-1:1.0") sit next to their devices, but only devices have IDs
+    std::vector<std::string> names = list_entries(root);
+    names.erase(std::remove_if(names.begin(), names.end(), [](const std::string &name) {
+                    return name.find(':') != std::string::npos;
+                }),
+                names.end());
+    const AttributeReader reader(root);
+    return read_in_parallel(names, [&reader](const std::string &name, Device &device) {
+        std::string value;
+        std::optional<std::uint16_t> vendor_id;
+        std::optional<std::uint16_t> product_id;
+        if (reader.read(name, "idVendor", value)) {
+            vendor_id = parse_attribute_id(value);
+        }
+        if (reader.read(name, "idProduct", value)) {
+            product_id = parse_attribute_id(value);
+        }
+        if (!vendor_id || !product_id) {
+            return false;
+        }
+        device.bus = "USB";
+        device.address = name;
+        device.vendor_id = *vendor_id;
+        device.device_id = *product_id;
+        if (reader.read(name, "manufacturer", value)) {
+            device.vendor = value;
+        }
+        if (reader.read(name, "product", value)) {
+            device.name = value;
+        }
+        return true;
+    });
+}
+
+void resolve_names(const IdDatabase &database,
+                   std::vector<Device> &devices)
+{
+    for (Device &device : devices) {
+        if (const auto vendor = database.find_vendor(device.vendor_id)) {
+            device.vendor.assign(*vendor);
+        }
+        if (const auto name = database.find_device(device.vendor_id, device.device_id)) {
+            device.name.assign(*name);
+        }
+    }
+}
+
+std::vector<Device> get_devices()
+{
+    std::vector<Device> pci_devices;
+    std::vector<Device> usb_devices;
+
+    // Both buses, and both databases, are independent, so USB is read on its own thread while PCI is read on this one
+    // If PCI throws, the USB thread is still joined; if USB throws, its exception is rethrown here after the join
+    std::exception_ptr usb_error;
+    core::thread::JoiningThread usb_thread([&usb_devices, &usb_error] {
+        try {
+#if defined(__APPLE__)
+            usb_devices = read_registry("IOUSBHostDevice", [](const io_registry_entry_t service, Device &device) {
+                const auto vendor_id = get_number_property(service, "idVendor");
+                const auto product_id = get_number_property(service, "idProduct");
+                if (!vendor_id || !product_id) {
+                    return false;
+                }
+                device.bus = "USB";
+                device.address = fmt::format("0x{:08x}", get_number_property(service, "locationID").value_or(0));
+                device.vendor_id = static_cast<std::uint16_t>(*vendor_id);
+                device.device_id = static_cast<std::uint16_t>(*product_id);
+                device.vendor = get_string_property(service, "USB Vendor Name");
+                device.name = get_string_property(service, "USB Product Name");
+                return true;
+            });
+#else
+            usb_devices = read_usb_devices("/sys/bus/usb/devices");
+#endif
+            resolve_names(*open_database("APPLEFETCH_USB_IDS", "usb.ids"), usb_devices);
+        }
+        catch (...) {
+            usb_error = std::current_exception();
+        }
+    });
+#if defined(__APPLE__)
+    pci_devices = read_registry("IOPCIDevice", [](const io_registry_entry_t service, Device &device) {
+        const auto vendor_id = get_number_property(service, "vendor-id");
+        const auto device_id = get_number_property(service, "device-id");
+        if (!vendor_id || !device_id) {
+            return false;
+        }
+        // "pcidebug" is the bus, device and function (e.g., "0:31:0"); the registry name is the fallback
+        device.bus = "PCI";
+        device.address = get_string_property(service, "pcidebug");
+        if (device.address.empty()) {
+            io_name_t name;
+            device.address = IORegistryEntryGetName(service, name) == KERN_SUCCESS ? name : "";
+        }
+        device.vendor_id = static_cast<std::uint16_t>(*vendor_id);
+        device.device_id = static_cast<std::uint16_t>(*device_id);
+        return true;
+    });
+#else
+    pci_devices = read_pci_devices("/sys/bus/pci/devices");
+#endif
+    resolve_names(*open_database("APPLEFETCH_PCI_IDS", "pci.ids"), pci_devices);
+    usb_thread.join();
+    if (usb_error) {
+        std::rethrow_exception(usb_error);
+    }
+
+    pci_devices.insert(pci_devices.end(), std::make_move_iterator(usb_devices.begin()), std::make_move_iterator(usb_devices.end()));
+    return pci_devices;
+}
+
+std::string format_text(const std::vector<Device> &devices)
+{
+    // Columns are sized by display width, as vendor and device names from the ID databases are not all ASCII
+    std::size_t address_width = 0;
+    std::size_t vendor_width = 0;
+    for (const Device &device : devices) {
+        address_width = std::max(address_width, core::width::get_width(device.address));
+        vendor_width = std::max(vendor_width, core::width::get_width(device.vendor.empty() ? std::string_view("Unknown vendor") : device.vendor));
+    }
+    std::string output;
+    for (const Device &device : devices) {
+        output.append(device.bus).append("  ");
+        core::width::append_padded(device.address, address_width, output);
+        fmt::format_to(std::back_inserter(output), "  {:04x}:{:04x}  ", device.vendor_id, device.device_id);
+        core::width::append_padded(device.vendor.empty() ? std::string_view("Unknown vendor") : device.vendor, vendor_width, output);
+        output.append("  ").append(device.name.empty() ? std::string_view("Unknown device") : device.name).push_back('\n');
+    }
+    return output;
+}
+
+std::string format_json(const std::vector<Device> &devices)
+{
+    std::string output = R"({"devices":[)";
+    for (std::size_t i = 0; i < devices.size(); ++i) {
+        const Device &device = devices[i];
+        fmt::format_to(std::back_inserter(output), R"({}{{"bus":{},"address":{},"vendor_id":"{:04x}","device_id":"{:04x}","vendor":{},"name":{}}})", i == 0 ? "" : ",",
+                       core::json::quote(device.bus), core::json::quote(device.address), device.vendor_id, device.device_id, core::json::quote(device.vendor), core::json::quote(device.name));
+    }
+    output += "]}";
+    return output;
+}
+
+}  // namespace modules::inventory
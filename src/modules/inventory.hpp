@@ -0,0 +1,220 @@
+/**
+ * @file inventory.hpp
+ *
+ * @brief List the PCI and USB devices of the system, with vendor and device names from the pci.ids and usb.ids databases.
+ */
+
+#pragma once
+
+#include <cstddef>      // for std::size_t
+#include <cstdint>      // for std::uint16_t, std::uint32_t
+#include <filesystem>   // for std::filesystem::path
+#include <optional>     // for std::optional
+#include <string>       // for std::string
+#include <string_view>  // for std::string_view
+#include <vector>       // for std::vector
+
+namespace modules::inventory {
+
+/**
+ * @brief Struct that represents a PCI or USB device.
+ */
+struct Device final {
+    /**
+     * @brief Bus of the device ("PCI" or "USB").
+     */
+    std::string bus;
+
+    /**
+     * @brief Address of the device on its bus (e.g., "0000:00:02.0", "1-1.2", "0x14100000").
+     */
+    std::string address;
+
+    /**
+     * @brief Vendor ID (e.g., "0x8086").
+     */
+    std::uint16_t vendor_id = 0;
+
+    /**
+     * @brief Device ID, or product ID for USB (e.g., "0x3e9b").
+     */
+    std::uint16_t device_id = 0;
+
+    /**
+     * @brief Vendor name (e.g., "Intel Corporation"), empty if unknown.
+     */
+    std::string vendor;
+
+    /**
+     * @brief Device name (e.g., "CoffeeLake-H GT2 [UHD Graphics 630]"), empty if unknown.
+     */
+    std::string name;
+};
+
+/**
+ * @brief Class that looks up vendor and device names in a pci.ids or usb.ids database.
+ *
+ * The text database is parsed once into a binary index (sorted vendor and device records followed by their names), which is stored next to the other cached values and memory-mapped on later runs. The index records the size, modification time and inode of the database, and is rebuilt when any of them changes. A lookup is a binary search in the mapping, without parsing or allocating.
+ *
+ * @note This class is marked as `final` to prevent inheritance.
+ */
+class IdDatabase final {
+  public:
+    /**
+     * @brief Construct a new IdDatabase object, building the index if it is missing or stale.
+     *
+     * @param ids_path Path to the text database (e.g., "/usr/share/hwdata/pci.ids").
+     * @param index_path Path to the binary index (e.g., "~/.cache/applefetch/pci.ids.index"), or std::nullopt to keep the index in memory only.
+     */
+    explicit IdDatabase(const std::filesystem::path &ids_path,
+                        const std::optional<std::filesystem::path> &index_path);
+
+    /**
+     * @brief Destroy the IdDatabase object and unmap the index.
+     */
+    ~IdDatabase();
+
+    IdDatabase(const IdDatabase &) = delete;
+    IdDatabase &operator=(const IdDatabase &) = delete;
+
+    /**
+     * @brief Check whether the database could be read.
+     *
+     * @return True if names can be looked up, false otherwise (e.g., the database is not installed).
+     */
+    [[nodiscard]] bool is_loaded() const noexcept;
+
+    /**
+     * @brief Check whether the index was read from its file rather than built during construction.
+     *
+     * @return True if the index file was up to date, false otherwise.
+     */
+    [[nodiscard]] bool is_mapped() const noexcept;
+
+    /**
+     * @brief Find the name of a vendor.
+     *
+     * @param vendor_id Vendor ID (e.g., "0x8086").
+     *
+     * @return Name (e.g., "Intel Corporation") if known, std::nullopt otherwise.
+     */
+    [[nodiscard]] std::optional<std::string_view> find_vendor(const std::uint16_t vendor_id) const noexcept;
+
+    /**
+     * @brief Find the name of a device.
+     *
+     * @param vendor_id Vendor ID (e.g., "0x8086").
+     * @param device_id Device ID (e.g., "0x3e9b").
+     *
+     * @return Name (e.g., "CoffeeLake-H GT2 [UHD Graphics 630]") if known, std::nullopt otherwise.
+     */
+    [[nodiscard]] std::optional<std::string_view> find_device(const std::uint16_t vendor_id,
+                                                              const std::uint16_t device_id) const noexcept;
+
+  private:
+    /**
+     * @brief Find a name in one of the record tables.
+     *
+     * @param table Index of the table (0 for vendors, 1 for devices).
+     * @param key Key of the record (vendor ID, or vendor ID << 16 | device ID).
+     *
+     * @return Name if found, std::nullopt otherwise.
+     */
+    [[nodiscard]] std::optional<std::string_view> find(const std::size_t table,
+                                                       const std::uint32_t key) const noexcept;
+
+    /**
+     * @brief Index built during construction, if it was not mapped.
+     */
+    std::string built_;
+
+    /**
+     * @brief Start of the mapping of the index file, nullptr if not mapped.
+     */
+    void *mapping_ = nullptr;
+
+    /**
+     * @brief Size of the mapping in bytes.
+     */
+    std::size_t mapping_size_ = 0;
+
+    /**
+     * @brief Start of the index, in the mapping or in "built_"; empty if not loaded.
+     */
+    std::string_view index_;
+};
+
+/**
+ * @brief Build the binary index of a text database.
+ *
+ * @param text Contents of a pci.ids or usb.ids file.
+ * @param source_size Size of the file in bytes, recorded in the header.
+ * @param source_mtime Modification time of the file in nanoseconds, recorded in the header.
+ * @param source_inode Inode of the file, recorded in the header.
+ *
+ * @return Index, ready to be written to a file or used as is.
+ */
+[[nodiscard]] std::string build_index(const std::string_view text,
+                                      const std::uint64_t source_size,
+                                      const std::uint64_t source_mtime,
+                                      const std::uint64_t source_inode);
+
+/**
+ * @brief Read the PCI devices of a sysfs tree.
+ *
+ * Only the "vendor" and "device" attributes of every device are read, on several threads.
+ *
+ * @param root Directory of the devices (e.g., "/sys/bus/pci/devices").
+ *
+ * @return Devices, in address order, without names.
+ */
+[[nodiscard]] std::vector<Device> read_pci_devices(const std::filesystem::path &root);
+
+/**
+ * @brief Read the USB devices of a sysfs tree.
+ *
+ * Interfaces (e.g., "1-1:1.0") are skipped. Only the "idVendor", "idProduct", "manufacturer" and "product" attributes of every device are read, on several threads. The last two are the names reported by the device itself, used when the database does not know it.
+ *
+ * @param root Directory of the devices (e.g., "/sys/bus/usb/devices").
+ *
+ * @return Devices, in address order, with the names they report (if any).
+ */
+[[nodiscard]] std::vector<Device> read_usb_devices(const std::filesystem::path &root);
+
+/**
+ * @brief Fill in the vendor and device names of devices from a database, keeping the names the devices reported if it does not know them.
+ *
+ * @param database Database to look the names up in.
+ * @param devices Devices to name.
+ */
+void resolve_names(const IdDatabase &database,
+                   std::vector<Device> &devices);
+
+/**
+ * @brief Get the PCI and USB devices of this system, with their names.
+ *
+ * On Linux, /sys/bus/pci/devices and /sys/bus/usb/devices are read concurrently. On macOS, the IORegistry is iterated for "IOPCIDevice" and "IOUSBHostDevice" services. The databases are looked up in $APPLEFETCH_PCI_IDS and $APPLEFETCH_USB_IDS first, then in the usual locations (e.g., "/usr/share/hwdata").
+ *
+ * @return Devices, PCI first, each bus in address order.
+ */
+[[nodiscard]] std::vector<Device> get_devices();
+
+/**
+ * @brief Format devices as aligned text, one device per line.
+ *
+ * @param devices Devices to format.
+ *
+ * @return Formatted devices (e.g., "PCI  0000:00:02.0  8086:3e9b  Intel Corporation  CoffeeLake-H GT2 [UHD Graphics 630]\n").
+ */
+[[nodiscard]] std::string format_text(const std::vector<Device> &devices);
+
+/**
+ * @brief Format devices as a JSON document.
+ *
+ * @param devices Devices to format.
+ *
+ * @return JSON document (e.g., {"devices":[{"bus":"PCI","address":"0000:00:02.0","vendor_id":"8086",...}]}).
+ */
+[[nodiscard]] std::string format_json(const std::vector<Device> &devices);
+
+}  // namespace modules::inventory
@@ -0,0 +1,139 @@
+/**
+ * @file logo.cpp
+ */
+
+#include <array>        // for std::array
+#include <cstddef>      // for std::size_t
+#include <string_view>  // for std::string_view
+
+#include "core/art.hpp"
+#include "logo.hpp"
+
+namespace modules::logo {
+
+namespace {
+
+/**
+ * @brief Struct that maps an operating system ID to its logo.
+ */
+struct NamedLogo final {
+    /**
+     * @brief Operating system ID, as in "/etc/os-release" (e.g., "arch").
+     */
+    std::string_view id;
+
+    /**
+     * @brief Compiled logo.
+     */
+    core::art::View view;
+};
+
+constexpr std::string_view apple_art = R"art(
+$1            .8
+          .888
+        .8888'
+       .8888'
+$2  .od8888o.od8888o.
+ d88888888888888888P
+$3 888888888888888P'
+ 88888888888888P
+$4 888888888888888b.
+$5 Y88888888888888888b
+$6  Y8888888888888888P
+   `Y8888P"`Y8888P'
+)art";
+constexpr std::array<std::string_view, 6> apple_palette = {"\033[32m", "\033[33m", "\033[38;5;208m", "\033[31m", "\033[35m", "\033[34m"};
+
+constexpr std::string_view tux_art = R"art(
+$1    .--.
+   |o$2_$1o |
+   |:$2_/$1 |
+  //   \ \
+ (|     | )
+/'\_   _/`\
+\___)=(___/
+)art";
+constexpr std::array<std::string_view, 2> tux_palette = {"\033[37m", "\033[33m"};
+
+constexpr std::string_view arch_art = R"art(
+$1      /\
+     /  \
+    /\   \
+   /      \
+  /   ,,   \
+ /   |  |  -\
+/_-''    ''-_\
+)art";
+constexpr std::array<std::string_view, 1> arch_palette = {"\033[36m"};
+
+constexpr std::string_view debian_art = R"art(
+$1  _____
+ /  __ \
+|  /    |
+|  \___-
+-_
+  --_
+)art";
+constexpr std::array<std::string_view, 1> debian_palette = {"\033[31m"};
+
+constexpr std::string_view fedora_art = R"art(
+$1      _____
+     /   __)$2\
+$1     |  /  $2\ \
+$1  ___|  |__$2/ /
+$1 / (_    _)$2_/
+$1/ /  |  |
+\ \__/  |
+ \(_____/
+)art";
+constexpr std::array<std::string_view, 2> fedora_palette = {"\033[34m", "\033[37m"};
+
+constexpr std::string_view ubuntu_art = R"art(
+$1         _
+     ---(_)
+ _/  ---  \
+(_) |   |
+  \  --- _/
+     ---(_)
+)art";
+constexpr std::array<std::string_view, 1> ubuntu_palette = {"\033[38;5;202m"};
+
+/**
+ * @brief Logos of the supported operating systems.
+ */
+constexpr std::array<NamedLogo, 6> logos = {{
+    {"macos", core::art::compiled<apple_art, apple_palette>.get_view()},
+    {"arch", core::art::compiled<arch_art, arch_palette>.get_view()},
+    {"debian", core::art::compiled<debian_art, debian_palette>.get_view()},
+    {"fedora", core::art::compiled<fedora_art, fedora_palette>.get_view()},
+    {"ubuntu", core::art::compiled<ubuntu_art, ubuntu_palette>.get_view()},
+    {"linux", core::art::compiled<tux_art, tux_palette>.get_view()},
+}};
+
+}  // namespace
+
+core::art::View get_logo(const std::string_view os_ids) noexcept
+{
+    // Try each ID in order, so that derivatives without a logo (e.g., "linuxmint") fall back to their parent (e.g., "ubuntu")
+    std::size_t start = 0;
+    while (start < os_ids.size()) {
+        std::size_t end = os_ids.find(' ', start);
+        if (end == std::string_view::npos) {
+            end = os_ids.size();
+        }
+        const std::string_view id = os_ids.substr(start, end - start);
+        for (const NamedLogo &logo : logos) {
+            if (logo.id == id) {
+                return logo.view;
+            }
+        }
+        start = end + 1;
+    }
+#if defined(__APPLE__)
+    return logos.front().view;
+#else
+    return logos.back().view;
+#endif
+}
+
+}  // namespace modules::logo
@@ -0,0 +1,26 @@
+/**
+ * @file logo.hpp
+ *
+ * @brief Get the ASCII logo of the operating system.
+ */
+
+#pragma once
+
+#include <string_view>  // for std::string_view
+
+#include "core/art.hpp"
+
+namespace modules::logo {
+
+/**
+ * @brief Get the logo that matches the operating system.
+ *
+ * All logos are compiled at compile time, so this only picks one of them.
+ *
+ * @param os_ids Space-separated operating system IDs, from the most to the least specific (e.g., "macos" or "linuxmint ubuntu debian").
+ *
+ * @return Logo of the first ID that has one, or a generic logo for the platform if none do.
+ */
+[[nodiscard]] core::art::View get_logo(const std::string_view os_ids) noexcept;
+
+}  // namespace modules::logo
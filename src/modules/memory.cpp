@@ -2,55 +2,376 @@
  * @file memory.cpp
  */
 
+#include <algorithm>    // for std::min
+#include <array>        // for std::array
+#include <cstddef>      // for std::size_t
 #include <cstdint>      // for std::uint64_t
-#include <mach/mach.h>  // for mach_port_t, mach_host_self, vm_size_t, vm_statistics64_data_t, mach_msg_type_number_t, host_statistics64, HOST_VM_INFO64, HOST_VM_INFO64_COUNT, KERN_SUCCESS
+#include <optional>     // for std::optional, std::nullopt
 #include <string>       // for std::string
+#include <string_view>  // for std::string_view
 
-#include <fmt/core.h>
+#if defined(__APPLE__)
+#include <mach/mach.h>   // for mach_port_t, mach_host_self, vm_size_t, vm_statistics64_data_t, mach_msg_type_number_t, host_statistics64, HOST_VM_INFO64, HOST_VM_INFO64_COUNT, KERN_SUCCESS, MACH_PORT_NULL
+#include <sys/sysctl.h>  // for CTL_VM, VM_SWAPUSAGE, struct xsw_usage
+#elif defined(__linux__)
+#include <charconv>      // for std::from_chars
+#include <fcntl.h>       // for ::open, O_RDONLY, O_CLOEXEC
+#include <sys/types.h>   // for ssize_t
+#include <system_error>  // for std::errc
+#include <unistd.h>      // for ::read, ::close, ::sysconf, _SC_PAGESIZE
+#endif
 
-#include "core/sysctl.hpp"
+#include "cgroup.hpp"
 #include "memory.hpp"
+#include "core/text.hpp"
+#if defined(__APPLE__)
+#include "core/sysctl.hpp"
+#endif
 
 namespace modules::memory {
 
-std::string get_memory_usage()
-{
-    // Fetch total physical memory using the sysctl abstraction
-    const auto total_memory_opt = core::sysctl::get_value<std::uint64_t>("hw.memsize");
-    if (!total_memory_opt) {
-        return "Unknown memory usage (Failed to get hw.memsize)";
-    }
-    const std::uint64_t total_memory = *total_memory_opt;
+#if defined(__APPLE__)
+namespace {
 
-    // Get page size
-    const mach_port_t host_port = mach_host_self();
+/**
+ * @brief Struct that holds the values that never change while the process is running.
+ */
+struct Handles final {
+    /**
+     * @brief Total physical memory in bytes, or 0 if unknown.
+     */
+    std::uint64_t total_memory = 0;
+
+    /**
+     * @brief Host port used for VM statistics queries.
+     */
+    mach_port_t host_port = MACH_PORT_NULL;
+
+    /**
+     * @brief Page size in bytes, or 0 if unknown.
+     */
     vm_size_t page_size = 0;
-    if (host_page_size(host_port, &page_size) != KERN_SUCCESS) {
-        return "Unknown memory usage (Failed to get page size)";
-    }
+};
 
-    // Fetch VM statistics
+/**
+ * @brief Get the handles, looking them up on first use.
+ *
+ * @return Reference to the handles, shared for the lifetime of the process.
+ */
+[[nodiscard]] const Handles &get_handles()
+{
+    // mach_host_self() returns a new send right on every call, so it is only called once
+    static const Handles handles = []() {
+        Handles result;
+        result.total_memory = core::sysctl::get_value<std::uint64_t>("hw.memsize").value_or(0);
+        result.host_port = mach_host_self();
+        if (host_page_size(result.host_port, &result.page_size) != KERN_SUCCESS) {
+            result.page_size = 0;
+        }
+        return result;
+    }();
+    return handles;
+}
+
+/**
+ * @brief Query the VM statistics of the host.
+ *
+ * @return VM statistics if succeeded, std::nullopt otherwise.
+ */
+[[nodiscard]] std::optional<vm_statistics64_data_t> get_vm_statistics()
+{
     vm_statistics64_data_t vm_stats{};
     mach_msg_type_number_t count = HOST_VM_INFO64_COUNT;
+    if (host_statistics64(get_handles().host_port, HOST_VM_INFO64, reinterpret_cast<host_info64_t>(&vm_stats), &count) != KERN_SUCCESS) {
+        return std::nullopt;
+    }
+    return vm_stats;
+}
+
+}  // namespace
 
-    if (host_statistics64(host_port, HOST_VM_INFO64, reinterpret_cast<host_info64_t>(&vm_stats), &count) != KERN_SUCCESS) {
-        return "Unknown memory usage (Failed to get VM statistics)";
+std::optional<Usage> get_usage()
+{
+    const Handles &handles = get_handles();
+    if (handles.total_memory == 0 || handles.page_size == 0) {
+        return std::nullopt;
+    }
+    const auto vm_stats = get_vm_statistics();
+    if (!vm_stats) {
+        return std::nullopt;
     }
 
     // Calculate used memory: active + wired + compressed
-    const std::uint64_t used_memory = (static_cast<std::uint64_t>(vm_stats.active_count) +
-                                       static_cast<std::uint64_t>(vm_stats.wire_count) +
-                                       static_cast<std::uint64_t>(vm_stats.compressor_page_count)) *
-                                      page_size;
+    const std::uint64_t used_memory = (static_cast<std::uint64_t>(vm_stats->active_count) +
+                                       static_cast<std::uint64_t>(vm_stats->wire_count) +
+                                       static_cast<std::uint64_t>(vm_stats->compressor_page_count)) *
+                                      handles.page_size;
+
+    return Usage{used_memory, handles.total_memory};
+}
 
+std::optional<Usage> get_swap_usage()
+{
+    const int mib[] = {CTL_VM, VM_SWAPUSAGE};
+    const std::size_t mib_len = sizeof(mib) / sizeof(int);
+    const auto swap_opt = core::sysctl::get_value<struct xsw_usage>(mib, mib_len);
+    if (!swap_opt) {
+        return std::nullopt;
+    }
+    return Usage{swap_opt->xsu_used, swap_opt->xsu_total};
+}
+
+std::optional<Paging> get_paging()
+{
+    const auto vm_stats = get_vm_statistics();
+    if (!vm_stats) {
+        return std::nullopt;
+    }
+    return Paging{vm_stats->pageins, vm_stats->pageouts, vm_stats->swapins, vm_stats->swapouts};
+}
+
+#elif defined(__linux__)
+namespace {
+
+/**
+ * @brief Struct that represents the counters of a "/proc" file (e.g., "/proc/meminfo"), read into a buffer on the stack.
+ */
+struct ProcFile final {
+    /**
+     * @brief Contents of the file, truncated to the buffer.
+     */
+    std::array<char, 8192> buffer;
+
+    /**
+     * @brief Number of valid bytes in the buffer.
+     */
+    std::size_t size = 0;
+
+    /**
+     * @brief Read a "/proc" file without allocating.
+     *
+     * @param path Path to the file (e.g., "/proc/meminfo").
+     *
+     * @return True if succeeded, false otherwise.
+     */
+    [[nodiscard]] bool read(const char *path) noexcept
+    {
+        const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return false;
+        }
+        this->size = 0;
+        for (ssize_t bytes_read; this->size < this->buffer.size() && (bytes_read = ::read(fd, this->buffer.data() + this->size, this->buffer.size() - this->size)) > 0;) {
+            this->size += static_cast<std::size_t>(bytes_read);
+        }
+        ::close(fd);
+        return this->size != 0;
+    }
+
+    /**
+     * @brief Find the number after a key, at the start of a line (e.g., "MemTotal:       16318412 kB", "pswpin 0").
+     *
+     * @param key Key, including its separator (e.g., "MemTotal:").
+     *
+     * @return Number if found (e.g., "16318412"), std::nullopt otherwise.
+     */
+    [[nodiscard]] std::optional<std::uint64_t> find(const std::string_view key) const noexcept
+    {
+        const std::string_view text(this->buffer.data(), this->size);
+        for (std::size_t start = 0; start < text.size();) {
+            const std::size_t end = std::min(text.find('\n', start), text.size());
+            if (text.compare(start, key.size(), key) == 0) {
+                const std::size_t number = text.find_first_not_of(' ', start + key.size());
+                std::uint64_t value = 0;
+                if (number < end && std::from_chars(text.data() + number, text.data() + end, value).ec == std::errc()) {
+                    return value;
+                }
+                return std::nullopt;
+            }
+            start = end + 1;
+        }
+        return std::nullopt;
+    }
+};
+
+}  // namespace
+
+std::optional<Usage> get_usage()
+{
+    // Available memory is what the kernel could hand out without swapping, page cache included
+    ProcFile meminfo;
+    if (!meminfo.read("/proc/meminfo")) {
+        return std::nullopt;
+    }
+    const auto total = meminfo.find("MemTotal:");
+    const auto available = meminfo.find("MemAvailable:");
+    if (!total || !available || *total == 0) {
+        return std::nullopt;
+    }
+    return Usage{(*total - std::min(*available, *total)) * 1024, *total * 1024};
+}
+
+std::optional<Usage> get_swap_usage()
+{
+    ProcFile meminfo;
+    if (!meminfo.read("/proc/meminfo")) {
+        return std::nullopt;
+    }
+    const auto total = meminfo.find("SwapTotal:");
+    const auto free = meminfo.find("SwapFree:");
+    if (!total || !free) {
+        return std::nullopt;
+    }
+    return Usage{(*total - std::min(*free, *total)) * 1024, *total * 1024};
+}
+
+std::optional<Paging> get_paging()
+{
+    // "pgpgin" and "pgpgout" are counted in KiB, swaps in pages
+    ProcFile vmstat;
+    const long page_size = ::sysconf(_SC_PAGESIZE);
+    if (page_size <= 0 || !vmstat.read("/proc/vmstat")) {
+        return std::nullopt;
+    }
+    const auto pageins = vmstat.find("pgpgin ");
+    const auto pageouts = vmstat.find("pgpgout ");
+    const auto swapins = vmstat.find("pswpin ");
+    const auto swapouts = vmstat.find("pswpout ");
+    if (!pageins || !pageouts || !swapins || !swapouts) {
+        return std::nullopt;
+    }
+    const std::uint64_t kib_per_page = static_cast<std::uint64_t>(page_size) / 1024;
+    return Paging{*pageins / kib_per_page, *pageouts / kib_per_page, *swapins, *swapouts};
+}
+#endif
+
+namespace {
+
+/**
+ * @brief Append memory usage to a string.
+ *
+ * @param usage Memory usage to format.
+ * @param output String to append to (e.g., "11.14GiB / 16.00GiB (69%)").
+ */
+void append_usage(const Usage &usage,
+                  std::string &output)
+{
     // Calculate used memory percentage
-    const int used_memory_percentage = static_cast<int>((used_memory * 100) / total_memory);
+    const int used_memory_percentage = usage.total_bytes == 0 ? 0 : static_cast<int>((usage.used_bytes * 100) / usage.total_bytes);
 
-    // Format the output as "<used_memory>GiB / <total_memory>GiB"
-    return fmt::format("{:.2f}GiB / {:.2f}GiB ({}%)",
-                       used_memory / (1024.0 * 1024.0 * 1024.0),
-                       total_memory / (1024.0 * 1024.0 * 1024.0),
-                       used_memory_percentage);
+    // Format the output as "<used_memory>GiB / <total_memory>GiB (<percentage>%)"
+    core::text::append_fixed(static_cast<double>(usage.used_bytes) / (1024.0 * 1024.0 * 1024.0), 2, output);
+    output.append("GiB / ");
+    core::text::append_fixed(static_cast<double>(usage.total_bytes) / (1024.0 * 1024.0 * 1024.0), 2, output);
+    output.append("GiB (");
+    core::text::append_signed(used_memory_percentage, output);
+    output.append("%)");
+}
+
+/**
+ * @brief Get the memory usage of the container this process runs in.
+ *
+ * @param stats Sample of the cgroup of this process, std::nullopt if there is none.
+ * @param host Memory usage of the host, which caps the limit (e.g., "memory.max" above the physical memory).
+ *
+ * @return Memory usage if the cgroup has a memory limit, std::nullopt otherwise.
+ */
+[[nodiscard]] std::optional<Usage> get_container_usage(const std::optional<modules::cgroup::Stats> &stats,
+                                                      const std::optional<Usage> &host)
+{
+    // Page cache that can be dropped without swapping is not counted, like the working set of container runtimes
+    if (!stats || !stats->memory_max) {
+        return std::nullopt;
+    }
+    const std::uint64_t used = stats->memory_current - std::min(stats->memory_inactive_file, stats->memory_current);
+    return Usage{used, host ? std::min(*stats->memory_max, host->total_bytes) : *stats->memory_max};
+}
+
+/**
+ * @brief Format the memory usage, with the container usage of a cgroup sample first if it has a memory limit.
+ *
+ * @param stats Sample of the cgroup of this process, std::nullopt if there is none.
+ * @param output String to replace with the formatted memory usage.
+ */
+void format_memory_usage(const std::optional<modules::cgroup::Stats> &stats,
+                         std::string &output)
+{
+#if defined(__APPLE__)
+    const Handles &handles = get_handles();
+    if (handles.total_memory == 0) {
+        output.assign("Unknown memory usage (Failed to get hw.memsize)");
+        return;
+    }
+    if (handles.page_size == 0) {
+        output.assign("Unknown memory usage (Failed to get page size)");
+        return;
+    }
+#endif
+    const auto usage = get_usage();
+    if (!usage) {
+#if defined(__APPLE__)
+        output.assign("Unknown memory usage (Failed to get VM statistics)");
+#else
+        output.assign("Unknown memory usage (Failed to read /proc/meminfo)");
+#endif
+        return;
+    }
+
+    // Inside a container with a memory limit, the host total alone would be misleading
+    if (const auto container = get_container_usage(stats, usage)) {
+        format_usage(*container, *usage, output);
+    }
+    else {
+        format_usage(*usage, output);
+    }
+}
+
+}  // namespace
+
+std::optional<Usage> get_container_usage()
+{
+    const modules::cgroup::Reader *reader = modules::cgroup::get_reader();
+    return get_container_usage(reader ? reader->read() : std::nullopt, get_usage());
+}
+
+std::string format_usage(const Usage &usage)
+{
+    std::string output;
+    format_usage(usage, output);
+    return output;
+}
+
+void format_usage(const Usage &usage,
+                  std::string &output)
+{
+    output.clear();
+    append_usage(usage, output);
+}
+
+void format_usage(const Usage &container,
+                  const Usage &host,
+                  std::string &output)
+{
+    output.clear();
+    append_usage(container, output);
+    output.append(" in container, ");
+    append_usage(host, output);
+    output.append(" on host");
+}
+
+void get_memory_usage(std::string &output)
+{
+    // Every refresh reads a new sample of the cgroup
+    const modules::cgroup::Reader *reader = modules::cgroup::get_reader();
+    format_memory_usage(reader ? reader->read() : std::nullopt, output);
+}
+
+std::string get_memory_usage()
+{
+    // A fetch shares its cgroup sample with the CPU field
+    std::string output;
+    format_memory_usage(modules::cgroup::get_stats(), output);
+    return output;
 }
 
 }  // namespace modules::memory
@@ -6,14 +6,128 @@
 
 #pragma once
 
-#include <string>  // for std::string
+#include <cstdint>   // for std::uint64_t
+#include <optional>  // for std::optional
+#include <string>    // for std::string
 
 namespace modules::memory {
 
+/**
+ * @brief Struct that represents memory usage in bytes.
+ */
+struct Usage final {
+    /**
+     * @brief Used memory (active + wired + compressed) in bytes (e.g., "11961823232").
+     */
+    std::uint64_t used_bytes = 0;
+
+    /**
+     * @brief Total physical memory in bytes (e.g., "17179869184").
+     */
+    std::uint64_t total_bytes = 0;
+};
+
+/**
+ * @brief Struct that represents cumulative paging counters since boot, in pages.
+ */
+struct Paging final {
+    /**
+     * @brief Pages read in from disk (e.g., "4318822").
+     */
+    std::uint64_t pageins = 0;
+
+    /**
+     * @brief Pages written out to disk (e.g., "16802").
+     */
+    std::uint64_t pageouts = 0;
+
+    /**
+     * @brief Compressed pages swapped in (e.g., "0").
+     */
+    std::uint64_t swapins = 0;
+
+    /**
+     * @brief Compressed pages swapped out (e.g., "0").
+     */
+    std::uint64_t swapouts = 0;
+};
+
+/**
+ * @brief Get memory usage as numbers.
+ *
+ * On macOS, the total memory, page size and host port are looked up once and kept for the lifetime of the process, so repeated calls (e.g., from long-running callers) only cost a single VM statistics query. On Linux, "/proc/meminfo" is read into a buffer on the stack.
+ *
+ * @return Memory usage if succeeded, std::nullopt otherwise.
+ */
+[[nodiscard]] std::optional<Usage> get_usage();
+
+/**
+ * @brief Get swap usage as numbers.
+ *
+ * @return Swap usage (used and total swap space in bytes) if succeeded, std::nullopt otherwise.
+ */
+[[nodiscard]] std::optional<Usage> get_swap_usage();
+
+/**
+ * @brief Get the cumulative paging counters.
+ *
+ * @return Paging counters if succeeded, std::nullopt otherwise.
+ */
+[[nodiscard]] std::optional<Paging> get_paging();
+
+/**
+ * @brief Get the memory usage of the container (cgroup v2) this process runs in.
+ *
+ * Inactive page cache is not counted as used, and the limit is capped at the host total.
+ *
+ * @return Memory usage if the cgroup has a memory limit, std::nullopt otherwise (e.g., no container, or not Linux).
+ */
+[[nodiscard]] std::optional<Usage> get_container_usage();
+
+/**
+ * @brief Format memory usage as a string (used / total).
+ *
+ * @param usage Memory usage to format.
+ *
+ * @return Formatted memory usage string (e.g., "11.14GiB / 16.00GiB (69%)").
+ */
+[[nodiscard]] std::string format_usage(const Usage &usage);
+
+/**
+ * @brief Format memory usage into an existing string, reusing its capacity.
+ *
+ * @param usage Memory usage to format.
+ * @param output String to replace with the formatted memory usage (e.g., "11.14GiB / 16.00GiB (69%)").
+ */
+void format_usage(const Usage &usage,
+                  std::string &output);
+
+/**
+ * @brief Format container and host memory usage into an existing string, reusing its capacity.
+ *
+ * @param container Memory usage of the container.
+ * @param host Memory usage of the host.
+ * @param output String to replace with the formatted memory usage (e.g., "1.20GiB / 4.00GiB (30%) in container, 11.14GiB / 16.00GiB (69%) on host").
+ */
+void format_usage(const Usage &container,
+                  const Usage &host,
+                  std::string &output);
+
+/**
+ * @brief Get memory usage as a formatted string into an existing string, reusing its capacity.
+ *
+ * A new sample of the cgroup is read on every call, for refreshes (e.g., "--watch").
+ *
+ * @param output String to replace with the formatted memory usage, with the container usage first if the process runs in a container with a memory limit.
+ */
+void get_memory_usage(std::string &output);
+
 /**
  * @brief Get memory usage as a formatted string (used / total).
  *
- * @return Formatted memory usage string (e.g., "11.14GiB / 16.00GiB") if succeeded, "Unknown memory usage ($REASON)" otherwise.
+ * The cgroup sample is the one shared by the fetch (see modules::cgroup::get_stats()).
+ *
+ * @return Formatted memory usage string (e.g., "11.14GiB / 16.00GiB (69%)", "1.20GiB / 4.00GiB (30%) in container, 11.14GiB / 16.00GiB (69%) on host") if succeeded, "Unknown memory usage ($REASON)" otherwise.
  */
 [[nodiscard]] std::string get_memory_usage();
 
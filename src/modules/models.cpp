@@ -0,0 +1,40 @@
+/**
+ * @file models.cpp
+ */
+
+#include <iterator>     // for std::size
+#include <optional>     // for std::optional
+#include <string_view>  // for std::string_view
+
+#include "core/perfect_hash.hpp"
+#include "models.hpp"
+
+namespace modules::models {
+
+namespace {
+
+/**
+ * @brief All known models, generated from "data/models.tsv" at build time.
+ */
+constexpr core::perfect_hash::Entry entries[] = {
+#include "model_names.inc"
+};
+
+/**
+ * @brief Perfect hash map of all known models, built by the compiler.
+ */
+constexpr core::perfect_hash::Map<std::size(entries)> table(entries);
+
+}  // namespace
+
+std::optional<std::string_view> find_name(const std::string_view identifier) noexcept
+{
+    return table.find(identifier);
+}
+
+Table get_table() noexcept
+{
+    return {table.begin(), table.end()};
+}
+
+}  // namespace modules::models
@@ -0,0 +1,69 @@
+/**
+ * @file models.hpp
+ *
+ * @brief Map model identifiers to marketing names.
+ */
+
+#pragma once
+
+#include <optional>     // for std::optional
+#include <string_view>  // for std::string_view
+
+#include "core/perfect_hash.hpp"
+
+namespace modules::models {
+
+/**
+ * @brief Struct that represents all known models, for iteration.
+ */
+struct Table final {
+    /**
+     * @brief Pointer to the first entry.
+     */
+    const core::perfect_hash::Entry *first = nullptr;
+
+    /**
+     * @brief Pointer past the last entry.
+     */
+    const core::perfect_hash::Entry *last = nullptr;
+
+    /**
+     * @brief Get a pointer to the first entry.
+     *
+     * @return Pointer to the first entry.
+     */
+    [[nodiscard]] const core::perfect_hash::Entry *begin() const noexcept
+    {
+        return this->first;
+    }
+
+    /**
+     * @brief Get a pointer past the last entry.
+     *
+     * @return Pointer past the last entry.
+     */
+    [[nodiscard]] const core::perfect_hash::Entry *end() const noexcept
+    {
+        return this->last;
+    }
+};
+
+/**
+ * @brief Find the marketing name of a model.
+ *
+ * The table is generated from "data/models.tsv" and compiled into a perfect hash, so a lookup costs two hashes and one comparison, without any heap use or startup initialization.
+ *
+ * @param identifier Model identifier (e.g., "MacBookPro18,3").
+ *
+ * @return Marketing name (e.g., "MacBook Pro (14-inch, 2021)") if known, std::nullopt otherwise.
+ */
+[[nodiscard]] std::optional<std::string_view> find_name(const std::string_view identifier) noexcept;
+
+/**
+ * @brief Get all known models.
+ *
+ * @return Table of all known models, in no particular order.
+ */
+[[nodiscard]] Table get_table() noexcept;
+
+}  // namespace modules::models
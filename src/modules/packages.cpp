@@ -0,0 +1,332 @@
+/**
+ * @file packages.cpp
+ */
+
+#include <algorithm>     // for std::sort, std::lower_bound, std::max, std::min
+#include <array>         // for std::array
+#include <atomic>        // for std::atomic
+#include <charconv>      // for std::from_chars
+#include <cstddef>       // for std::size_t
+#include <cstdint>       // for std::int64_t
+#include <fcntl.h>       // for ::open, O_RDONLY, O_CLOEXEC
+#include <filesystem>    // for std::filesystem
+#include <optional>      // for std::optional, std::nullopt
+#include <string>        // for std::string
+#include <string_view>   // for std::string_view
+#include <sys/stat.h>    // for ::fstat, struct stat
+#include <sys/types.h>   // for ssize_t
+#include <system_error>  // for std::error_code, std::errc
+#include <thread>        // for std::thread
+#include <unistd.h>      // for ::read, ::close
+#include <utility>       // for std::move
+#include <vector>        // for std::vector
+
+#include "core/cache.hpp"
+#include "core/env.hpp"
+#include "core/json.hpp"
+#include "core/text.hpp"
+#include "packages.hpp"
+
+namespace modules::packages {
+
+namespace {
+
+/**
+ * @brief Number of kegs that justify one additional parsing thread.
+ */
+constexpr std::size_t kegs_per_thread = 64;
+
+/**
+ * @brief Count the non-hidden entries of a directory.
+ *
+ * @param directory Directory to count (e.g., "/opt/homebrew/Caskroom").
+ *
+ * @return Number of entries, or 0 if the directory does not exist.
+ */
+[[nodiscard]] std::size_t count_entries(const std::filesystem::path &directory)
+{
+    std::error_code ec;
+    std::size_t count = 0;
+    for (std::filesystem::directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec)) {
+        if (it->path().filename().native().front() != '.') {
+            ++count;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Read a whole file into a reusable buffer.
+ *
+ * @param path Path to the file (e.g., "/opt/homebrew/opt/git/INSTALL_RECEIPT.json").
+ * @param buffer Buffer to read into. Its capacity is kept between calls, so reading many small files does not reallocate.
+ *
+ * @return True if succeeded, false otherwise.
+ */
+[[nodiscard]] bool read_file(const std::string &path,
+                             std::string &buffer)
+{
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat file_stat;
+    if (::fstat(fd, &file_stat) != 0) {
+        ::close(fd);
+        return false;
+    }
+    buffer.resize(static_cast<std::size_t>(file_stat.st_size));
+    std::size_t total = 0;
+    while (total < buffer.size()) {
+        const ssize_t bytes_read = ::read(fd, buffer.data() + total, buffer.size() - total);
+        if (bytes_read <= 0) {
+            break;
+        }
+        total += static_cast<std::size_t>(bytes_read);
+    }
+    ::close(fd);
+    buffer.resize(total);
+    return true;
+}
+
+/**
+ * @brief Find the receipt of a formula that has no "opt" link, using the greatest installed version.
+ *
+ * @param cellar Path to the Cellar (e.g., "/opt/homebrew/Cellar").
+ * @param name Name of the formula (e.g., "git").
+ *
+ * @return Path to the receipt if found, std::nullopt otherwise.
+ */
+[[nodiscard]] std::optional<std::string> find_receipt_in_cellar(const std::filesystem::path &cellar,
+                                                                const std::string &name)
+{
+    std::error_code ec;
+    std::optional<std::filesystem::path> latest;
+    for (std::filesystem::directory_iterator it(cellar / name, ec), end; !ec && it != end; it.increment(ec)) {
+        if (!latest || it->path() > *latest) {
+            latest = it->path();
+        }
+    }
+    if (!latest) {
+        return std::nullopt;
+    }
+    return (*latest / "INSTALL_RECEIPT.json").string();
+}
+
+/**
+ * @brief Mark all runtime dependencies listed in a receipt.
+ *
+ * Only the "full_name" of each entry in the top-level "runtime_dependencies" array is looked at; everything else is skipped without decoding.
+ *
+ * @param receipt Contents of "INSTALL_RECEIPT.json".
+ * @param names Sorted names of all installed formulae.
+ * @param is_dependency Flags to set, one per name.
+ */
+void mark_dependencies(const std::string_view receipt,
+                       const std::vector<std::string> &names,
+                       std::vector<unsigned char> &is_dependency)
+{
+    core::json::Scanner scanner(receipt);
+    if (scanner.next().type != core::json::TokenType::ObjectBegin) {
+        return;
+    }
+    for (core::json::Token key = scanner.next(); key.type == core::json::TokenType::Key; key = scanner.next()) {
+        if (key.text != "runtime_dependencies") {
+            if (!scanner.skip_value()) {
+                return;
+            }
+            continue;
+        }
+        if (scanner.next().type != core::json::TokenType::ArrayBegin) {
+            // Older receipts store "null" instead of an array
+            continue;
+        }
+        // Each dependency is an object (e.g., {"full_name": "openssl@3", "version": "3.3.1", ...})
+        while (scanner.next().type == core::json::TokenType::ObjectBegin) {
+            for (core::json::Token field = scanner.next(); field.type == core::json::TokenType::Key; field = scanner.next()) {
+                if (field.text != "full_name") {
+                    scanner.skip_value();
+                    continue;
+                }
+                const core::json::Token value = scanner.next();
+                if (value.type != core::json::TokenType::String) {
+                    continue;
+                }
+                // Formulae from third-party taps are prefixed with the tap (e.g., "user/tap/formula")
+                std::string_view name = value.text;
+                if (const std::size_t slash = name.rfind('/'); slash != std::string_view::npos) {
+                    name.remove_prefix(slash + 1);
+                }
+                const auto it = std::lower_bound(names.cbegin(), names.cend(), name,
+                                                 [](const std::string &lhs, const std::string_view rhs) { return lhs < rhs; });
+                if (it != names.cend() && *it == name) {
+                    is_dependency[static_cast<std::size_t>(it - names.cbegin())] = 1;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Get the last modification time of a path as a string, for use in cache keys.
+ *
+ * @param path Path to check (e.g., "/opt/homebrew/Cellar").
+ *
+ * @return Modification time in clock ticks (e.g., "1722470400000000000"), or "0" if the path does not exist.
+ */
+[[nodiscard]] std::string get_mtime(const std::filesystem::path &path)
+{
+    std::error_code ec;
+    const auto mtime = std::filesystem::last_write_time(path, ec);
+    std::string output;
+    core::text::append_signed(ec ? 0 : static_cast<std::int64_t>(mtime.time_since_epoch().count()), output);
+    return output;
+}
+
+/**
+ * @brief Format a Homebrew summary for display.
+ *
+ * @param summary Summary to format.
+ *
+ * @return Formatted string (e.g., "139 (brew, 42 leaves, 3 pinned)").
+ */
+[[nodiscard]] std::string format_summary(const HomebrewSummary &summary)
+{
+    std::string output;
+    core::text::append_unsigned(summary.formulae + summary.casks, output);
+    output.append(" (brew, ");
+    core::text::append_unsigned(summary.leaves, output);
+    output.append(" leaves, ");
+    core::text::append_unsigned(summary.pinned, output);
+    output.append(" pinned)");
+    return output;
+}
+
+}  // namespace
+
+std::optional<std::filesystem::path> get_homebrew_prefix()
+{
+    std::error_code ec;
+    if (const auto prefix = core::env::get_variable("HOMEBREW_PREFIX"); prefix && !prefix->empty()) {
+        if (std::filesystem::is_directory(std::filesystem::path(*prefix) / "Cellar", ec)) {
+            return std::filesystem::path(*prefix);
+        }
+    }
+    for (const char *prefix : {"/opt/homebrew", "/usr/local", "/home/linuxbrew/.linuxbrew"}) {
+        if (std::filesystem::is_directory(std::filesystem::path(prefix) / "Cellar", ec)) {
+            return std::filesystem::path(prefix);
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<HomebrewSummary> scan_homebrew(const std::filesystem::path &prefix)
+{
+    const std::filesystem::path cellar = prefix / "Cellar";
+
+    // Every directory in the Cellar is an installed formula
+    std::vector<std::string> names;
+    std::error_code ec;
+    for (std::filesystem::directory_iterator it(cellar, ec), end; !ec && it != end; it.increment(ec)) {
+        std::string name = it->path().filename().string();
+        if (!name.empty() && name.front() != '.') {
+            names.emplace_back(std::move(name));
+        }
+    }
+    if (ec) {
+        return std::nullopt;
+    }
+    std::sort(names.begin(), names.end());
+
+    // Parse the receipts in parallel, each thread marking dependencies in its own flags to avoid sharing cache lines
+    const std::size_t hardware_threads = std::max(1U, std::thread::hardware_concurrency());
+    const std::size_t thread_count = std::min(hardware_threads, names.size() / kegs_per_thread + 1);
+    std::vector<std::vector<unsigned char>> is_dependency(thread_count, std::vector<unsigned char>(names.size(), 0));
+    std::atomic<std::size_t> next_index{0};
+    const std::string opt_prefix = (prefix / "opt").string() + "/";
+
+    const auto worker = [&](const std::size_t thread_index) {
+        std::string path;
+        std::string receipt;
+        for (std::size_t i = next_index.fetch_add(1, std::memory_order_relaxed); i < names.size(); i = next_index.fetch_add(1, std::memory_order_relaxed)) {
+            // The "opt" link always points to the linked (current) version of the keg
+            path.assign(opt_prefix).append(names[i]).append("/INSTALL_RECEIPT.json");
+            if (!read_file(path, receipt)) {
+                const auto fallback_path = find_receipt_in_cellar(cellar, names[i]);
+                if (!fallback_path || !read_file(*fallback_path, receipt)) {
+                    continue;
+                }
+            }
+            mark_dependencies(receipt, names, is_dependency[thread_index]);
+        }
+    };
+    std::vector<std::thread> threads;
+    threads.reserve(thread_count - 1);
+    for (std::size_t t = 1; t < thread_count; ++t) {
+        threads.emplace_back(worker, t);
+    }
+    worker(0);
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    // Merge the per-thread flags; leaves are formulae that nothing depends on
+    HomebrewSummary summary;
+    summary.formulae = names.size();
+    for (std::size_t i = 0; i < names.size(); ++i) {
+        bool depended_on = false;
+        for (const auto &flags : is_dependency) {
+            depended_on = depended_on || flags[i] != 0;
+        }
+        summary.leaves += depended_on ? 0 : 1;
+    }
+    summary.casks = count_entries(prefix / "Caskroom");
+    summary.pinned = count_entries(prefix / "var" / "homebrew" / "pinned");
+    return summary;
+}
+
+std::string get_packages()
+{
+    const auto prefix = get_homebrew_prefix();
+    if (!prefix) {
+        return "Unknown number of packages (Brew is not installed)";
+    }
+
+    // Installing, upgrading, removing, or pinning a package always changes at least one of these directories
+    const std::string cache_key = "homebrew:" + prefix->string() +
+                                  ':' + get_mtime(*prefix / "Cellar") +
+                                  ':' + get_mtime(*prefix / "opt") +
+                                  ':' + get_mtime(*prefix / "Caskroom") +
+                                  ':' + get_mtime(*prefix / "var" / "homebrew" / "pinned");
+    if (const auto cached = core::cache::load(cache_key)) {
+        // Stored as "<formulae> <casks> <leaves> <pinned>"
+        std::array<std::size_t, 4> values{};
+        const char *position = cached->data();
+        const char *end = cached->data() + cached->size();
+        bool valid = true;
+        for (std::size_t &value : values) {
+            const auto [next, error] = std::from_chars(position, end, value);
+            valid = valid && error == std::errc();
+            position = (next < end) ? next + 1 : end;
+        }
+        if (valid) {
+            return format_summary({values[0], values[1], values[2], values[3]});
+        }
+    }
+
+    const auto summary = scan_homebrew(*prefix);
+    if (!summary) {
+        return "Unknown number of packages (Failed to read the Cellar)";
+    }
+    std::string value;
+    for (const std::size_t count : {summary->formulae, summary->casks, summary->leaves, summary->pinned}) {
+        if (!value.empty()) {
+            value.push_back(' ');
+        }
+        core::text::append_unsigned(count, value);
+    }
+    core::cache::store(cache_key, value);
+    return format_summary(*summary);
+}
+
+}  // namespace modules::packages
@@ -0,0 +1,70 @@
+/**
+ * @file packages.hpp
+ *
+ * @brief Get package manager information.
+ */
+
+#pragma once
+
+#include <cstddef>     // for std::size_t
+#include <filesystem>  // for std::filesystem::path
+#include <optional>    // for std::optional
+#include <string>      // for std::string
+
+namespace modules::packages {
+
+/**
+ * @brief Struct that represents a breakdown of the packages installed with Homebrew.
+ */
+struct HomebrewSummary final {
+    /**
+     * @brief Number of installed formulae (kegs in the Cellar) (e.g., "120").
+     */
+    std::size_t formulae = 0;
+
+    /**
+     * @brief Number of installed casks (e.g., "19").
+     */
+    std::size_t casks = 0;
+
+    /**
+     * @brief Number of formulae that are not a runtime dependency of any other installed formula, like "brew leaves" (e.g., "42").
+     */
+    std::size_t leaves = 0;
+
+    /**
+     * @brief Number of pinned formulae (e.g., "3").
+     */
+    std::size_t pinned = 0;
+};
+
+/**
+ * @brief Get the Homebrew prefix.
+ *
+ * $HOMEBREW_PREFIX is used if set, otherwise the default prefixes are tried ("/opt/homebrew", "/usr/local", "/home/linuxbrew/.linuxbrew").
+ *
+ * @return Path to the prefix (e.g., "/opt/homebrew") if a Cellar was found, std::nullopt otherwise.
+ */
+[[nodiscard]] std::optional<std::filesystem::path> get_homebrew_prefix();
+
+/**
+ * @brief Scan a Homebrew prefix without running brew.
+ *
+ * The "INSTALL_RECEIPT.json" of every keg is parsed in parallel with a streaming JSON scanner to build the dependency graph, the pinned formulae are counted from "var/homebrew/pinned", and the casks from "Caskroom". No caching is done.
+ *
+ * @param prefix Homebrew prefix (e.g., "/opt/homebrew").
+ *
+ * @return Summary if succeeded, std::nullopt otherwise (e.g., the Cellar does not exist).
+ */
+[[nodiscard]] std::optional<HomebrewSummary> scan_homebrew(const std::filesystem::path &prefix);
+
+/**
+ * @brief Get the number of packages installed with Homebrew, including leaves and pinned formulae.
+ *
+ * The result is cached on disk, keyed by the mtimes of the Cellar, "opt", "Caskroom" and pinned directories, which change whenever a package is installed, upgraded, removed, or (un)pinned.
+ *
+ * @return Packages string (e.g., "139 (brew, 42 leaves, 3 pinned)") if succeeded, "Unknown number of packages ($REASON)" otherwise.
+ */
+[[nodiscard]] std::string get_packages();
+
+}  // namespace modules::packages
@@ -0,0 +1,354 @@
+/**
+ * @file plugins.cpp
+ */
+
+#include <algorithm>    // for std::find, std::min
+#include <array>        // for std::array
+#include <cstddef>      // for std::size_t
+#include <cstdint>      // for std::uint32_t
+#include <cstdlib>      // for EXIT_FAILURE, EXIT_SUCCESS
+#include <cstring>      // for std::strcmp
+#include <dlfcn.h>      // for ::dlopen, ::dlsym, ::dlclose, RTLD_NOW, RTLD_LOCAL
+#include <filesystem>   // for std::filesystem
+#include <memory>       // for std::unique_ptr
+#include <optional>     // for std::optional, std::nullopt
+#include <string>       // for std::string
+#include <string_view>  // for std::string_view
+#include <sys/types.h>  // for ssize_t
+#include <thread>       // for std::thread
+#include <unistd.h>     // for ::getpid, ::write, STDOUT_FILENO
+#include <utility>      // for std::move
+#include <vector>       // for std::vector
+
+#include <fmt/core.h>
+
+#include "core/config.hpp"
+#include "core/env.hpp"
+#include "core/process.hpp"
+#include "core/shell.hpp"
+#include "plugins.hpp"
+
+namespace modules::plugins {
+
+namespace {
+
+/**
+ * @brief Remove leading and trailing spaces and tabs.
+ *
+ * @param text Text to trim (e.g., " Agent ").
+ *
+ * @return Trimmed text (e.g., "Agent").
+ */
+[[nodiscard]] std::string_view trim(std::string_view text) noexcept
+{
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+/**
+ * @brief Write a whole buffer to a file descriptor, retrying short writes.
+ *
+ * @param fd File descriptor to write to.
+ * @param data Data to write.
+ *
+ * @return True if succeeded, false otherwise.
+ */
+bool write_all(const int fd,
+               std::string_view data) noexcept
+{
+    while (!data.empty()) {
+        const ssize_t written = ::write(fd, data.data(), data.size());
+        if (written <= 0) {
+            return false;
+        }
+        data.remove_prefix(static_cast<std::size_t>(written));
+    }
+    return true;
+}
+
+}  // namespace
+
+std::optional<std::filesystem::path> get_directory()
+{
+    if (const auto directory = core::env::get_variable("APPLEFETCH_PLUGIN_DIR"); directory && !directory->empty()) {
+        return std::filesystem::path(*directory);
+    }
+    if (const auto config = core::config::get_path()) {
+        return config->parent_path() / "plugins";
+    }
+    return std::nullopt;
+}
+
+std::vector<Request> get_requests(const std::vector<core::config::Section> &sections)
+{
+    std::vector<Request> requests;
+    const auto directory = get_directory();
+    for (const core::config::Section &section : sections) {
+        if (section.kind != "plugin") {
+            continue;
+        }
+        Request request;
+        request.name = section.name;
+        for (const auto &[key, value] : section.entries) {
+            if (key == "fields") {
+                request.fields.clear();
+                for (std::size_t start = 0; start <= value.size();) {
+                    const std::size_t end = std::min(value.find(',', start), value.size());
+                    if (const std::string_view title = trim(std::string_view(value).substr(start, end - start)); !title.empty()) {
+                        request.fields.emplace_back(title);
+                    }
+                    start = end + 1;
+                }
+            }
+            else if (key == "path") {
+                request.path = value;
+            }
+            else if (key == "isolate") {
+                if (value != "yes" && value != "no") {
+                    throw core::config::ConfigError(fmt::format("Invalid config: [plugin {}] isolate = {} (Expected \"yes\" or \"no\")", section.name, value));
+                }
+                request.isolate = value == "yes";
+            }
+            else if (key == "timeout") {
+                const auto timeout = core::config::parse_duration(value);
+                if (!timeout) {
+                    throw core::config::ConfigError(fmt::format("Invalid config: [plugin {}] timeout = {} (Expected a duration such as \"500ms\" or \"2s\")", section.name, value));
+                }
+                request.timeout = *timeout;
+            }
+            else {
+                throw core::config::ConfigError(fmt::format("Invalid config: [plugin {}] {} (Unknown key, expected \"fields\", \"path\", \"isolate\" or \"timeout\")", section.name, key));
+            }
+        }
+        if (request.fields.empty()) {
+            throw core::config::ConfigError(fmt::format("Invalid config: [plugin {}] (Missing \"fields\")", section.name));
+        }
+
+        // Relative paths and the default "NAME.so" are looked up in the plugin directory, never in the library search path
+        if (request.path.empty()) {
+            request.path = request.name + ".so";
+        }
+        if (request.path.is_relative()) {
+            request.path = directory ? *directory / request.path : std::filesystem::path();
+        }
+        requests.push_back(std::move(request));
+    }
+    return requests;
+}
+
+Plugin::Plugin(Request request)
+    : request_(std::move(request)),
+      volatile_(this->request_.fields.size(), false)
+{
+}
+
+Plugin::~Plugin()
+{
+    if (this->handle_) {
+        ::dlclose(this->handle_);
+    }
+}
+
+void Plugin::probe(std::vector<std::string> &values,
+                   const bool volatile_only)
+{
+    values.resize(this->request_.fields.size());
+    if (this->request_.isolate) {
+        this->probe_isolated(values, volatile_only);
+    }
+    else {
+        this->probe_in_process(values, volatile_only);
+    }
+}
+
+const Request &Plugin::get_request() const noexcept
+{
+    return this->request_;
+}
+
+bool Plugin::is_loaded() const noexcept
+{
+    return this->handle_ != nullptr;
+}
+
+bool Plugin::is_volatile(const std::size_t index) const noexcept
+{
+    return this->volatile_[index];
+}
+
+const std::string &Plugin::load()
+{
+    if (this->attempted_) {
+        return this->error_;
+    }
+    this->attempted_ = true;
+    this->indices_.assign(this->request_.fields.size(), std::nullopt);
+    if (this->request_.path.empty() || !(this->handle_ = ::dlopen(this->request_.path.c_str(), RTLD_NOW | RTLD_LOCAL))) {
+        this->error_ = fmt::format("Failed to load plugin {}", this->request_.name);
+        return this->error_;
+    }
+
+    // The version comes first in every descriptor, so it can be checked before trusting the rest of the layout
+    const auto get_descriptor = reinterpret_cast<af_plugin_get_descriptor_function>(::dlsym(this->handle_, AF_PLUGIN_DESCRIPTOR_SYMBOL));
+    const af_plugin_descriptor *descriptor = get_descriptor ? get_descriptor() : nullptr;
+    if (descriptor && descriptor->abi_version != AF_PLUGIN_ABI_VERSION) {
+        this->error_ = fmt::format("Plugin {} uses ABI version {}, expected {}", this->request_.name, descriptor->abi_version, AF_PLUGIN_ABI_VERSION);
+        return this->error_;
+    }
+    if (!descriptor || !descriptor->probe || (descriptor->field_count != 0 && !descriptor->fields)) {
+        this->error_ = fmt::format("Plugin {} has no valid descriptor", this->request_.name);
+        return this->error_;
+    }
+    this->descriptor_ = descriptor;
+    for (std::size_t i = 0; i < this->request_.fields.size(); ++i) {
+        for (std::uint32_t index = 0; index < descriptor->field_count; ++index) {
+            const af_plugin_field &field = descriptor->fields[index];
+            if (field.title && std::strcmp(field.title, this->request_.fields[i].c_str()) == 0) {
+                this->indices_[i] = index;
+                this->volatile_[i] = field.volatility == AF_PLUGIN_VOLATILE;
+                break;
+            }
+        }
+    }
+    return this->error_;
+}
+
+void Plugin::probe_in_process(std::vector<std::string> &values,
+                              const bool volatile_only)
+{
+    const std::string &error = this->load();
+    std::array<char, max_value_size> buffer;
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        const std::string &title = this->request_.fields[i];
+        if (volatile_only && !this->volatile_[i]) {
+            continue;
+        }
+        if (!error.empty()) {
+            values[i] = fmt::format("Unknown {} ({})", title, error);
+            continue;
+        }
+        if (!this->indices_[i]) {
+            values[i] = fmt::format("Unknown {} (Not provided by plugin {})", title, this->request_.name);
+            continue;
+        }
+
+        // The value is written into a buffer of ours, so that refreshing it reuses the capacity of the field
+        buffer.front() = '\0';
+        const int status = this->descriptor_->probe(*this->indices_[i], buffer.data(), buffer.size());
+        buffer.back() = '\0';
+        if (status != 0) {
+            values[i] = fmt::format("Unknown {} (Probe failed with status {})", title, status);
+        }
+        else if (buffer.front() == '\0') {
+            values[i] = fmt::format("Unknown {} (No output)", title);
+        }
+        else {
+            values[i].assign(buffer.data());
+        }
+    }
+}
+
+void Plugin::probe_isolated(std::vector<std::string> &values,
+                            const bool volatile_only)
+{
+    // Until a first probe reported which fields are volatile, none are
+    if (volatile_only && std::find(this->volatile_.begin(), this->volatile_.end(), true) == this->volatile_.end()) {
+        return;
+    }
+    const auto fail = [&](const auto &reason) {
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            if (!volatile_only || this->volatile_[i]) {
+                values[i] = fmt::format("Unknown {} ({})", this->request_.fields[i], reason);
+            }
+        }
+    };
+
+    // The plugin is probed by a new process of this executable rather than a fork, which is unsafe while other threads run
+    const auto executable = core::process::get_executable_path(::getpid());
+    std::vector<std::string> arguments = {"applefetch", std::string(host_argument), this->request_.name, this->request_.path.string(), volatile_only ? "volatile" : "all"};
+    arguments.insert(arguments.end(), this->request_.fields.begin(), this->request_.fields.end());
+    const auto output = executable ? core::shell::spawn(*executable, arguments, this->request_.timeout, values.size() * (max_value_size + 1)) : std::nullopt;
+    if (!output) {
+        fail(fmt::format("Failed to start plugin {}", this->request_.name));
+        return;
+    }
+    if (output->timed_out) {
+        fail(fmt::format("Timed out after {} ms", this->request_.timeout.count()));
+        return;
+    }
+    if (output->term_signal != 0) {
+        fail(fmt::format("Plugin {} crashed with signal {}", this->request_.name, output->term_signal));
+        return;
+    }
+    if (output->exit_code != 0 || output->truncated) {
+        fail(fmt::format("Plugin {} failed", this->request_.name));
+        return;
+    }
+    std::string_view records(output->text);
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        const std::size_t end = records.find('\0');
+        if (records.empty() || end == std::string_view::npos) {
+            fail(fmt::format("Plugin {} failed", this->request_.name));
+            return;
+        }
+        this->volatile_[i] = records.front() == 'V';
+        if (end > 1) {
+            values[i].assign(records.substr(1, end - 1));
+        }
+        records.remove_prefix(end + 1);
+    }
+}
+
+int run_host(const int argc,
+             char **argv)
+{
+    // "applefetch --plugin-host NAME PATH all|volatile FIELD..."
+    if (argc < 6) {
+        return EXIT_FAILURE;
+    }
+    Request request;
+    request.name = argv[2];
+    request.path = argv[3];
+    const bool volatile_only = std::string_view(argv[4]) == "volatile";
+    for (int i = 5; i < argc; ++i) {
+        request.fields.emplace_back(argv[i]);
+    }
+    Plugin plugin(std::move(request));
+    std::vector<std::string> values;
+    plugin.probe(values, volatile_only);
+
+    // Every value is sent as a volatility flag, then the value itself up to a null byte; an empty value is one that was skipped
+    std::string records;
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        records += plugin.is_volatile(i) ? 'V' : 'S';
+        if (!volatile_only || plugin.is_volatile(i)) {
+            records += values[i];
+        }
+        records += '\0';
+    }
+    return write_all(STDOUT_FILENO, records) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+std::vector<std::vector<std::string>> run_plugins(const std::vector<std::unique_ptr<Plugin>> &plugins)
+{
+    // Like commands, plugins mostly wait on something else (e.g., an agent), so every plugin gets its own thread
+    std::vector<std::vector<std::string>> values(plugins.size());
+    std::vector<std::thread> threads;
+    threads.reserve(plugins.size());
+    for (std::size_t i = 0; i < plugins.size(); ++i) {
+        threads.emplace_back([&plugins, &values, i] {
+            plugins[i]->probe(values[i]);
+        });
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    return values;
+}
+
+}  // namespace modules::plugins
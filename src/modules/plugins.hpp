@@ -0,0 +1,226 @@
+/**
+ * @file plugins.hpp
+ *
+ * @brief Load plugins and probe the fields they provide.
+ */
+
+#pragma once
+
+#include <chrono>       // for std::chrono::milliseconds
+#include <cstddef>      // for std::size_t
+#include <cstdint>      // for std::uint32_t
+#include <filesystem>   // for std::filesystem::path
+#include <memory>       // for std::unique_ptr
+#include <optional>     // for std::optional
+#include <string>       // for std::string
+#include <string_view>  // for std::string_view
+#include <vector>       // for std::vector
+
+#include "capi/applefetch_plugin.h"
+#include "core/config.hpp"
+
+namespace modules::plugins {
+
+/**
+ * @brief Size of the buffer a probe writes a value to, including the terminator; longer values are truncated.
+ */
+inline constexpr std::size_t max_value_size = 256;
+
+/**
+ * @brief Hidden first argument that makes the executable probe an isolated plugin and print its values, instead of a fetch.
+ */
+inline constexpr std::string_view host_argument = "--plugin-host";
+
+/**
+ * @brief Struct that represents a plugin requested by the configuration file (e.g., "[plugin agent]").
+ */
+struct Request final {
+    /**
+     * @brief Name of the plugin (e.g., "agent").
+     */
+    std::string name;
+
+    /**
+     * @brief Path to the shared object (e.g., "/Users/user/.config/applefetch/plugins/agent.so").
+     */
+    std::filesystem::path path;
+
+    /**
+     * @brief Titles of the requested fields, in order (e.g., {"Agent"}).
+     */
+    std::vector<std::string> fields;
+
+    /**
+     * @brief Whether the plugin is loaded and probed in a child process, so that a crash only loses its fields.
+     */
+    bool isolate = false;
+
+    /**
+     * @brief Maximum time to wait for an isolated plugin (e.g., "1000ms").
+     */
+    std::chrono::milliseconds timeout{1000};
+};
+
+/**
+ * @brief Get the directory plugins are loaded from.
+ *
+ * The first available location is used: $APPLEFETCH_PLUGIN_DIR, then the "plugins" directory next to the configuration file (e.g., "~/.config/applefetch/plugins").
+ *
+ * @return Path to the plugin directory if succeeded, std::nullopt otherwise (e.g., $HOME is not set).
+ */
+[[nodiscard]] std::optional<std::filesystem::path> get_directory();
+
+/**
+ * @brief Get the plugins requested by the configuration file.
+ *
+ * Every "[plugin NAME]" section requests the comma-separated titles in "fields" (required) from "NAME.so" in the plugin directory, or from "path". With "isolate = yes", the plugin runs in a child process that is killed after "timeout". Other sections are ignored.
+ *
+ * @param sections Sections of the configuration file.
+ *
+ * @return Requests, in the order of the file.
+ *
+ * @throws core::config::ConfigError If a plugin has no "fields", an unknown key or an invalid value.
+ */
+[[nodiscard]] std::vector<Request> get_requests(const std::vector<core::config::Section> &sections);
+
+/**
+ * @brief Class that owns a plugin and probes the requested fields.
+ *
+ * The shared object is only opened by the first probe, and stays loaded until the object is destroyed.
+ *
+ * @note This class is marked as `final` to prevent inheritance.
+ */
+class Plugin final {
+  public:
+    /**
+     * @brief Construct a new Plugin object, without loading the shared object.
+     *
+     * @param request Plugin and fields to probe.
+     */
+    explicit Plugin(Request request);
+
+    /**
+     * @brief Destroy the Plugin object and unload the shared object.
+     */
+    ~Plugin();
+
+    Plugin(const Plugin &) = delete;
+    Plugin &operator=(const Plugin &) = delete;
+
+    /**
+     * @brief Probe the requested fields, loading the plugin on first use.
+     *
+     * @param values Values of the requested fields, resized to match and overwritten in place (e.g., {"healthy"}); "Unknown $TITLE ($REASON)" for the fields that failed.
+     * @param volatile_only Whether to only probe the fields the plugin marks as volatile, and leave the others untouched.
+     */
+    void probe(std::vector<std::string> &values,
+               const bool volatile_only = false);
+
+    /**
+     * @brief Get the request of the plugin.
+     *
+     * @return Plugin and fields to probe.
+     */
+    [[nodiscard]] const Request &get_request() const noexcept;
+
+    /**
+     * @brief Check whether the shared object was opened in this process.
+     *
+     * @return True if it was opened, false if it was not probed yet or is isolated.
+     */
+    [[nodiscard]] bool is_loaded() const noexcept;
+
+    /**
+     * @brief Check whether a requested field is volatile, as reported by the plugin.
+     *
+     * @param index Index of the field in the request (e.g., "0").
+     *
+     * @return True if the field is volatile, false if it is not or the plugin was not probed yet.
+     */
+    [[nodiscard]] bool is_volatile(const std::size_t index) const noexcept;
+
+  private:
+    /**
+     * @brief Open the shared object and match the requested fields against its descriptor, once.
+     *
+     * @return Empty string if succeeded, the reason otherwise (e.g., "Failed to load plugin agent").
+     */
+    const std::string &load();
+
+    /**
+     * @brief Probe the requested fields in this process.
+     *
+     * @param values Values of the requested fields.
+     * @param volatile_only Whether to only probe the volatile fields.
+     */
+    void probe_in_process(std::vector<std::string> &values,
+                          const bool volatile_only);
+
+    /**
+     * @brief Probe the requested fields in a new process of this executable, started with host_argument.
+     *
+     * @param values Values of the requested fields.
+     * @param volatile_only Whether to only probe the volatile fields.
+     */
+    void probe_isolated(std::vector<std::string> &values,
+                        const bool volatile_only);
+
+    /**
+     * @brief Plugin and fields to probe.
+     */
+    Request request_;
+
+    /**
+     * @brief Handle returned by dlopen(), nullptr if the shared object is not open.
+     */
+    void *handle_ = nullptr;
+
+    /**
+     * @brief Descriptor of the plugin, nullptr if it is not loaded.
+     */
+    const af_plugin_descriptor *descriptor_ = nullptr;
+
+    /**
+     * @brief Index in the descriptor of every requested field, std::nullopt if the plugin does not provide it.
+     */
+    std::vector<std::optional<std::uint32_t>> indices_;
+
+    /**
+     * @brief Whether every requested field is volatile; filled by the first probe.
+     */
+    std::vector<bool> volatile_;
+
+    /**
+     * @brief Reason why the plugin could not be loaded, empty if it was or was not tried yet.
+     */
+    std::string error_;
+
+    /**
+     * @brief Whether loading was attempted.
+     */
+    bool attempted_ = false;
+};
+
+/**
+ * @brief Probe an isolated plugin on behalf of its parent, and print the values on stdout.
+ *
+ * Every executable that probes isolated plugins must call this from main() when its first argument is host_argument. The values are printed as records of a volatility flag ("V" or "S"), the value and a null byte.
+ *
+ * @param argc Number of command-line arguments (e.g., "6").
+ * @param argv Command-line arguments (e.g., {"applefetch", "--plugin-host", "agent", "/path/to/agent.so", "all", "Agent"}).
+ *
+ * @return EXIT_SUCCESS if the values were printed, EXIT_FAILURE otherwise.
+ */
+[[nodiscard]] int run_host(const int argc,
+                           char **argv);
+
+/**
+ * @brief Probe plugins concurrently, each in its own thread.
+ *
+ * @param plugins Plugins to probe.
+ *
+ * @return Values of the requested fields of every plugin, in order.
+ */
+[[nodiscard]] std::vector<std::vector<std::string>> run_plugins(const std::vector<std::unique_ptr<Plugin>> &plugins);
+
+}  // namespace modules::plugins
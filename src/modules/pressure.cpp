@@ -0,0 +1,363 @@
+/**
+ * @file pressure.cpp
+ */
+
+#include <algorithm>    // for std::min
+#include <array>        // for std::array
+#include <cstddef>      // for std::size_t
+#include <cstdint>      // for std::uint64_t
+#include <optional>     // for std::optional, std::nullopt
+#include <string>       // for std::string
+#include <string_view>  // for std::string_view
+
+#if defined(__APPLE__)
+#include <cstdlib>       // for ::getloadavg
+#include <sys/sysctl.h>  // for ::sysctlnametomib
+#else
+#include <fcntl.h>      // for ::open, O_RDONLY, O_CLOEXEC
+#include <sys/types.h>  // for ssize_t
+#include <unistd.h>     // for ::pread, ::close
+#endif
+
+#include "core/text.hpp"
+#include "pressure.hpp"
+
+namespace modules::pressure {
+
+namespace {
+
+/**
+ * @brief Names of the resources, in the order of Sample::stalls.
+ */
+constexpr std::array<std::string_view, 3> resource_names = {"CPU", "memory", "IO"};
+
+/**
+ * @brief Class that reads a text one field at a time, for the fixed formats written by the kernel.
+ */
+class Cursor final {
+  public:
+    /**
+     * @brief Construct a new Cursor object.
+     *
+     * @param text Text to read (e.g., "0.52 0.48 0.40 2/1234 56789\n").
+     */
+    explicit Cursor(const std::string_view text) noexcept
+        : text_(text)
+    {
+    }
+
+    /**
+     * @brief Skip a literal.
+     *
+     * @param literal Literal expected at the position (e.g., " avg10=").
+     *
+     * @return True if the literal was there, false otherwise.
+     */
+    [[nodiscard]] bool skip(const std::string_view literal) noexcept
+    {
+        if (this->text_.compare(this->position_, literal.size(), literal) != 0) {
+            return false;
+        }
+        this->position_ += literal.size();
+        return true;
+    }
+
+    /**
+     * @brief Read an unsigned integer.
+     *
+     * @return Number if there was at least one digit (e.g., "81234567"), std::nullopt otherwise.
+     */
+    [[nodiscard]] std::optional<std::uint64_t> read_integer() noexcept
+    {
+        const std::size_t start = this->position_;
+        std::uint64_t value = 0;
+        for (; this->position_ < this->text_.size() && this->text_[this->position_] >= '0' && this->text_[this->position_] <= '9'; ++this->position_) {
+            value = value * 10 + static_cast<std::uint64_t>(this->text_[this->position_] - '0');
+        }
+        if (this->position_ == start) {
+            return std::nullopt;
+        }
+        return value;
+    }
+
+    /**
+     * @brief Read a number with exactly two decimals, which is how the kernel prints load averages and PSI averages.
+     *
+     * @return Number if succeeded (e.g., "1.2" for "1.20"), std::nullopt otherwise.
+     */
+    [[nodiscard]] std::optional<double> read_hundredths() noexcept
+    {
+        const auto integer = this->read_integer();
+        if (!integer || !this->skip(".")) {
+            return std::nullopt;
+        }
+        const std::size_t start = this->position_;
+        const auto fraction = this->read_integer();
+        if (!fraction || this->position_ - start != 2) {
+            return std::nullopt;
+        }
+        return static_cast<double>(*integer * 100 + *fraction) / 100.0;
+    }
+
+    /**
+     * @brief Move to the start of the next line.
+     */
+    void next_line() noexcept
+    {
+        this->position_ = std::min(this->text_.find('\n', this->position_), this->text_.size());
+        if (this->position_ < this->text_.size()) {
+            ++this->position_;
+        }
+    }
+
+  private:
+    /**
+     * @brief Text to read.
+     */
+    std::string_view text_;
+
+    /**
+     * @brief Position of the next field.
+     */
+    std::size_t position_ = 0;
+};
+
+/**
+ * @brief Parse a line of a PSI file, after its "some" or "full" prefix.
+ *
+ * @param cursor Cursor at the " avg10=" field.
+ *
+ * @return Stall if succeeded, std::nullopt otherwise.
+ */
+[[nodiscard]] std::optional<Stall> parse_stall(Cursor &cursor) noexcept
+{
+    Stall stall;
+    std::optional<double> average;
+    if (!cursor.skip(" avg10=") || !(average = cursor.read_hundredths())) {
+        return std::nullopt;
+    }
+    stall.avg10 = *average;
+    if (!cursor.skip(" avg60=") || !(average = cursor.read_hundredths())) {
+        return std::nullopt;
+    }
+    stall.avg60 = *average;
+    if (!cursor.skip(" avg300=") || !(average = cursor.read_hundredths())) {
+        return std::nullopt;
+    }
+    stall.avg300 = *average;
+    const auto total = cursor.skip(" total=") ? cursor.read_integer() : std::nullopt;
+    if (!total) {
+        return std::nullopt;
+    }
+    stall.total_us = *total;
+    return stall;
+}
+
+/**
+ * @brief Append the load averages (e.g., "0.52, 0.48, 0.40").
+ *
+ * @param load Load averages to append.
+ * @param output String to append to.
+ */
+void append_load(const LoadAverage &load,
+                 std::string &output)
+{
+    core::text::append_fixed(load.one, 2, output);
+    output.append(", ");
+    core::text::append_fixed(load.five, 2, output);
+    output.append(", ");
+    core::text::append_fixed(load.fifteen, 2, output);
+}
+
+/**
+ * @brief Format a sample, with the share of time stalled on every resource given by a function.
+ *
+ * @tparam Function Type of the function.
+ * @param sample Sample to format.
+ * @param get_percentage Function that returns the percentage of time stalled on a resource, from its index.
+ * @param output String to write to.
+ */
+template <typename Function>
+void format(const Sample &sample,
+            const Function &get_percentage,
+            std::string &output)
+{
+    output.clear();
+    if (!sample.load) {
+#if defined(__APPLE__)
+        output.assign("Unknown load (Failed to get load averages)");
+#else
+        output.assign("Unknown load (Failed to read /proc/loadavg)");
+#endif
+        return;
+    }
+    append_load(*sample.load, output);
+
+    // Resources without PSI are left out, and the whole suffix too when there is none
+    bool first = true;
+    for (std::size_t i = 0; i < sample.stalls.size(); ++i) {
+        if (!sample.stalls[i]) {
+            continue;
+        }
+        output.append(first ? " (stalled: " : ", ").append(resource_names[i]).append(" ");
+        core::text::append_fixed(get_percentage(i), 2, output);
+        output.append("%");
+        first = false;
+    }
+    if (!first) {
+        output.append(")");
+    }
+
+    if (sample.level) {
+        switch (*sample.level) {
+        case Level::Normal:
+            output.append(" (memory pressure normal)");
+            break;
+        case Level::Warning:
+            output.append(" (memory pressure warning)");
+            break;
+        case Level::Critical:
+            output.append(" (memory pressure critical)");
+            break;
+        }
+    }
+}
+
+}  // namespace
+
+std::optional<LoadAverage> parse_loadavg(const std::string_view text) noexcept
+{
+    Cursor cursor(text);
+    const auto one = cursor.read_hundredths();
+    const auto five = one && cursor.skip(" ") ? cursor.read_hundredths() : std::nullopt;
+    const auto fifteen = five && cursor.skip(" ") ? cursor.read_hundredths() : std::nullopt;
+    if (!fifteen) {
+        return std::nullopt;
+    }
+    return LoadAverage{*one, *five, *fifteen};
+}
+
+std::optional<Stalls> parse_stalls(const std::string_view text) noexcept
+{
+    // "full" is optional, as the system-wide "cpu" file only has it since Linux 5.13
+    Cursor cursor(text);
+    Stalls stalls;
+    if (!cursor.skip("some")) {
+        return std::nullopt;
+    }
+    const auto some = parse_stall(cursor);
+    if (!some) {
+        return std::nullopt;
+    }
+    stalls.some = *some;
+    cursor.next_line();
+    if (cursor.skip("full")) {
+        stalls.full = parse_stall(cursor).value_or(Stall{});
+    }
+    return stalls;
+}
+
+#if defined(__APPLE__)
+Sampler::Sampler(const std::string &)
+{
+    std::size_t size = this->level_oid_.parts.size();
+    if (::sysctlnametomib("kern.memorystatus_vm_pressure_level", this->level_oid_.parts.data(), &size) == 0) {
+        this->level_oid_.size = size;
+    }
+}
+
+Sampler::~Sampler() = default;
+
+Sample Sampler::read() const noexcept
+{
+    Sample sample;
+    double loads[3] = {};
+    if (::getloadavg(loads, 3) == 3) {
+        sample.load = LoadAverage{loads[0], loads[1], loads[2]};
+    }
+    if (this->level_oid_.size != 0) {
+        const auto level = core::sysctl::get_value<int>(this->level_oid_.parts.data(), this->level_oid_.size);
+        if (level && (*level == 1 || *level == 2 || *level == 4)) {
+            sample.level = static_cast<Level>(*level);
+        }
+    }
+    return sample;
+}
+
+#else
+Sampler::Sampler(const std::string &proc)
+    : fds_{::open((proc + "/loadavg").c_str(), O_RDONLY | O_CLOEXEC),
+           ::open((proc + "/pressure/cpu").c_str(), O_RDONLY | O_CLOEXEC),
+           ::open((proc + "/pressure/memory").c_str(), O_RDONLY | O_CLOEXEC),
+           ::open((proc + "/pressure/io").c_str(), O_RDONLY | O_CLOEXEC)}
+{
+}
+
+Sampler::~Sampler()
+{
+    for (const int fd : this->fds_) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+}
+
+Sample Sampler::read() const noexcept
+{
+    // Reading from offset 0 makes procfs generate the file again, so the descriptors never need to be reopened or seeked
+    Sample sample;
+    std::array<char, 256> buffer;
+    for (std::size_t i = 0; i < this->fds_.size(); ++i) {
+        if (this->fds_[i] < 0) {
+            continue;
+        }
+        const ssize_t length = ::pread(this->fds_[i], buffer.data(), buffer.size(), 0);
+        if (length <= 0) {
+            continue;
+        }
+        const std::string_view text(buffer.data(), static_cast<std::size_t>(length));
+        if (i == 0) {
+            sample.load = parse_loadavg(text);
+        }
+        else {
+            sample.stalls[i - 1] = parse_stalls(text);
+        }
+    }
+    return sample;
+}
+#endif
+
+void format_sample(const Sample &sample,
+                   std::string &output)
+{
+    format(sample, [&sample](const std::size_t i) { return sample.stalls[i]->some.avg10; }, output);
+}
+
+void format_rates(const Sample &previous,
+                  const Sample &current,
+                  const std::uint64_t elapsed_us,
+                  std::string &output)
+{
+    // Without an earlier total (e.g., the file could not be read last time), the kernel average is the best estimate
+    format(
+        current,
+        [&previous, &current, elapsed_us](const std::size_t i) {
+            const Stall &now = current.stalls[i]->some;
+            if (!previous.stalls[i] || elapsed_us == 0 || now.total_us < previous.stalls[i]->some.total_us) {
+                return now.avg10;
+            }
+            const double stalled = static_cast<double>(now.total_us - previous.stalls[i]->some.total_us) * 100.0 / static_cast<double>(elapsed_us);
+            return std::min(stalled, 100.0);
+        },
+        output);
+}
+
+std::string get_pressure()
+{
+    const Sampler sampler;
+    std::string output;
+    format_sample(sampler.read(), output);
+    return output;
+}
+
+}  // namespace modules::pressure
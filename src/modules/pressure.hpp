@@ -0,0 +1,207 @@
+/**
+ * @file pressure.hpp
+ *
+ * @brief Get the load averages and how much the system stalls on CPU, memory and IO (Linux PSI, macOS memory pressure level).
+ */
+
+#pragma once
+
+#include <array>        // for std::array
+#include <cstdint>      // for std::uint64_t
+#include <optional>     // for std::optional
+#include <string>       // for std::string
+#include <string_view>  // for std::string_view
+
+#if defined(__APPLE__)
+#include "core/sysctl.hpp"
+#endif
+
+namespace modules::pressure {
+
+/**
+ * @brief Struct that represents the load averages (number of runnable threads, averaged over time).
+ */
+struct LoadAverage final {
+    /**
+     * @brief Average over the last minute (e.g., "2.41").
+     */
+    double one = 0.0;
+
+    /**
+     * @brief Average over the last 5 minutes (e.g., "2.12").
+     */
+    double five = 0.0;
+
+    /**
+     * @brief Average over the last 15 minutes (e.g., "1.98").
+     */
+    double fifteen = 0.0;
+};
+
+/**
+ * @brief Struct that represents one line of a PSI file (e.g., "some avg10=1.20 avg60=0.85 avg300=0.40 total=81234567").
+ */
+struct Stall final {
+    /**
+     * @brief Percentage of time stalled over the last 10 seconds (e.g., "1.2").
+     */
+    double avg10 = 0.0;
+
+    /**
+     * @brief Percentage of time stalled over the last minute (e.g., "0.85").
+     */
+    double avg60 = 0.0;
+
+    /**
+     * @brief Percentage of time stalled over the last 5 minutes (e.g., "0.4").
+     */
+    double avg300 = 0.0;
+
+    /**
+     * @brief Time stalled since boot in microseconds (e.g., "81234567").
+     */
+    std::uint64_t total_us = 0;
+};
+
+/**
+ * @brief Struct that represents a PSI file, where "some" counts the time at least one task stalled and "full" the time all of them did.
+ */
+struct Stalls final {
+    /**
+     * @brief Time at least one task stalled.
+     */
+    Stall some;
+
+    /**
+     * @brief Time all non-idle tasks stalled at once; zero for files without a "full" line (e.g., "cpu" before Linux 5.13).
+     */
+    Stall full;
+};
+
+/**
+ * @brief Enum that represents the memory pressure level of macOS, with the values of "kern.memorystatus_vm_pressure_level".
+ */
+enum class Level : int {
+    Normal = 1,
+    Warning = 2,
+    Critical = 4,
+};
+
+/**
+ * @brief Struct that represents one sample of the load and pressure of the system.
+ */
+struct Sample final {
+    /**
+     * @brief Load averages, std::nullopt if they could not be read.
+     */
+    std::optional<LoadAverage> load;
+
+    /**
+     * @brief Stalls on CPU, memory and IO, in that order, std::nullopt where PSI is not available (e.g., macOS, or a kernel without "CONFIG_PSI").
+     */
+    std::array<std::optional<Stalls>, 3> stalls;
+
+    /**
+     * @brief Memory pressure level on macOS, std::nullopt elsewhere.
+     */
+    std::optional<Level> level;
+};
+
+/**
+ * @brief Parse the load averages of "/proc/loadavg" without allocating.
+ *
+ * @param text Contents of the file (e.g., "0.52 0.48 0.40 2/1234 56789\n").
+ *
+ * @return Load averages if succeeded, std::nullopt otherwise.
+ */
+[[nodiscard]] std::optional<LoadAverage> parse_loadavg(const std::string_view text) noexcept;
+
+/**
+ * @brief Parse a PSI file without allocating.
+ *
+ * The format is fixed by the kernel, so every line is matched field by field rather than split into words.
+ *
+ * @param text Contents of the file (e.g., "some avg10=1.20 avg60=0.85 avg300=0.40 total=81234567\nfull avg10=0.00 avg60=0.00 avg300=0.00 total=0\n").
+ *
+ * @return Stalls if the "some" line was parsed, std::nullopt otherwise.
+ */
+[[nodiscard]] std::optional<Stalls> parse_stalls(const std::string_view text) noexcept;
+
+/**
+ * @brief Class that samples the load and pressure repeatedly (e.g., in watch mode), without opening any file or allocating after construction.
+ *
+ * On Linux, "/proc/loadavg" and "/proc/pressure/{cpu,memory,io}" are opened once and read again from the start with pread(), which regenerates their contents. On macOS, the MIB of "kern.memorystatus_vm_pressure_level" is resolved once.
+ *
+ * @note This class is marked as `final` to prevent inheritance.
+ */
+class Sampler final {
+  public:
+    /**
+     * @brief Construct a new Sampler object.
+     *
+     * @param proc Directory where procfs is mounted (e.g., "/proc"), ignored on macOS.
+     */
+    explicit Sampler(const std::string &proc = "/proc");
+
+    /**
+     * @brief Close the files.
+     */
+    ~Sampler();
+
+    // Disable copy semantics, as the files would be closed twice
+    Sampler(const Sampler &) = delete;
+    Sampler &operator=(const Sampler &) = delete;
+
+    /**
+     * @brief Read a sample.
+     *
+     * @return Sample, with std::nullopt for every value that could not be read.
+     */
+    [[nodiscard]] Sample read() const noexcept;
+
+  private:
+#if defined(__APPLE__)
+    /**
+     * @brief MIB of "kern.memorystatus_vm_pressure_level", empty if it does not exist.
+     */
+    core::sysctl::Oid level_oid_;
+#else
+    /**
+     * @brief Descriptors of "loadavg", "pressure/cpu", "pressure/memory" and "pressure/io", in that order, -1 for the ones that could not be opened.
+     */
+    std::array<int, 4> fds_;
+#endif
+};
+
+/**
+ * @brief Format a sample, with the stalls averaged by the kernel over the last 10 seconds.
+ *
+ * @param sample Sample to format.
+ * @param output String to write to (e.g., "0.52, 0.48, 0.40 (stalled: CPU 1.20%, memory 0.00%, IO 0.31%)", "2.41, 2.12, 1.98 (memory pressure normal)").
+ */
+void format_sample(const Sample &sample,
+                   std::string &output);
+
+/**
+ * @brief Format a sample, with the stalls measured between two samples.
+ *
+ * The stall totals are counters, so their difference over the time between the samples is the share of that time spent stalled, which follows changes faster than the 10-second average.
+ *
+ * @param previous Earlier sample.
+ * @param current Later sample.
+ * @param elapsed_us Time between the samples in microseconds (e.g., "1000000").
+ * @param output String to write to (e.g., "0.52, 0.48, 0.40 (stalled: CPU 3.05%, memory 0.00%, IO 0.12%)").
+ */
+void format_rates(const Sample &previous,
+                  const Sample &current,
+                  const std::uint64_t elapsed_us,
+                  std::string &output);
+
+/**
+ * @brief Get the load and pressure as a string.
+ *
+ * @return Load and pressure (e.g., "0.52, 0.48, 0.40 (stalled: CPU 1.20%, memory 0.00%, IO 0.31%)") if succeeded, "Unknown load ($REASON)" otherwise.
+ */
+[[nodiscard]] std::string get_pressure();
+
+}  // namespace modules::pressure
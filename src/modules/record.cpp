@@ -0,0 +1,196 @@
+/**
+ * @file record.cpp
+ */
+
+#include <algorithm>  // for std::max, std::min
+#include <array>      // for std::array
+#include <chrono>     // for std::chrono::system_clock, std::chrono::seconds, std::chrono::duration_cast
+#include <cmath>      // for std::llround
+#include <cstddef>    // for std::size_t
+#include <cstdint>    // for std::uint64_t
+#include <ctime>      // for std::time_t, std::tm, std::strftime, ::localtime_r
+#include <iterator>   // for std::back_inserter
+#include <string>     // for std::string
+#include <vector>     // for std::vector
+
+#include <fmt/core.h>
+
+#include "host.hpp"
+#include "memory.hpp"
+#include "pressure.hpp"
+#include "record.hpp"
+
+namespace modules::record {
+
+namespace {
+
+/**
+ * @brief Convert a stored value of a gauge to display units.
+ *
+ * @param value Stored value (e.g., "11681468" KiB).
+ * @param unit Unit of the stored value.
+ *
+ * @return Value in seconds, bytes, load or pages (e.g., "11961823232").
+ */
+[[nodiscard]] double to_display(const std::uint64_t value,
+                                const Unit unit) noexcept
+{
+    switch (unit) {
+    case Unit::KiB:
+        return static_cast<double>(value) * 1024.0;
+    case Unit::Hundredths:
+        return static_cast<double>(value) / 100.0;
+    case Unit::Seconds:
+    case Unit::Pages:
+        break;
+    }
+    return static_cast<double>(value);
+}
+
+/**
+ * @brief Format a value in display units.
+ *
+ * @param field Field of the value.
+ * @param value Value in display units (e.g., "11961823232").
+ *
+ * @return Formatted value (e.g., "11.14GiB").
+ */
+[[nodiscard]] std::string format_value(const Field &field,
+                                       const double value)
+{
+    if (field.kind == Kind::Counter) {
+        return fmt::format("{:.1f}/s", value);
+    }
+    switch (field.unit) {
+    case Unit::Seconds:
+        return modules::host::format_uptime(static_cast<std::uint64_t>(std::llround(std::max(value, 0.0))));
+    case Unit::KiB:
+        return fmt::format("{:.2f}GiB", value / (1024.0 * 1024.0 * 1024.0));
+    case Unit::Hundredths:
+    case Unit::Pages:
+        break;
+    }
+    return fmt::format("{:.2f}", value);
+}
+
+/**
+ * @brief Add a value to the statistics of a field.
+ *
+ * @param stats Statistics to update.
+ * @param value Value in display units.
+ */
+void add_value(Stats &stats,
+               const double value) noexcept
+{
+    stats.min = stats.count == 0 ? value : std::min(stats.min, value);
+    stats.max = stats.count == 0 ? value : std::max(stats.max, value);
+    stats.sum += value;
+    ++stats.count;
+}
+
+}  // namespace
+
+void take_sample(Sample &sample)
+{
+    sample.fill(0);
+    sample[0] = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+    if (const auto seconds = modules::host::get_uptime_seconds()) {
+        sample[1] = *seconds;
+    }
+    if (const auto usage = modules::memory::get_usage()) {
+        sample[2] = usage->used_bytes / 1024;
+    }
+    if (const auto swap = modules::memory::get_swap_usage()) {
+        sample[3] = swap->used_bytes / 1024;
+    }
+    // The sampler keeps "/proc/loadavg" open, as a sample is taken every second for as long as the recording runs
+    static const modules::pressure::Sampler sampler;
+    if (const auto load = sampler.read().load) {
+        sample[4] = static_cast<std::uint64_t>(std::llround(load->one * 100.0));
+        sample[5] = static_cast<std::uint64_t>(std::llround(load->five * 100.0));
+        sample[6] = static_cast<std::uint64_t>(std::llround(load->fifteen * 100.0));
+    }
+    if (const auto paging = modules::memory::get_paging()) {
+        sample[7] = paging->pageins;
+        sample[8] = paging->pageouts;
+        sample[9] = paging->swapins;
+        sample[10] = paging->swapouts;
+    }
+}
+
+std::vector<Bucket> downsample(const std::vector<Sample> &samples,
+                               const std::uint64_t window_seconds)
+{
+    std::vector<Bucket> buckets;
+    const Sample *previous = nullptr;
+    for (const Sample &sample : samples) {
+        const std::uint64_t start = window_seconds == 0 ? 0 : sample[0] - sample[0] % window_seconds;
+        if (buckets.empty() || buckets.back().start != start) {
+            buckets.push_back(Bucket{start, 0, {}});
+        }
+        Bucket &bucket = buckets.back();
+        ++bucket.sample_count;
+
+        for (std::size_t i = 0; i < fields.size(); ++i) {
+            const std::uint64_t value = sample[i + 1];
+            if (fields[i].kind == Kind::Gauge) {
+                add_value(bucket.stats[i], to_display(value, fields[i].unit));
+            }
+            // A counter that went backwards was reset by a reboot, so it has no rate for this sample
+            else if (previous && sample[0] > (*previous)[0] && value >= (*previous)[i + 1]) {
+                add_value(bucket.stats[i], static_cast<double>(value - (*previous)[i + 1]) / static_cast<double>(sample[0] - (*previous)[0]));
+            }
+        }
+        previous = &sample;
+    }
+    if (window_seconds == 0 && !buckets.empty()) {
+        buckets.front().start = samples.front()[0];
+    }
+    return buckets;
+}
+
+std::string format_buckets(const std::vector<Bucket> &buckets,
+                           const bool header)
+{
+    std::string output;
+    if (header) {
+        fmt::format_to(std::back_inserter(output), "{:<19} {:>7}", "Time", "Samples");
+        for (const Field &field : fields) {
+            fmt::format_to(std::back_inserter(output), " {:>12}", field.name);
+        }
+        output += '\n';
+    }
+    for (const Bucket &bucket : buckets) {
+        const auto time = static_cast<std::time_t>(bucket.start);
+        std::tm local{};
+        std::array<char, 32> date{};
+        if (::localtime_r(&time, &local) == nullptr || std::strftime(date.data(), date.size(), "%Y-%m-%d %H:%M:%S", &local) == 0) {
+            date[0] = '\0';
+        }
+        fmt::format_to(std::back_inserter(output), "{:<19} {:>7}", date.data(), bucket.sample_count);
+        for (std::size_t i = 0; i < fields.size(); ++i) {
+            const Stats &stats = bucket.stats[i];
+            fmt::format_to(std::back_inserter(output), " {:>12}", stats.count == 0 ? "-" : format_value(fields[i], stats.sum / static_cast<double>(stats.count)));
+        }
+        output += '\n';
+    }
+    return output;
+}
+
+std::string format_summary(const Bucket &bucket)
+{
+    std::string output = fmt::format("Summary of {} samples\n", bucket.sample_count);
+    fmt::format_to(std::back_inserter(output), "{:<12} {:>12} {:>12} {:>12}\n", "Field", "Min", "Avg", "Max");
+    for (std::size_t i = 0; i < fields.size(); ++i) {
+        const Stats &stats = bucket.stats[i];
+        if (stats.count == 0) {
+            fmt::format_to(std::back_inserter(output), "{:<12} {:>12} {:>12} {:>12}\n", fields[i].name, "-", "-", "-");
+            continue;
+        }
+        fmt::format_to(std::back_inserter(output), "{:<12} {:>12} {:>12} {:>12}\n", fields[i].name,
+                       format_value(fields[i], stats.min), format_value(fields[i], stats.sum / static_cast<double>(stats.count)), format_value(fields[i], stats.max));
+    }
+    return output;
+}
+
+}  // namespace modules::record
@@ -0,0 +1,179 @@
+/**
+ * @file record.hpp
+ *
+ * @brief Sample the volatile system metrics for recording, and summarize recorded samples.
+ */
+
+#pragma once
+
+#include <array>        // for std::array
+#include <cstddef>      // for std::size_t
+#include <cstdint>      // for std::uint64_t
+#include <string>       // for std::string
+#include <string_view>  // for std::string_view
+#include <vector>       // for std::vector
+
+namespace modules::record {
+
+/**
+ * @brief How the value of a field evolves.
+ */
+enum class Kind {
+    /**
+     * @brief Current level (e.g., memory usage), summarized as is.
+     */
+    Gauge,
+
+    /**
+     * @brief Cumulative count since boot (e.g., page-ins), summarized as a rate per second.
+     */
+    Counter,
+};
+
+/**
+ * @brief Unit in which the value of a field is stored.
+ */
+enum class Unit {
+    Seconds,
+    KiB,
+    Hundredths,
+    Pages,
+};
+
+/**
+ * @brief Struct that describes a recorded field.
+ */
+struct Field final {
+    /**
+     * @brief Name of the field (e.g., "Memory").
+     */
+    std::string_view name;
+
+    /**
+     * @brief How the value evolves.
+     */
+    Kind kind;
+
+    /**
+     * @brief Unit of the stored value.
+     */
+    Unit unit;
+};
+
+/**
+ * @brief Recorded fields, in the order they are stored after the timestamp.
+ */
+inline constexpr std::array<Field, 10> fields = {{
+    {"Uptime", Kind::Gauge, Unit::Seconds},
+    {"Memory", Kind::Gauge, Unit::KiB},
+    {"Swap", Kind::Gauge, Unit::KiB},
+    {"Load 1m", Kind::Gauge, Unit::Hundredths},
+    {"Load 5m", Kind::Gauge, Unit::Hundredths},
+    {"Load 15m", Kind::Gauge, Unit::Hundredths},
+    {"Page-ins", Kind::Counter, Unit::Pages},
+    {"Page-outs", Kind::Counter, Unit::Pages},
+    {"Swap-ins", Kind::Counter, Unit::Pages},
+    {"Swap-outs", Kind::Counter, Unit::Pages},
+}};
+
+/**
+ * @brief Number of values in a sample: the UNIX time in seconds, followed by every field.
+ */
+inline constexpr std::size_t value_count = fields.size() + 1;
+
+/**
+ * @brief Number of 512-byte blocks in a recording (8 MiB); with about 20 bytes per sample, this holds several days at one sample per second.
+ */
+inline constexpr std::size_t block_count = 16384;
+
+/**
+ * @brief Values of a sample; a value that could not be read is 0.
+ */
+using Sample = std::array<std::uint64_t, value_count>;
+
+/**
+ * @brief Take a sample of the volatile system metrics.
+ *
+ * This only reads counters from the kernel (no processes, files or allocations), so it is cheap enough to run every second for days.
+ *
+ * @param sample Sample to overwrite.
+ */
+void take_sample(Sample &sample);
+
+/**
+ * @brief Struct that represents the minimum, maximum and sum of a field over a window, in display units (seconds, bytes, load or pages per second).
+ */
+struct Stats final {
+    /**
+     * @brief Smallest value (e.g., "10905190400").
+     */
+    double min = 0.0;
+
+    /**
+     * @brief Largest value (e.g., "11961823232").
+     */
+    double max = 0.0;
+
+    /**
+     * @brief Sum of all values, divided by "count" for the average.
+     */
+    double sum = 0.0;
+
+    /**
+     * @brief Number of values (e.g., "60"); counters have no value for the first sample.
+     */
+    std::size_t count = 0;
+};
+
+/**
+ * @brief Struct that represents the samples of one time window.
+ */
+struct Bucket final {
+    /**
+     * @brief UNIX time of the start of the window in seconds (e.g., "1722470400").
+     */
+    std::uint64_t start = 0;
+
+    /**
+     * @brief Number of samples in the window (e.g., "60").
+     */
+    std::size_t sample_count = 0;
+
+    /**
+     * @brief Statistics of every field.
+     */
+    std::array<Stats, fields.size()> stats{};
+};
+
+/**
+ * @brief Downsample samples into fixed time windows.
+ *
+ * @param samples Samples, oldest first.
+ * @param window_seconds Length of a window in seconds (e.g., "60"); 0 puts all samples into a single window.
+ *
+ * @return Windows that contain at least one sample, oldest first.
+ */
+[[nodiscard]] std::vector<Bucket> downsample(const std::vector<Sample> &samples,
+                                             const std::uint64_t window_seconds);
+
+/**
+ * @brief Format windows as a table, one row with the average of every field per window.
+ *
+ * @param buckets Windows to format.
+ * @param header Whether to start with a header row.
+ *
+ * @return Table, with a newline after every row.
+ */
+[[nodiscard]] std::string format_buckets(const std::vector<Bucket> &buckets,
+                                         const bool header);
+
+/**
+ * @brief Format a window as a table, one row with the minimum, average and maximum per field.
+ *
+ * @param bucket Window to format.
+ *
+ * @return Table, with a newline after every row.
+ */
+[[nodiscard]] std::string format_summary(const Bucket &bucket);
+
+}  // namespace modules::record
@@ -0,0 +1,309 @@
+/**
+ * @file sessions.cpp
+ */
+
+#include <charconv>      // for std::from_chars
+#include <cstddef>       // for std::size_t, offsetof
+#include <cstdint>       // for std::uint64_t
+#include <cstring>       // for std::memcpy, std::memcmp, ::strnlen
+#include <fcntl.h>       // for ::open, O_RDONLY, O_CLOEXEC
+#include <filesystem>    // for std::filesystem::path
+#include <optional>      // for std::optional, std::nullopt
+#include <string>        // for std::string
+#include <string_view>   // for std::string_view
+#include <sys/mman.h>    // for ::mmap, ::munmap, PROT_READ, MAP_PRIVATE, MAP_FAILED
+#include <sys/stat.h>    // for ::stat, ::fstat, struct stat
+#include <system_error>  // for std::errc
+#include <unistd.h>      // for ::close
+#include <utmpx.h>       // for struct utmpx, USER_PROCESS, _PATH_UTMPX
+#include <vector>        // for std::vector
+
+#include "core/cache.hpp"
+#include "core/text.hpp"
+#include "sessions.hpp"
+
+namespace modules::sessions {
+
+namespace {
+
+/**
+ * @brief Size of a record of the database.
+ */
+constexpr std::size_t record_size = sizeof(struct utmpx);
+
+/**
+ * @brief Offset of the type of a record.
+ */
+constexpr std::size_t type_offset = offsetof(struct utmpx, ut_type);
+
+/**
+ * @brief Offset of the user name of a record.
+ */
+constexpr std::size_t user_offset = offsetof(struct utmpx, ut_user);
+
+/**
+ * @brief Size of the user name field, which is not null-terminated when full.
+ */
+constexpr std::size_t user_size = sizeof(utmpx::ut_user);
+
+/**
+ * @brief Cache key of the counts, whose value starts with the identity of the database they were read from.
+ */
+constexpr const char *cache_key = "sessions";
+
+/**
+ * @brief Class that represents a set of user names, as an open-addressing hash table with linear probing.
+ *
+ * Names are not copied: the table stores views into the records, which outlive it.
+ *
+ * @note This class is marked as `final` to prevent inheritance.
+ */
+class UserSet final {
+  public:
+    /**
+     * @brief Insert a name if it is not in the set yet.
+     *
+     * @param name Name to insert (e.g., "alice").
+     */
+    void insert(const std::string_view name)
+    {
+        // Keep the table at most half full, so that probe sequences stay short
+        if ((this->size_ + 1) * 2 > this->slots_.size()) {
+            this->grow();
+        }
+        const std::uint64_t hash = get_hash(name);
+        const std::size_t mask = this->slots_.size() - 1;
+        for (std::size_t i = static_cast<std::size_t>(hash) & mask;; i = (i + 1) & mask) {
+            Slot &slot = this->slots_[i];
+            if (slot.name.data() == nullptr) {
+                slot = {hash, name};
+                ++this->size_;
+                return;
+            }
+            if (slot.hash == hash && slot.name == name) {
+                return;
+            }
+        }
+    }
+
+    /**
+     * @brief Get the number of names in the set.
+     *
+     * @return Number of names (e.g., "5").
+     */
+    [[nodiscard]] std::size_t size() const noexcept
+    {
+        return this->size_;
+    }
+
+  private:
+    /**
+     * @brief Struct that represents a slot of the table, empty if the name is null.
+     */
+    struct Slot final {
+        /**
+         * @brief Hash of the name.
+         */
+        std::uint64_t hash = 0;
+
+        /**
+         * @brief Name, pointing into a record.
+         */
+        std::string_view name;
+    };
+
+    /**
+     * @brief Hash a name with 64-bit FNV-1a.
+     *
+     * @param name Name to hash (e.g., "alice").
+     *
+     * @return Hash of the name.
+     */
+    [[nodiscard]] static std::uint64_t get_hash(const std::string_view name) noexcept
+    {
+        std::uint64_t hash = 14695981039346656037ULL;
+        for (const char c : name) {
+            hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    /**
+     * @brief Double the number of slots (16 at first) and insert every name again.
+     */
+    void grow()
+    {
+        std::vector<Slot> old_slots(this->slots_.empty() ? 16 : this->slots_.size() * 2);
+        old_slots.swap(this->slots_);
+        const std::size_t mask = this->slots_.size() - 1;
+        for (const Slot &slot : old_slots) {
+            if (slot.name.data() == nullptr) {
+                continue;
+            }
+            std::size_t i = static_cast<std::size_t>(slot.hash) & mask;
+            while (this->slots_[i].name.data() != nullptr) {
+                i = (i + 1) & mask;
+            }
+            this->slots_[i] = slot;
+        }
+    }
+
+    /**
+     * @brief Slots of the table, a power of two in number.
+     */
+    std::vector<Slot> slots_;
+
+    /**
+     * @brief Number of names in the set.
+     */
+    std::size_t size_ = 0;
+};
+
+/**
+ * @brief Build the identity of a database, which changes whenever the database is written.
+ *
+ * @param info Status of the database.
+ *
+ * @return Identity (e.g., "16777232:1152921500312:1722470400.123456789:7680").
+ */
+[[nodiscard]] std::string get_identity(const struct stat &info)
+{
+#if defined(__APPLE__)
+    const auto &mtime = info.st_mtimespec;
+#else
+    const auto &mtime = info.st_mtim;
+#endif
+    std::string identity;
+    core::text::append_integer(info.st_dev, identity);
+    identity.push_back(':');
+    core::text::append_integer(info.st_ino, identity);
+    identity.push_back(':');
+    core::text::append_integer(mtime.tv_sec, identity);
+    identity.push_back('.');
+    core::text::append_integer(mtime.tv_nsec, identity);
+    identity.push_back(':');
+    core::text::append_integer(info.st_size, identity);
+    return identity;
+}
+
+/**
+ * @brief Parse sessions stored in the cache.
+ *
+ * @param text Cached value (e.g., "16777232:1152921500312:1722470400.123456789:7680\n14 5").
+ * @param identity Current identity of the database.
+ *
+ * @return Sessions if valid and stored for the same identity, std::nullopt otherwise.
+ */
+[[nodiscard]] std::optional<Sessions> parse_cached(const std::string_view text,
+                                                   const std::string_view identity) noexcept
+{
+    if (text.size() <= identity.size() || text.compare(0, identity.size(), identity) != 0 || text[identity.size()] != '\n') {
+        return std::nullopt;
+    }
+    Sessions sessions;
+    const char *const begin = text.data() + identity.size() + 1;
+    const char *const end = text.data() + text.size();
+    const auto first = std::from_chars(begin, end, sessions.sessions);
+    if (first.ec != std::errc() || first.ptr == end || *first.ptr != ' ') {
+        return std::nullopt;
+    }
+    const auto second = std::from_chars(first.ptr + 1, end, sessions.users);
+    if (second.ec != std::errc() || second.ptr != end) {
+        return std::nullopt;
+    }
+    return sessions;
+}
+
+}  // namespace
+
+Sessions count_sessions(const std::string_view records)
+{
+    // The type and name are read from their offsets, so that records are neither copied nor accessed unaligned
+    Sessions sessions;
+    UserSet users;
+    const std::size_t record_count = records.size() / record_size;
+    for (std::size_t i = 0; i < record_count; ++i) {
+        const char *const record = records.data() + i * record_size;
+        decltype(utmpx::ut_type) type;
+        std::memcpy(&type, record + type_offset, sizeof(type));
+        if (type != USER_PROCESS) {
+            continue;
+        }
+        const char *const user = record + user_offset;
+        const std::size_t length = ::strnlen(user, user_size);
+        if (length == 0) {
+            continue;
+        }
+        ++sessions.sessions;
+        users.insert(std::string_view(user, length));
+    }
+    sessions.users = users.size();
+    return sessions;
+}
+
+std::optional<Sessions> read_sessions(const std::filesystem::path &path)
+{
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return std::nullopt;
+    }
+    struct stat info{};
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        return std::nullopt;
+    }
+
+    // An empty database (e.g., right after boot) cannot be mapped, but has no sessions either
+    if (info.st_size <= 0) {
+        ::close(fd);
+        return Sessions{};
+    }
+    const auto size = static_cast<std::size_t>(info.st_size);
+    void *mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        return std::nullopt;
+    }
+    const Sessions sessions = count_sessions(std::string_view(static_cast<const char *>(mapping), size));
+    ::munmap(mapping, size);
+    return sessions;
+}
+
+std::string format_sessions(const Sessions &sessions)
+{
+    std::string output;
+    core::text::append_unsigned(sessions.sessions, output);
+    output.append(" (");
+    core::text::append_unsigned(sessions.users, output);
+    output.append(" unique)");
+    return output;
+}
+
+std::string get_users()
+{
+    struct stat info{};
+    if (::stat(_PATH_UTMPX, &info) != 0) {
+        return "Unknown users (Failed to read " _PATH_UTMPX ")";
+    }
+    // One fixed entry holds the identity of the database on its first line, so a login overwrites it instead of adding another
+    const std::string identity = get_identity(info);
+    if (const auto cached = core::cache::load(cache_key)) {
+        if (const auto sessions = parse_cached(*cached, identity)) {
+            return format_sessions(*sessions);
+        }
+    }
+
+    const auto sessions = read_sessions(_PATH_UTMPX);
+    if (!sessions) {
+        return "Unknown users (Failed to read " _PATH_UTMPX ")";
+    }
+    std::string value = identity;
+    value.push_back('\n');
+    core::text::append_unsigned(sessions->sessions, value);
+    value.push_back(' ');
+    core::text::append_unsigned(sessions->users, value);
+    core::cache::store(cache_key, value);
+    return format_sessions(*sessions);
+}
+
+}  // namespace modules::sessions
@@ -0,0 +1,70 @@
+/**
+ * @file sessions.hpp
+ *
+ * @brief Count the login sessions and the users they belong to, from the utmpx database.
+ */
+
+#pragma once
+
+#include <cstdint>      // for std::uint64_t
+#include <filesystem>   // for std::filesystem::path
+#include <optional>     // for std::optional
+#include <string>       // for std::string
+#include <string_view>  // for std::string_view
+
+namespace modules::sessions {
+
+/**
+ * @brief Struct that represents the login sessions of a host.
+ */
+struct Sessions final {
+    /**
+     * @brief Number of sessions (e.g., "14"), one per terminal or remote login.
+     */
+    std::uint64_t sessions = 0;
+
+    /**
+     * @brief Number of distinct users among the sessions (e.g., "5").
+     */
+    std::uint64_t users = 0;
+};
+
+/**
+ * @brief Count the sessions of a utmpx database already in memory.
+ *
+ * Records are "struct utmpx" of the platform, scanned in place: only the type and user name of each one are read. Users are deduplicated with an open-addressing set of pointers into the records, so nothing is copied. A truncated trailing record is ignored.
+ *
+ * @param records Contents of the database.
+ *
+ * @return Sessions (records of type "USER_PROCESS" with a user name).
+ */
+[[nodiscard]] Sessions count_sessions(const std::string_view records);
+
+/**
+ * @brief Map a utmpx database and count its sessions.
+ *
+ * @param path Path to the database (e.g., "/var/run/utmpx", "/var/run/utmp").
+ *
+ * @return Sessions if the file could be read, std::nullopt otherwise.
+ */
+[[nodiscard]] std::optional<Sessions> read_sessions(const std::filesystem::path &path);
+
+/**
+ * @brief Format sessions as a string.
+ *
+ * @param sessions Sessions to format.
+ *
+ * @return Formatted sessions (e.g., "14 (5 unique)").
+ */
+[[nodiscard]] std::string format_sessions(const Sessions &sessions);
+
+/**
+ * @brief Get the sessions of the host as a string.
+ *
+ * The count is cached on disk, keyed by the device, inode, mtime and size of the database, which change on every login and logout, so repeated runs only cost a stat.
+ *
+ * @return Formatted sessions (e.g., "14 (5 unique)") if succeeded, "Unknown users ($REASON)" otherwise.
+ */
+[[nodiscard]] std::string get_users();
+
+}  // namespace modules::sessions
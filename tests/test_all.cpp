@@ -2,52 +2,430 @@
  * @file test_all.cpp
  */
 
-#include <cstdlib>        // for EXIT_FAILURE, EXIT_SUCCESS
-#include <exception>      // for std::exception
-#include <functional>     // for std::function
-#include <string>         // for std::string
-#include <unordered_map>  // for std::unordered_map
+#include <algorithm>       // for std::sort, std::min, std::max
+#include <array>           // for std::array
+#include <chrono>          // for std::chrono::milliseconds
+#include <cstddef>         // for std::size_t
+#include <cstdint>         // for std::int64_t, std::uint64_t, std::uint8_t, std::uintmax_t
+#include <cstdio>          // for std::FILE, std::tmpfile, std::ftell, std::rewind, std::fread, std::fclose
+#include <cstdlib>         // for EXIT_FAILURE, EXIT_SUCCESS, setenv
+#include <cstring>         // for std::memcpy
+#include <exception>       // for std::exception
+#include <fcntl.h>         // for open, O_WRONLY
+#include <filesystem>      // for std::filesystem
+#include <fstream>         // for std::ifstream, std::ofstream
+#include <functional>      // for std::function
+#include <iterator>        // for std::istreambuf_iterator
+#include <limits>          // for std::numeric_limits
+#include <memory>          // for std::make_unique
+#include <optional>        // for std::optional, std::nullopt
+#include <string>          // for std::string
+#include <string_view>     // for std::string_view
+#include <sys/resource.h>  // for struct rusage
+#include <sys/wait.h>      // for wait4, WIFEXITED, WEXITSTATUS
+#include <unistd.h>        // for getppid, getpid, fork, dup2, execv, _exit
+#include <unordered_map>   // for std::unordered_map
+#include <utility>         // for std::move
+#include <utmpx.h>         // for struct utmpx, USER_PROCESS, DEAD_PROCESS, LOGIN_PROCESS
+#include <vector>          // for std::vector
 
 #include <fmt/core.h>
 
 #include "app.hpp"
+#include "core/aggregate.hpp"
+#include "core/alloc.hpp"
 #include "core/args.hpp"
+#include "core/art.hpp"
+#include "core/config.hpp"
+#include "core/diff.hpp"
+#include "core/dump.hpp"
+#include "core/cache.hpp"
+#include "core/graphics.hpp"
+#include "core/json.hpp"
+#include "core/layout.hpp"
+#include "core/png.hpp"
+#include "core/process.hpp"
+#include "core/profile.hpp"
+#include "core/ring.hpp"
+#include "core/shell.hpp"
+#include "core/text.hpp"
+#include "core/width.hpp"
+#include "modules/cgroup.hpp"
+#include "modules/commands.hpp"
 #include "modules/cpu.hpp"
 #include "modules/display.hpp"
 #include "modules/host.hpp"
+#include "modules/image.hpp"
+#include "modules/inventory.hpp"
+#include "modules/logo.hpp"
 #include "modules/memory.hpp"
+#include "modules/models.hpp"
+#include "modules/packages.hpp"
+#include "modules/plugins.hpp"
+#include "modules/pressure.hpp"
+#include "modules/sessions.hpp"
+#include "modules/record.hpp"
 
 #define TEST_EXECUTABLE_NAME "tests"
 
+namespace {
+
+/**
+ * @brief Create a unique, empty temporary directory for a test fixture.
+ *
+ * @param name Name of the fixture (e.g., "homebrew").
+ *
+ * @return Path to the created directory (e.g., "/tmp/applefetch-tests-4242/homebrew").
+ */
+[[nodiscard]] std::filesystem::path make_fixture_directory(const std::string &name)
+{
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / fmt::format("applefetch-tests-{}", getpid()) / name;
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    return directory;
+}
+
+/**
+ * @brief Write a fixture file, creating parent directories as needed.
+ *
+ * @param path Path to the file.
+ * @param content Content of the file.
+ */
+void write_fixture_file(const std::filesystem::path &path,
+                        const std::string_view content)
+{
+    std::filesystem::create_directories(path.parent_path());
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << content;
+}
+
+/**
+ * @brief Create a fake sysfs CPU tree: two SMT cores at 3 GHz with private L2 caches, and two cores at 2 GHz sharing an L2, under one L3.
+ *
+ * @return Path to the tree (e.g., "/tmp/applefetch-tests-1234/cpu").
+ */
+[[nodiscard]] std::filesystem::path make_cpu_fixture()
+{
+    const auto root = make_fixture_directory("cpu");
+    write_fixture_file(root / "online", "0-5\n");
+    for (int cpu = 0; cpu < 6; ++cpu) {
+        const auto directory = root / fmt::format("cpu{}", cpu);
+        write_fixture_file(directory / "topology" / "thread_siblings_list", cpu < 4 ? fmt::format("{}-{}\n", cpu & ~1, (cpu & ~1) + 1) : fmt::format("{}\n", cpu));
+        write_fixture_file(directory / "cpufreq" / "cpuinfo_max_freq", cpu < 4 ? "3000000\n" : "2000000\n");
+    }
+    const auto add_cache = [&root](const int cpu, const int index, const std::string_view level, const std::string_view type, const std::string_view size, const std::string_view shared) {
+        const auto directory = root / fmt::format("cpu{}", cpu) / "cache" / fmt::format("index{}", index);
+        write_fixture_file(directory / "level", fmt::format("{}\n", level));
+        write_fixture_file(directory / "type", fmt::format("{}\n", type));
+        write_fixture_file(directory / "size", fmt::format("{}\n", size));
+        write_fixture_file(directory / "shared_cpu_list", fmt::format("{}\n", shared));
+    };
+    add_cache(0, 0, "1", "Data", "48K", "0-1");
+    add_cache(0, 1, "1", "Instruction", "32K", "0-1");
+    add_cache(0, 2, "2", "Unified", "1280K", "0-1");
+    add_cache(0, 3, "3", "Unified", "8M", "0-5");
+    add_cache(4, 0, "1", "Data", "32K", "4");
+    add_cache(4, 1, "1", "Instruction", "64K", "4");
+    add_cache(4, 2, "2", "Unified", "2048K", "4-5");
+    add_cache(4, 3, "3", "Unified", "8M", "0-5");
+    return root;
+}
+
+/**
+ * @brief Append a record to a fake utmpx database.
+ *
+ * @param type Type of the record (e.g., "USER_PROCESS").
+ * @param user User name, truncated to the size of the field.
+ * @param records Database to append to.
+ */
+void append_utmpx_record(const short type,
+                         const std::string_view user,
+                         std::string &records)
+{
+    struct utmpx record{};
+    record.ut_type = type;
+    std::memcpy(record.ut_user, user.data(), std::min(user.size(), sizeof(record.ut_user)));
+    records.append(reinterpret_cast<const char *>(&record), sizeof(record));
+}
+
+/**
+ * @brief Create a fake cgroupfs tree: a container limited to 4 GiB and 1.5 CPUs, next to an unlimited sibling, with the cgroup files of three processes.
+ *
+ * @return Path to the tree (e.g., "/tmp/applefetch-tests-1234/cgroup").
+ */
+[[nodiscard]] std::filesystem::path make_cgroup_fixture()
+{
+    const auto root = make_fixture_directory("cgroup");
+    const auto container = root / "sys" / "system.slice" / "docker-4f3c.scope";
+    write_fixture_file(container / "memory.current", "1610612736\n");
+    write_fixture_file(container / "memory.max", "4294967296\n");
+    write_fixture_file(container / "memory.stat", "anon 1073741824\nfile 536870912\nactive_file 268435456\ninactive_file 268435456\n");
+    write_fixture_file(container / "cpu.max", "150000 100000\n");
+    write_fixture_file(container / "cpu.stat", "usage_usec 81234567\nuser_usec 61234567\nsystem_usec 20000000\nnr_periods 1200\nnr_throttled 36\nthrottled_usec 900000\n");
+    const auto sibling = root / "sys" / "user.slice";
+    write_fixture_file(sibling / "memory.current", "524288000\n");
+    write_fixture_file(sibling / "memory.max", "max\n");
+    write_fixture_file(sibling / "memory.stat", "anon 262144000\n");
+    write_fixture_file(root / "container.cgroup", "0::/system.slice/docker-4f3c.scope\n");
+    write_fixture_file(root / "sibling.cgroup", "12:pids:/user.slice\n0::/user.slice\n");
+    write_fixture_file(root / "v1.cgroup", "12:pids:/user.slice\n4:memory:/user.slice\n");
+    return root;
+}
+
+/**
+ * @brief Create a fake DRM sysfs tree: a card, a laptop panel with a 60 Hz EDID, an external monitor without EDID, and two inactive connectors.
+ *
+ * @return Path to the tree (e.g., "/tmp/applefetch-tests-1234/drm").
+ */
+[[nodiscard]] std::filesystem::path make_drm_fixture()
+{
+    // EDID header, then a preferred timing of 1920x1080 with 280 and 45 blanking lines at 148.5 MHz, which is 60 Hz
+    std::string edid(128, '\0');
+    edid.replace(0, 8, "\x00\xFF\xFF\xFF\xFF\xFF\xFF\x00", 8);
+    edid.replace(54, 8, "\x02\x3A\x80\x18\x71\x38\x2D\x40", 8);
+
+    const auto root = make_fixture_directory("drm");
+    write_fixture_file(root / "card0" / "dev", "226:0\n");
+    write_fixture_file(root / "card0-eDP-1" / "status", "connected\n");
+    write_fixture_file(root / "card0-eDP-1" / "enabled", "enabled\n");
+    write_fixture_file(root / "card0-eDP-1" / "modes", "2880x1800\n1920x1200\n");
+    write_fixture_file(root / "card0-eDP-1" / "edid", edid);
+    write_fixture_file(root / "card0-HDMI-A-1" / "status", "connected\n");
+    write_fixture_file(root / "card0-HDMI-A-1" / "modes", "2560x1440\n");
+    write_fixture_file(root / "card0-DP-1" / "status", "disconnected\n");
+    write_fixture_file(root / "card1-DP-2" / "status", "connected\n");
+    write_fixture_file(root / "card1-DP-2" / "enabled", "disabled\n");
+    write_fixture_file(root / "card1-DP-2" / "modes", "1920x1080\n");
+    return root;
+}
+
+/**
+ * @brief Two-color art for layout tests, with a multi-byte character and a color that carries over to the next row.
+ */
+constexpr std::string_view layout_art = R"art(
+$1/\
+$2/é\
+\/
+)art";
+
+/**
+ * @brief Palette of the layout test art.
+ */
+constexpr std::array<std::string_view, 2> layout_palette = {"\033[31m", "\033[32m"};
+
+/**
+ * @brief Art for width tests, with wide and combining characters.
+ */
+constexpr std::string_view wide_art = R"art(
+$1日本
+$2ée
+)art";
+
+/**
+ * @brief 2x2 RGBA PNG for image tests: red, green / blue, transparent white. The rows use the Sub and Paeth filters and the data is split across two IDAT chunks.
+ */
+constexpr char png_fixture_data[] =
+    "\x89\x50\x4e\x47\x0d\x0a\x1a\x0a\x00\x00\x00\x0d\x49\x48\x44\x52\x00\x00\x00\x02\x00\x00\x00\x02"
+    "\x08\x06\x00\x00\x00\x72\xb6\x0d\x24\x00\x00\x00\x05\x49\x44\x41\x54\x78\xda\x63\xfc\xcf\x35\x84"
+    "\xaf\xd3\x00\x00\x00\x12\x49\x44\x41\x54\xc0\xf0\x9f\x11\x48\xb0\x30\x32\xfc\x07\x42\x06\x46\x00"
+    "\x35\x29\x05\x04\x4a\x09\x03\x33\x00\x00\x00\x00\x49\x45\x4e\x44\xae\x42\x60\x82";
+
+/**
+ * @brief Contents of the PNG fixture, including its NUL bytes.
+ */
+constexpr std::string_view png_fixture(png_fixture_data, sizeof(png_fixture_data) - 1);
+
+/**
+ * @brief Create a solid RGBA image.
+ *
+ * @param width Width in pixels (e.g., "3").
+ * @param height Height in pixels (e.g., "7").
+ * @param rgba Color of every pixel.
+ *
+ * @return Image.
+ */
+[[nodiscard]] core::png::Image make_image(const std::size_t width,
+                                          const std::size_t height,
+                                          const std::array<std::uint8_t, 4> &rgba)
+{
+    core::png::Image image;
+    image.width = width;
+    image.height = height;
+    image.pixels.reserve(width * height * 4);
+    for (std::size_t i = 0; i < width * height; ++i) {
+        image.pixels.insert(image.pixels.end(), rgba.begin(), rgba.end());
+    }
+    return image;
+}
+
+}  // namespace
+
 namespace test_args {
 [[nodiscard]] int none();
 [[nodiscard]] int help();
 [[nodiscard]] int version();
 [[nodiscard]] int invalid();
+[[nodiscard]] int image();
+[[nodiscard]] int flags();
+[[nodiscard]] int aggregate();
+[[nodiscard]] int diff();
 }  // namespace test_args
 
 namespace test_host {
 [[nodiscard]] int get_version();
 [[nodiscard]] int get_architecture();
 [[nodiscard]] int get_model_identifier();
+[[nodiscard]] int get_model_name();
 [[nodiscard]] int get_uptime();
-[[nodiscard]] int get_packages();
 [[nodiscard]] int get_shell();
+[[nodiscard]] int get_shell_version();
+[[nodiscard]] int get_terminal();
 }  // namespace test_host
 
 namespace test_display {
-[[nodiscard]] int get_resolution();
-[[nodiscard]] int get_refresh_rate();
+[[nodiscard]] int get_displays();
+[[nodiscard]] int read_drm_topology();
+[[nodiscard]] int watcher();
 }  // namespace test_display
 
 namespace test_cpu {
 [[nodiscard]] int get_cpu_model();
+[[nodiscard]] int read_sysfs_topology();
 }  // namespace test_cpu
 
 namespace test_memory {
 [[nodiscard]] int get_memory_usage();
 }  // namespace test_memory
 
+namespace test_packages {
+[[nodiscard]] int get_packages();
+[[nodiscard]] int scan_homebrew();
+}  // namespace test_packages
+
+namespace test_json {
+[[nodiscard]] int scanner();
+[[nodiscard]] int quote();
+}  // namespace test_json
+
+namespace test_text {
+[[nodiscard]] int format();
+}  // namespace test_text
+
+namespace test_process {
+[[nodiscard]] int get_ancestry();
+}  // namespace test_process
+
+namespace test_cache {
+[[nodiscard]] int store_and_load();
+}  // namespace test_cache
+
+namespace test_models {
+[[nodiscard]] int find_name();
+}  // namespace test_models
+
+namespace test_layout {
+[[nodiscard]] int render();
+[[nodiscard]] int render_image();
+}  // namespace test_layout
+
+namespace test_logo {
+[[nodiscard]] int get_logo();
+}  // namespace test_logo
+
+namespace test_png {
+[[nodiscard]] int decode();
+}  // namespace test_png
+
+namespace test_graphics {
+[[nodiscard]] int downscale();
+[[nodiscard]] int encode_kitty();
+[[nodiscard]] int encode_sixel();
+}  // namespace test_graphics
+
+namespace test_image {
+[[nodiscard]] int render();
+}  // namespace test_image
+
+namespace test_profile {
+[[nodiscard]] int profiler();
+}  // namespace test_profile
+
+namespace test_alloc {
+[[nodiscard]] int get_counters();
+}  // namespace test_alloc
+
+namespace test_app {
+[[nodiscard]] int watch();
+[[nodiscard]] int budgets();
+}  // namespace test_app
+
+namespace test_ring {
+[[nodiscard]] int varint();
+[[nodiscard]] int round_trip();
+}  // namespace test_ring
+
+namespace test_record {
+[[nodiscard]] int downsample();
+}  // namespace test_record
+
+namespace test_aggregate {
+[[nodiscard]] int add_snapshot();
+[[nodiscard]] int aggregate();
+}  // namespace test_aggregate
+
+namespace test_diff {
+[[nodiscard]] int parse_snapshot();
+[[nodiscard]] int compare();
+}  // namespace test_diff
+
+namespace test_config {
+[[nodiscard]] int parse();
+}  // namespace test_config
+
+namespace test_shell {
+[[nodiscard]] int run();
+}  // namespace test_shell
+
+namespace test_commands {
+[[nodiscard]] int run_commands();
+[[nodiscard]] int ttl();
+}  // namespace test_commands
+
+namespace test_plugins {
+[[nodiscard]] int get_requests();
+[[nodiscard]] int probe();
+[[nodiscard]] int isolate();
+}  // namespace test_plugins
+
+namespace test_cgroup {
+[[nodiscard]] int resolve_path();
+[[nodiscard]] int read();
+}  // namespace test_cgroup
+
+namespace test_dump {
+[[nodiscard]] int pattern();
+[[nodiscard]] int dump_tree();
+}  // namespace test_dump
+
+namespace test_inventory {
+[[nodiscard]] int id_database();
+[[nodiscard]] int read_devices();
+}  // namespace test_inventory
+
+namespace test_pressure {
+[[nodiscard]] int parse();
+[[nodiscard]] int sampler();
+}  // namespace test_pressure
+
+namespace test_sessions {
+[[nodiscard]] int count_sessions();
+}  // namespace test_sessions
+
+namespace test_width {
+[[nodiscard]] int east_asian_width();
+[[nodiscard]] int get_width();
+}  // namespace test_width
+
 /**
  * @brief Entry-point of the test application.
  *
@@ -69,6 +447,11 @@ int main(int argc,
         "  test  name of the test to run ('all' to run all tests)\n",
         argv[0]);
 
+    // Isolated plugins are probed by a new process of this executable, as they are by applefetch
+    if (argc > 1 && std::string_view(argv[1]) == modules::plugins::host_argument) {
+        return modules::plugins::run_host(argc, argv);
+    }
+
     // If no arguments, print help message and exit
     if (argc == 1) {
         fmt::print("{}\n", help_message);
@@ -81,16 +464,69 @@ int main(int argc,
         {"test_args::help", test_args::help},
         {"test_args::version", test_args::version},
         {"test_args::invalid", test_args::invalid},
+        {"test_args::image", test_args::image},
+        {"test_args::flags", test_args::flags},
+        {"test_args::aggregate", test_args::aggregate},
+        {"test_args::diff", test_args::diff},
         {"test_host::get_version", test_host::get_version},
         {"test_host::get_architecture", test_host::get_architecture},
         {"test_host::get_model_identifier", test_host::get_model_identifier},
+        {"test_host::get_model_name", test_host::get_model_name},
         {"test_host::get_uptime", test_host::get_uptime},
-        {"test_host::get_packages", test_host::get_packages},
         {"test_host::get_shell", test_host::get_shell},
-        {"test_display::get_resolution", test_display::get_resolution},
-        {"test_display::get_refresh_rate", test_display::get_refresh_rate},
+        {"test_host::get_shell_version", test_host::get_shell_version},
+        {"test_host::get_terminal", test_host::get_terminal},
+        {"test_display::get_displays", test_display::get_displays},
+        {"test_display::read_drm_topology", test_display::read_drm_topology},
+        {"test_display::watcher", test_display::watcher},
         {"test_cpu::get_cpu_model", test_cpu::get_cpu_model},
+        {"test_cpu::read_sysfs_topology", test_cpu::read_sysfs_topology},
         {"test_memory::get_memory_usage", test_memory::get_memory_usage},
+        {"test_packages::get_packages", test_packages::get_packages},
+        {"test_packages::scan_homebrew", test_packages::scan_homebrew},
+        {"test_json::scanner", test_json::scanner},
+        {"test_json::quote", test_json::quote},
+        {"test_text::format", test_text::format},
+        {"test_process::get_ancestry", test_process::get_ancestry},
+        {"test_cache::store_and_load", test_cache::store_and_load},
+        {"test_models::find_name", test_models::find_name},
+        {"test_layout::render", test_layout::render},
+        {"test_layout::render_image", test_layout::render_image},
+        {"test_logo::get_logo", test_logo::get_logo},
+        {"test_png::decode", test_png::decode},
+        {"test_graphics::downscale", test_graphics::downscale},
+        {"test_graphics::encode_kitty", test_graphics::encode_kitty},
+        {"test_graphics::encode_sixel", test_graphics::encode_sixel},
+        {"test_image::render", test_image::render},
+        {"test_profile::profiler", test_profile::profiler},
+        {"test_alloc::get_counters", test_alloc::get_counters},
+        {"test_app::watch", test_app::watch},
+        {"test_app::budgets", test_app::budgets},
+        {"test_ring::varint", test_ring::varint},
+        {"test_ring::round_trip", test_ring::round_trip},
+        {"test_record::downsample", test_record::downsample},
+        {"test_aggregate::add_snapshot", test_aggregate::add_snapshot},
+        {"test_aggregate::aggregate", test_aggregate::aggregate},
+        {"test_diff::parse_snapshot", test_diff::parse_snapshot},
+        {"test_diff::compare", test_diff::compare},
+        {"test_config::parse", test_config::parse},
+        {"test_shell::run", test_shell::run},
+        {"test_commands::run_commands", test_commands::run_commands},
+        {"test_commands::ttl", test_commands::ttl},
+        {"test_plugins::get_requests", test_plugins::get_requests},
+        {"test_plugins::probe", test_plugins::probe},
+        {"test_plugins::isolate", test_plugins::isolate},
+        {"test_cgroup::resolve_path", test_cgroup::resolve_path},
+        {"test_cgroup::read", test_cgroup::read},
+        {"test_dump::pattern", test_dump::pattern},
+        {"test_dump::dump_tree", test_dump::dump_tree},
+        {"test_inventory::id_database", test_inventory::id_database},
+        {"test_inventory::read_devices", test_inventory::read_devices},
+        {"test_pressure::parse", test_pressure::parse},
+        {"test_pressure::sampler", test_pressure::sampler},
+        {"test_sessions::count_sessions", test_sessions::count_sessions},
+        {"test_width::east_asian_width", test_width::east_asian_width},
+        {"test_width::get_width", test_width::get_width},
     };
 
     // Get the test name from the command-line arguments
@@ -201,6 +637,129 @@ int test_args::invalid()
     }
 }
 
+int test_args::image()
+{
+    try {
+        char test_executable_name[] = TEST_EXECUTABLE_NAME;
+        char arg_image[] = "--image=logo.png";
+        char *fake_argv[] = {test_executable_name, arg_image};
+        const core::args::Args args(2, fake_argv);
+        if (args.image_path != "logo.png") {
+            fmt::print(stderr, "core::args::Args() failed: image path was not parsed.\n");
+            return EXIT_FAILURE;
+        }
+
+        // An empty path is not a valid image
+        char arg_empty[] = "--image=";
+        char *empty_argv[] = {test_executable_name, arg_empty};
+        try {
+            core::args::Args(2, empty_argv);
+            fmt::print(stderr, "core::args::Args() failed: empty image path was not caught.\n");
+            return EXIT_FAILURE;
+        }
+        catch (const core::args::ArgsError &) {
+        }
+        fmt::print("core::args::Args() passed: image path parsed.\n");
+        return EXIT_SUCCESS;
+    }
+    catch (const core::args::ArgsError &e) {
+        fmt::print(stderr, "core::args::Args() failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_args::flags()
+{
+    try {
+        char test_executable_name[] = TEST_EXECUTABLE_NAME;
+        char arg_json[] = "--json";
+        char arg_profile[] = "--profile";
+        char arg_alloc_stats[] = "--alloc-stats";
+        char arg_watch[] = "--watch";
+        char arg_replay[] = "--replay=memory.ring";
+        char arg_window[] = "--window=300";
+        char arg_follow[] = "--follow";
+        char *fake_argv[] = {test_executable_name, arg_json, arg_profile, arg_alloc_stats, arg_watch, arg_replay, arg_window, arg_follow};
+        const core::args::Args args(8, fake_argv);
+        if (!args.json || !args.profile || !args.alloc_stats || !args.watch || args.image_path ||
+            args.replay_path != "memory.ring" || args.window_seconds != 300U || !args.follow || args.record_path || args.summarize_path) {
+            fmt::print(stderr, "core::args::Args() failed: flags were not parsed.\n");
+            return EXIT_FAILURE;
+        }
+        fmt::print("core::args::Args() passed: flags parsed.\n");
+        return EXIT_SUCCESS;
+    }
+    catch (const core::args::ArgsError &e) {
+        fmt::print(stderr, "core::args::Args() failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_args::aggregate()
+{
+    try {
+        char test_executable_name[] = TEST_EXECUTABLE_NAME;
+        char arg_command[] = "aggregate";
+        char arg_directory[] = "snapshots/";
+        char arg_file[] = "--json";
+        char *fake_argv[] = {test_executable_name, arg_command, arg_directory, arg_file};
+        const core::args::Args args(4, fake_argv);
+
+        // Everything after the command is a path, even if it looks like a flag
+        if (args.aggregate_paths != std::vector<std::string>{"snapshots/", "--json"} || args.json) {
+            fmt::print(stderr, "core::args::Args() failed: aggregate paths were not parsed.\n");
+            return EXIT_FAILURE;
+        }
+        char *missing_argv[] = {test_executable_name, arg_command};
+        try {
+            const core::args::Args missing(2, missing_argv);
+            fmt::print(stderr, "core::args::Args() failed: aggregate without paths was accepted.\n");
+            return EXIT_FAILURE;
+        }
+        catch (const core::args::ArgsError &) {
+        }
+        fmt::print("core::args::Args() passed: aggregate paths parsed.\n");
+        return EXIT_SUCCESS;
+    }
+    catch (const core::args::ArgsError &e) {
+        fmt::print(stderr, "core::args::Args() failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_args::diff()
+{
+    try {
+        char test_executable_name[] = TEST_EXECUTABLE_NAME;
+        char arg_command[] = "diff";
+        char arg_old[] = "before.json";
+        char arg_json[] = "--json";
+        char arg_new[] = "after.json";
+        char *fake_argv[] = {test_executable_name, arg_command, arg_old, arg_json, arg_new};
+        const core::args::Args args(5, fake_argv);
+
+        // "--json" may appear anywhere, the two other arguments are the snapshots in order
+        if (args.diff_paths != std::vector<std::string>{"before.json", "after.json"} || !args.json) {
+            fmt::print(stderr, "core::args::Args() failed: diff paths were not parsed.\n");
+            return EXIT_FAILURE;
+        }
+        char *missing_argv[] = {test_executable_name, arg_command, arg_old};
+        try {
+            const core::args::Args missing(3, missing_argv);
+            fmt::print(stderr, "core::args::Args() failed: diff with one snapshot was accepted.\n");
+            return EXIT_FAILURE;
+        }
+        catch (const core::args::ArgsError &) {
+        }
+        fmt::print("core::args::Args() passed: diff paths parsed.\n");
+        return EXIT_SUCCESS;
+    }
+    catch (const core::args::ArgsError &e) {
+        fmt::print(stderr, "core::args::Args() failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
 int test_host::get_version()
 {
     try {
@@ -252,6 +811,23 @@ int test_host::get_model_identifier()
     }
 }
 
+int test_host::get_model_name()
+{
+    try {
+        const auto model = modules::host::get_model_name();
+        if (model.find("Unknown") != std::string::npos) {
+            fmt::print(stderr, "modules::host::get_model_name() failed: {}\n", model);
+            return EXIT_FAILURE;
+        }
+        fmt::print("Model: {}\n", model);
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "modules::host::get_model_name() failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
 int test_host::get_uptime()
 {
     try {
@@ -269,70 +845,251 @@ int test_host::get_uptime()
     }
 }
 
-int test_host::get_packages()
+int test_host::get_shell()
+{
+    try {
+        const auto shell = modules::host::get_shell();
+        if (shell.find("Unknown") != std::string::npos) {
+            fmt::print(stderr, "modules::host::get_shell() failed: {}\n", shell);
+            return EXIT_FAILURE;
+        }
+        fmt::print("Shell: {}\n", shell);
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "modules::host::get_shell() failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_host::get_shell_version()
+{
+    try {
+        // Versions are cached in a fixture directory, so the test neither reads nor fills the real cache
+        const auto cache = make_fixture_directory("shell-version-cache");
+        ::setenv("APPLEFETCH_CACHE_DIR", cache.c_str(), 1);
+
+        // Use the real shells installed on the test host, skipping the ones that are missing
+        const std::array<const char *, 10> candidates = {
+            "/bin/bash",
+            "/usr/bin/bash",
+            "/opt/homebrew/bin/bash",
+            "/bin/zsh",
+            "/usr/bin/zsh",
+            "/opt/homebrew/bin/zsh",
+            "/usr/bin/fish",
+            "/usr/local/bin/fish",
+            "/opt/homebrew/bin/fish",
+            "/home/linuxbrew/.linuxbrew/bin/fish",
+        };
+        std::size_t found = 0;
+        for (const char *path : candidates) {
+            if (!std::filesystem::is_regular_file(path)) {
+                continue;
+            }
+            ++found;
+            const auto version = modules::host::get_shell_version(path);
+            if (!version) {
+                fmt::print(stderr, "modules::host::get_shell_version() failed: no version found for {}\n", path);
+                return EXIT_FAILURE;
+            }
+
+            // The version must match the one reported by the shell itself
+            const auto output = core::shell::get_output(fmt::format("{} --version", path), std::chrono::milliseconds(5000));
+            if (!output || output->find(*version) == std::string::npos) {
+                fmt::print(stderr, "modules::host::get_shell_version() failed: version '{}' of {} does not match '{}'\n", *version, path, output.value_or(""));
+                return EXIT_FAILURE;
+            }
+
+            // The second call is served from the cache and must return the same version
+            if (modules::host::get_shell_version(path) != version) {
+                fmt::print(stderr, "modules::host::get_shell_version() failed: cached version of {} differs\n", path);
+                return EXIT_FAILURE;
+            }
+            fmt::print("Shell version: {} {}\n", path, *version);
+        }
+        if (found == 0) {
+            fmt::print(stderr, "modules::host::get_shell_version() failed: no shells found on the test host\n");
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "modules::host::get_shell_version() failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_host::get_terminal()
+{
+    try {
+        // Tests may run without any terminal emulator (e.g., on CI), so "Unknown" is not treated as failure
+        const auto terminal = modules::host::get_terminal();
+        if (terminal.empty()) {
+            fmt::print(stderr, "modules::host::get_terminal() failed: empty string\n");
+            return EXIT_FAILURE;
+        }
+        fmt::print("Terminal: {}\n", terminal);
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "modules::host::get_terminal() failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_packages::get_packages()
 {
     try {
-        const auto packages = modules::host::get_packages();
+        const auto packages = modules::packages::get_packages();
         if (packages.find("Unknown") != std::string::npos) {
-            fmt::print(stderr, "modules::host::get_packages() failed: {}\n", packages);
+            fmt::print(stderr, "modules::packages::get_packages() failed: {}\n", packages);
             return EXIT_FAILURE;
         }
-        fmt::print("Packages: {} (brew)\n", packages);
+        fmt::print("Packages: {}\n", packages);
         return EXIT_SUCCESS;
     }
     catch (const std::exception &e) {
-        fmt::print(stderr, "modules::host::get_packages() failed: {}\n", e.what());
+        fmt::print(stderr, "modules::packages::get_packages() failed: {}\n", e.what());
         return EXIT_FAILURE;
     }
 }
 
-int test_host::get_shell()
+int test_packages::scan_homebrew()
 {
     try {
-        const auto shell = modules::host::get_shell();
-        if (shell.find("Unknown") != std::string::npos) {
-            fmt::print(stderr, "modules::host::get_shell() failed: {}\n", shell);
+        // Fixture prefix with 5 formulae: "a" depends on "b" and "user/tap/c", "b" on "c", "e" 2.0 (not linked) on "d"
+        const auto prefix = make_fixture_directory("homebrew");
+        const auto receipt = [](const std::string &dependencies) {
+            return fmt::format(R"({{"homebrew_version":"4.3.0","used_options":[],"installed_as_dependency":false,"installed_on_request":true,)"
+                               R"("time":1722470400,"aliases":[],"runtime_dependencies":{},"source":{{"tap":"homebrew/core","versions":{{"stable":"1.0","head":null}}}},"arch":"arm64"}})",
+                               dependencies);
+        };
+        const std::string dependency_b = R"({"full_name":"b","version":"1.0","revision":0,"pkg_version":"1.0","declared_directly":true})";
+        const std::string dependency_c = R"({"full_name":"user/tap/c","version":"1.0","revision":0,"pkg_version":"1.0","declared_directly":false})";
+        const std::string dependency_d = R"({"full_name":"d","version":"1.0"})";
+        write_fixture_file(prefix / "Cellar" / "a" / "1.0" / "INSTALL_RECEIPT.json", receipt(fmt::format("[{},{}]", dependency_b, dependency_c)));
+        write_fixture_file(prefix / "Cellar" / "b" / "1.0" / "INSTALL_RECEIPT.json", receipt(fmt::format("[{}]", dependency_c)));
+        write_fixture_file(prefix / "Cellar" / "c" / "1.0" / "INSTALL_RECEIPT.json", receipt("[]"));
+        write_fixture_file(prefix / "Cellar" / "d" / "1.0" / "INSTALL_RECEIPT.json", receipt("null"));
+        write_fixture_file(prefix / "Cellar" / "e" / "1.0" / "INSTALL_RECEIPT.json", receipt("[]"));
+        write_fixture_file(prefix / "Cellar" / "e" / "2.0" / "INSTALL_RECEIPT.json", receipt(fmt::format("[{}]", dependency_d)));
+        for (const char *name : {"a", "b", "c", "d"}) {
+            std::filesystem::create_directories(prefix / "opt");
+            std::filesystem::create_directory_symlink(std::filesystem::path("..") / "Cellar" / name / "1.0", prefix / "opt" / name);
+        }
+        std::filesystem::create_directories(prefix / "var" / "homebrew" / "pinned");
+        std::filesystem::create_directory_symlink(std::filesystem::path("..") / ".." / ".." / "Cellar" / "a" / "1.0", prefix / "var" / "homebrew" / "pinned" / "a");
+        std::filesystem::create_directories(prefix / "Caskroom" / "firefox");
+        std::filesystem::create_directories(prefix / "Caskroom" / "iterm2");
+
+        const auto summary = modules::packages::scan_homebrew(prefix);
+        if (!summary) {
+            fmt::print(stderr, "modules::packages::scan_homebrew() failed: fixture prefix could not be scanned\n");
             return EXIT_FAILURE;
         }
-        fmt::print("Shell: {}\n", shell);
+        if (summary->formulae != 5 || summary->casks != 2 || summary->leaves != 2 || summary->pinned != 1) {
+            fmt::print(stderr, "modules::packages::scan_homebrew() failed: got {} formulae, {} casks, {} leaves, {} pinned, expected 5, 2, 2, 1\n",
+                       summary->formulae, summary->casks, summary->leaves, summary->pinned);
+            return EXIT_FAILURE;
+        }
+        if (modules::packages::scan_homebrew(prefix / "missing")) {
+            fmt::print(stderr, "modules::packages::scan_homebrew() failed: missing prefix was scanned\n");
+            return EXIT_FAILURE;
+        }
+        std::filesystem::remove_all(prefix);
+        fmt::print("modules::packages::scan_homebrew() passed.\n");
         return EXIT_SUCCESS;
     }
     catch (const std::exception &e) {
-        fmt::print(stderr, "modules::host::get_shell() failed: {}\n", e.what());
+        fmt::print(stderr, "modules::packages::scan_homebrew() failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_display::get_displays()
+{
+    try {
+        const auto displays = modules::display::get_displays();
+        if (displays.find("Unknown") != std::string::npos) {
+            fmt::print(stderr, "modules::display::get_displays() failed: {}\n", displays);
+            return EXIT_FAILURE;
+        }
+        fmt::print("Displays: {}\n", displays);
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "modules::display::get_displays() failed: {}\n", e.what());
         return EXIT_FAILURE;
     }
 }
 
-int test_display::get_resolution()
+int test_display::read_drm_topology()
 {
     try {
-        const auto resolution = modules::display::get_resolution();
-        if (resolution.find("Unknown") != std::string::npos) {
-            fmt::print(stderr, "modules::display::get_resolution() failed: {}\n", resolution);
+        // Fake DRM tree: a card, a laptop panel with a 60 Hz EDID, an external monitor without EDID, and two inactive connectors
+        const auto root = make_drm_fixture();
+        const modules::display::Topology topology = modules::display::read_drm_topology(root);
+        std::string formatted;
+        modules::display::format_topology(topology, formatted);
+        std::filesystem::remove_all(root);
+        if (topology.count != 2 || !topology.displays[0].main || topology.displays[1].main || topology.displays[0].width != 2880 ||
+            topology.displays[0].height != 1800 || formatted != "2880x1800 @ 60 Hz (main), 2560x1440") {
+            fmt::print(stderr, "modules::display::read_drm_topology() failed: {} displays: {}\n", topology.count, formatted);
+            return EXIT_FAILURE;
+        }
+        if (modules::display::read_drm_topology(root).count != 0) {
+            fmt::print(stderr, "modules::display::read_drm_topology() failed: found displays in a missing directory\n");
+            return EXIT_FAILURE;
+        }
+        std::string unknown;
+        modules::display::format_topology({}, unknown);
+        if (unknown != "Unknown displays (No active display)") {
+            fmt::print(stderr, "modules::display::format_topology() failed: {}\n", unknown);
             return EXIT_FAILURE;
         }
-        fmt::print("Resolution: {}\n", resolution);
+        fmt::print("modules::display::read_drm_topology() passed: {}\n", formatted);
         return EXIT_SUCCESS;
     }
     catch (const std::exception &e) {
-        fmt::print(stderr, "modules::display::get_resolution() failed: {}\n", e.what());
+        fmt::print(stderr, "modules::display::read_drm_topology() failed: {}\n", e.what());
         return EXIT_FAILURE;
     }
 }
 
-int test_display::get_refresh_rate()
+int test_display::watcher()
 {
     try {
-        const auto refresh_rate = modules::display::get_refresh_rate();
-        if (refresh_rate.find("Unknown") != std::string::npos) {
-            fmt::print(stderr, "modules::display::get_refresh_rate() failed: {}\n", refresh_rate);
+        const auto root = make_drm_fixture();
+        std::size_t query_count = 0;
+        modules::display::Watcher watcher([&root, &query_count]() {
+            ++query_count;
+            return modules::display::read_drm_topology(root);
+        });
+
+        // The topology is queried on the first refresh only, until the displays change
+        const bool first = watcher.refresh();
+        const bool second = watcher.refresh();
+        if (!first || second || query_count != 1 || watcher.get_topology().count != 2) {
+            fmt::print(stderr, "modules::display::Watcher::refresh() failed: {} queries\n", query_count);
             return EXIT_FAILURE;
         }
-        fmt::print("Refresh rate: {}\n", refresh_rate);
+
+        // Unplug the external monitor; a change notification invalidates the topology
+        write_fixture_file(root / "card0-HDMI-A-1" / "status", "disconnected\n");
+        const std::size_t stale_count = watcher.get_topology().count;
+        watcher.invalidate();
+        const bool changed = watcher.refresh();
+        std::filesystem::remove_all(root);
+        if (stale_count != 2 || !changed || query_count != 2 || watcher.get_topology().count != 1 || !watcher.get_topology().displays[0].main) {
+            fmt::print(stderr, "modules::display::Watcher::refresh() failed: {} displays after unplugging\n", watcher.get_topology().count);
+            return EXIT_FAILURE;
+        }
+        fmt::print("modules::display::Watcher::refresh() passed: {} queries\n", query_count);
         return EXIT_SUCCESS;
     }
     catch (const std::exception &e) {
-        fmt::print(stderr, "modules::display::get_refresh_rate() failed: {}\n", e.what());
+        fmt::print(stderr, "modules::display::Watcher::refresh() failed: {}\n", e.what());
         return EXIT_FAILURE;
     }
 }
@@ -354,7 +1111,43 @@ int test_cpu::get_cpu_model()
     }
 }
 
-int test_memory::get_memory_usage()
+int test_cpu::read_sysfs_topology()
+{
+    try {
+        const auto root = make_cpu_fixture();
+        const modules::cpu::Topology topology = modules::cpu::read_sysfs_topology(root);
+        std::filesystem::remove_all(root);
+        const std::string formatted = modules::cpu::format_topology(topology);
+        if (topology.clusters.size() != 2 || topology.clusters[0].cores != 2 || topology.clusters[0].threads != 4 || topology.clusters[1].cores != 2 ||
+            topology.clusters[1].threads != 2 || topology.clusters[1].max_frequency_hz != 2000000000) {
+            fmt::print(stderr, "modules::cpu::read_sysfs_topology() failed: unexpected clusters: {}\n", formatted);
+            return EXIT_FAILURE;
+        }
+
+        // Per-core caches repeat over the cores of a cluster, while the L3 shared by both clusters is counted once
+        if (topology.l1d_bytes != 2 * 48 * 1024 + 2 * 32 * 1024 || topology.l1i_bytes != 2 * 32 * 1024 + 2 * 64 * 1024 || topology.l2_bytes != 2 * 1280 * 1024 + 2048 * 1024 ||
+            topology.l3_bytes != 8 * 1024 * 1024) {
+            fmt::print(stderr, "modules::cpu::read_sysfs_topology() failed: unexpected caches: {}\n", formatted);
+            return EXIT_FAILURE;
+        }
+        if (formatted != "2 cores (4 threads) @ 3.00 GHz + 2 cores @ 2.00 GHz, L2 4.5 MiB, L3 8 MiB") {
+            fmt::print(stderr, "modules::cpu::format_topology() failed: {}\n", formatted);
+            return EXIT_FAILURE;
+        }
+        if (!modules::cpu::read_sysfs_topology(root).clusters.empty()) {
+            fmt::print(stderr, "modules::cpu::read_sysfs_topology() failed: found clusters in a missing directory\n");
+            return EXIT_FAILURE;
+        }
+        fmt::print("modules::cpu::read_sysfs_topology() passed: {}\n", formatted);
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "modules::cpu::read_sysfs_topology() failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_memory::get_memory_usage()
 {
     try {
         const auto memory_usage = modules::memory::get_memory_usage();
@@ -370,3 +1163,1968 @@ int test_memory::get_memory_usage()
         return EXIT_FAILURE;
     }
 }
+
+int test_process::get_ancestry()
+{
+    try {
+        const auto &ancestry = core::process::get_ancestry();
+        if (ancestry.size == 0) {
+            fmt::print(stderr, "core::process::get_ancestry() failed: no parent processes found\n");
+            return EXIT_FAILURE;
+        }
+        if (ancestry.processes[0].pid != getppid()) {
+            fmt::print(stderr, "core::process::get_ancestry() failed: first entry is PID {}, expected parent PID {}\n", ancestry.processes[0].pid, getppid());
+            return EXIT_FAILURE;
+        }
+        // Every entry must be the parent of the previous one
+        for (std::size_t i = 1; i < ancestry.size; ++i) {
+            if (ancestry.processes[i - 1].ppid != ancestry.processes[i].pid) {
+                fmt::print(stderr, "core::process::get_ancestry() failed: broken chain at index {}\n", i);
+                return EXIT_FAILURE;
+            }
+        }
+        // The cached ancestry must be returned on subsequent calls
+        if (&core::process::get_ancestry() != &ancestry) {
+            fmt::print(stderr, "core::process::get_ancestry() failed: ancestry is not cached\n");
+            return EXIT_FAILURE;
+        }
+        for (const auto &process : ancestry) {
+            fmt::print("Ancestor: {} ({})\n", process.get_name(), process.pid);
+        }
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "core::process::get_ancestry() failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_json::quote()
+{
+    try {
+        // Quoted strings must round-trip through the scanner, including control characters such as the escape of a colored value
+        const std::string text = "Apple \"M1\" \\ caf\u00e9\n\t\033[0m";
+        const std::string quoted = core::json::quote(text);
+        if (quoted != R"("Apple \"M1\" \\ café\n\t\u001b[0m")") {
+            fmt::print(stderr, "core::json::quote() failed: {}\n", quoted);
+            return EXIT_FAILURE;
+        }
+        const std::string document = "[" + quoted + "]";
+        core::json::Scanner scanner(document);
+        static_cast<void>(scanner.next());
+        const core::json::Token token = scanner.next();
+        if (token.type != core::json::TokenType::String || core::json::unescape(token.text) != text) {
+            fmt::print(stderr, "core::json::quote() failed: string did not round-trip\n");
+            return EXIT_FAILURE;
+        }
+        fmt::print("core::json::quote() passed.\n");
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "core::json::quote() failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_cache::store_and_load()
+{
+    try {
+        const std::string key = "test-cache:store-and-load";
+        // Values may contain newlines and null bytes
+        const std::string value("first line\nsecond line\0binary", 30);
+        if (!core::cache::store(key, value)) {
+            fmt::print(stderr, "core::cache::store() failed: could not store value\n");
+            return EXIT_FAILURE;
+        }
+        if (core::cache::load(key) != value) {
+            fmt::print(stderr, "core::cache::load() failed: loaded value differs from stored value\n");
+            return EXIT_FAILURE;
+        }
+        if (core::cache::load("test-cache:missing-key")) {
+            fmt::print(stderr, "core::cache::load() failed: missing key returned a value\n");
+            return EXIT_FAILURE;
+        }
+        fmt::print("core::cache::store() and core::cache::load() passed.\n");
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "core::cache::store() and core::cache::load() failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_json::scanner()
+{
+    try {
+        const std::string document = R"( {"name": "git", "nested": {"list": [1, -2.5e3, true, false, null, {"a": "]"}]}, "escaped": "caf\u00e9 \"\ud83c\udf4e\"", "last": []} )";
+        core::json::Scanner scanner(document);
+
+        // Keys and values must be told apart, and nested values must be skippable
+        const auto expect = [&scanner](const core::json::TokenType type, const std::string_view text) {
+            const core::json::Token token = scanner.next();
+            return token.type == type && (text.empty() || token.text == text);
+        };
+        bool passed = expect(core::json::TokenType::ObjectBegin, "{") &&
+                      expect(core::json::TokenType::Key, "name") &&
+                      expect(core::json::TokenType::String, "git") &&
+                      expect(core::json::TokenType::Key, "nested") &&
+                      scanner.skip_value() &&
+                      scanner.depth() == 1 &&
+                      expect(core::json::TokenType::Key, "escaped");
+        const core::json::Token escaped = scanner.next();
+        passed = passed && escaped.type == core::json::TokenType::String && core::json::unescape(escaped.text) == "café \"\U0001F34E\"";
+        passed = passed &&
+                 expect(core::json::TokenType::Key, "last") &&
+                 expect(core::json::TokenType::ArrayBegin, "[") &&
+                 expect(core::json::TokenType::ArrayEnd, "]") &&
+                 expect(core::json::TokenType::ObjectEnd, "}") &&
+                 expect(core::json::TokenType::End, "");
+        if (!passed) {
+            fmt::print(stderr, "core::json::Scanner failed: unexpected token sequence\n");
+            return EXIT_FAILURE;
+        }
+
+        // Malformed input must be reported as an error instead of being read past
+        core::json::Scanner malformed(R"({"unterminated: 1})");
+        if (malformed.next().type != core::json::TokenType::ObjectBegin || malformed.next().type != core::json::TokenType::Error) {
+            fmt::print(stderr, "core::json::Scanner failed: unterminated string was not reported\n");
+            return EXIT_FAILURE;
+        }
+        fmt::print("core::json::Scanner passed.\n");
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "core::json::Scanner failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_models::find_name()
+{
+    try {
+        // Every line of the data file must round-trip through the generated table
+        std::ifstream file(MODELS_DATA_FILE);
+        if (!file) {
+            fmt::print(stderr, "modules::models::find_name() failed: could not open {}\n", MODELS_DATA_FILE);
+            return EXIT_FAILURE;
+        }
+        std::size_t count = 0;
+        for (std::string line; std::getline(file, line);) {
+            if (line.empty() || line.front() == '#') {
+                continue;
+            }
+            const std::size_t tab = line.find('\t');
+            const std::string_view identifier = std::string_view(line).substr(0, tab);
+            const std::string_view name = std::string_view(line).substr(tab + 1);
+            if (modules::models::find_name(identifier) != name) {
+                fmt::print(stderr, "modules::models::find_name() failed: '{}' did not map to '{}'\n", identifier, name);
+                return EXIT_FAILURE;
+            }
+            ++count;
+        }
+
+        // The table must hold exactly the entries of the data file, each reachable by its own key
+        std::size_t table_size = 0;
+        for (const auto &entry : modules::models::get_table()) {
+            if (modules::models::find_name(entry.key) != entry.value) {
+                fmt::print(stderr, "modules::models::find_name() failed: table entry '{}' is not reachable\n", entry.key);
+                return EXIT_FAILURE;
+            }
+            ++table_size;
+        }
+        if (table_size != count) {
+            fmt::print(stderr, "modules::models::get_table() failed: {} entries, expected {}\n", table_size, count);
+            return EXIT_FAILURE;
+        }
+
+        // Unknown identifiers, including prefixes and near misses of known ones, must not match
+        for (const std::string_view unknown : {"", "Mac", "MacBookPro18,", "MacBookPro18,30", "macbookpro18,3", "Mac99,1"}) {
+            if (modules::models::find_name(unknown)) {
+                fmt::print(stderr, "modules::models::find_name() failed: unknown identifier '{}' matched\n", unknown);
+                return EXIT_FAILURE;
+            }
+        }
+        fmt::print("modules::models::find_name() passed for {} models.\n", count);
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "modules::models::find_name() failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_layout::render()
+{
+    try {
+        // Widths are computed at compile time and count columns, not bytes
+        constexpr core::art::View logo = core::art::compiled<layout_art, layout_palette>.get_view();
+        static_assert(logo.row_count == 3 && logo.width == 3, "unexpected art dimensions");
+        static_assert(logo.rows[1].width == 3 && logo.rows[1].plain_size == 4, "multi-byte characters must take one column");
+
+        const std::vector<core::layout::Field> fields = {{"OS", "macOS 14.6.1"}, {"CPU", "Apple M1 Pro"}};
+        const std::string plain = core::layout::render(logo, fields, false);
+        const std::string expected_plain = "/\\    OS: macOS 14.6.1\n"
+                                           "/é\\   CPU: Apple M1 Pro\n"
+                                           "\\/\n";
+        if (plain != expected_plain) {
+            fmt::print(stderr, "core::layout::render() failed: plain output differs:\n{}\nexpected:\n{}\n", plain, expected_plain);
+            return EXIT_FAILURE;
+        }
+
+        // Every colored row restarts its color and ends with a reset; fields longer than the logo are aligned past it
+        const std::vector<core::layout::Field> more_fields = {{"A", "1"}, {"B", "2"}, {"C", "3"}, {"D", "4"}};
+        const std::string colored = core::layout::render(logo, more_fields, true);
+        const std::string expected_colored = "\033[31m/\\\033[0m    \033[1m\033[33mA: \033[0m\033[37m1\033[0m\n"
+                                             "\033[32m/é\\\033[0m   \033[1m\033[33mB: \033[0m\033[37m2\033[0m\n"
+                                             "\033[32m\\/\033[0m    \033[1m\033[33mC: \033[0m\033[37m3\033[0m\n"
+                                             "      \033[1m\033[33mD: \033[0m\033[37m4\033[0m\n";
+        if (colored != expected_colored) {
+            fmt::print(stderr, "core::layout::render() failed: colored output differs\n");
+            return EXIT_FAILURE;
+        }
+        fmt::print("core::layout::render() passed.\n");
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "core::layout::render() failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_logo::get_logo()
+{
+    try {
+        const auto same = [](const core::art::View &lhs, const core::art::View &rhs) {
+            return lhs.rows == rhs.rows;
+        };
+        const core::art::View macos = modules::logo::get_logo("macos");
+        const core::art::View ubuntu = modules::logo::get_logo("ubuntu");
+        const core::art::View tux = modules::logo::get_logo("linux");
+
+        // Derivatives fall back to the first ID that has a logo, unknown systems to the platform's logo
+        if (same(macos, ubuntu) || same(ubuntu, tux) ||
+            !same(modules::logo::get_logo("linuxmint ubuntu debian"), ubuntu) ||
+            !same(modules::logo::get_logo("unknown-os"), modules::logo::get_logo(""))) {
+            fmt::print(stderr, "modules::logo::get_logo() failed: unexpected logo selection\n");
+            return EXIT_FAILURE;
+        }
+        const core::art::View logo = modules::logo::get_logo(modules::host::get_os_ids());
+        for (std::size_t i = 0; i < logo.row_count; ++i) {
+            fmt::print("{}\n", logo.get_row(i, false));
+        }
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "modules::logo::get_logo() failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_layout::render_image()
+{
+    try {
+        // The image is drawn once with the cursor saved, then the fields are moved past its columns
+        const std::vector<core::layout::Field> fields = {{"OS", "macOS 14.6.1"}};
+        const std::string output = core::layout::render_image("<image>", 4, 2, fields, false);
+        const std::string expected = "\n\n\033[2A\0337<image>\0338"
+                                     "\033[7COS: macOS 14.6.1\n"
+                                     "\n";
+        if (output != expected) {
+            fmt::print(stderr, "core::layout::render_image() failed: output differs\n");
+            return EXIT_FAILURE;
+        }
+        fmt::print("core::layout::render_image() passed.\n");
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "core::layout::render_image() failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_png::decode()
+{
+    try {
+        const auto image = core::png::decode(png_fixture);
+        const std::vector<std::uint8_t> expected = {255, 0, 0, 255, 0, 255, 0, 255, 0, 0, 255, 255, 255, 255, 255, 0};
+        if (!image || image->width != 2 || image->height != 2 || image->pixels != expected) {
+            fmt::print(stderr, "core::png::decode() failed: unexpected pixels\n");
+            return EXIT_FAILURE;
+        }
+
+        // Truncated or foreign data must be rejected, not crash
+        if (core::png::decode(png_fixture.substr(0, 60)) || core::png::decode("GIF89a") || core::png::decode("")) {
+            fmt::print(stderr, "core::png::decode() failed: invalid data was accepted\n");
+            return EXIT_FAILURE;
+        }
+        fmt::print("core::png::decode() passed.\n");
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "core::png::decode() failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_graphics::downscale()
+{
+    try {
+        // The transparent pixel must not pull the average toward white
+        const auto image = core::png::decode(png_fixture);
+        const core::png::Image scaled = core::graphics::downscale(image.value(), 1, 1);
+        const std::vector<std::uint8_t> expected = {85, 85, 85, 191};
+        if (scaled.width != 1 || scaled.height != 1 || scaled.pixels != expected) {
+            fmt::print(stderr, "core::graphics::downscale() failed: unexpected pixels\n");
+            return EXIT_FAILURE;
+        }
+        fmt::print("core::graphics::downscale() passed.\n");
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "core::graphics::downscale() failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_graphics::encode_kitty()
+{
+    try {
+        const auto image = core::png::decode(png_fixture);
+        const std::string small = core::graphics::encode_kitty(image.value(), 1, 1);
+        const std::string expected_small = "\033_Ga=T,f=32,s=2,v=2,c=1,r=1,q=2;/wAA/wD/AP8AAP//////AA==\033\\";
+        if (small != expected_small) {
+            fmt::print(stderr, "core::graphics::encode_kitty() failed: output differs:\n{}\n", small);
+            return EXIT_FAILURE;
+        }
+
+        // 32x32 pixels take 5464 base64 bytes, so they are split into a 4096-byte chunk and a final chunk
+        const std::string large = core::graphics::encode_kitty(make_image(32, 32, {0, 0, 0, 255}), 4, 2);
+        const std::string_view head = "\033_Ga=T,f=32,s=32,v=32,c=4,r=2,q=2,m=1;";
+        const std::size_t tail = head.size() + 4096;
+        if (large.compare(0, head.size(), head) != 0 ||
+            large.compare(tail, 9, "\033\\\033_Gm=0;") != 0 ||
+            large.size() != tail + 9 + (5464 - 4096) + 2) {
+            fmt::print(stderr, "core::graphics::encode_kitty() failed: unexpected chunks\n");
+            return EXIT_FAILURE;
+        }
+        fmt::print("core::graphics::encode_kitty() passed.\n");
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "core::graphics::encode_kitty() failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_graphics::encode_sixel()
+{
+    try {
+        // Red band of six rows, then one blue row; the right column is transparent
+        core::png::Image image = make_image(3, 7, {255, 0, 0, 255});
+        for (std::size_t y = 0; y < image.height; ++y) {
+            for (std::size_t x = 0; x < image.width; ++x) {
+                std::uint8_t *pixel = image.pixels.data() + (y * image.width + x) * 4;
+                if (x == 2) {
+                    pixel[3] = 0;
+                }
+                else if (y == 6) {
+                    pixel[0] = 0;
+                    pixel[2] = 255;
+                }
+            }
+        }
+        const std::string output = core::graphics::encode_sixel(image);
+        const std::string expected = "\033P0;1;0q\"1;1;3;7"
+                                     "#5;2;0;0;100#180;2;100;0;0"
+                                     "#180~~"
+                                     "-#5@@"
+                                     "\033\\";
+        if (output != expected) {
+            fmt::print(stderr, "core::graphics::encode_sixel() failed: output differs:\n{}\n", output);
+            return EXIT_FAILURE;
+        }
+
+        // Long runs are run-length encoded
+        const std::string wide = core::graphics::encode_sixel(make_image(8, 1, {0, 0, 0, 255}));
+        if (wide != "\033P0;1;0q\"1;1;8;1#0;2;0;0;0#0!8@\033\\") {
+            fmt::print(stderr, "core::graphics::encode_sixel() failed: run was not encoded:\n{}\n", wide);
+            return EXIT_FAILURE;
+        }
+        fmt::print("core::graphics::encode_sixel() passed.\n");
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "core::graphics::encode_sixel() failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_image::render()
+{
+    try {
+        // Images narrower than the column limit are not upscaled
+        const std::string png(png_fixture);
+        const auto kitty = modules::image::render(png, modules::image::Protocol::Kitty, {});
+        const auto sixel = modules::image::render(png, modules::image::Protocol::Sixel, {});
+        if (!kitty || !sixel || kitty->columns != 1 || kitty->rows != 1 || sixel->columns != 1 || sixel->rows != 1 ||
+            kitty->escape.compare(0, 3, "\033_G") != 0 || sixel->escape.compare(0, 2, "\033P") != 0) {
+            fmt::print(stderr, "modules::image::render() failed: unexpected output\n");
+            return EXIT_FAILURE;
+        }
+        if (modules::image::render("not a png", modules::image::Protocol::Kitty, {})) {
+            fmt::print(stderr, "modules::image::render() failed: invalid data was accepted\n");
+            return EXIT_FAILURE;
+        }
+
+        // Every spelling of a path shares one cache entry
+        const auto directory = make_fixture_directory("image");
+        const auto cache = make_fixture_directory("image-cache");
+        write_fixture_file(directory / "logo.png", png);
+        ::setenv("APPLEFETCH_CACHE_DIR", cache.c_str(), 1);
+        if (!modules::image::get_image((directory / "logo.png").string()) || !modules::image::get_image((directory / "." / "logo.png").string())) {
+            fmt::print(stderr, "modules::image::get_image() failed: the fixture was not rendered\n");
+            return EXIT_FAILURE;
+        }
+        std::size_t entry_count = 0;
+        for ([[maybe_unused]] const auto &entry : std::filesystem::directory_iterator(cache)) {
+            ++entry_count;
+        }
+        if (entry_count != 1) {
+            fmt::print(stderr, "modules::image::get_image() failed: {} cache entries for one image\n", entry_count);
+            return EXIT_FAILURE;
+        }
+        fmt::print("modules::image::render() passed.\n");
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "modules::image::render() failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_profile::profiler()
+{
+    try {
+        std::size_t touched = 0;
+        std::string table;
+        std::string json;
+        {
+            core::profile::Profiler profiler;
+            {
+                const core::profile::Scope probe("probe");
+                {
+                    // Touch fresh pages, so that the primitive has page faults to report
+                    const core::profile::Scope primitive("primitive");
+                    std::vector<char> pages(std::size_t{1} << 22);
+                    for (std::size_t i = 0; i < pages.size(); i += 4096) {
+                        pages[i] = 1;
+                        touched += static_cast<std::size_t>(pages[i]);
+                    }
+                }
+            }
+            const auto &samples = profiler.get_samples();
+            if (samples.size() != 2 || samples[0].name != "probe" || samples[0].depth != 0 || samples[1].name != "primitive" || samples[1].depth != 1) {
+                fmt::print(stderr, "core::profile::Profiler failed: unexpected samples\n");
+                return EXIT_FAILURE;
+            }
+
+            // The probe includes its primitive
+            const core::profile::Counters &outer = samples[0].counters;
+            const core::profile::Counters &inner = samples[1].counters;
+            if (outer.wall_ns < inner.wall_ns || inner.wall_ns == 0 || outer.page_faults < inner.page_faults) {
+                fmt::print(stderr, "core::profile::Profiler failed: probe costs less than its primitive\n");
+                return EXIT_FAILURE;
+            }
+            fmt::print("Source: {}, page faults: {}, touched pages: {}\n",
+                       profiler.get_source() == core::profile::Source::PerfEvent ? "perf_event" : "getrusage", inner.page_faults, touched);
+            table = core::profile::format_table(profiler);
+            json = core::profile::format_json(profiler);
+        }
+
+        // Without an active profiler, scopes are not recorded anywhere
+        {
+            const core::profile::Scope ignored("ignored");
+        }
+        if (table.find("  primitive") == std::string::npos || json.find(R"("name":"primitive","depth":1)") == std::string::npos) {
+            fmt::print(stderr, "core::profile::format_table() or format_json() failed:\n{}\n{}\n", table, json);
+            return EXIT_FAILURE;
+        }
+        fmt::print("{}{}\n", table, json);
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "core::profile::Profiler failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_alloc::get_counters()
+{
+    try {
+        if (!core::alloc::is_enabled()) {
+            fmt::print(stderr, "core::alloc::is_enabled() failed: the allocation hook is not linked into the tests\n");
+            return EXIT_FAILURE;
+        }
+        const core::alloc::Counters before = core::alloc::get_counters();
+        {
+            std::vector<char> buffer(1000);
+            buffer[0] = 1;
+        }
+        const core::alloc::Counters after = core::alloc::get_counters();
+        if (after.allocations - before.allocations != 1 || after.deallocations - before.deallocations != 1 || after.bytes - before.bytes != 1000) {
+            fmt::print(stderr, "core::alloc::get_counters() failed: {} allocations, {} deallocations, {} bytes\n",
+                       after.allocations - before.allocations, after.deallocations - before.deallocations, after.bytes - before.bytes);
+            return EXIT_FAILURE;
+        }
+        fmt::print("core::alloc::get_counters() passed: one allocation of 1000 bytes counted.\n");
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "core::alloc::get_counters() failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_app::watch()
+{
+    // Largest number of allocations allowed over all refreshes after the first one; a field that grows (e.g., "9 mins" to "10 mins") may reallocate once
+    constexpr std::uint64_t allocation_budget = 2;
+    constexpr std::size_t refresh_count = 100;
+
+    try {
+        std::vector<core::layout::Field> fields = {
+            {"OS", "macOS Sequoia 15.3 (arm64)"},
+            {"Uptime", modules::host::get_uptime()},
+            {"Shell", "zsh 5.9"},
+            {"Memory", modules::memory::get_memory_usage()},
+            {"Load", modules::pressure::get_pressure()},
+            {"Display", modules::display::get_displays()},
+        };
+        app::Watch watch(std::move(fields), modules::logo::get_logo("macos"), true);
+
+        // The first refresh sizes the buffers, every later one reuses them
+        const std::string first = watch.refresh();
+        const core::alloc::Counters before = core::alloc::get_counters();
+        for (std::size_t i = 0; i < refresh_count; ++i) {
+            static_cast<void>(watch.refresh());
+        }
+        const core::alloc::Counters after = core::alloc::get_counters();
+        const std::uint64_t allocations = after.allocations - before.allocations;
+        if (allocations > allocation_budget) {
+            fmt::print(stderr, "app::Watch::refresh() failed: {} allocations in {} refreshes (budget: {})\n", allocations, refresh_count, allocation_budget);
+            return EXIT_FAILURE;
+        }
+        if (first.find("Uptime") == std::string::npos || first.find("Memory") == std::string::npos || first.find("Load") == std::string::npos) {
+            fmt::print(stderr, "app::Watch::refresh() failed: volatile fields are missing:\n{}\n", first);
+            return EXIT_FAILURE;
+        }
+        fmt::print("{}app::Watch::refresh() passed: {} allocations in {} refreshes.\n", first, allocations, refresh_count);
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "app::Watch::refresh() failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_ring::varint()
+{
+    try {
+        const std::array<std::uint64_t, 5> values = {0, 127, 128, 300, ~std::uint64_t{0}};
+        const std::array<std::size_t, 5> sizes = {1, 1, 2, 2, 10};
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            std::array<std::uint8_t, 10> buffer{};
+            const std::size_t size = core::ring::encode_varint(values[i], buffer.data());
+            const std::uint8_t *input = buffer.data();
+            std::uint64_t decoded = 0;
+            if (size != sizes[i] || !core::ring::decode_varint(input, buffer.data() + size, decoded) || decoded != values[i] || input != buffer.data() + size) {
+                fmt::print(stderr, "core::ring::encode_varint() or decode_varint() failed for {}: {} bytes, decoded {}\n", values[i], size, decoded);
+                return EXIT_FAILURE;
+            }
+
+            // A truncated varint is rejected
+            input = buffer.data();
+            if (size > 1 && core::ring::decode_varint(input, buffer.data() + size - 1, decoded)) {
+                fmt::print(stderr, "core::ring::decode_varint() failed: truncated varint of {} was accepted\n", values[i]);
+                return EXIT_FAILURE;
+            }
+        }
+        fmt::print("core::ring::encode_varint() and decode_varint() passed.\n");
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "core::ring::encode_varint() failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_ring::round_trip()
+{
+    try {
+        const std::string path = (make_fixture_directory("ring") / "test.ring").string();
+        const auto make_sample = [](const std::uint64_t i) {
+            // A timestamp, a slowly growing counter and a value that goes up and down
+            return std::vector<std::uint64_t>{1722470400 + i, 1000000 + i * 3, i % 2 == 0 ? 500U : 480U};
+        };
+
+        // A reader that follows the file sees every sample as soon as it is appended
+        auto writer = std::make_unique<core::ring::Writer>(path, 3, 4);
+        core::ring::Reader reader(path);
+        for (std::uint64_t i = 0; i < 10; ++i) {
+            writer->append(make_sample(i).data());
+        }
+        auto samples = reader.read();
+        if (samples.size() != 10 || samples.front() != make_sample(0) || samples.back() != make_sample(9) || !reader.read().empty()) {
+            fmt::print(stderr, "core::ring::Reader::read() failed: read {} of 10 samples\n", samples.size());
+            return EXIT_FAILURE;
+        }
+
+        // After the writer laps the reader, the reader continues with the oldest samples that were not overwritten
+        constexpr std::uint64_t total = 1000;
+        for (std::uint64_t i = 10; i < total; ++i) {
+            writer->append(make_sample(i).data());
+        }
+        samples = reader.read();
+        for (std::size_t i = 0; i < samples.size(); ++i) {
+            if (samples[i] != make_sample(total - samples.size() + i)) {
+                fmt::print(stderr, "core::ring::Reader::read() failed: sample {} of {} after lapping is wrong\n", i, samples.size());
+                return EXIT_FAILURE;
+            }
+        }
+        // A 496-byte payload holds about 160 of these samples (3 bytes each after the first), and three full blocks are always kept
+        const std::size_t kept = samples.size();
+        if (kept < 3 * 150 || kept > 4 * 170) {
+            fmt::print(stderr, "core::ring::Reader::read() failed: {} samples in 4 blocks\n", kept);
+            return EXIT_FAILURE;
+        }
+
+        // A new writer with the same layout continues the file, and a second writer is refused while it is recording
+        writer.reset();
+        writer = std::make_unique<core::ring::Writer>(path, 3, 4);
+        writer->append(make_sample(total).data());
+        samples = reader.read();
+        bool refused = false;
+        try {
+            const core::ring::Writer second(path, 3, 4);
+        }
+        catch (const core::ring::RingError &) {
+            refused = true;
+        }
+        if (samples.size() != 1 || samples.front() != make_sample(total) || !refused) {
+            fmt::print(stderr, "core::ring::Writer failed: the file was not continued ({} samples) or not locked\n", samples.size());
+            return EXIT_FAILURE;
+        }
+        fmt::print("core::ring::Writer and Reader passed: {} samples kept in 4 blocks.\n", kept);
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "core::ring failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_record::downsample()
+{
+    try {
+        // Two minutes of samples: memory grows by 1 KiB per second and 5 pages are read in per second
+        std::vector<modules::record::Sample> samples(120);
+        for (std::uint64_t i = 0; i < samples.size(); ++i) {
+            samples[i][0] = 1722470400 + i;
+            samples[i][2] = 1024 + i;
+            samples[i][4] = 150;
+            samples[i][7] = 1000 + 5 * i;
+        }
+        const auto buckets = modules::record::downsample(samples, 60);
+        if (buckets.size() != 2 || buckets[0].start != 1722470400 || buckets[0].sample_count != 60 || buckets[1].sample_count != 60) {
+            fmt::print(stderr, "modules::record::downsample() failed: {} windows\n", buckets.size());
+            return EXIT_FAILURE;
+        }
+        const modules::record::Stats &memory = buckets[1].stats[1];
+        const modules::record::Stats &load = buckets[0].stats[3];
+        const modules::record::Stats &pageins = buckets[0].stats[6];
+        if (memory.min != (1024.0 + 60) * 1024 || memory.max != (1024.0 + 119) * 1024 || load.sum / static_cast<double>(load.count) != 1.5 ||
+            pageins.count != 59 || pageins.min != 5.0 || pageins.max != 5.0) {
+            fmt::print(stderr, "modules::record::downsample() failed: unexpected statistics\n");
+            return EXIT_FAILURE;
+        }
+
+        // The whole recording as one window
+        const auto all = modules::record::downsample(samples, 0);
+        const std::string summary = modules::record::format_summary(all.front());
+        if (all.size() != 1 || all.front().sample_count != 120 || summary.find("Page-ins") == std::string::npos || summary.find("5.0/s") == std::string::npos) {
+            fmt::print(stderr, "modules::record::format_summary() failed:\n{}\n", summary);
+            return EXIT_FAILURE;
+        }
+        fmt::print("{}{}", modules::record::format_buckets(buckets, true), summary);
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "modules::record::downsample() failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_aggregate::add_snapshot()
+{
+    try {
+        core::aggregate::Summary summary;
+        const bool parsed = core::aggregate::add_snapshot(R"json({"fields":{"OS":"macOS 14.6.1 (arm64)","Model":"MacBook Pro (14-inch, 2021)","Uptime":"1d 2h 3m",)json"
+                                                          R"json("Packages":"138 (brew, 42 leaves, 3 pinned)","Mounts":["/",{"path":"/Volumes/Data"}],"CPU":"Apple M1 Pro","Memory":"10.16GiB / 16.00GiB (63%)"},)json"
+                                                          R"json("profile":{"source":"perf_event","samples":[]}})json",
+                                                          summary);
+        const bool unknown = core::aggregate::add_snapshot(R"json({"fields":{"OS":"macOS 14.6.1 (arm64)","Packages":"Unknown number of packages (Brew is not installed)",)json"
+                                                           R"json("Memory":"23.50GiB / 23.99GiB (97%)"}})json",
+                                                           summary);
+        const bool invalid = core::aggregate::add_snapshot(R"({"version":1})", summary) || core::aggregate::add_snapshot("not json", summary);
+        if (!parsed || !unknown || invalid || summary.snapshots != 2 || summary.failed != 2) {
+            fmt::print(stderr, "core::aggregate::add_snapshot() failed: {} parsed, {} failed\n", summary.snapshots, summary.failed);
+            return EXIT_FAILURE;
+        }
+        if (summary.os_versions.at("macOS 14.6.1 (arm64)") != 2 || summary.cpus.at("Apple M1 Pro") != 1 || summary.models.size() != 1 ||
+            summary.memory_gib.at(16) != 1 || summary.memory_gib.at(24) != 1 || summary.packages.at(138) != 1 || summary.packages.size() != 1 ||
+            summary.packages_by_os.at("macOS 14.6.1 (arm64)").at(138) != 1) {
+            fmt::print(stderr, "core::aggregate::add_snapshot() failed: unexpected counts\n");
+            return EXIT_FAILURE;
+        }
+
+        // Percentiles use the nearest rank: 10 hosts with 1..10 packages
+        core::aggregate::Histogram histogram;
+        for (std::uint64_t i = 1; i <= 10; ++i) {
+            histogram[i] = 1;
+        }
+        if (core::aggregate::get_percentile(histogram, 50.0) != 5U || core::aggregate::get_percentile(histogram, 90.0) != 9U ||
+            core::aggregate::get_percentile(histogram, 99.0) != 10U || core::aggregate::get_percentile({}, 50.0)) {
+            fmt::print(stderr, "core::aggregate::get_percentile() failed\n");
+            return EXIT_FAILURE;
+        }
+        fmt::print("{}", core::aggregate::format_summary(summary));
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "core::aggregate::add_snapshot() failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_aggregate::aggregate()
+{
+    try {
+        // More files than one batch, spread over a few models, plus a file that is not a snapshot
+        constexpr std::size_t file_count = 100;
+        const auto directory = make_fixture_directory("aggregate");
+        for (std::size_t i = 0; i < file_count; ++i) {
+            write_fixture_file(directory / fmt::format("host-{:03}.json", i),
+                               fmt::format(R"json({{"fields":{{"OS":"macOS 15.{} (arm64)","Model":"Mac mini ({})","Packages":"{} (brew, 1 leaves, 0 pinned)","Memory":"1.00GiB / {}.00GiB (6%)"}}}})json",
+                                           i % 3, 2020 + i % 4, i, 8 << (i % 2)));
+        }
+        write_fixture_file(directory / "notes.txt", "not a snapshot");
+        write_fixture_file(directory / "empty.json", "");
+
+        const std::vector<std::string> paths = core::aggregate::expand_paths({directory.string()});
+        const core::aggregate::Summary parallel = core::aggregate::aggregate(paths, 4);
+        const core::aggregate::Summary serial = core::aggregate::aggregate(paths, 1);
+        if (paths.size() != file_count + 1 || parallel.snapshots != file_count || parallel.failed != 1 || parallel.models.size() != 4 ||
+            parallel.memory_gib.at(8) != file_count / 2 || parallel.packages_by_os.size() != 3) {
+            fmt::print(stderr, "core::aggregate::aggregate() failed: {} paths, {} snapshots, {} failed\n", paths.size(), parallel.snapshots, parallel.failed);
+            return EXIT_FAILURE;
+        }
+
+        // Failures are reported by path, including files that do not exist
+        const std::string empty_path = (directory / "empty.json").string();
+        const std::string missing_path = (directory / "missing.json").string();
+        if (parallel.failed_paths != std::vector<std::string>{empty_path} || core::aggregate::aggregate({missing_path}).failed_paths != std::vector<std::string>{missing_path}) {
+            fmt::print(stderr, "core::aggregate::aggregate() failed: unexpected failed paths\n");
+            return EXIT_FAILURE;
+        }
+
+        // The merged per-thread summaries must match a single thread
+        if (core::aggregate::format_summary(parallel) != core::aggregate::format_summary(serial) || parallel.failed_paths != serial.failed_paths) {
+            fmt::print(stderr, "core::aggregate::aggregate() failed: parallel and serial summaries differ\n");
+            return EXIT_FAILURE;
+        }
+        fmt::print("{}", core::aggregate::format_summary(parallel));
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "core::aggregate::aggregate() failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_diff::parse_snapshot()
+{
+    try {
+        // Lists are sorted and deduplicated, escapes are decoded, and everything outside "fields" is ignored
+        const auto snapshot = core::diff::parse_snapshot(R"json({"fields":{"OS":"macOS 15.0 (arm64)","CPU":"Apple \"M4\"",)json"
+                                                         R"json("Packages":["zlib","git","git"]},"profile":{"samples":[{"name":"OS"}]}})json");
+        if (!snapshot || snapshot->size() != 3 || snapshot->at("CPU").text != R"(Apple "M4")" || snapshot->at("OS").is_list ||
+            !snapshot->at("Packages").is_list || snapshot->at("Packages").items != std::vector<std::string>{"git", "zlib"}) {
+            fmt::print(stderr, "core::diff::parse_snapshot() failed: unexpected fields\n");
+            return EXIT_FAILURE;
+        }
+        if (core::diff::parse_snapshot(R"({"version":1})") || core::diff::parse_snapshot(R"({"fields":{"Display":{"width":1920}}})") ||
+            core::diff::parse_snapshot("not json")) {
+            fmt::print(stderr, "core::diff::parse_snapshot() failed: accepted an invalid snapshot\n");
+            return EXIT_FAILURE;
+        }
+        fmt::print("core::diff::parse_snapshot() passed\n");
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "core::diff::parse_snapshot() failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_diff::compare()
+{
+    try {
+        // Same host before and after an OS update: uptime, load, sessions and memory usage changed but are not drift
+        const auto before = core::diff::parse_snapshot(R"json({"fields":{"OS":"macOS 14.6.1 (arm64)","Uptime":"12d 3h 4m","Shell":"zsh 5.9",)json"
+                                                       R"json("Load":"5.33, 4.10, 3.02 (stalled: CPU 1.75%, memory 0.00%, IO 0.31%)","Users":"14 (5 unique)",)json"
+                                                       R"json("Memory":"10.16GiB / 16.00GiB (63%)","Packages":["git","python@3.12","zlib"]}})json");
+        const auto after = core::diff::parse_snapshot(R"json({"fields":{"OS":"macOS 15.0 (arm64)","Uptime":"5m","Display":"2560x1440 @ 60Hz",)json"
+                                                      R"json("Load":"5.31, 4.10, 3.02 (stalled: CPU 1.79%, memory 0.00%, IO 0.30%)","Users":"2 (1 unique)",)json"
+                                                      R"json("Memory":"4.02GiB / 16.00GiB (25%)","Packages":["git","python@3.13","zlib"]}})json");
+        if (!before || !after) {
+            fmt::print(stderr, "core::diff::parse_snapshot() failed\n");
+            return EXIT_FAILURE;
+        }
+        const std::vector<core::diff::Change> changes = core::diff::compare(*before, *after);
+        const std::string report = core::diff::format_report(changes);
+        const std::string expected = "Display: (missing) -> 2560x1440 @ 60Hz\n"
+                                     "OS: macOS 14.6.1 (arm64) -> macOS 15.0 (arm64)\n"
+                                     "Packages: +1 -1\n"
+                                     "  + python@3.13\n"
+                                     "  - python@3.12\n"
+                                     "Shell: zsh 5.9 -> (missing)\n";
+        if (report != expected) {
+            fmt::print(stderr, "core::diff::format_report() failed: expected:\n{}got:\n{}", expected, report);
+            return EXIT_FAILURE;
+        }
+        const std::string json = core::diff::format_json(changes);
+        if (json.substr(0, 14) != R"({"drift":true,)" || json.find(R"({"field":"Shell","old":"zsh 5.9","new":null})") == std::string::npos ||
+            json.find(R"({"field":"Packages","added":["python@3.13"],"removed":["python@3.12"]})") == std::string::npos) {
+            fmt::print(stderr, "core::diff::format_json() failed: {}\n", json);
+            return EXIT_FAILURE;
+        }
+        if (!core::diff::compare(*before, *before).empty() || core::diff::format_json({}) != R"({"drift":false,"changes":[]})") {
+            fmt::print(stderr, "core::diff::compare() failed: a snapshot drifted from itself\n");
+            return EXIT_FAILURE;
+        }
+
+        // Large package lists: every third package removed and as many added, checked against the expected counts
+        core::diff::Snapshot old_snapshot;
+        core::diff::Snapshot new_snapshot;
+        core::diff::Value &old_packages = old_snapshot["Packages"];
+        core::diff::Value &new_packages = new_snapshot["Packages"];
+        old_packages.is_list = new_packages.is_list = true;
+        for (std::size_t i = 0; i < 12000; ++i) {
+            old_packages.items.push_back(fmt::format("formula-{:05}", i));
+            new_packages.items.push_back(fmt::format("formula-{:05}", i % 3 == 0 ? i + 20000 : i));
+        }
+        std::sort(new_packages.items.begin(), new_packages.items.end());
+        const std::vector<core::diff::Change> drift = core::diff::compare(old_snapshot, new_snapshot);
+        if (drift.size() != 1 || drift[0].added.size() != 4000 || drift[0].removed.size() != 4000 || drift[0].added.front() != "formula-20000" ||
+            drift[0].removed.back() != "formula-11997") {
+            fmt::print(stderr, "core::diff::compare() failed: unexpected difference of large lists\n");
+            return EXIT_FAILURE;
+        }
+        fmt::print("{}", report);
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "core::diff::compare() failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_config::parse()
+{
+    try {
+        const std::vector<core::config::Section> sections = core::config::parse("# Site-specific fields\n"
+                                                                                 "[command VPN]\n"
+                                                                                 "  run = scutil --nc list | grep -c Connected\n"
+                                                                                 "timeout=2s\r\n"
+                                                                                 "\n"
+                                                                                 "; Branch of the current directory\n"
+                                                                                 "[command Git branch]\n"
+                                                                                 "run = git branch --show-current\n"
+                                                                                 "run = git rev-parse --abbrev-ref HEAD\n",
+                                                                                 "config");
+        if (sections.size() != 2 || sections[0].kind != "command" || sections[0].name != "VPN" || sections[0].line != 2 ||
+            sections[0].get("run") != "scutil --nc list | grep -c Connected" || sections[0].get("timeout") != "2s" || sections[0].get("ttl").has_value() ||
+            sections[1].name != "Git branch" || sections[1].get("run") != "git rev-parse --abbrev-ref HEAD") {
+            fmt::print(stderr, "core::config::parse() failed: unexpected sections\n");
+            return EXIT_FAILURE;
+        }
+        for (const char *invalid : {"run = ls\n", "[command]\n", "[command VPN\n", "[command VPN]\nrun\n"}) {
+            try {
+                static_cast<void>(core::config::parse(invalid, "config"));
+                fmt::print(stderr, "core::config::parse() failed: no error for {:?}\n", invalid);
+                return EXIT_FAILURE;
+            }
+            catch (const core::config::ConfigError &) {
+            }
+        }
+        if (core::config::parse_duration("500ms") != std::chrono::milliseconds(500) || core::config::parse_duration("2s") != std::chrono::seconds(2) ||
+            core::config::parse_duration("5m") != std::chrono::minutes(5) || core::config::parse_duration("1h") != std::chrono::hours(1) ||
+            core::config::parse_duration("10").has_value() || core::config::parse_duration("fast").has_value()) {
+            fmt::print(stderr, "core::config::parse_duration() failed\n");
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "core::config::parse() failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_shell::run()
+{
+    try {
+        const auto output = core::shell::run("echo main; exit 3", std::chrono::milliseconds(5000));
+        if (!output || output->text != "main\n" || output->exit_code != 3 || output->timed_out || output->truncated) {
+            fmt::print(stderr, "core::shell::run() failed: unexpected output or exit status\n");
+            return EXIT_FAILURE;
+        }
+
+        // A runaway command is killed once enough output was captured, long before it would finish on its own
+        const auto start = std::chrono::steady_clock::now();
+        const auto bounded = core::shell::run("yes; sleep 10", std::chrono::milliseconds(5000), 4096);
+        if (!bounded || bounded->text.size() != 4096 || !bounded->truncated || bounded->timed_out || std::chrono::steady_clock::now() - start > std::chrono::seconds(3)) {
+            fmt::print(stderr, "core::shell::run() failed: output was not bounded\n");
+            return EXIT_FAILURE;
+        }
+        const auto slow = core::shell::run("sleep 10", std::chrono::milliseconds(100));
+        if (!slow || !slow->timed_out || slow->exit_code != -1) {
+            fmt::print(stderr, "core::shell::run() failed: command did not time out\n");
+            return EXIT_FAILURE;
+        }
+
+        // Closing the output does not escape the timeout
+        const auto detached_start = std::chrono::steady_clock::now();
+        const auto detached = core::shell::run("echo hi; exec >/dev/null; sleep 10", std::chrono::milliseconds(200));
+        if (!detached || !detached->timed_out || detached->text != "hi\n" || std::chrono::steady_clock::now() - detached_start > std::chrono::seconds(3)) {
+            fmt::print(stderr, "core::shell::run() failed: command that closed its output did not time out\n");
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "core::shell::run() failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_commands::run_commands()
+{
+    try {
+        const std::vector<modules::commands::Command> commands = modules::commands::get_commands(core::config::parse("[logo mac]\n"
+                                                                                                                       "[command Fast]\n"
+                                                                                                                       "run = printf 'main  \\nsecond line'\n"
+                                                                                                                       "[command Slow]\n"
+                                                                                                                       "run = sleep 10\n"
+                                                                                                                       "timeout = 300ms\n"
+                                                                                                                       "[command Failing]\n"
+                                                                                                                       "run = echo partial; exit 3\n"
+                                                                                                                       "[command Quiet]\n"
+                                                                                                                       "run = sleep 0.2\n"
+                                                                                                                       "[command Silent]\n"
+                                                                                                                       "run = true\n",
+                                                                                                                       "config"));
+        if (commands.size() != 5 || commands[1].title != "Slow" || commands[1].timeout != std::chrono::milliseconds(300) || commands[0].ttl.count() != 0) {
+            fmt::print(stderr, "modules::commands::get_commands() failed: unexpected commands\n");
+            return EXIT_FAILURE;
+        }
+
+        // The commands run concurrently, so the slowest one bounds the total rather than the sum
+        const auto start = std::chrono::steady_clock::now();
+        const std::vector<std::string> values = modules::commands::run_commands(commands);
+        const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+        const std::vector<std::string> expected = {"main", "Unknown Slow (Timed out after 300 ms)", "Unknown Failing (Exited with status 3)", "Unknown Quiet (No output)",
+                                                   "Unknown Silent (No output)"};
+        if (values != expected) {
+            fmt::print(stderr, "modules::commands::run_commands() failed: got \"{}\", \"{}\", \"{}\", \"{}\", \"{}\"\n", values[0], values[1], values[2], values[3], values[4]);
+            return EXIT_FAILURE;
+        }
+        if (elapsed > std::chrono::milliseconds(2000)) {
+            fmt::print(stderr, "modules::commands::run_commands() failed: took {} ms, commands did not run concurrently\n", elapsed.count());
+            return EXIT_FAILURE;
+        }
+
+        for (const char *invalid : {"[command A]\ntimeout = 1s\n", "[command A]\nrun = ls\ntimeout = soon\n", "[command A]\nrun = ls\ncolor = red\n"}) {
+            try {
+                static_cast<void>(modules::commands::get_commands(core::config::parse(invalid, "config")));
+                fmt::print(stderr, "modules::commands::get_commands() failed: no error for {:?}\n", invalid);
+                return EXIT_FAILURE;
+            }
+            catch (const core::config::ConfigError &) {
+            }
+        }
+        fmt::print("Commands: {} ms\n", elapsed.count());
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "modules::commands::run_commands() failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_commands::ttl()
+{
+    try {
+        // Every run appends a line to a counter file; values are cached in a fixture directory instead of the real cache
+        const auto counter = make_fixture_directory("commands") / "counter";
+        const auto cache = make_fixture_directory("commands-cache");
+        ::setenv("APPLEFETCH_CACHE_DIR", cache.c_str(), 1);
+        modules::commands::Command command;
+        command.title = "Counter";
+        command.run = fmt::format("echo x >> '{}'; wc -l < '{}'", counter.string(), counter.string());
+        command.ttl = std::chrono::seconds(300);
+        const auto first = modules::commands::run_commands({command});
+        const auto second = modules::commands::run_commands({command});
+        if (first != std::vector<std::string>{"1"} || second != first) {
+            fmt::print(stderr, "modules::commands::run_commands() failed: value was not reused within its TTL\n");
+            return EXIT_FAILURE;
+        }
+
+        // Without a TTL, the command runs on every fetch
+        command.ttl = std::chrono::seconds(0);
+        if (modules::commands::run_commands({command}) != std::vector<std::string>{"2"}) {
+            fmt::print(stderr, "modules::commands::run_commands() failed: command without TTL was not run again\n");
+            return EXIT_FAILURE;
+        }
+
+        // A failed run is not cached, so the command runs again on the next fetch
+        const auto failures = counter.parent_path() / "failures";
+        command.title = "Failing";
+        command.run = fmt::format("echo x >> '{}'; exit 1", failures.string());
+        command.ttl = std::chrono::seconds(300);
+        static_cast<void>(modules::commands::run_commands({command}));
+        const auto failed = modules::commands::run_commands({command});
+        std::ifstream runs(failures);
+        const std::string text((std::istreambuf_iterator<char>(runs)), std::istreambuf_iterator<char>());
+        if (failed != std::vector<std::string>{"Unknown Failing (Exited with status 1)"} || text != "x\nx\n") {
+            fmt::print(stderr, "modules::commands::run_commands() failed: failed run was cached\n");
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "modules::commands::run_commands() failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_plugins::get_requests()
+{
+    try {
+        const std::vector<modules::plugins::Request> requests = modules::plugins::get_requests(core::config::parse("[command Branch]\n"
+                                                                                                                  "run = git branch --show-current\n"
+                                                                                                                  "[plugin agent]\n"
+                                                                                                                  "fields = Agent, Agent version ,\n"
+                                                                                                                  "[plugin test]\n"
+                                                                                                                  "path = /opt/plugins/test.so\n"
+                                                                                                                  "fields = Crash\n"
+                                                                                                                  "isolate = yes\n"
+                                                                                                                  "timeout = 250ms\n",
+                                                                                                                  "config"));
+        if (requests.size() != 2 || requests[0].name != "agent" || requests[0].fields != std::vector<std::string>{"Agent", "Agent version"} ||
+            requests[0].path.filename() != "agent.so" || requests[0].isolate || requests[1].path != "/opt/plugins/test.so" || !requests[1].isolate ||
+            requests[1].timeout != std::chrono::milliseconds(250)) {
+            fmt::print(stderr, "modules::plugins::get_requests() failed: unexpected requests\n");
+            return EXIT_FAILURE;
+        }
+        for (const char *invalid : {"[plugin a]\npath = a.so\n", "[plugin a]\nfields = A\nisolate = maybe\n", "[plugin a]\nfields = A\nsymbol = probe\n"}) {
+            try {
+                static_cast<void>(modules::plugins::get_requests(core::config::parse(invalid, "config")));
+                fmt::print(stderr, "modules::plugins::get_requests() failed: no error for {:?}\n", invalid);
+                return EXIT_FAILURE;
+            }
+            catch (const core::config::ConfigError &) {
+            }
+        }
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "modules::plugins::get_requests() failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_plugins::probe()
+{
+    try {
+        // Plugins are only opened by their first probe
+        modules::plugins::Plugin plugin({"test", TEST_PLUGIN_FILE, {"Greeting", "Counter", "Failing", "Overflow", "Missing"}, false, std::chrono::milliseconds(1000)});
+        if (plugin.is_loaded()) {
+            fmt::print(stderr, "modules::plugins::Plugin failed: loaded before the first probe\n");
+            return EXIT_FAILURE;
+        }
+        std::vector<std::string> values;
+        plugin.probe(values);
+        const std::vector<std::string> expected = {"Hello from a plugin", "1", "Unknown Failing (Probe failed with status 7)",
+                                                   std::string(modules::plugins::max_value_size - 1, 'x'), "Unknown Missing (Not provided by plugin test)"};
+        if (!plugin.is_loaded() || values != expected) {
+            fmt::print(stderr, "modules::plugins::Plugin::probe() failed: got \"{}\", \"{}\", \"{}\", \"{}\"\n", values[0], values[1], values[2], values[4]);
+            return EXIT_FAILURE;
+        }
+
+        // Only volatile fields are probed again, static ones are left untouched
+        values[0] = "unchanged";
+        plugin.probe(values, true);
+        if (values[0] != "unchanged" || values[1] != "2") {
+            fmt::print(stderr, "modules::plugins::Plugin::probe() failed: volatile refresh got \"{}\", \"{}\"\n", values[0], values[1]);
+            return EXIT_FAILURE;
+        }
+
+        // Plugins run concurrently, and a missing plugin only loses its own fields
+        std::vector<std::unique_ptr<modules::plugins::Plugin>> plugins;
+        plugins.push_back(std::make_unique<modules::plugins::Plugin>(modules::plugins::Request{"sample", SAMPLE_PLUGIN_FILE, {"Hostname", "Time"}, false, std::chrono::milliseconds(1000)}));
+        plugins.push_back(std::make_unique<modules::plugins::Plugin>(modules::plugins::Request{"absent", "/nonexistent/absent.so", {"Absent"}, false, std::chrono::milliseconds(1000)}));
+        const auto results = modules::plugins::run_plugins(plugins);
+        if (results.size() != 2 || results[0].size() != 2 || results[0][0].empty() || results[0][0].find("Unknown") != std::string::npos ||
+            results[0][1].size() != 8 || results[1] != std::vector<std::string>{"Unknown Absent (Failed to load plugin absent)"}) {
+            fmt::print(stderr, "modules::plugins::run_plugins() failed: unexpected values\n");
+            return EXIT_FAILURE;
+        }
+        fmt::print("Hostname: {}\nTime: {}\n", results[0][0], results[0][1]);
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "modules::plugins::Plugin::probe() failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_plugins::isolate()
+{
+    try {
+        // An isolated plugin runs in a child process, so its state does not survive between probes
+        modules::plugins::Plugin plugin({"test", TEST_PLUGIN_FILE, {"Counter", "Greeting"}, true, std::chrono::milliseconds(5000)});
+        std::vector<std::string> values;
+        plugin.probe(values);
+        plugin.probe(values, true);
+        if (plugin.is_loaded() || values != std::vector<std::string>{"1", "Hello from a plugin"}) {
+            fmt::print(stderr, "modules::plugins::Plugin::probe() failed: isolated plugin got \"{}\", \"{}\"\n", values[0], values[1]);
+            return EXIT_FAILURE;
+        }
+
+        // A crash only loses the fields of the plugin
+        modules::plugins::Plugin crashing({"test", TEST_PLUGIN_FILE, {"Greeting", "Crash"}, true, std::chrono::milliseconds(5000)});
+        crashing.probe(values);
+        if (values != std::vector<std::string>{"Unknown Greeting (Plugin test crashed with signal 11)", "Unknown Crash (Plugin test crashed with signal 11)"}) {
+            fmt::print(stderr, "modules::plugins::Plugin::probe() failed: crash got \"{}\"\n", values[0]);
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "modules::plugins::Plugin::probe() failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_cgroup::resolve_path()
+{
+    try {
+        const auto root = make_cgroup_fixture();
+        const auto container = modules::cgroup::resolve_path(root / "sys", root / "container.cgroup");
+        if (!container || *container != root / "sys" / "system.slice" / "docker-4f3c.scope") {
+            fmt::print(stderr, "modules::cgroup::resolve_path() failed: got {}\n", container ? container->string() : "nothing");
+            return EXIT_FAILURE;
+        }
+
+        // Version 1 lines are skipped, and a hierarchy without the unified line (or without a memory controller) is not resolved
+        if (!modules::cgroup::resolve_path(root / "sys", root / "sibling.cgroup")) {
+            fmt::print(stderr, "modules::cgroup::resolve_path() failed: unified line after a version 1 line was not resolved\n");
+            return EXIT_FAILURE;
+        }
+        if (modules::cgroup::resolve_path(root / "sys", root / "v1.cgroup") || modules::cgroup::resolve_path(root / "missing", root / "container.cgroup")) {
+            fmt::print(stderr, "modules::cgroup::resolve_path() failed: resolved a path without a cgroup v2 hierarchy\n");
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "modules::cgroup::resolve_path() failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_cgroup::read()
+{
+    try {
+        const auto root = make_cgroup_fixture();
+        const modules::cgroup::Reader container(root / "sys" / "system.slice" / "docker-4f3c.scope");
+        const auto stats = container.read();
+        if (!stats || stats->memory_current != 1610612736 || stats->memory_max != 4294967296u || stats->memory_inactive_file != 268435456) {
+            fmt::print(stderr, "modules::cgroup::Reader::read() failed: unexpected memory statistics\n");
+            return EXIT_FAILURE;
+        }
+        if (stats->cpu_quota_us != 150000u || stats->cpu_period_us != 100000 || stats->cpu_usage_us != 81234567 || stats->cpu_periods != 1200 || stats->cpu_throttled_periods != 36) {
+            fmt::print(stderr, "modules::cgroup::Reader::read() failed: unexpected CPU statistics\n");
+            return EXIT_FAILURE;
+        }
+        if (modules::cgroup::get_cpu_limit(*stats) != 1.5) {
+            fmt::print(stderr, "modules::cgroup::get_cpu_limit() failed: expected 1.5 CPUs\n");
+            return EXIT_FAILURE;
+        }
+
+        // "max" means unlimited, and missing CPU files leave the CPU unlimited rather than failing the sample
+        const auto sibling = modules::cgroup::Reader(root / "sys" / "user.slice").read();
+        if (!sibling || sibling->memory_max || sibling->cpu_quota_us || modules::cgroup::get_cpu_limit(*sibling)) {
+            fmt::print(stderr, "modules::cgroup::Reader::read() failed: unlimited cgroup has a limit\n");
+            return EXIT_FAILURE;
+        }
+
+        // Samples are read again from the files, so a long-running caller sees new values through the same reader
+        write_fixture_file(root / "sys" / "system.slice" / "docker-4f3c.scope" / "memory.current", "2147483648\n");
+        const std::uint64_t allocations = core::alloc::get_counters().allocations;
+        const auto updated = container.read();
+        if (!updated || updated->memory_current != 2147483648) {
+            fmt::print(stderr, "modules::cgroup::Reader::read() failed: sample was not refreshed\n");
+            return EXIT_FAILURE;
+        }
+        if (core::alloc::get_counters().allocations != allocations) {
+            fmt::print(stderr, "modules::cgroup::Reader::read() failed: reading a sample allocated\n");
+            return EXIT_FAILURE;
+        }
+
+        // Without the memory controller, there is no sample at all
+        std::filesystem::remove(root / "sys" / "user.slice" / "memory.current");
+        if (modules::cgroup::Reader(root / "sys" / "user.slice").read()) {
+            fmt::print(stderr, "modules::cgroup::Reader::read() failed: read a cgroup without memory.current\n");
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "modules::cgroup::Reader::read() failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_dump::pattern()
+{
+    try {
+        // Every case is a pattern, a name and whether it matches
+        struct Case {
+            const char *pattern;
+            const char *name;
+            bool matches;
+        };
+        const Case cases[] = {
+            {"", "kernel.ostype", true},
+            {"*", "kernel.ostype", true},
+            {"kernel.ostype", "kernel.ostype", true},
+            {"kernel.ostype", "kernel.ostypes", false},
+            {"kernel", "kernel.ostype", true},
+            {"kernel", "kernelx.ostype", false},
+            {"kernel.", "kernel.ostype", true},
+            {"kernel.os????", "kernel.ostype", true},
+            {"kernel.os???", "kernel.ostype", false},
+            {"net.*forward*", "net.ipv4.conf.all.forwarding", true},
+            {"net.*forward*", "net.ipv4.tcp_syncookies", false},
+            {"*.ostype", "kernel.ostype", true},
+            {"*.ostype", "kernel.ostype.x", false},
+            {"k*e", "kernel.core_pipe_limit", false},
+            {"k*e", "kernel.core_uses_pid", false},
+            {"k*e", "kernel.ostype", true},
+            {"a**b", "ab", true},
+            {"ab*ab", "ab", false},
+            {"ab*ab", "abab", true},
+        };
+        for (const Case &test_case : cases) {
+            if (core::dump::Pattern(test_case.pattern).matches(test_case.name) != test_case.matches) {
+                fmt::print(stderr, "core::dump::Pattern::matches() failed: pattern {:?} and name {:?} should {}match\n", test_case.pattern, test_case.name, test_case.matches ? "" : "not ");
+                return EXIT_FAILURE;
+            }
+        }
+
+        // Subtrees are ruled out by the literal head of the pattern only
+        const core::dump::Pattern forward("net.ipv4.*forward*");
+        if (!forward.may_match_below("net.") || !forward.may_match_below("net.ipv4.conf.") || forward.may_match_below("kernel.") || forward.may_match_below("net.ipv6.")) {
+            fmt::print(stderr, "core::dump::Pattern::may_match_below() failed: wrong subtrees for \"net.ipv4.*forward*\"\n");
+            return EXIT_FAILURE;
+        }
+        if (!core::dump::Pattern("*forward").may_match_below("kernel.") || core::dump::Pattern("vm").may_match_below("vmx.")) {
+            fmt::print(stderr, "core::dump::Pattern::may_match_below() failed: wrong subtrees for \"*forward\" or \"vm\"\n");
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "core::dump::Pattern failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_dump::dump_tree()
+{
+    try {
+        const auto root = make_fixture_directory("dump");
+        write_fixture_file(root / "kernel" / "ostype", "Linux\n");
+        write_fixture_file(root / "kernel" / "hostname", "build-01\n");
+        write_fixture_file(root / "kernel" / "random" / "boot_id", "4f3c\n");
+        write_fixture_file(root / "net" / "ipv4" / "conf" / "eth0.100" / "forwarding", "1\n");
+        write_fixture_file(root / "net" / "ipv4" / "tcp_rmem", "4096\t131072\t6291456\n");
+        write_fixture_file(root / "dev" / "cdrom" / "info", "CD-ROM information\ndrive name:\n");
+        write_fixture_file(root / "vm" / "swappiness", "60\n");
+
+        // The output is the same whatever the number of threads, since subtrees are written in name order
+        const auto dump = [&root](const std::string_view pattern, const core::dump::Format format, const std::size_t thread_count, std::size_t &count) {
+            std::FILE *file = std::tmpfile();
+            count = core::dump::dump_tree(root, core::dump::Pattern(pattern), format, file, thread_count);
+            std::string output(static_cast<std::size_t>(std::ftell(file)), '\0');
+            std::rewind(file);
+            output.resize(std::fread(output.data(), 1, output.size(), file));
+            std::fclose(file);
+            return output;
+        };
+        std::size_t count = 0;
+        const std::string everything = dump("", core::dump::Format::Text, 1, count);
+        const std::string expected = "dev.cdrom.info = CD-ROM information\n"
+                                     "dev.cdrom.info = drive name:\n"
+                                     "kernel.hostname = build-01\n"
+                                     "kernel.ostype = Linux\n"
+                                     "kernel.random.boot_id = 4f3c\n"
+                                     "net.ipv4.conf.eth0/100.forwarding = 1\n"
+                                     "net.ipv4.tcp_rmem = 4096\t131072\t6291456\n"
+                                     "vm.swappiness = 60\n";
+        if (everything != expected || count != 7) {
+            fmt::print(stderr, "core::dump::dump_tree() failed: got {} variables:\n{}", count, everything);
+            return EXIT_FAILURE;
+        }
+        for (const std::size_t thread_count : {std::size_t{2}, std::size_t{8}}) {
+            if (dump("", core::dump::Format::Text, thread_count, count) != everything) {
+                fmt::print(stderr, "core::dump::dump_tree() failed: output on {} threads differs from 1 thread\n", thread_count);
+                return EXIT_FAILURE;
+            }
+        }
+
+        const std::string forwarding = dump("net.*forward*", core::dump::Format::Ndjson, 4, count);
+        if (forwarding != "{\"name\":\"net.ipv4.conf.eth0/100.forwarding\",\"value\":\"1\"}\n" || count != 1) {
+            fmt::print(stderr, "core::dump::dump_tree() failed: unexpected NDJSON output: {}", forwarding);
+            return EXIT_FAILURE;
+        }
+        if (dump("kernel.random", core::dump::Format::Text, 4, count) != "kernel.random.boot_id = 4f3c\n" || dump("fs", core::dump::Format::Text, 4, count) != "" || count != 0) {
+            fmt::print(stderr, "core::dump::dump_tree() failed: unexpected output for a subtree\n");
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "core::dump::dump_tree() failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_inventory::id_database()
+{
+    try {
+        // Subsystems and the class list after the vendors are not indexed, and the first of duplicate IDs wins
+        const auto root = make_fixture_directory("inventory-ids");
+        const std::string text = "# List of PCI ID's\n"
+                                 "\n"
+                                 "10de  NVIDIA Corporation\n"
+                                 "\t1eb8  TU104GL [Tesla T4]\n"
+                                 "\t\t10de 12a2  T4 16GB\n"
+                                 "8086  Intel Corporation\n"
+                                 "\t3e9b  CoffeeLake-H GT2 [UHD Graphics 630]\n"
+                                 "\ta36d  Cannon Lake PCH USB 3.1 xHCI Host Controller\n"
+                                 "\t3e9b  Duplicate\n"
+                                 "1af4  Red Hat, Inc.\n"
+                                 "C 03  Display controller\n"
+                                 "\t00  VGA compatible controller\n";
+        write_fixture_file(root / "pci.ids", text);
+        const auto index_path = root / "cache" / "pci.ids.index";
+
+        const auto check = [](const modules::inventory::IdDatabase &database) {
+            return database.is_loaded() && database.find_vendor(0x8086) == "Intel Corporation" && database.find_vendor(0x1af4) == "Red Hat, Inc." && database.find_device(0x8086, 0x3e9b) == "CoffeeLake-H GT2 [UHD Graphics 630]" &&
+                   database.find_device(0x10de, 0x1eb8) == "TU104GL [Tesla T4]" && !database.find_vendor(0x1234) && !database.find_device(0x8086, 0x1eb8) && !database.find_device(0x10de, 0x12a2) && !database.find_vendor(0x0003);
+        };
+        {
+            const modules::inventory::IdDatabase built(root / "pci.ids", index_path);
+            if (!check(built) || built.is_mapped() || !std::filesystem::exists(index_path)) {
+                fmt::print(stderr, "modules::inventory::IdDatabase failed: unexpected names or no index after the first load\n");
+                return EXIT_FAILURE;
+            }
+        }
+
+        // The second load maps the index, and looking up a name does not allocate
+        const modules::inventory::IdDatabase mapped(root / "pci.ids", index_path);
+        const std::uint64_t allocations = core::alloc::get_counters().allocations;
+        if (!check(mapped) || !mapped.is_mapped()) {
+            fmt::print(stderr, "modules::inventory::IdDatabase failed: the index was not mapped on the second load\n");
+            return EXIT_FAILURE;
+        }
+        if (core::alloc::get_counters().allocations != allocations) {
+            fmt::print(stderr, "modules::inventory::IdDatabase failed: looking up names allocated\n");
+            return EXIT_FAILURE;
+        }
+
+        // Once the database changes, the stale index is replaced
+        write_fixture_file(root / "pci.ids", "8086  Intel Corp.\n");
+        const modules::inventory::IdDatabase rebuilt(root / "pci.ids", index_path);
+        if (rebuilt.is_mapped() || rebuilt.find_vendor(0x8086) != "Intel Corp." || rebuilt.find_device(0x8086, 0x3e9b)) {
+            fmt::print(stderr, "modules::inventory::IdDatabase failed: a stale index was used\n");
+            return EXIT_FAILURE;
+        }
+        if (!modules::inventory::IdDatabase(root / "pci.ids", index_path).is_mapped()) {
+            fmt::print(stderr, "modules::inventory::IdDatabase failed: the rebuilt index was not stored\n");
+            return EXIT_FAILURE;
+        }
+
+        // A missing database is not an error, it just names nothing
+        const modules::inventory::IdDatabase missing(root / "usb.ids", std::nullopt);
+        if (missing.is_loaded() || missing.find_vendor(0x8086)) {
+            fmt::print(stderr, "modules::inventory::IdDatabase failed: a missing database was loaded\n");
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "modules::inventory::IdDatabase failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_inventory::read_devices()
+{
+    try {
+        // PCI attributes have a "0x" prefix, USB ones do not, and USB interfaces sit next to their devices
+        const auto root = make_fixture_directory("inventory-sysfs");
+        const auto pci = root / "pci";
+        for (int i = 0; i < 40; ++i) {
+            const auto device = pci / fmt::format("0000:{:02x}:00.0", i);
+            write_fixture_file(device / "vendor", "0x1af4\n");
+            write_fixture_file(device / "device", fmt::format("0x{:04x}\n", 0x1000 + i));
+        }
+        write_fixture_file(pci / "0000:00:02.0" / "vendor", "0x8086\n");
+        write_fixture_file(pci / "0000:00:02.0" / "device", "0x3e9b\n");
+        write_fixture_file(pci / "0000:00:03.0" / "vendor", "0x8086\n");
+        const auto usb = root / "usb";
+        write_fixture_file(usb / "1-1" / "idVendor", "046d\n");
+        write_fixture_file(usb / "1-1" / "idProduct", "c52b\n");
+        write_fixture_file(usb / "1-1" / "manufacturer", "Logitech\n");
+        write_fixture_file(usb / "1-1" / "product", "USB Receiver\n");
+        write_fixture_file(usb / "1-1:1.0" / "bInterfaceClass", "03\n");
+        write_fixture_file(usb / "usb1" / "idVendor", "1d6b\n");
+        write_fixture_file(usb / "usb1" / "idProduct", "0002\n");
+
+        // Devices come back in address order whatever the thread that read them, and incomplete ones are dropped
+        auto devices = modules::inventory::read_pci_devices(pci);
+        if (devices.size() != 41 || devices[0].address != "0000:00:00.0" || devices[1].address != "0000:00:02.0" || devices[1].vendor_id != 0x8086 || devices[1].device_id != 0x3e9b || devices[40].address != "0000:27:00.0" || devices[40].device_id != 0x1027) {
+            fmt::print(stderr, "modules::inventory::read_pci_devices() failed: got {} devices\n", devices.size());
+            return EXIT_FAILURE;
+        }
+        auto usb_devices = modules::inventory::read_usb_devices(usb);
+        if (usb_devices.size() != 2 || usb_devices[0].address != "1-1" || usb_devices[0].vendor_id != 0x046d || usb_devices[0].device_id != 0xc52b || usb_devices[0].name != "USB Receiver" || usb_devices[1].address != "usb1" || !usb_devices[1].vendor.empty()) {
+            fmt::print(stderr, "modules::inventory::read_usb_devices() failed: got {} devices\n", usb_devices.size());
+            return EXIT_FAILURE;
+        }
+
+        // Names from the database win over the ones the devices report, which are kept otherwise
+        write_fixture_file(root / "pci.ids", "8086  Intel Corporation\n\t3e9b  CoffeeLake-H GT2 [UHD Graphics 630]\n");
+        write_fixture_file(root / "usb.ids", "046d  Logitech, Inc.\n1d6b  Linux Foundation\n\t0002  2.0 root hub\n");
+        modules::inventory::resolve_names(modules::inventory::IdDatabase(root / "pci.ids", std::nullopt), devices);
+        modules::inventory::resolve_names(modules::inventory::IdDatabase(root / "usb.ids", std::nullopt), usb_devices);
+        if (devices[1].vendor != "Intel Corporation" || devices[1].name != "CoffeeLake-H GT2 [UHD Graphics 630]" || !devices[0].vendor.empty() || usb_devices[0].vendor != "Logitech, Inc." || usb_devices[0].name != "USB Receiver" || usb_devices[1].name != "2.0 root hub") {
+            fmt::print(stderr, "modules::inventory::resolve_names() failed: unexpected names\n");
+            return EXIT_FAILURE;
+        }
+
+        const std::vector<modules::inventory::Device> shown = {devices[1], devices[0], usb_devices[0]};
+        const std::string text = modules::inventory::format_text(shown);
+        const std::string expected_text = "PCI  0000:00:02.0  8086:3e9b  Intel Corporation  CoffeeLake-H GT2 [UHD Graphics 630]\n"
+                                          "PCI  0000:00:00.0  1af4:1000  Unknown vendor     Unknown device\n"
+                                          "USB  1-1           046d:c52b  Logitech, Inc.     USB Receiver\n";
+        if (text != expected_text) {
+            fmt::print(stderr, "modules::inventory::format_text() failed: got:\n{}", text);
+            return EXIT_FAILURE;
+        }
+        const std::string json = modules::inventory::format_json({usb_devices[0]});
+        if (json != R"({"devices":[{"bus":"USB","address":"1-1","vendor_id":"046d","device_id":"c52b","vendor":"Logitech, Inc.","name":"USB Receiver"}]})") {
+            fmt::print(stderr, "modules::inventory::format_json() failed: got {}\n", json);
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "modules::inventory::read_devices() failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_text::format()
+{
+    try {
+        // Every value must come out exactly as fmt prints it, so that the output does not depend on the formatting path
+        std::vector<double> values = {0.0, -0.0, 0.5, 1.5, 2.5, 0.125, -0.125, 0.005, 0.015, 1.005, 1.0 / 3.0, 2.0 / 3.0, 1.75, 99.995, 99999.95, 999999.5, 1e-5, 9.9999949e-5, 1e6, 1e20, -1e-300, 1e300};
+        std::uint64_t state = 0x9E3779B97F4A7C15ULL;
+        const auto next = [&state]() {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return state;
+        };
+        for (std::size_t i = 0; i < 10000; ++i) {
+            // Memory sizes in GiB, ratios and quarters (e.g., display scales), then arbitrary bit patterns
+            values.push_back(static_cast<double>(next() % (std::uint64_t{64} << 30)) / (1024.0 * 1024.0 * 1024.0));
+            values.push_back(static_cast<double>(next() % 100000) / static_cast<double>(1 + next() % 1000));
+            values.push_back(static_cast<double>(next() % 20000) / 4.0);
+            const std::uint64_t bits = next();
+            double value = 0.0;
+            std::memcpy(&value, &bits, sizeof(value));
+            values.push_back(value);
+        }
+        std::string output;
+        for (const double value : values) {
+            for (int precision = 0; precision <= 3; ++precision) {
+                output.clear();
+                core::text::append_fixed(value, precision, output);
+                if (const std::string expected = fmt::format("{:.{}f}", value, precision); output != expected) {
+                    fmt::print(stderr, "core::text::append_fixed() failed for {} with {} decimals: got {}, expected {}\n", value, precision, output, expected);
+                    return EXIT_FAILURE;
+                }
+            }
+            output.clear();
+            core::text::append_general(value, output);
+            if (const std::string expected = fmt::format("{:g}", value); output != expected) {
+                fmt::print(stderr, "core::text::append_general() failed for {}: got {}, expected {}\n", value, output, expected);
+                return EXIT_FAILURE;
+            }
+        }
+
+        for (const std::uint64_t value : {std::uint64_t{0}, std::uint64_t{9}, std::uint64_t{10}, std::uint64_t{99}, std::uint64_t{100}, std::uint64_t{1536}, ~std::uint64_t{0}}) {
+            output.clear();
+            core::text::append_unsigned(value, output);
+            core::text::append_hex(value, 16, output);
+            core::text::append_signed(-static_cast<std::int64_t>(value / 2), output);
+            if (const std::string expected = fmt::format("{}{:016x}{}", value, value, -static_cast<std::int64_t>(value / 2)); output != expected) {
+                fmt::print(stderr, "core::text failed for {}: got {}, expected {}\n", value, output, expected);
+                return EXIT_FAILURE;
+            }
+        }
+        output.clear();
+        core::text::append_signed(std::numeric_limits<std::int64_t>::min(), output);
+        core::text::append_hex(0x3e9b, 4, output);
+        if (output != "-92233720368547758083e9b") {
+            fmt::print(stderr, "core::text failed: got {}\n", output);
+            return EXIT_FAILURE;
+        }
+        fmt::print("core::text passed: {} values formatted like fmt.\n", values.size());
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "core::text failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_app::budgets()
+{
+    // Budgets of the executable: a fetch must start, print and exit quickly, and stay small in memory and on disk
+    constexpr std::uintmax_t size_budget = 1536 * 1024;
+    constexpr long rss_budget = 32 * 1024 * 1024;
+    constexpr std::chrono::milliseconds time_budget(250);
+    constexpr std::size_t run_count = 5;
+
+    try {
+        // The fetch must not read the user's config, cache or plugins, which would make the budgets depend on the machine
+        const auto root = make_fixture_directory("budgets");
+        write_fixture_file(root / "config", "");
+        std::filesystem::create_directories(root / "cache");
+        std::filesystem::create_directories(root / "plugins");
+        const std::string config_path = (root / "config").string();
+        const std::string cache_directory = (root / "cache").string();
+        const std::string plugin_directory = (root / "plugins").string();
+
+        // Run the fetch with its output discarded, returning its wall time and peak resident memory in bytes
+        const auto run = [&config_path, &cache_directory, &plugin_directory]() -> std::optional<std::pair<std::chrono::steady_clock::duration, long>> {
+            const auto start = std::chrono::steady_clock::now();
+            const pid_t pid = ::fork();
+            if (pid < 0) {
+                return std::nullopt;
+            }
+            if (pid == 0) {
+                const int null_fd = ::open("/dev/null", O_WRONLY);
+                ::dup2(null_fd, STDOUT_FILENO);
+                ::setenv("NO_COLOR", "1", 1);
+                ::setenv("APPLEFETCH_CONFIG", config_path.c_str(), 1);
+                ::setenv("APPLEFETCH_CACHE_DIR", cache_directory.c_str(), 1);
+                ::setenv("APPLEFETCH_PLUGIN_DIR", plugin_directory.c_str(), 1);
+                char *const argv[] = {const_cast<char *>(APPLEFETCH_FILE), nullptr};
+                ::execv(APPLEFETCH_FILE, argv);
+                ::_exit(127);
+            }
+            int status = 0;
+            struct rusage usage{};
+            if (::wait4(pid, &status, 0, &usage) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+                return std::nullopt;
+            }
+#if defined(__APPLE__)
+            const long rss = usage.ru_maxrss;
+#else
+            const long rss = usage.ru_maxrss * 1024;
+#endif
+            return std::make_pair(std::chrono::steady_clock::now() - start, rss);
+        };
+
+        // The first run fills the cache (e.g., the shell version), which is what every later fetch reads
+        if (!run()) {
+            fmt::print(stderr, "applefetch failed: {} did not exit successfully\n", APPLEFETCH_FILE);
+            return EXIT_FAILURE;
+        }
+        auto fastest = std::chrono::steady_clock::duration::max();
+        long peak_rss = 0;
+        for (std::size_t i = 0; i < run_count; ++i) {
+            const auto result = run();
+            if (!result) {
+                fmt::print(stderr, "applefetch failed: {} did not exit successfully\n", APPLEFETCH_FILE);
+                return EXIT_FAILURE;
+            }
+            fastest = std::min(fastest, result->first);
+            peak_rss = std::max(peak_rss, result->second);
+        }
+        const auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(fastest);
+        if (milliseconds > time_budget) {
+            fmt::print(stderr, "applefetch failed: fetch took {} ms (budget: {} ms)\n", milliseconds.count(), time_budget.count());
+            return EXIT_FAILURE;
+        }
+        if (peak_rss > rss_budget) {
+            fmt::print(stderr, "applefetch failed: peak RSS is {} KiB (budget: {} KiB)\n", peak_rss / 1024, rss_budget / 1024);
+            return EXIT_FAILURE;
+        }
+
+        // Only optimized builds are stripped, so the size of a debug build says nothing
+        const std::uintmax_t size = std::filesystem::file_size(APPLEFETCH_FILE);
+#if defined(NDEBUG)
+        constexpr bool check_size = true;
+#else
+        constexpr bool check_size = false;
+#endif
+        if (check_size && size > size_budget) {
+            fmt::print(stderr, "applefetch failed: executable is {} KiB (budget: {} KiB)\n", size / 1024, size_budget / 1024);
+            return EXIT_FAILURE;
+        }
+        fmt::print("applefetch passed: {} ms, {} KiB peak RSS, {} KiB on disk.\n", milliseconds.count(), peak_rss / 1024, size / 1024);
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "applefetch failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_pressure::parse()
+{
+    try {
+        const auto load = modules::pressure::parse_loadavg("0.52 0.48 12.40 2/1234 56789\n");
+        if (!load || load->one != 0.52 || load->five != 0.48 || load->fifteen != 12.4) {
+            fmt::print(stderr, "modules::pressure::parse_loadavg() failed: unexpected load averages\n");
+            return EXIT_FAILURE;
+        }
+        if (modules::pressure::parse_loadavg("0.52 0.48\n") || modules::pressure::parse_loadavg("0.5 0.48 0.40\n") || modules::pressure::parse_loadavg("")) {
+            fmt::print(stderr, "modules::pressure::parse_loadavg() failed: parsed a malformed file\n");
+            return EXIT_FAILURE;
+        }
+
+        const auto memory = modules::pressure::parse_stalls("some avg10=1.20 avg60=0.85 avg300=0.40 total=81234567\nfull avg10=0.31 avg60=0.10 avg300=0.00 total=1234\n");
+        if (!memory || memory->some.avg10 != 1.2 || memory->some.avg60 != 0.85 || memory->some.avg300 != 0.4 || memory->some.total_us != 81234567 ||
+            memory->full.avg10 != 0.31 || memory->full.total_us != 1234) {
+            fmt::print(stderr, "modules::pressure::parse_stalls() failed: unexpected stalls\n");
+            return EXIT_FAILURE;
+        }
+
+        // Kernels before 5.13 have no "full" line for CPU, which is not an error
+        const auto cpu = modules::pressure::parse_stalls("some avg10=3.05 avg60=2.00 avg300=1.00 total=99\n");
+        if (!cpu || cpu->some.avg10 != 3.05 || cpu->full.total_us != 0) {
+            fmt::print(stderr, "modules::pressure::parse_stalls() failed: \"some\" only file was rejected\n");
+            return EXIT_FAILURE;
+        }
+        if (modules::pressure::parse_stalls("full avg10=0.00 avg60=0.00 avg300=0.00 total=0\n") || modules::pressure::parse_stalls("some avg10=1.20 avg60=0.85\n")) {
+            fmt::print(stderr, "modules::pressure::parse_stalls() failed: parsed a malformed file\n");
+            return EXIT_FAILURE;
+        }
+
+        // Rates come from the totals, so 250 ms stalled over 1 s is 25% whatever the kernel averages say
+        modules::pressure::Sample previous;
+        previous.load = load;
+        previous.stalls[0] = cpu;
+        previous.stalls[1] = memory;
+        modules::pressure::Sample current = previous;
+        current.stalls[0]->some.total_us += 250000;
+        current.stalls[1]->some.total_us += 5000;
+        std::string formatted;
+        modules::pressure::format_sample(current, formatted);
+        if (formatted != "0.52, 0.48, 12.40 (stalled: CPU 3.05%, memory 1.20%)") {
+            fmt::print(stderr, "modules::pressure::format_sample() failed: {}\n", formatted);
+            return EXIT_FAILURE;
+        }
+        modules::pressure::format_rates(previous, current, 1000000, formatted);
+        if (formatted != "0.52, 0.48, 12.40 (stalled: CPU 25.00%, memory 0.50%)") {
+            fmt::print(stderr, "modules::pressure::format_rates() failed: {}\n", formatted);
+            return EXIT_FAILURE;
+        }
+
+        // Without PSI, only the load averages are shown, and the level when there is one
+        modules::pressure::Sample level;
+        level.load = load;
+        level.level = modules::pressure::Level::Warning;
+        modules::pressure::format_sample(level, formatted);
+        if (formatted != "0.52, 0.48, 12.40 (memory pressure warning)") {
+            fmt::print(stderr, "modules::pressure::format_sample() failed: {}\n", formatted);
+            return EXIT_FAILURE;
+        }
+        modules::pressure::format_sample({}, formatted);
+        if (formatted.rfind("Unknown load (", 0) != 0) {
+            fmt::print(stderr, "modules::pressure::format_sample() failed: {}\n", formatted);
+            return EXIT_FAILURE;
+        }
+        fmt::print("modules::pressure::parse_stalls() passed.\n");
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "modules::pressure::parse_stalls() failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_pressure::sampler()
+{
+    try {
+#if defined(__linux__)
+        // Fake procfs with PSI for CPU and memory only, as if IO accounting were missing
+        const auto root = make_fixture_directory("proc");
+        write_fixture_file(root / "loadavg", "0.52 0.48 0.40 2/1234 56789\n");
+        write_fixture_file(root / "pressure" / "cpu", "some avg10=1.20 avg60=0.85 avg300=0.40 total=1000000\n");
+        write_fixture_file(root / "pressure" / "memory", "some avg10=0.00 avg60=0.00 avg300=0.00 total=0\nfull avg10=0.00 avg60=0.00 avg300=0.00 total=0\n");
+        const modules::pressure::Sampler sampler(root.string());
+        const modules::pressure::Sample first = sampler.read();
+        if (!first.load || first.load->one != 0.52 || !first.stalls[0] || first.stalls[0]->some.total_us != 1000000 || !first.stalls[1] || first.stalls[2]) {
+            fmt::print(stderr, "modules::pressure::Sampler::read() failed: unexpected sample\n");
+            return EXIT_FAILURE;
+        }
+
+        // The files are rewritten in place, so the open descriptors see the new contents without allocating
+        write_fixture_file(root / "loadavg", "1.52 0.68 0.44 3/1234 56790\n");
+        write_fixture_file(root / "pressure" / "cpu", "some avg10=2.40 avg60=1.05 avg300=0.44 total=1500000\n");
+        const std::uint64_t allocations = core::alloc::get_counters().allocations;
+        const modules::pressure::Sample second = sampler.read();
+        if (core::alloc::get_counters().allocations != allocations) {
+            fmt::print(stderr, "modules::pressure::Sampler::read() failed: reading a sample allocated\n");
+            return EXIT_FAILURE;
+        }
+        std::filesystem::remove_all(root);
+        if (!second.load || second.load->one != 1.52 || !second.stalls[0] || second.stalls[0]->some.total_us != 1500000) {
+            fmt::print(stderr, "modules::pressure::Sampler::read() failed: sample was not refreshed\n");
+            return EXIT_FAILURE;
+        }
+        std::string formatted;
+        modules::pressure::format_rates(first, second, 2000000, formatted);
+        if (formatted != "1.52, 0.68, 0.44 (stalled: CPU 25.00%, memory 0.00%)") {
+            fmt::print(stderr, "modules::pressure::format_rates() failed: {}\n", formatted);
+            return EXIT_FAILURE;
+        }
+#else
+        const modules::pressure::Sampler sampler;
+        const modules::pressure::Sample sample = sampler.read();
+        if (!sample.load || !sample.level) {
+            fmt::print(stderr, "modules::pressure::Sampler::read() failed: missing load averages or pressure level\n");
+            return EXIT_FAILURE;
+        }
+#endif
+        fmt::print("modules::pressure::Sampler::read() passed: {}\n", modules::pressure::get_pressure());
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "modules::pressure::Sampler::read() failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_sessions::count_sessions()
+{
+    try {
+        // 14 sessions of 5 users, including one whose name fills the field without a terminator, among dead and login records
+        const std::string long_name(sizeof(utmpx::ut_user), 'x');
+        const std::array<std::string_view, 5> users = {"alice", "bob", "carol", "dave", long_name};
+        std::string records;
+        for (std::size_t i = 0; i < 14; ++i) {
+            append_utmpx_record(USER_PROCESS, users[i % users.size()], records);
+            append_utmpx_record(DEAD_PROCESS, "mallory", records);
+        }
+        append_utmpx_record(LOGIN_PROCESS, "LOGIN", records);
+        append_utmpx_record(USER_PROCESS, "", records);
+        const auto root = make_fixture_directory("utmp");
+        write_fixture_file(root / "utmp", records);
+        const auto sessions = modules::sessions::read_sessions(root / "utmp");
+        if (!sessions || sessions->sessions != 14 || sessions->users != 5 || modules::sessions::format_sessions(*sessions) != "14 (5 unique)") {
+            fmt::print(stderr, "modules::sessions::read_sessions() failed: {}\n", sessions ? modules::sessions::format_sessions(*sessions) : "no sessions");
+            return EXIT_FAILURE;
+        }
+
+        // A record being written is cut off at the end of the file, and must not be read past it
+        const auto truncated = modules::sessions::count_sessions(std::string_view(records.data(), records.size() - sizeof(struct utmpx) / 2));
+        if (truncated.sessions != 14 || truncated.users != 5) {
+            fmt::print(stderr, "modules::sessions::count_sessions() failed: {} sessions in a truncated database\n", truncated.sessions);
+            return EXIT_FAILURE;
+        }
+
+        // Enough distinct users to grow the set several times
+        std::string many;
+        for (int i = 0; i < 20000; ++i) {
+            append_utmpx_record(USER_PROCESS, fmt::format("user{}", i % 1000), many);
+        }
+        const auto grown = modules::sessions::count_sessions(many);
+        if (grown.sessions != 20000 || grown.users != 1000) {
+            fmt::print(stderr, "modules::sessions::count_sessions() failed: {} sessions of {} users\n", grown.sessions, grown.users);
+            return EXIT_FAILURE;
+        }
+
+        // An empty database has no sessions, while a missing one is an error
+        write_fixture_file(root / "utmp", "");
+        const auto empty = modules::sessions::read_sessions(root / "utmp");
+        const auto missing = modules::sessions::read_sessions(root / "missing");
+        std::filesystem::remove_all(root);
+        if (!empty || empty->sessions != 0 || missing) {
+            fmt::print(stderr, "modules::sessions::read_sessions() failed: empty or missing database\n");
+            return EXIT_FAILURE;
+        }
+        fmt::print("modules::sessions::read_sessions() passed: {}\n", modules::sessions::get_users());
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "modules::sessions::read_sessions() failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_width::east_asian_width()
+{
+    try {
+        // Tables must be sorted and disjoint for the binary search, and a character cannot be both wide and zero-width
+        const auto is_valid = [](const auto &ranges) {
+            for (std::size_t i = 0; i < ranges.size(); ++i) {
+                if (ranges[i].first > ranges[i].last || (i > 0 && ranges[i - 1].last + 1 >= ranges[i].first)) {
+                    return false;
+                }
+            }
+            return true;
+        };
+        if (!is_valid(core::width::zero_ranges) || !is_valid(core::width::wide_ranges)) {
+            fmt::print(stderr, "core::width tables failed: ranges are out of order or not merged\n");
+            return EXIT_FAILURE;
+        }
+        for (const core::width::Range &range : core::width::wide_ranges) {
+            if (core::width::contains(range.first, core::width::zero_ranges) || core::width::contains(range.last, core::width::zero_ranges)) {
+                fmt::print(stderr, "core::width tables failed: U+{:04X} is both wide and zero-width\n", static_cast<std::uint32_t>(range.first));
+                return EXIT_FAILURE;
+            }
+        }
+
+        // Characters of every East Asian Width category of EastAsianWidth.txt, with the width a terminal gives them:
+        // "W" and "F" take two columns (including the unassigned codepoints of the ideograph planes, which default to "W"),
+        // "Na", "H", "A" and "N" take one, and nonspacing marks and format characters take none whatever their category
+        struct Case final {
+            char32_t codepoint;
+            std::string_view category;
+            std::size_t width;
+        };
+        constexpr std::array<Case, 49> cases = {{
+            {0x1100, "W", 2}, {0x231A, "W", 2}, {0x2E80, "W", 2}, {0x3041, "W", 2}, {0x4E00, "W", 2}, {0x9FFF, "W", 2}, {0xAC00, "W", 2},
+            {0xD7A3, "W", 2}, {0xF900, "W", 2}, {0xFE10, "W", 2}, {0xFE30, "W", 2}, {0x16FE0, "W", 2}, {0x17000, "W", 2}, {0x1B000, "W", 2},
+            {0x1F300, "W", 2}, {0x1F600, "W", 2}, {0x1F9FF, "W", 2}, {0x20000, "W", 2}, {0x2A6DF, "W", 2}, {0x2FFFD, "W", 2}, {0x3FFFD, "W", 2},
+            {0x3000, "F", 2}, {0xFF01, "F", 2}, {0xFFE0, "F", 2},
+            {0x0041, "Na", 1}, {0x27E6, "Na", 1}, {0x2985, "Na", 1},
+            {0x20A9, "H", 1}, {0xFF61, "H", 1}, {0xFFA0, "H", 1}, {0xFFE8, "H", 1},
+            {0x00A1, "A", 1}, {0x00AD, "A", 1}, {0x00B7, "A", 1}, {0x2010, "A", 1}, {0x25A0, "A", 1}, {0xE000, "A", 1},
+            {0x00A9, "N", 1}, {0x0E01, "N", 1}, {0x2603, "N", 1}, {0x1160, "N", 0},
+            {0x0301, "A", 0}, {0x0E31, "N", 0}, {0x200D, "N", 0}, {0xFE0F, "A", 0}, {0xFEFF, "N", 0}, {0x302A, "W", 0}, {0x3099, "W", 0}, {0xE0100, "A", 0},
+        }};
+        for (const Case &c : cases) {
+            if (const std::size_t width = core::width::get_codepoint_width(c.codepoint); width != c.width) {
+                fmt::print(stderr, "core::width::get_codepoint_width() failed for U+{:04X} ({}): got {}, expected {}\n", static_cast<std::uint32_t>(c.codepoint), c.category, width, c.width);
+                return EXIT_FAILURE;
+            }
+        }
+
+        // Logos are measured at compile time with the same tables
+        constexpr core::art::View logo = core::art::compiled<wide_art, layout_palette>.get_view();
+        static_assert(logo.rows[0].width == 4 && logo.rows[1].width == 2 && logo.width == 4, "wide and combining characters must be measured in columns");
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "core::width::get_codepoint_width() failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int test_width::get_width()
+{
+    try {
+        // Escapes take no column, whether colors, hyperlinks terminated by BEL or ST, or truncated at the end
+        const std::vector<std::pair<std::string_view, std::size_t>> cases = {
+            {"", 0},
+            {"Apple M1 Pro", 12},
+            {"\033[1m\033[33mCPU: \033[0m\033[37mApple M1 Pro\033[0m", 17},
+            {"\033]8;;https://example.com\033\\link\033]8;;\033\\", 4},
+            {"\033]0;title\atext", 4},
+            {"\0337\033(Bsaved\0338", 5},
+            {"truncated\033[38;5", 9},
+            {"日本語のテキスト", 16},
+            {"Ｆｕｌｌ ｗｉｄｔｈ", 19},
+            {"caf\u00e9 cafe\u0301", 9},
+            {"\U0001F600 emoji \u2615", 11},
+            {"tab\tand\nnewline\x7f", 13},
+            {"bad \xff\xc0\x80 \xe4\xb8 end", 14},
+        };
+        for (const auto &[text, expected] : cases) {
+            // Shift every case by a few ASCII bytes, so that the escape or multibyte character lands at each position of a word
+            for (std::size_t shift = 0; shift < 9; ++shift) {
+                const std::string shifted = std::string(shift, '-') + std::string(text);
+                const std::size_t fast = core::width::get_width(shifted);
+                const std::size_t slow = core::width::measure(shifted);
+                if (fast != expected + shift || slow != expected + shift) {
+                    fmt::print(stderr, "core::width::get_width() failed for \"{}\": got {} and {}, expected {}\n", shifted, fast, slow, expected + shift);
+                    return EXIT_FAILURE;
+                }
+            }
+        }
+        static_assert(core::width::measure("\033[32m日本\033[0m") == 4, "escapes must be skipped at compile time");
+
+        // Padding counts columns, so wide values line up with ASCII ones
+        std::string output;
+        core::width::append_padded("日本語", 8, output);
+        output.append("|");
+        core::width::append_padded("abc", 8, output);
+        output.append("|");
+        core::width::append_padded("too long for it", 8, output);
+        if (output != "日本語  |abc     |too long for it") {
+            fmt::print(stderr, "core::width::append_padded() failed: got \"{}\"\n", output);
+            return EXIT_FAILURE;
+        }
+        modules::inventory::Device device;
+        device.bus = "USB";
+        device.address = "1-1";
+        device.vendor = "株式会社バッファロー";
+        device.name = "Drive";
+        modules::inventory::Device other = device;
+        other.vendor = "Logitech, Inc.";
+        const std::string text = modules::inventory::format_text({device, other});
+        if (text != "USB  1-1  0000:0000  株式会社バッファロー  Drive\n"
+                    "USB  1-1  0000:0000  Logitech, Inc.        Drive\n") {
+            fmt::print(stderr, "modules::inventory::format_text() failed: got:\n{}", text);
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "core::width::get_width() failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
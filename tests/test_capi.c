@@ -0,0 +1,101 @@
+/**
+ * @file test_capi.c
+ *
+ * @brief Test the C API from plain C, as an embedding program would use it.
+ */
+
+#include <stdint.h>  // for uint64_t
+#include <stdio.h>   // for fprintf, printf, stderr
+#include <stdlib.h>  // for EXIT_FAILURE, EXIT_SUCCESS
+#include <string.h>  // for strncmp
+
+#include "applefetch.h"
+
+/**
+ * @brief Entry-point of the C API test.
+ *
+ * @return EXIT_SUCCESS if all checks passed, EXIT_FAILURE otherwise.
+ */
+int main(void)
+{
+    if (af_api_version() != AF_API_VERSION) {
+        fprintf(stderr, "af_api_version() failed: expected %u, got %u\n", AF_API_VERSION, af_api_version());
+        return EXIT_FAILURE;
+    }
+    if (af_create(AF_API_VERSION + 1u) != NULL) {
+        fprintf(stderr, "af_create() failed: accepted an unsupported version\n");
+        return EXIT_FAILURE;
+    }
+
+    af_context *ctx = af_create(AF_API_VERSION);
+    if (ctx == NULL) {
+        fprintf(stderr, "af_create() failed\n");
+        return EXIT_FAILURE;
+    }
+
+    int result = EXIT_SUCCESS;
+    uint64_t seconds = 0;
+    af_memory memory = {0, 0};
+
+    // Nothing is available before the first refresh
+    if (af_get_uptime(ctx, &seconds) != AF_ERROR_UNAVAILABLE || af_get_string(ctx, AF_FIELD_CPU)[0] != '\0') {
+        fprintf(stderr, "af_get_*() failed: returned a value before af_refresh()\n");
+        result = EXIT_FAILURE;
+    }
+
+    // Invalid arguments are rejected instead of crashing
+    if (af_refresh(NULL, AF_FIELDS_ALL) != AF_ERROR_INVALID_ARGUMENT || af_refresh(ctx, 1u << 31) != AF_ERROR_INVALID_ARGUMENT ||
+        af_get_string(ctx, (af_field)0) != NULL || af_get_memory(ctx, NULL) != AF_ERROR_INVALID_ARGUMENT) {
+        fprintf(stderr, "af_*() failed: accepted an invalid argument\n");
+        result = EXIT_FAILURE;
+    }
+
+    // Volatile fields are read directly from the kernel and must always be available
+    if (af_refresh(ctx, AF_FIELDS_VOLATILE) != AF_OK) {
+        fprintf(stderr, "af_refresh(AF_FIELDS_VOLATILE) failed\n");
+        result = EXIT_FAILURE;
+    }
+    if (af_get_uptime(ctx, &seconds) != AF_OK || seconds == 0) {
+        fprintf(stderr, "af_get_uptime() failed\n");
+        result = EXIT_FAILURE;
+    }
+    if (af_get_memory(ctx, &memory) != AF_OK || memory.total_bytes == 0 || memory.used_bytes > memory.total_bytes) {
+        fprintf(stderr, "af_get_memory() failed: %llu / %llu bytes\n", (unsigned long long)memory.used_bytes, (unsigned long long)memory.total_bytes);
+        result = EXIT_FAILURE;
+    }
+    printf("Uptime: %s\n", af_get_string(ctx, AF_FIELD_UPTIME));
+    printf("Memory: %s\n", af_get_string(ctx, AF_FIELD_MEMORY));
+
+    // Static fields may be unavailable in CI (e.g., no display), but must never return NULL
+    const af_status static_status = af_refresh(ctx, AF_FIELDS_ALL & ~AF_FIELDS_VOLATILE);
+    if (af_get_string(ctx, AF_FIELD_OS) == NULL || af_get_string(ctx, AF_FIELD_CPU) == NULL) {
+        fprintf(stderr, "af_get_string() failed: returned NULL for a valid field\n");
+        result = EXIT_FAILURE;
+    }
+
+    // A field that could not be read is reported by the status and left empty, never stored as "Unknown ..."
+    int missing = 0;
+    for (uint32_t field = 1; (field & AF_FIELDS_ALL) != 0; field <<= 1) {
+        if ((field & AF_FIELDS_VOLATILE) != 0) {
+            continue;
+        }
+        const char *value = af_get_string(ctx, (af_field)field);
+        if (value[0] == '\0') {
+            missing = 1;
+        }
+        else if (strncmp(value, "Unknown ", 8) == 0) {
+            fprintf(stderr, "af_refresh() failed: stored \"%s\" as a valid value\n", value);
+            result = EXIT_FAILURE;
+        }
+    }
+    if ((static_status == AF_OK) == (missing != 0)) {
+        fprintf(stderr, "af_refresh() failed: returned %d with%s missing fields\n", (int)static_status, missing ? "" : "out");
+        result = EXIT_FAILURE;
+    }
+    printf("OS: %s\n", af_get_string(ctx, AF_FIELD_OS));
+    printf("CPU: %s\n", af_get_string(ctx, AF_FIELD_CPU));
+
+    af_destroy(ctx);
+    af_destroy(NULL);
+    return result;
+}
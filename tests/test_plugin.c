@@ -0,0 +1,67 @@
+/**
+ * @file test_plugin.c
+ *
+ * @brief Plugin for the plugin tests, with fields that count, fail, overflow and crash on purpose.
+ */
+
+#include <signal.h>  // for raise, SIGSEGV
+#include <stddef.h>  // for size_t
+#include <stdint.h>  // for uint32_t
+#include <stdio.h>   // for snprintf
+#include <string.h>  // for memset
+
+#include "applefetch_plugin.h"
+
+/**
+ * @brief Fields provided by the plugin, in the order of their indices.
+ */
+static const af_plugin_field fields[] = {
+    {"Counter", AF_PLUGIN_VOLATILE},
+    {"Greeting", AF_PLUGIN_STATIC},
+    {"Failing", AF_PLUGIN_STATIC},
+    {"Overflow", AF_PLUGIN_STATIC},
+    {"Crash", AF_PLUGIN_STATIC},
+};
+
+/**
+ * @brief Number of times "Counter" was probed in this process.
+ */
+static unsigned counter = 0;
+
+/**
+ * @brief Probe a field.
+ *
+ * @param field_index Index of the field in "fields".
+ * @param buffer Buffer to write the value to.
+ * @param size Size of the buffer in bytes.
+ *
+ * @return 0 if succeeded, 7 for "Failing".
+ */
+static int probe(uint32_t field_index,
+                 char *buffer,
+                 size_t size)
+{
+    switch (field_index) {
+    case 0:
+        snprintf(buffer, size, "%u", ++counter);
+        return 0;
+    case 1:
+        snprintf(buffer, size, "%s", "Hello from a plugin");
+        return 0;
+    case 2:
+        return 7;
+    case 3:
+        // Fill the whole buffer without a terminator, which the caller must not read past
+        memset(buffer, 'x', size);
+        return 0;
+    default:
+        raise(SIGSEGV);
+        return 0;
+    }
+}
+
+AF_PLUGIN_EXPORT const af_plugin_descriptor *af_plugin_get_descriptor(void)
+{
+    static const af_plugin_descriptor descriptor = {AF_PLUGIN_ABI_VERSION, "test", sizeof(fields) / sizeof(fields[0]), fields, probe};
+    return &descriptor;
+}